@@ -0,0 +1,238 @@
+/*
+ * bench_locks.c
+ *
+ * 锁后端对比基准
+ * 目的：在相同的短临界区下比较 NvmLock.h 中各锁实现与 pthread 原语的
+ *       吞吐与公平性，用于选择 NVM_*_BACKEND。
+ *
+ * 方法：
+ *   1. 互斥类 (spin / ticket / mcs / clh / mutex / adaptive)：
+ *      每个线程在固定时长内反复 加锁 -> 更新共享计数 -> 解锁，
+ *      统计总吞吐以及各线程完成数的最小/最大比 (1.0 为完全公平)。
+ *   2. 读写锁 (pthread / percpu)：95% 读、5% 写的混合负载。
+ *
+ * 用法: ./bench_locks [max_threads] [duration_ms]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "NvmDefs.h"
+#include "NvmConfig.h"
+
+// ============================================================================
+//                          基准配置参数
+// ============================================================================
+
+#define DEFAULT_MAX_THREADS  8
+#define DEFAULT_DURATION_MS  300
+#define MAX_BENCH_THREADS    MAX_CPUS
+
+// 临界区内的额外工作量 (模拟 Slab 位图操作)
+#define CRITICAL_WORK        16
+
+// 读写锁负载中写操作的比例 (每 N 次一次写)
+#define RW_WRITE_EVERY       20
+
+// ============================================================================
+//                          被测锁的统一接口
+// ============================================================================
+
+typedef struct LockImpl {
+    const char* name;
+    size_t      size;
+    int (*init)(void* l);
+    int (*destroy)(void* l);
+    int (*acquire)(void* l);
+    int (*release)(void* l);
+    int (*read_acquire)(void* l);   // 仅读写锁使用
+} LockImpl;
+
+static int spin_init(void* l)      { return pthread_spin_init((pthread_spinlock_t*)l, PTHREAD_PROCESS_PRIVATE); }
+static int spin_destroy(void* l)   { return pthread_spin_destroy((pthread_spinlock_t*)l); }
+static int spin_acquire(void* l)   { return pthread_spin_lock((pthread_spinlock_t*)l); }
+static int spin_release(void* l)   { return pthread_spin_unlock((pthread_spinlock_t*)l); }
+
+static int ticket_init(void* l)    { return nvm_ticket_lock_init((nvm_ticket_lock_t*)l); }
+static int ticket_destroy(void* l) { return nvm_ticket_lock_destroy((nvm_ticket_lock_t*)l); }
+static int ticket_acquire(void* l) { return nvm_ticket_lock_acquire((nvm_ticket_lock_t*)l); }
+static int ticket_release(void* l) { return nvm_ticket_lock_release((nvm_ticket_lock_t*)l); }
+
+static int mcs_init(void* l)       { return nvm_mcs_lock_init((nvm_mcs_lock_t*)l); }
+static int mcs_destroy(void* l)    { return nvm_mcs_lock_destroy((nvm_mcs_lock_t*)l); }
+static int mcs_acquire(void* l)    { return nvm_mcs_lock_acquire((nvm_mcs_lock_t*)l); }
+static int mcs_release(void* l)    { return nvm_mcs_lock_release((nvm_mcs_lock_t*)l); }
+
+static int clh_init(void* l)       { return nvm_clh_lock_init((nvm_clh_lock_t*)l); }
+static int clh_destroy(void* l)    { return nvm_clh_lock_destroy((nvm_clh_lock_t*)l); }
+static int clh_acquire(void* l)    { return nvm_clh_lock_acquire((nvm_clh_lock_t*)l); }
+static int clh_release(void* l)    { return nvm_clh_lock_release((nvm_clh_lock_t*)l); }
+
+static int mutex_init(void* l)     { return pthread_mutex_init((pthread_mutex_t*)l, NULL); }
+static int mutex_destroy(void* l)  { return pthread_mutex_destroy((pthread_mutex_t*)l); }
+static int mutex_acquire(void* l)  { return pthread_mutex_lock((pthread_mutex_t*)l); }
+static int mutex_release(void* l)  { return pthread_mutex_unlock((pthread_mutex_t*)l); }
+
+static int adaptive_init(void* l)    { return nvm_adaptive_mutex_init((nvm_adaptive_mutex_t*)l); }
+static int adaptive_destroy(void* l) { return nvm_adaptive_mutex_destroy((nvm_adaptive_mutex_t*)l); }
+static int adaptive_acquire(void* l) { return nvm_adaptive_mutex_acquire((nvm_adaptive_mutex_t*)l); }
+static int adaptive_release(void* l) { return nvm_adaptive_mutex_release((nvm_adaptive_mutex_t*)l); }
+
+static int rw_init(void* l)        { return pthread_rwlock_init((pthread_rwlock_t*)l, NULL); }
+static int rw_destroy(void* l)     { return pthread_rwlock_destroy((pthread_rwlock_t*)l); }
+static int rw_wrlock(void* l)      { return pthread_rwlock_wrlock((pthread_rwlock_t*)l); }
+static int rw_rdlock(void* l)      { return pthread_rwlock_rdlock((pthread_rwlock_t*)l); }
+static int rw_unlock(void* l)      { return pthread_rwlock_unlock((pthread_rwlock_t*)l); }
+
+static int percpu_init(void* l)    { return nvm_percpu_rwlock_init((nvm_percpu_rwlock_t*)l); }
+static int percpu_destroy(void* l) { return nvm_percpu_rwlock_destroy((nvm_percpu_rwlock_t*)l); }
+static int percpu_wrlock(void* l)  { return nvm_percpu_rwlock_write_lock((nvm_percpu_rwlock_t*)l); }
+static int percpu_rdlock(void* l)  { return nvm_percpu_rwlock_read_lock((nvm_percpu_rwlock_t*)l); }
+static int percpu_unlock(void* l)  { return nvm_percpu_rwlock_unlock((nvm_percpu_rwlock_t*)l); }
+
+static const LockImpl g_mutex_impls[] = {
+    { "pthread-spin", sizeof(pthread_spinlock_t),   spin_init,     spin_destroy,     spin_acquire,     spin_release,     NULL },
+    { "ticket",       sizeof(nvm_ticket_lock_t),    ticket_init,   ticket_destroy,   ticket_acquire,   ticket_release,   NULL },
+    { "mcs",          sizeof(nvm_mcs_lock_t),       mcs_init,      mcs_destroy,      mcs_acquire,      mcs_release,      NULL },
+    { "clh",          sizeof(nvm_clh_lock_t),       clh_init,      clh_destroy,      clh_acquire,      clh_release,      NULL },
+    { "pthread-mutex", sizeof(pthread_mutex_t),     mutex_init,    mutex_destroy,    mutex_acquire,    mutex_release,    NULL },
+    { "adaptive",     sizeof(nvm_adaptive_mutex_t), adaptive_init, adaptive_destroy, adaptive_acquire, adaptive_release, NULL },
+};
+
+static const LockImpl g_rwlock_impls[] = {
+    { "pthread-rw",   sizeof(pthread_rwlock_t),     rw_init,       rw_destroy,       rw_wrlock,        rw_unlock,        rw_rdlock },
+    { "percpu-rw",    sizeof(nvm_percpu_rwlock_t),  percpu_init,   percpu_destroy,   percpu_wrlock,    percpu_unlock,    percpu_rdlock },
+};
+
+// ============================================================================
+//                          基准逻辑
+// ============================================================================
+
+typedef struct WorkerArg {
+    const LockImpl*  impl;
+    void*            lock;
+    volatile int*    stop;
+    volatile uint64_t* shared;
+    uint64_t         ops;
+} __attribute__((aligned(CACHE_LINE_SIZE))) WorkerArg;
+
+// 防止读路径被优化掉
+static volatile uint64_t g_sink;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void critical_section(volatile uint64_t* shared) {
+    for (int i = 0; i < CRITICAL_WORK; ++i) {
+        shared[i % 8] += 1;
+    }
+}
+
+static void* mutex_worker(void* arg) {
+    WorkerArg* w = (WorkerArg*)arg;
+    uint64_t ops = 0;
+    while (!*w->stop) {
+        w->impl->acquire(w->lock);
+        critical_section(w->shared);
+        w->impl->release(w->lock);
+        ++ops;
+    }
+    w->ops = ops;
+    return NULL;
+}
+
+static void* rw_worker(void* arg) {
+    WorkerArg* w = (WorkerArg*)arg;
+    uint64_t ops = 0;
+    uint64_t sink = 0;
+    while (!*w->stop) {
+        if (ops % RW_WRITE_EVERY == 0) {
+            w->impl->acquire(w->lock);
+            critical_section(w->shared);
+        } else {
+            w->impl->read_acquire(w->lock);
+            sink += w->shared[ops % 8];
+        }
+        w->impl->release(w->lock);
+        ++ops;
+    }
+    w->ops = ops;
+    g_sink += sink;
+    return NULL;
+}
+
+static void run_case(const LockImpl* impl, void* (*worker)(void*), int threads, int duration_ms) {
+    void* lock = aligned_alloc(CACHE_LINE_SIZE, NVM_ALIGN_UP(impl->size, CACHE_LINE_SIZE));
+    if (!lock || impl->init(lock) != 0) {
+        printf("%-14s | init failed\n", impl->name);
+        free(lock);
+        return;
+    }
+
+    static volatile uint64_t shared[8] __attribute__((aligned(CACHE_LINE_SIZE)));
+    volatile int stop = 0;
+    pthread_t tids[MAX_BENCH_THREADS];
+    WorkerArg args[MAX_BENCH_THREADS];
+
+    for (int i = 0; i < threads; ++i) {
+        args[i] = (WorkerArg){ impl, lock, &stop, shared, 0 };
+        pthread_create(&tids[i], NULL, worker, &args[i]);
+    }
+
+    double start = now_sec();
+    struct timespec ts = { duration_ms / 1000, (long)(duration_ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+    stop = 1;
+
+    uint64_t total = 0, min_ops = UINT64_MAX, max_ops = 0;
+    for (int i = 0; i < threads; ++i) {
+        pthread_join(tids[i], NULL);
+        total += args[i].ops;
+        if (args[i].ops < min_ops) min_ops = args[i].ops;
+        if (args[i].ops > max_ops) max_ops = args[i].ops;
+    }
+    double elapsed = now_sec() - start;
+
+    printf("%-14s | %7d | %12.2f | %10.1f | %8.3f\n",
+           impl->name, threads, total / elapsed / 1e6,
+           total ? elapsed * 1e9 / total : 0.0,
+           max_ops ? (double)min_ops / max_ops : 0.0);
+
+    impl->destroy(lock);
+    free(lock);
+}
+
+int main(int argc, char** argv) {
+    int max_threads = (argc > 1) ? atoi(argv[1]) : DEFAULT_MAX_THREADS;
+    int duration_ms = (argc > 2) ? atoi(argv[2]) : DEFAULT_DURATION_MS;
+    if (max_threads < 1) max_threads = 1;
+    if (max_threads > MAX_BENCH_THREADS) max_threads = MAX_BENCH_THREADS;
+
+    printf("==================================================================\n");
+    printf("  Lock Backend Benchmark (duration %d ms, critical work %d)\n", duration_ms, CRITICAL_WORK);
+    printf("==================================================================\n");
+    printf("%-14s | %7s | %12s | %10s | %8s\n", "Lock", "Threads", "Mops/s", "ns/op", "Fairness");
+    printf("------------------------------------------------------------------\n");
+
+    for (size_t i = 0; i < sizeof(g_mutex_impls) / sizeof(g_mutex_impls[0]); ++i) {
+        for (int t = 1; t <= max_threads; t *= 2) {
+            run_case(&g_mutex_impls[i], mutex_worker, t, duration_ms);
+        }
+    }
+
+    printf("------------------------------------------------------------------\n");
+    printf("  RWLock: %d%% reads\n", 100 - 100 / RW_WRITE_EVERY);
+    printf("------------------------------------------------------------------\n");
+    for (size_t i = 0; i < sizeof(g_rwlock_impls) / sizeof(g_rwlock_impls[0]); ++i) {
+        for (int t = 1; t <= max_threads; t *= 2) {
+            run_case(&g_rwlock_impls[i], rw_worker, t, duration_ms);
+        }
+    }
+    return 0;
+}
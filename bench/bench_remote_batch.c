@@ -0,0 +1,209 @@
+/*
+ * bench_remote_batch.c
+ *
+ * 远程释放批处理基准
+ * 目的：在生产者/消费者模式 (同 tests/test_nvm_multithread.c 的跨线程交接) 下，
+ *       对比远程释放逐块写入 Slab 暂存区 (remote_batch:0) 与按目标 Slab 线程本地成组后
+ *       整组写入 (remote_batch:N)，观察吞吐与目标 Slab 远程锁的获取次数。
+ *
+ * 方法：
+ *   生产者线程绑定在 CPU 0 上反复 nvm_malloc，把指针经单生产者单消费者队列交给 N 个
+ *   绑定在其他 CPU 上的消费者线程，消费者 nvm_free 后退出前调用 nvm_free_remote_flush。
+ *   队列满时生产者自己释放。每种配置重建一次分配器，统计固定时长内的吞吐。
+ *   只有 1 个 CPU 时所有释放都是本地释放，两种配置没有差别。
+ *
+ * 用法: ./bench_remote_batch [max_consumers] [duration_ms]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "NvmDefs.h"
+#include "NvmAllocator.h"
+
+// ============================================================================
+//                          基准配置参数
+// ============================================================================
+
+#define DEFAULT_MAX_CONSUMERS 8
+#define DEFAULT_DURATION_MS   300
+#define MAX_BENCH_THREADS     (MAX_CPUS - 1)
+#define BLOCK_SIZE            64
+#define BATCH_SIZE            32    // remote_batch 的默认值
+
+// 生产者到每个消费者的队列容量 (2 的幂)
+#define HANDOFF_RING_SIZE     1024
+
+// 管理区域: 128MB (64 个 Slab)
+#define TOTAL_NVM_SIZE        (64ULL * NVM_SLAB_SIZE)
+
+// ============================================================================
+//                          基准逻辑
+// ============================================================================
+
+typedef struct HandoffRing {
+    uint32_t head __attribute__((aligned(CACHE_LINE_SIZE)));   // 消费者写
+    uint32_t tail __attribute__((aligned(CACHE_LINE_SIZE)));   // 生产者写
+    void*    slots[HANDOFF_RING_SIZE];
+} HandoffRing;
+
+typedef struct ConsumerArg {
+    HandoffRing*  ring;
+    volatile int* stop;
+    int           cpu;
+    uint64_t      frees;
+} __attribute__((aligned(CACHE_LINE_SIZE))) ConsumerArg;
+
+typedef struct ProducerArg {
+    HandoffRing*  rings;
+    int           ring_count;
+    volatile int* stop;
+    uint64_t      allocs;
+} ProducerArg;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void pin_to_cpu(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+static void* producer_worker(void* arg) {
+    ProducerArg* p = (ProducerArg*)arg;
+    uint64_t allocs = 0;
+    pin_to_cpu(0);
+
+    while (!*p->stop) {
+        void* ptr = nvm_malloc(BLOCK_SIZE);
+        if (!ptr) {
+            sched_yield();   // 空间暂时用尽，等待消费者归还
+            continue;
+        }
+        ++allocs;
+
+        HandoffRing* ring = &p->rings[allocs % p->ring_count];
+        uint32_t tail = ring->tail;
+        if (tail - __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) >= HANDOFF_RING_SIZE) {
+            nvm_free(ptr);
+            continue;
+        }
+        ring->slots[tail % HANDOFF_RING_SIZE] = ptr;
+        __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+    }
+    p->allocs = allocs;
+    return NULL;
+}
+
+static void* consumer_worker(void* arg) {
+    ConsumerArg* c = (ConsumerArg*)arg;
+    HandoffRing* ring = c->ring;
+    uint64_t frees = 0;
+    pin_to_cpu(c->cpu);
+
+    for (;;) {
+        uint32_t head = ring->head;
+        if (head == __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)) {
+            if (*c->stop) break;
+            continue;
+        }
+        void* ptr = ring->slots[head % HANDOFF_RING_SIZE];
+        __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+        nvm_free(ptr);
+        ++frees;
+    }
+    nvm_free_remote_flush();
+    c->frees = frees;
+    return NULL;
+}
+
+static void run_case(void* nvm_base, uint32_t batch, int consumers, int cpus, int duration_ms) {
+    NvmAllocatorConfig config;
+    nvm_allocator_config_default(&config);
+    config.remote_batch = batch;
+    HandoffRing* rings = aligned_alloc(CACHE_LINE_SIZE, sizeof(HandoffRing) * consumers);
+    if (!rings || nvm_allocator_create_config(nvm_base, TOTAL_NVM_SIZE, 0, &config) != 0) {
+        printf("%5u | init failed\n", batch);
+        free(rings);
+        return;
+    }
+    memset(rings, 0, sizeof(HandoffRing) * consumers);
+
+    volatile int stop = 0;
+    pthread_t producer_tid;
+    pthread_t tids[MAX_BENCH_THREADS];
+    ConsumerArg args[MAX_BENCH_THREADS];
+    ProducerArg producer = { rings, consumers, &stop, 0 };
+
+    for (int i = 0; i < consumers; ++i) {
+        int cpu = (cpus > 1) ? 1 + i % (cpus - 1) : 0;
+        args[i] = (ConsumerArg){ &rings[i], &stop, cpu, 0 };
+        pthread_create(&tids[i], NULL, consumer_worker, &args[i]);
+    }
+    pthread_create(&producer_tid, NULL, producer_worker, &producer);
+
+    double start = now_sec();
+    struct timespec ts = { duration_ms / 1000, (long)(duration_ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+    stop = 1;
+
+    pthread_join(producer_tid, NULL);
+    uint64_t frees = 0;
+    for (int i = 0; i < consumers; ++i) {
+        pthread_join(tids[i], NULL);
+        frees += args[i].frees;
+    }
+    double elapsed = now_sec() - start;
+
+    uint64_t batched = 0, flushes = 0;
+    size_t len = sizeof(uint64_t);
+    nvm_ctl("stats.remote_batch.frees", &batched, &len, NULL, 0);
+    nvm_ctl("stats.remote_batch.flushes", &flushes, &len, NULL, 0);
+
+    printf("%5u | %9d | %14.2f | %14.2f | %12.1f\n",
+           batch, consumers, producer.allocs / elapsed / 1e6, frees / elapsed / 1e6,
+           flushes ? (double)batched / flushes : 0.0);
+
+    nvm_allocator_destroy();
+    free(rings);
+}
+
+int main(int argc, char** argv) {
+    int max_consumers = (argc > 1) ? atoi(argv[1]) : DEFAULT_MAX_CONSUMERS;
+    int duration_ms = (argc > 2) ? atoi(argv[2]) : DEFAULT_DURATION_MS;
+    if (max_consumers < 1) max_consumers = 1;
+    if (max_consumers > MAX_BENCH_THREADS) max_consumers = MAX_BENCH_THREADS;
+
+    int cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    void* nvm_base = aligned_alloc(NVM_SLAB_SIZE, TOTAL_NVM_SIZE);
+    if (!nvm_base) {
+        fprintf(stderr, "Failed to allocate NVM region.\n");
+        return 1;
+    }
+
+    printf("====================================================================\n");
+    printf("  Remote Free Batching, producer/consumer (%d ms, %d CPUs)\n", duration_ms, cpus);
+    printf("====================================================================\n");
+    if (cpus < 2) printf("  (single CPU: all frees are local, batching is not exercised)\n");
+    printf("%5s | %9s | %14s | %14s | %12s\n", "Batch", "Consumers", "Alloc Mops/s", "Free Mops/s", "Blocks/lock");
+    printf("--------------------------------------------------------------------\n");
+
+    for (int c = 1; c <= max_consumers; c *= 2) {
+        run_case(nvm_base, 0, c, cpus, duration_ms);
+        run_case(nvm_base, BATCH_SIZE, c, cpus, duration_ms);
+    }
+
+    free(nvm_base);
+    return 0;
+}
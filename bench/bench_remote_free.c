@@ -0,0 +1,183 @@
+/*
+ * bench_remote_free.c
+ *
+ * Slab 远程释放扩展性基准
+ * 目的：衡量其他 CPU 的释放对 Slab 持有者分配路径的干扰 (锁与缓存行伪共享)，
+ *       对比远程释放走持有者路径 (nvm_slab_free)、远程暂存区 (nvm_slab_free_remote)
+ *       与原子位图引擎 (nvm_slab_create_atomic，无 Slab 锁，直接清位)。
+ *
+ * 方法：
+ *   一个持有者线程在单个 Slab 上反复分配，把块交给 N 个释放线程 (每线程一个
+ *   单生产者单消费者队列)；释放线程取出后执行远程释放。队列满时持有者自己释放。
+ *   统计固定时长内持有者的分配吞吐与远程释放总数，N 从 1 倍增到 max_threads。
+ *
+ * 用法: ./bench_remote_free [max_threads] [duration_ms]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+
+#include "NvmDefs.h"
+#include "NvmSlab.h"
+
+// ============================================================================
+//                          基准配置参数
+// ============================================================================
+
+#define DEFAULT_MAX_THREADS  8
+#define DEFAULT_DURATION_MS  300
+#define MAX_BENCH_THREADS    (MAX_CPUS - 1)
+
+// 持有者到每个释放线程的队列容量 (2 的幂)
+#define HANDOFF_RING_SIZE    1024
+
+// ============================================================================
+//                          基准逻辑
+// ============================================================================
+
+typedef struct HandoffRing {
+    uint32_t head __attribute__((aligned(CACHE_LINE_SIZE)));   // 消费者写
+    uint32_t tail __attribute__((aligned(CACHE_LINE_SIZE)));   // 生产者写
+    uint32_t slots[HANDOFF_RING_SIZE];
+} HandoffRing;
+
+typedef struct FreerArg {
+    NvmSlab*      slab;
+    HandoffRing*  ring;
+    volatile int* stop;
+    int           use_remote;
+    uint64_t      frees;
+} __attribute__((aligned(CACHE_LINE_SIZE))) FreerArg;
+
+typedef struct OwnerArg {
+    NvmSlab*      slab;
+    HandoffRing*  rings;
+    int           ring_count;
+    volatile int* stop;
+    uint64_t      allocs;
+} OwnerArg;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void* owner_worker(void* arg) {
+    OwnerArg* o = (OwnerArg*)arg;
+    uint64_t allocs = 0;
+    uint32_t block_idx;
+
+    while (!*o->stop) {
+        if (nvm_slab_alloc(o->slab, &block_idx) != 0) {
+            sched_yield();   // Slab 暂时用尽，等待释放线程归还
+            continue;
+        }
+        ++allocs;
+
+        HandoffRing* ring = &o->rings[allocs % o->ring_count];
+        uint32_t tail = ring->tail;
+        if (tail - __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) >= HANDOFF_RING_SIZE) {
+            nvm_slab_free(o->slab, block_idx);
+            continue;
+        }
+        ring->slots[tail % HANDOFF_RING_SIZE] = block_idx;
+        __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+    }
+    o->allocs = allocs;
+    return NULL;
+}
+
+static void* freer_worker(void* arg) {
+    FreerArg* f = (FreerArg*)arg;
+    HandoffRing* ring = f->ring;
+    uint64_t frees = 0;
+
+    for (;;) {
+        uint32_t head = ring->head;
+        if (head == __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)) {
+            if (*f->stop) break;
+            continue;
+        }
+        uint32_t block_idx = ring->slots[head % HANDOFF_RING_SIZE];
+        __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+
+        if (f->use_remote) {
+            nvm_slab_free_remote(f->slab, block_idx);
+        } else {
+            nvm_slab_free(f->slab, block_idx);
+        }
+        ++frees;
+    }
+    f->frees = frees;
+    return NULL;
+}
+
+static void run_case(const char* name, int use_remote, int atomic, int threads, int duration_ms) {
+    NvmSlab* slab = atomic ? nvm_slab_create_atomic(SC_64B, 0, -1) : nvm_slab_create(SC_64B, 0);
+    HandoffRing* rings = aligned_alloc(CACHE_LINE_SIZE, sizeof(HandoffRing) * threads);
+    if (!slab || !rings) {
+        printf("%-8s | init failed\n", name);
+        nvm_slab_destroy(slab);
+        free(rings);
+        return;
+    }
+    memset(rings, 0, sizeof(HandoffRing) * threads);
+
+    volatile int stop = 0;
+    pthread_t owner_tid;
+    pthread_t tids[MAX_BENCH_THREADS];
+    FreerArg args[MAX_BENCH_THREADS];
+    OwnerArg owner = { slab, rings, threads, &stop, 0 };
+
+    for (int i = 0; i < threads; ++i) {
+        args[i] = (FreerArg){ slab, &rings[i], &stop, use_remote, 0 };
+        pthread_create(&tids[i], NULL, freer_worker, &args[i]);
+    }
+    pthread_create(&owner_tid, NULL, owner_worker, &owner);
+
+    double start = now_sec();
+    struct timespec ts = { duration_ms / 1000, (long)(duration_ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+    stop = 1;
+
+    pthread_join(owner_tid, NULL);
+    uint64_t frees = 0;
+    for (int i = 0; i < threads; ++i) {
+        pthread_join(tids[i], NULL);
+        frees += args[i].frees;
+    }
+    double elapsed = now_sec() - start;
+
+    printf("%-8s | %7d | %14.2f | %14.2f | %10.1f\n",
+           name, threads, owner.allocs / elapsed / 1e6, frees / elapsed / 1e6,
+           owner.allocs ? elapsed * 1e9 / owner.allocs : 0.0);
+
+    nvm_slab_destroy(slab);
+    free(rings);
+}
+
+int main(int argc, char** argv) {
+    int max_threads = (argc > 1) ? atoi(argv[1]) : DEFAULT_MAX_THREADS;
+    int duration_ms = (argc > 2) ? atoi(argv[2]) : DEFAULT_DURATION_MS;
+    if (max_threads < 1) max_threads = 1;
+    if (max_threads > MAX_BENCH_THREADS) max_threads = MAX_BENCH_THREADS;
+
+    printf("==================================================================\n");
+    printf("  Slab Remote Free Scaling (duration %d ms, remote buffer %d)\n",
+           duration_ms, SLAB_REMOTE_BUFFER_SIZE);
+    printf("==================================================================\n");
+    printf("%-8s | %7s | %14s | %14s | %10s\n", "Path", "Freers", "Alloc Mops/s", "Free Mops/s", "ns/alloc");
+    printf("------------------------------------------------------------------\n");
+
+    for (int t = 1; t <= max_threads; t *= 2) {
+        run_case("shared", 0, 0, t, duration_ms);
+        run_case("staged", 1, 0, t, duration_ms);
+        run_case("atomic", 1, 1, t, duration_ms);
+    }
+    return 0;
+}
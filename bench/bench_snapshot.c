@@ -0,0 +1,137 @@
+/*
+ * bench_snapshot.c
+ *
+ * 堆快照开销基准
+ * 目的：比较二进制快照 (nvm_heap_snapshot) 与 printf 调试转储 (nvm_allocator_debug_print)
+ *       在同一个碎片化堆上的耗时与输出大小。
+ *
+ * 方法：
+ *   按 8B ~ 4KB 轮流分配填满若干 Slab，再在每个尺寸类别内隔一释放一个，使每个 Slab 的位图高度碎片化；
+ *   两种方式都写入 /dev/null 测耗时 (调试转储临时重定向 stdout)，另写一次临时文件测大小。
+ *
+ * 用法: ./bench_snapshot [blocks] [repeats]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "NvmAllocator.h"
+
+// ============================================================================
+//                          基准配置参数
+// ============================================================================
+
+#define DEFAULT_BLOCKS   200000
+#define DEFAULT_REPEATS  5
+
+// 管理区域: 512MB (256 个 Slab)
+#define TOTAL_NVM_SIZE   (256ULL * NVM_SLAB_SIZE)
+
+// ============================================================================
+//                          基准逻辑
+// ============================================================================
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double time_snapshot(int repeats) {
+    int fd = open("/dev/null", O_WRONLY);
+    double start = now_sec();
+    for (int i = 0; i < repeats; ++i) nvm_heap_snapshot(fd);
+    double elapsed = (now_sec() - start) / repeats;
+    close(fd);
+    return elapsed;
+}
+
+static double time_debug_print(int repeats) {
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int fd = open("/dev/null", O_WRONLY);
+    dup2(fd, STDOUT_FILENO);
+    close(fd);
+
+    double start = now_sec();
+    for (int i = 0; i < repeats; ++i) nvm_allocator_debug_print();
+    fflush(stdout);
+    double elapsed = (now_sec() - start) / repeats;
+
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    return elapsed;
+}
+
+// 输出大小：写入临时文件后取文件长度
+static long output_size(bool snapshot) {
+    FILE* f = tmpfile();
+    if (!f) return -1;
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    if (snapshot) {
+        nvm_heap_snapshot(fileno(f));
+    } else {
+        dup2(fileno(f), STDOUT_FILENO);
+        nvm_allocator_debug_print();
+        fflush(stdout);
+        dup2(saved, STDOUT_FILENO);
+    }
+    close(saved);
+    long size = lseek(fileno(f), 0, SEEK_END);
+    fclose(f);
+    return size;
+}
+
+int main(int argc, char** argv) {
+    int blocks = (argc > 1) ? atoi(argv[1]) : DEFAULT_BLOCKS;
+    int repeats = (argc > 2) ? atoi(argv[2]) : DEFAULT_REPEATS;
+    if (blocks < 2) blocks = 2;
+    if (repeats < 1) repeats = 1;
+
+    void* nvm_base = aligned_alloc(NVM_SLAB_SIZE, TOTAL_NVM_SIZE);
+    void** ptrs = (void**)malloc((size_t)blocks * sizeof(void*));
+    if (!nvm_base || !ptrs || nvm_allocator_create(nvm_base, TOTAL_NVM_SIZE) != 0) {
+        fprintf(stderr, "Failed to set up allocator.\n");
+        return 1;
+    }
+
+    // 8B ~ 4KB 轮流分配，每个尺寸类别内隔一释放一个
+    int live = 0, freed = 0;
+    for (int i = 0; i < blocks; ++i) {
+        ptrs[i] = nvm_malloc((size_t)8 << (i % SC_COUNT));
+        if (!ptrs[i]) break;
+        live++;
+    }
+    for (int i = 0; i < live; ++i) {
+        if ((i / SC_COUNT) % 2 == 0) {
+            nvm_free(ptrs[i]);
+            freed++;
+        }
+    }
+
+    double snap_sec = time_snapshot(repeats);
+    double print_sec = time_debug_print(repeats);
+    long snap_bytes = output_size(true);
+    long print_bytes = output_size(false);
+
+    printf("==========================================================\n");
+    printf("  Heap snapshot vs debug print (%d blocks, %d live)\n", live, live - freed);
+    printf("==========================================================\n");
+    printf("%-12s | %12s | %14s\n", "Method", "Time (ms)", "Output (bytes)");
+    printf("----------------------------------------------------------\n");
+    printf("%-12s | %12.3f | %14ld\n", "snapshot", snap_sec * 1e3, snap_bytes);
+    printf("%-12s | %12.3f | %14ld\n", "debug_print", print_sec * 1e3, print_bytes);
+    printf("----------------------------------------------------------\n");
+    printf("Speedup: %.1fx, size ratio: %.1fx\n", print_sec / snap_sec, (double)print_bytes / snap_bytes);
+
+    nvm_allocator_destroy();
+    free(ptrs);
+    free(nvm_base);
+    return 0;
+}
@@ -0,0 +1,160 @@
+/*
+ * bench_volatile.c
+ *
+ * 易失模式分配吞吐基准
+ * 目的：比较持久模式 (位图 + 环形缓存)、易失模式 (侵入式空闲链表) 与 glibc malloc
+ *       在小块分配/释放上的吞吐。
+ *
+ * 方法：
+ *   每个线程反复分配一批同尺寸的块 (每块写首字节)，再按分配顺序全部释放，
+ *   统计固定轮数内的 (分配 + 释放) 对数。尺寸覆盖 8B ~ 1KB，线程数从 1 倍增到 max_threads。
+ *
+ * 用法: ./bench_volatile [max_threads] [rounds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "NvmAllocator.h"
+
+// ============================================================================
+//                          基准配置参数
+// ============================================================================
+
+#define DEFAULT_MAX_THREADS  4
+#define DEFAULT_ROUNDS       2000
+#define MAX_BENCH_THREADS    MAX_CPUS
+
+// 每轮分配的块数
+#define BATCH_BLOCKS         256
+
+// 管理区域: 256MB (128 个 Slab)
+#define TOTAL_NVM_SIZE       (128ULL * NVM_SLAB_SIZE)
+
+// ============================================================================
+//                          基准逻辑
+// ============================================================================
+
+typedef enum {
+    MODE_PERSISTENT = 0,
+    MODE_VOLATILE,
+    MODE_GLIBC,
+} BenchMode;
+
+static const char* const MODE_NAMES[] = { "persist", "volatile", "glibc" };
+
+typedef struct WorkerArg {
+    BenchMode mode;
+    size_t    size;
+    int       rounds;
+    uint64_t  pairs;
+    int       failed;
+} __attribute__((aligned(CACHE_LINE_SIZE))) WorkerArg;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void* bench_worker(void* arg) {
+    WorkerArg* w = (WorkerArg*)arg;
+    void* ptrs[BATCH_BLOCKS];
+    bool use_glibc = (w->mode == MODE_GLIBC);
+
+    for (int r = 0; r < w->rounds; ++r) {
+        for (int i = 0; i < BATCH_BLOCKS; ++i) {
+            ptrs[i] = use_glibc ? malloc(w->size) : nvm_malloc(w->size);
+            if (!ptrs[i]) {
+                w->failed = 1;
+                return NULL;
+            }
+            *(volatile char*)ptrs[i] = (char)i;
+        }
+        for (int i = 0; i < BATCH_BLOCKS; ++i) {
+            if (use_glibc) {
+                free(ptrs[i]);
+            } else {
+                nvm_free(ptrs[i]);
+            }
+        }
+        w->pairs += BATCH_BLOCKS;
+    }
+    return NULL;
+}
+
+static void run_case(void* nvm_base, BenchMode mode, size_t size, int threads, int rounds) {
+    if (mode != MODE_GLIBC) {
+        uint32_t flags = (mode == MODE_VOLATILE) ? NVM_CREATE_VOLATILE : 0;
+        if (nvm_allocator_create_ex(nvm_base, TOTAL_NVM_SIZE, flags) != 0) {
+            printf("%-8s | init failed\n", MODE_NAMES[mode]);
+            return;
+        }
+    }
+
+    pthread_t tids[MAX_BENCH_THREADS];
+    WorkerArg args[MAX_BENCH_THREADS];
+    double start = now_sec();
+    for (int i = 0; i < threads; ++i) {
+        args[i] = (WorkerArg){ mode, size, rounds, 0, 0 };
+        pthread_create(&tids[i], NULL, bench_worker, &args[i]);
+    }
+
+    uint64_t pairs = 0;
+    int failed = 0;
+    for (int i = 0; i < threads; ++i) {
+        pthread_join(tids[i], NULL);
+        pairs += args[i].pairs;
+        failed |= args[i].failed;
+    }
+    double elapsed = now_sec() - start;
+
+    if (failed) {
+        printf("%-8s | %6zu | %7d | allocation failed\n", MODE_NAMES[mode], size, threads);
+    } else {
+        printf("%-8s | %6zu | %7d | %12.2f | %10.1f\n", MODE_NAMES[mode], size, threads,
+               pairs / elapsed / 1e6, pairs ? elapsed * 1e9 / pairs : 0.0);
+    }
+
+    if (mode != MODE_GLIBC) {
+        nvm_allocator_destroy();
+    }
+}
+
+int main(int argc, char** argv) {
+    int max_threads = (argc > 1) ? atoi(argv[1]) : DEFAULT_MAX_THREADS;
+    int rounds = (argc > 2) ? atoi(argv[2]) : DEFAULT_ROUNDS;
+    if (max_threads < 1) max_threads = 1;
+    if (max_threads > MAX_BENCH_THREADS) max_threads = MAX_BENCH_THREADS;
+    if (rounds < 1) rounds = 1;
+
+    // 模拟 DRAM / 内存模式 NVM 区域
+    void* nvm_base = aligned_alloc(NVM_SLAB_SIZE, TOTAL_NVM_SIZE);
+    if (!nvm_base) {
+        fprintf(stderr, "Failed to allocate simulated region.\n");
+        return 1;
+    }
+    memset(nvm_base, 0, TOTAL_NVM_SIZE);
+
+    static const size_t sizes[] = { 8, 64, 256, 1024 };
+
+    printf("==========================================================\n");
+    printf("  Volatile vs Persistent vs glibc (batch %d, rounds %d)\n", BATCH_BLOCKS, rounds);
+    printf("==========================================================\n");
+    printf("%-8s | %6s | %7s | %12s | %10s\n", "Mode", "Size", "Threads", "Mpairs/s", "ns/pair");
+    printf("----------------------------------------------------------\n");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        for (int t = 1; t <= max_threads; t *= 2) {
+            for (int m = MODE_PERSISTENT; m <= MODE_GLIBC; ++m) {
+                run_case(nvm_base, (BenchMode)m, sizes[s], t, rounds);
+            }
+        }
+    }
+
+    free(nvm_base);
+    return 0;
+}
@@ -12,6 +12,95 @@ extern "C" {
 #include "SlabHashTable.h"
 #include "NvmSlab.h"
 #include "NvmDefs.h"
+#include "NvmDeferredFree.h"
+
+// ============================================================================
+//                          类型定义
+// ============================================================================
+
+/**
+ * @brief 小块放置策略
+ */
+typedef enum {
+    NVM_PLACEMENT_DEFAULT = 0,   // 按位图顺序填补首个空闲块
+    NVM_PLACEMENT_MEDIA_LINE     // 8B~128B 类别按 256B 介质行整行交付
+} NvmPlacementMode;
+
+/**
+ * @brief nvm_try_malloc 的结果
+ */
+typedef enum {
+    NVM_TRY_OK = 0,
+    NVM_TRY_UNINITIALIZED,       // 分配器未初始化
+    NVM_TRY_BAD_SIZE,            // 大小为 0 或超过最大尺寸类别
+    NVM_TRY_CONTENDED,           // CPU 堆或 Slab 锁正被其他线程持有 (drain/trim/远程释放)
+    NVM_TRY_NO_LOCAL_SLAB,       // 本地没有未满的 Slab (已通过回调请求补充)
+    NVM_TRY_LOG_BUSY             // 日志锁被占用或日志已满待折叠
+} NvmTryStatus;
+
+/**
+ * @brief 异步补充请求回调
+ * 在 nvm_try_malloc 的调用线程上执行，必须同样不阻塞 (如投递到工作队列)。
+ * @param cpu 需要补充的 CPU
+ * @param size 触发请求的分配大小
+ */
+typedef void (*nvm_replenish_fn)(int cpu, size_t size, void* arg);
+
+// nvm_allocator_create_ex 标志位
+#define NVM_CREATE_LOG      0x01  // 启用日志式元数据持久化 (区间前部保留为元数据区)
+#define NVM_CREATE_RECOVER  0x02  // 从已有元数据区恢复 (否则格式化；须与 NVM_CREATE_LOG 组合)
+#define NVM_CREATE_VOLATILE 0x04  // 易失模式：侵入式空闲链表，不保留位图 (不可与日志组合)
+#define NVM_CREATE_ATOMIC   0x08  // 原子位图 Slab 引擎：无锁分配与释放 (不可与易失模式组合)
+
+// 区域表容量 (初始区间 + nvm_allocator_extend 追加的区域)
+#define NVM_MAX_REGIONS     64
+
+/**
+ * @brief NUMA 节点的 NVM 区间描述
+ *
+ * 区间以相对 nvm_base_addr 的偏移表示，起点必须按 NVM_SLAB_SIZE 对齐，
+ * 各区间互不重叠。每个区间由一个独立的中心堆 (含空间管理器) 管理。
+ */
+typedef struct NvmNumaRange {
+    uint64_t offset;      // 区间起始偏移
+    uint64_t size;        // 区间大小 (字节)
+    int      numa_node;   // 区间所在 NUMA 节点
+} NvmNumaRange;
+
+// 运行时配置的环境变量名，格式 "key:value,key:value"
+#define NVM_MALLOC_CONF_ENV "NVM_MALLOC_CONF"
+
+// depot_keep 默认值：每个 CPU 堆每个尺寸类别最多保留的未满 Slab 数，多余的捐给仓库
+#define NVM_DEPOT_CPU_KEEP      2
+
+// depot_trim_interval 默认值：CPU 堆每分配这么多次检查一次过剩 Slab
+#define NVM_DEPOT_TRIM_INTERVAL 1024
+
+/**
+ * @brief 分配器运行时配置
+ *
+ * 可调参数在创建时读入分配器 (或新建 Slab 的描述符)，快速路径读的是这些字段而不是宏，
+ * 分支与常量折叠的形态不变。以下两项仍在编译期固定，配置中只做核对：
+ *   - slab_size：属于持久化布局 (日志区、快照、偏移对齐)，只能为 0 (默认) 或 NVM_SLAB_SIZE；
+ *   - spinlock/mutex/rwlock：锁后端编译进快速路径，只能为空或等于 NVM_*_BACKEND_NAME。
+ * cache_depth 的上限是 SLAB_CACHE_MAX_SIZE (4096)，默认 SLAB_CACHE_SIZE；环形缓冲区随新建 Slab
+ * 的描述符按深度分配，加深缓存不需要重新编译。
+ * 键名与字段同名，数值可带 k/m/g 后缀。
+ */
+typedef struct NvmAllocatorConfig {
+    uint32_t cache_depth;          // Slab 环形缓存深度 (1, SLAB_CACHE_MAX_SIZE]
+    uint32_t cache_batch;          // 环形缓存一次补充/回写的块数 [1, cache_depth)
+    uint64_t slab_size;            // 0 或 NVM_SLAB_SIZE
+    uint32_t heap_count;           // CPU 堆数 [1, MAX_CPUS]，CPU 编号按取模映射到堆
+    uint32_t hashtable_capacity;   // 每个中心堆 Slab 查找表的初始容量
+    uint32_t depot_keep;           // 每个 CPU 堆每个尺寸类别保留的未满 Slab 数
+    uint32_t depot_trim_interval;  // 每分配这么多次检查一次过剩 Slab (>= 1)
+    uint32_t epoch_reclaim_batch;  // 延迟释放链表触发回收的长度 (进程级)
+    uint32_t remote_batch;         // 远程释放按目标 Slab 暂存的组大小 [0, 64]，0 = 不暂存
+    char     spinlock[16];         // 期望的锁后端名，空串表示不核对
+    char     mutex[16];
+    char     rwlock[16];
+} NvmAllocatorConfig;
 
 // ============================================================================
 //                          NVM Allocator Public API
@@ -29,6 +118,143 @@ extern "C" {
  */
 int nvm_allocator_create(void* nvm_base_addr, uint64_t nvm_size_bytes);
 
+/**
+ * @brief 以扩展选项初始化 NVM 分配器
+ *
+ * 指定 NVM_CREATE_LOG 时，区间前部保留为持久化元数据区：每次分配/释放向
+ * Slab 所属 CPU 的顺序日志追加一条 8 字节记录，后台检查点线程周期性地把
+ * 日志折叠进持久化位图并截断日志。再次以 NVM_CREATE_LOG | NVM_CREATE_RECOVER
+ * 打开同一区域时，从位图出发重放日志尾部，重建所有 Slab (挂载到 CPU 0)。
+ *
+ * 指定 NVM_CREATE_VOLATILE 时区域按 DRAM (或内存模式 NVM) 使用：空闲块内嵌下一个
+ * 空闲块的地址，分配与释放是链表的弹出与压入，Slab 描述符不带位图；calloc/realloc
+ * 改用普通 memset/memcpy。进程退出后分配状态不可恢复，因此不能与 NVM_CREATE_LOG 组合，
+ * nvm_allocator_restore_allocation 也返回 -1。
+ *
+ * 指定 NVM_CREATE_ATOMIC 时本池的 Slab 改用原子位图引擎 (nvm_slab_create_atomic)：
+ * 分配与释放以 CAS / fetch_and 直接修改 64 位位图字，不持 Slab 锁，没有环形缓存与
+ * 远程暂存区，远程释放也不经线程本地成组。适合没有线程缓存、远程释放密集的负载，
+ * 可与日志元数据组合。
+ *
+ * @param flags NVM_CREATE_* 组合；为 0 时等价于 nvm_allocator_create
+ * @return 0 成功, -1 失败 (含恢复时元数据不匹配)
+ */
+int nvm_allocator_create_ex(void* nvm_base_addr, uint64_t nvm_size_bytes, uint32_t flags);
+
+/**
+ * @brief 把配置填为编译期默认值
+ */
+void nvm_allocator_config_default(NvmAllocatorConfig* config);
+
+/**
+ * @brief 解析 "key:value,key:value" 形式的配置串，覆盖 config 中对应字段
+ * 未知键、缺少值或数值非法时整串拒绝，config 保持不变。
+ * @return 0 成功, -1 失败
+ */
+int nvm_allocator_config_parse(const char* conf, NvmAllocatorConfig* config);
+
+/**
+ * @brief 用环境变量 NVM_MALLOC_CONF 覆盖 config (未设置时不变)
+ * @return 0 成功, -1 环境变量内容非法
+ */
+int nvm_allocator_config_apply_env(NvmAllocatorConfig* config);
+
+/**
+ * @brief 校验取值范围，并核对编译期固定的 Slab 大小与锁后端
+ * @return 0 有效, -1 无效 (原因写入错误日志)
+ */
+int nvm_allocator_config_validate(const NvmAllocatorConfig* config);
+
+/**
+ * @brief 以运行时配置初始化 NVM 分配器
+ *
+ * 生效顺序：编译期默认值 < config < 环境变量 NVM_MALLOC_CONF。
+ * nvm_allocator_create/create_ex/create_numa 等价于 config 为 NULL，同样读取环境变量。
+ * Slab 缓存参数与回收批量是进程级设置，对之后新建的 Slab 生效。
+ *
+ * @param flags NVM_CREATE_* 组合
+ * @param config NULL 表示默认值
+ * @return 0 成功, -1 失败 (含配置无效)
+ */
+int nvm_allocator_create_config(void* nvm_base_addr, uint64_t nvm_size_bytes, uint32_t flags,
+                                const NvmAllocatorConfig* config);
+
+/**
+ * @brief 立即把所有 CPU 日志折叠进持久化位图
+ * @return 0 成功, -1 未初始化或未启用日志
+ */
+int nvm_allocator_checkpoint(void);
+
+/**
+ * @brief 以 NUMA 感知模式初始化 NVM 分配器
+ *
+ * 为每个区间创建一个中心堆。CPU 堆优先从本地节点的中心堆获取 Slab，
+ * 仅在本地空间耗尽时回退到远端节点；Slab 的 DRAM 元数据分配在
+ * 所属 CPU 的本地节点上。CPU 到节点的映射来自 nvm_numa_node_of_cpu，
+ * 可通过 nvm_numa_set_fake_topology 在单节点机器上模拟。
+ *
+ * @param nvm_base_addr NVM 映射的起始地址 (所有区间共享)
+ * @param ranges 各节点的区间描述
+ * @param range_count 区间数量 [1, MAX_NUMA_NODES]
+ * @return 0 成功, -1 失败
+ */
+int nvm_allocator_create_numa(void* nvm_base_addr, const NvmNumaRange* ranges, int range_count);
+
+/**
+ * @brief 在线扩容：把一段新映射的 NVM 加入分配器
+ *
+ * 可与 nvm_malloc/nvm_free 并发调用。新区域不要求与已有区域连续，
+ * 起点按 Slab 边界 (相对 nvm_base_addr) 对齐后，首尾不足一个 Slab 的部分被舍弃；
+ * 可用空间加入调用线程本地节点的中心堆。区域在分配器销毁前必须保持映射。
+ * 池文件可先用 nvm_pool_grow 扩展并映射新增部分，再交给本函数。
+ *
+ * @param addr 新区域起始地址
+ * @param size 新区域大小 (字节)
+ * @return 0 成功, -1 失败 (不足一个 Slab、与已有区域重叠、区域表已满或已启用日志元数据)
+ */
+int nvm_allocator_extend(void* addr, uint64_t size);
+
+/**
+ * @brief 把当前 CPU 堆中的未满 Slab 全部捐给跨 CPU 仓库
+ *
+ * 线程即将长时间空闲 (或迁出该 CPU) 时调用，使其缓存的空闲块可被其他 CPU 使用。
+ * 分配路径也会周期性地捐出超出保留数量的未满 Slab；其他 CPU 本地 Slab 全满时
+ * 先从仓库窃取，再向中心堆申请新 Slab。
+ *
+ * @return 0 成功, -1 分配器未初始化
+ */
+int nvm_allocator_donate_partial(void);
+
+/**
+ * @brief 清空指定 CPU 的本地堆
+ *
+ * 用于 CPU 下线、cpuset 收缩或线程池销毁之后。空 Slab 归还中心堆，未满 Slab
+ * 移入跨 CPU 仓库；全满的 Slab 留在原处，待其因释放变空后由下一次调用处理。
+ * 可与其他 CPU 上的分配/释放并发调用；若该 CPU 上仍有线程分配，只是让它重新取 Slab。
+ *
+ * @param cpu CPU ID，范围 [0, MAX_CPUS - 1]
+ * @return 归还的 Slab 数, -1 失败
+ */
+int nvm_cpu_heap_drain(int cpu);
+
+/**
+ * @brief 归还仓库与所有 CPU 堆中的空 Slab (类似 malloc_trim)
+ *
+ * 可与分配/释放并发调用。启用日志元数据时会先执行一次检查点。
+ *
+ * @return 归还的 Slab 数, -1 失败
+ */
+int nvm_allocator_trim(void);
+
+/**
+ * @brief 线程亲和性 / cpuset 变化后的编排层钩子
+ *
+ * 按调用线程当前允许的 CPU 集合，清空不再可用的 CPU 堆，然后执行 nvm_allocator_trim。
+ *
+ * @return 归还的 Slab 数, -1 失败
+ */
+int nvm_allocator_on_affinity_change(void);
+
 /**
  * @brief 销毁 NVM 分配器
  * 
@@ -48,6 +274,34 @@ void nvm_allocator_destroy(void);
  */
 void* nvm_malloc(size_t size);
 
+/**
+ * @brief 非阻塞分配：只使用当前 CPU 堆中已有的未满 Slab
+ *
+ * 不进入慢路径：不窃取仓库、不向中心堆申请 (空间管理器互斥锁)、不分配 DRAM 元数据、
+ * 不获取哈希表写锁；CPU 堆、Slab 与日志锁都只尝试一次。本地没有可用 Slab 时
+ * 调用 nvm_try_malloc_set_replenish 注册的回调，由调用方安排 nvm_cpu_heap_replenish。
+ *
+ * @param size 请求大小 (字节)
+ * @param out_status [输出，可为 NULL] 结果原因
+ * @return 成功返回指针，否则返回 NULL
+ */
+void* nvm_try_malloc(size_t size, NvmTryStatus* out_status);
+
+/**
+ * @brief 注册 nvm_try_malloc 的补充请求回调 (NULL 取消)
+ */
+void nvm_try_malloc_set_replenish(nvm_replenish_fn fn, void* arg);
+
+/**
+ * @brief 为指定 CPU 堆补充一个可容纳 size 的未满 Slab (可能阻塞)
+ *
+ * 供后台线程响应补充请求：本地已有未满 Slab 时直接返回，否则先从仓库窃取，再向中心堆申请。
+ * 新 Slab 的日志归属为目标 CPU。
+ *
+ * @return 0 成功, -1 失败 (未初始化、参数无效或空间耗尽)
+ */
+int nvm_cpu_heap_replenish(int cpu, size_t size);
+
 /**
  * @brief 释放 NVM 内存
  * 
@@ -57,6 +311,124 @@ void* nvm_malloc(size_t size);
  */
 void nvm_free(void* nvm_ptr);
 
+/**
+ * @brief 延迟释放 NVM 内存 (用于不允许阻塞的线程)
+ *
+ * 只把指针放入调用线程的单生产者环形队列，不获取任何锁。队列由后台回收线程
+ * (nvm_allocator_set_deferred_reclaim) 或线程自己的空闲钩子 (nvm_free_deferred_flush)
+ * 成批处理：按地址排序后，同一 Slab 的块只查表、加锁一次。
+ * 队列满时按 nvm_free_deferred_set_policy 设置的背压策略处理。
+ * 启用日志元数据时，释放记录在实际处理时才写入。
+ *
+ * @param nvm_ptr nvm_malloc 返回的指针；NULL 时直接返回 0
+ * @return 0 成功, -1 未初始化或被拒绝 (NVM_DEFER_FULL_REJECT，指针仍归调用方所有)
+ */
+int nvm_free_deferred(void* nvm_ptr);
+
+/**
+ * @brief 设置调用线程的延迟释放队列满时的背压策略 (默认 NVM_DEFER_FULL_FLUSH)
+ */
+void nvm_free_deferred_set_policy(NvmDeferFullPolicy policy);
+
+/**
+ * @brief 同步处理调用线程的延迟释放队列 (供事件循环的空闲钩子调用)
+ * @return 处理的指针数, -1 未初始化
+ */
+int nvm_free_deferred_flush(void);
+
+/**
+ * @brief 刷新调用线程暂存的远程释放 (供线程空闲或退出前调用)
+ *
+ * nvm_free 释放其他 CPU 堆的块时，块先按目标 Slab 分组暂存在线程本地，组满
+ * (配置项 remote_batch) 时整组写入该 Slab 的远程暂存区，每组只获取一次远程锁。
+ * 组满、超时、trim 或线程退出时也会刷新；暂存期间块仍计为已分配。
+ *
+ * @return 刷新的块数, -1 未初始化
+ */
+int nvm_free_remote_flush(void);
+
+/**
+ * @brief 启动、调整或停止延迟释放的后台回收线程
+ *
+ * 线程按间隔处理所有线程的队列；某个队列积压超过 NVM_DEFERRED_WAKE_THRESHOLD 时提前唤醒。
+ *
+ * @param interval_ms 轮询间隔 (毫秒)；0 表示停止线程 (队列内容保留到下次处理或销毁)
+ * @return 0 成功, -1 失败
+ */
+int nvm_allocator_set_deferred_reclaim(uint32_t interval_ms);
+
+/**
+ * @brief 启动、调整或停止后台 Slab 预备线程
+ *
+ * 新建 Slab (申请空间、分配元数据、注册哈希表) 比普通分配慢一到两个数量级，
+ * 且落在恰好用完本地 Slab 的那次请求上。预备线程按间隔采样各 CPU 堆每个尺寸类别的
+ * 分配次数，估算消耗速率，并为仍有需求的类别提前挂入 Slab (先窃取仓库，再向中心堆申请)，
+ * 使本地空闲块始终不少于 slabs_ahead 个 Slab 的容量加两个采样周期的消耗。
+ * 稳定负载下分配路径几乎不再同步创建 Slab。预备的余量不会被周期性捐赠移出。
+ *
+ * @param slabs_ahead 每个活跃 (CPU, 尺寸类别) 的余量 Slab 数，上限 8；0 表示停止线程
+ * @param interval_ms 采样间隔 (毫秒)；0 使用默认值 10
+ * @return 0 成功, -1 失败
+ */
+int nvm_allocator_set_provisioning(uint32_t slabs_ahead, uint32_t interval_ms);
+
+/**
+ * @brief 分配并清零 NVM 内存 (语义同 calloc)
+ *
+ * 块来自预清零 Slab 且从未被使用过时直接返回；否则经 nvm_memset_persist 清零并持久化。
+ *
+ * @return 指向已清零内存的指针；乘法溢出或分配失败时返回 NULL
+ */
+void* nvm_calloc(size_t nmemb, size_t size);
+
+/**
+ * @brief 调整 NVM 内存块大小 (语义同 realloc)
+ *
+ * 新大小不超过原块容量时原地返回；否则分配新块，经 nvm_memcpy_persist
+ * 拷贝原块内容后释放原块。nvm_ptr 为 NULL 时等价于 nvm_malloc，
+ * size 为 0 时等价于 nvm_free 并返回 NULL。
+ *
+ * @return 新指针；失败时返回 NULL，原块保持不变
+ */
+void* nvm_realloc(void* nvm_ptr, size_t size);
+
+/**
+ * @brief 设置每个中心堆预清零 Slab 池的目标深度
+ *
+ * 首次设置为非 0 时为每个中心堆启动一个后台线程，预先申请 Slab 并用
+ * 非临时存储清零。慢路径创建 Slab 时优先从池中获取，使 nvm_calloc
+ * 在新 Slab 上无需内联清零。设置为 0 停止补充 (已清零的 Slab 仍可使用)。
+ *
+ * @param depth 目标深度，上限 NVM_SLAB_POOL_MAX_DEPTH
+ * @return 0 成功, -1 失败
+ */
+int nvm_allocator_set_zero_pool_depth(uint32_t depth);
+
+/**
+ * @brief 开启/关闭 Slab 预缺页
+ *
+ * 新映射的 NVM (fsdax、tmpfs) 首次写入会触发缺页，使慢路径上的 nvm_malloc
+ * 从亚微秒级上升到数十微秒。开启后，当某个 CPU 的 Slab 填充率达到阈值时，
+ * 本地节点的后台线程会提前申请下一个 Slab 并触发写缺页 (MADV_POPULATE_WRITE，
+ * 旧内核上逐页触碰)，慢路径随后直接取用。
+ *
+ * @param threshold_pct 触发阈值 [1, 100]；0 表示停止请求 (已准备的 Slab 仍可使用)
+ * @return 0 成功, -1 失败
+ */
+int nvm_allocator_set_prefault(uint32_t threshold_pct);
+
+/**
+ * @brief 设置小块放置策略
+ *
+ * 仅影响此后新建的 Slab。介质行模式下，每个 256B 介质行只属于一个
+ * (由单个 CPU 堆持有的) Slab，且 refill 会先交付完整的空闲介质行，
+ * 使连续写入在介质写合并缓冲中凑满整行，降低读-改-写带来的写放大。
+ *
+ * @param mode 放置策略
+ * @return 0 成功, -1 失败 (未初始化或参数无效)
+ */
+int nvm_allocator_set_placement_mode(NvmPlacementMode mode);
+
 // ============================================================================
 //                          故障恢复 API
 // ============================================================================
@@ -84,6 +456,42 @@ int nvm_allocator_restore_allocation(void* nvm_ptr, size_t size);
  */
 void nvm_allocator_debug_print(void);
 
+/**
+ * @brief 把堆状态以紧凑的二进制快照写入 fd (格式见 NvmSnapshot.h)
+ *
+ * 内容：各中心堆区间、每个 Slab 的尺寸类别/偏移/占用数与游程编码的占用位图、
+ * 空间管理器的空闲段。不暂停分配：哈希表无锁遍历，每个 Slab 只在复制位图时
+ * 短暂持锁，空闲段分批复制；因此快照不是某一时刻的精确切面。
+ * 用 tools/nvm_snapdiff 比较两份快照，观察 Slab 周转、各类别增长与搁浅 Slab。
+ *
+ * @return 0 成功, -1 未初始化或写入失败
+ */
+int nvm_heap_snapshot(int fd);
+
+/**
+ * @brief 按层次名称读取状态、修改可调参数或触发动作 (mallctl 风格)
+ *
+ * 名称以 '.' 分隔，'#' 处为十进制下标：
+ *   opt.*    可调参数，读写 uint32_t (opt.slab_size 为 uint64_t，opt.spinlock/mutex/rwlock 为 const char*)：
+ *            cache_depth cache_batch depot_keep depot_trim_interval epoch_reclaim_batch prefault_pct
+ *            zero_pool_depth deferred_reclaim_ms remote_batch remote_flush_ms
+ *            provision.slabs_ahead provision.interval_ms placement；
+ *            heap_count slab_size spinlock mutex rwlock slab_engine ("locked" / "atomic") 只读
+ *   stats.*  只读 uint64_t：slabs free_bytes slow_path_hits provisioned epoch_pending
+ *            remote_batch.{frees,flushes}
+ *            class.#.{slabs,active,capacity,allocs,depot} heap.#.{slabs,free_bytes}
+ *   heap.*   动作，调用即执行，old 为处理的数量 (uint64_t)：
+ *            trim donate_partial deferred_flush remote_flush epoch_reclaim checkpoint cpu.#.{trim,drain}；
+ *            heap.cpu.#.slabs 只读 uint64_t
+ *
+ * 与 sysctl 相同：oldp 非 NULL 时 *oldlenp 必须等于值的大小；oldp 为 NULL 而 oldlenp 非 NULL 时
+ * 只返回大小；newp 非 NULL 时 newlen 必须等于值的大小，先读出旧值再写入新值。
+ * heap.cpu.# 的下标是 CPU 编号，按 heap_count 映射到 CPU 堆。
+ *
+ * @return 0 成功, -1 未初始化、名称未知、下标越界、长度不符、只读或取值无效
+ */
+int nvm_ctl(const char* name, void* oldp, size_t* oldlenp, const void* newp, size_t newlen);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,98 @@
+#ifndef NVM_CHECK_H
+#define NVM_CHECK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "NvmDefs.h"
+
+// ============================================================================
+//                          类型定义
+// ============================================================================
+
+/**
+ * @brief 检查选项
+ */
+typedef struct NvmCheckOptions {
+    uint32_t workers;          // 扫描 Slab 镜像的线程数 (0 = 在线 CPU 数)
+    bool     repair;           // 修复模式：释放无效与孤立的镜像 (要求可写映射)
+} NvmCheckOptions;
+
+/**
+ * @brief 检查报告
+ *
+ * 错误类计数非零说明池不一致，不能直接用于恢复；警告类 (orphaned_slabs) 只影响空间利用率。
+ */
+typedef struct NvmCheckReport {
+    // 布局
+    uint64_t data_offset;
+    uint64_t data_size;
+    uint32_t slab_count;
+
+    // 空闲空间 (以 Slab 为单位，由镜像重建)
+    uint64_t slabs_in_use;
+    uint64_t free_extents;                  // 连续空闲区间数
+    uint64_t largest_free_extent;           // 最大连续空闲 Slab 数
+
+    // 各尺寸类别用量 (已折叠的镜像)
+    uint64_t class_slabs[SC_COUNT];
+    uint64_t class_blocks[SC_COUNT];        // 已分配块数
+
+    // 日志
+    uint64_t pending_records;               // 尚未折叠的记录数
+
+    // 错误
+    uint64_t bad_class_slabs;               // 镜像尺寸类别无效
+    uint64_t stray_bit_slabs;               // 位图中有超出块数的位 (位图与块数不一致)
+    uint64_t bad_records;                   // 越界、未对齐或操作码无效的记录
+    uint64_t overlapping_slabs;             // 同一 Slab 同时被两个描述符 (CPU 日志或尺寸类别) 使用
+    uint64_t double_allocs;                 // 重放时分配已占用的块
+    uint64_t double_frees;                  // 重放时释放空闲块 (含从未描述过的 Slab)
+
+    // 警告
+    uint64_t orphaned_slabs;                // 有尺寸类别但没有任何已分配块，也没有待折叠记录
+
+    // 修复
+    uint64_t repaired_slabs;                // 修复模式下改写的镜像数
+} NvmCheckReport;
+
+// ============================================================================
+//                          核心操作 API
+// ============================================================================
+
+/**
+ * @brief 离线检查一个以 NVM_CREATE_LOG 格式化的池
+ *
+ * 1. 校验头部与池大小
+ * 2. 多线程分段扫描 Slab 镜像：尺寸类别、位图越界位、各类别用量与空闲区间
+ * 3. 重放各 CPU 日志中未折叠的记录，检测越界记录、重叠 Slab 与重复分配/释放
+ *
+ * DRAM 占用与池大小无关：镜像直接在映射上读取，重放只为日志中的记录分配内存
+ * (至多 MAX_CPUS * NVM_LOG_CAPACITY 条)。
+ *
+ * 修复模式把无效尺寸类别的镜像与孤立 Slab 标记为未使用并清除越界位，
+ * 使下次恢复时这些 Slab 回到空闲空间；日志记录保持不变，重叠等错误需人工处理。
+ *
+ * @param pool_base 池映射基址 (元数据区位于偏移 0)
+ * @param pool_size 映射大小
+ * @param opts 选项，NULL 表示默认
+ * @param out 报告
+ * @return 0 一致, 1 发现错误, -1 无法解析 (头部无效或内存不足)
+ */
+int nvm_check_pool(void* pool_base, uint64_t pool_size, const NvmCheckOptions* opts, NvmCheckReport* out);
+
+/**
+ * @brief 报告中的错误总数
+ */
+uint64_t nvm_check_error_count(const NvmCheckReport* report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NVM_CHECK_H
@@ -13,6 +13,8 @@ extern "C" {
 #include <sched.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
 
 // ============================================================================
 //                          硬件与性能配置
@@ -23,10 +25,19 @@ extern "C" {
 // RTEMS: 根据 BSP 配置设定
 #define MAX_CPUS 64
 
+// 最大支持的 NUMA 节点数 (每个节点对应一个中心堆)
+#define MAX_NUMA_NODES 8
+
 // 缓存行大小 (用于填充对齐，消除 False Sharing)
 // x86_64 通常为 64，部分 ARM/PowerPC 为 128
 #define CACHE_LINE_SIZE 64
 
+// 大页大小 (元数据 arena 的映射粒度)
+#define NVM_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+// NVM 介质写入粒度 (Optane 等设备内部以 256B 为单位读改写)
+#define NVM_MEDIA_LINE_SIZE 256
+
 // 分支预测优化宏
 #if defined(__GNUC__) || defined(__clang__)
     #define NVM_LIKELY(x)   __builtin_expect(!!(x), 1)
@@ -64,37 +75,246 @@ static inline int nvm_get_current_cpu_id(void) {
 // 兼容旧代码的宏定义 (如果不想修改所有调用处)
 #define NVM_GET_CURRENT_CPU_ID() nvm_get_current_cpu_id()
 
+/**
+ * @brief 获取调用线程当前允许运行的 CPU
+ * @param allowed [输出] allowed[i] 非 0 表示 CPU ID i 仍可能被使用；编号不小于 MAX_CPUS 的 CPU 被跳过
+ * @return 0 成功, -1 查询失败 (此时全部置为可用)
+ * @note 非 Linux 平台恒视为全部可用
+ */
+int nvm_get_allowed_cpus(uint8_t allowed[MAX_CPUS]);
+
+// ============================================================================
+//                          OS 适配层 (NUMA 拓扑)
+// ============================================================================
+
+/**
+ * @brief 获取系统 NUMA 节点数
+ * Linux: 读取 sysfs；其他平台恒为 1。若设置了伪拓扑则返回伪拓扑的节点数。
+ */
+int nvm_numa_node_count(void);
+
+/**
+ * @brief 获取指定 CPU 所属的 NUMA 节点
+ * @return 范围 [0, MAX_NUMA_NODES - 1]，未知时返回 0
+ */
+int nvm_numa_node_of_cpu(int cpu_id);
+
+/**
+ * @brief 设置伪 NUMA 拓扑 (用于在单节点机器上测试)
+ * @param node_count 节点数
+ * @param cpu_to_node 长度为 cpu_count 的映射表，未覆盖的 CPU 视为节点 0
+ */
+void nvm_numa_set_fake_topology(int node_count, const int* cpu_to_node, int cpu_count);
+
+/**
+ * @brief 清除伪拓扑，恢复使用真实拓扑
+ */
+void nvm_numa_clear_fake_topology(void);
+
+/**
+ * @brief 在指定节点上分配清零的 DRAM (用于元数据)
+ * 返回地址至少按 CACHE_LINE_SIZE 对齐。
+ * node < 0 时使用普通堆内存；否则使用 mmap + mbind(MPOL_PREFERRED)，
+ * 绑定失败 (如伪拓扑中不存在的节点) 时仍返回可用内存。
+ * @note 必须使用 nvm_numa_free 并传入相同的 size 与 node 释放
+ */
+void* nvm_numa_alloc(size_t size, int node);
+
+/**
+ * @brief 释放 nvm_numa_alloc 分配的内存
+ */
+void nvm_numa_free(void* ptr, size_t size, int node);
+
+/**
+ * @brief 分配按 NVM_HUGE_PAGE_SIZE 对齐、尽量由大页承载的清零匿名内存
+ * 先尝试 MAP_HUGETLB (需预留 hugetlbfs 页)；失败时映射普通页并裁剪到大页对齐，
+ * 再以 MADV_HUGEPAGE 请求透明大页。node >= 0 时按 MPOL_PREFERRED 绑定。
+ * @param size 须为 NVM_HUGE_PAGE_SIZE 的整数倍
+ * @param out_hugetlb [输出，可为 NULL] 是否由 hugetlbfs 大页承载
+ * @return 失败返回 NULL
+ */
+void* nvm_huge_page_alloc(size_t size, int node, bool* out_hugetlb);
+
+/**
+ * @brief 释放 nvm_huge_page_alloc 分配的内存
+ */
+void nvm_huge_page_free(void* ptr, size_t size);
+
+// ============================================================================
+//                          OS 适配层 (NVM 映射与预缺页)
+// ============================================================================
+
+// nvm_pool_map 标志位
+#define NVM_MAP_POPULATE   0x01   // 映射时预先建立全部页表 (MAP_POPULATE)
+
+/**
+ * @brief 映射 NVM 池文件 (不存在时创建并扩展到 size)
+ * fsdax 上优先尝试 MAP_SYNC，文件系统不支持时回退为普通 MAP_SHARED。
+ * @param flags NVM_MAP_* 组合
+ * @return 映射基地址，失败返回 NULL
+ */
+void* nvm_pool_map(const char* path, uint64_t size, int flags);
+
+/**
+ * @brief 把池文件从 old_size 扩展到 new_size 并映射新增部分
+ * 以 base + old_size 作为提示地址，内核可能放在别处，因此返回的段不一定
+ * 与原映射连续；随后交给 nvm_allocator_extend 即可在线扩容。
+ * @param base 原映射基地址 (仅作提示，可为 NULL)
+ * @param old_size 原文件大小 (须按页对齐)
+ * @return 新增段的映射地址 (长度 new_size - old_size)，失败返回 NULL
+ */
+void* nvm_pool_grow(const char* path, void* base, uint64_t old_size, uint64_t new_size, int flags);
+
+/**
+ * @brief 解除 nvm_pool_map / nvm_pool_grow 建立的映射
+ */
+void nvm_pool_unmap(void* base, uint64_t size);
+
+/**
+ * @brief 预先触发 [addr, addr + len) 的写缺页，不修改内容
+ * Linux 5.14+ 使用 MADV_POPULATE_WRITE，否则逐页原子加 0 (touch-ahead)。
+ * @note 调用者须保证区间当前无其他写者 (如尚未交付的空闲 Slab)
+ */
+void nvm_os_prefault(void* addr, size_t len);
+
 // ============================================================================
 //                          OS 适配层 (锁原语)
 // ============================================================================
+// 各类锁的实现在编译期选择 (CMake 缓存变量 NVM_SPINLOCK_BACKEND /
+// NVM_MUTEX_BACKEND / NVM_RWLOCK_BACKEND)，默认均为 pthread。
+// 所有后端的实现见 NvmLock.h，调用处只使用下面的 NVM_* 宏。
+// NVM_*_BACKEND_NAME 是编译进来的后端名，供运行时配置核对。
+// *_TRYACQUIRE 成功返回 0，锁被占用时立即返回非 0 (不排队、不睡眠)。
+
+#include "NvmLock.h"
 
 // --- 1. 自旋锁 (Spinlock) ---
 // 场景: 持有时间极短、不可睡眠 (如 Slab 位图操作)
+#if defined(NVM_SPINLOCK_TICKET)
+typedef nvm_ticket_lock_t nvm_spinlock_t;
+#define NVM_SPINLOCK_BACKEND_NAME "ticket"
+
+#define NVM_SPINLOCK_INIT(l)     nvm_ticket_lock_init(l)
+#define NVM_SPINLOCK_DESTROY(l)  nvm_ticket_lock_destroy(l)
+#define NVM_SPINLOCK_ACQUIRE(l)  nvm_ticket_lock_acquire(l)
+#define NVM_SPINLOCK_TRYACQUIRE(l) nvm_ticket_lock_try_acquire(l)
+#define NVM_SPINLOCK_RELEASE(l)  nvm_ticket_lock_release(l)
+#elif defined(NVM_SPINLOCK_MCS)
+typedef nvm_mcs_lock_t nvm_spinlock_t;
+#define NVM_SPINLOCK_BACKEND_NAME "mcs"
+
+#define NVM_SPINLOCK_INIT(l)     nvm_mcs_lock_init(l)
+#define NVM_SPINLOCK_DESTROY(l)  nvm_mcs_lock_destroy(l)
+#define NVM_SPINLOCK_ACQUIRE(l)  nvm_mcs_lock_acquire(l)
+#define NVM_SPINLOCK_TRYACQUIRE(l) nvm_mcs_lock_try_acquire(l)
+#define NVM_SPINLOCK_RELEASE(l)  nvm_mcs_lock_release(l)
+#elif defined(NVM_SPINLOCK_CLH)
+typedef nvm_clh_lock_t nvm_spinlock_t;
+#define NVM_SPINLOCK_BACKEND_NAME "clh"
+
+#define NVM_SPINLOCK_INIT(l)     nvm_clh_lock_init(l)
+#define NVM_SPINLOCK_DESTROY(l)  nvm_clh_lock_destroy(l)
+#define NVM_SPINLOCK_ACQUIRE(l)  nvm_clh_lock_acquire(l)
+#define NVM_SPINLOCK_TRYACQUIRE(l) nvm_clh_lock_try_acquire(l)
+#define NVM_SPINLOCK_RELEASE(l)  nvm_clh_lock_release(l)
+#else
 typedef pthread_spinlock_t nvm_spinlock_t;
+#define NVM_SPINLOCK_BACKEND_NAME "pthread"
 
 #define NVM_SPINLOCK_INIT(l)     pthread_spin_init(l, PTHREAD_PROCESS_PRIVATE)
 #define NVM_SPINLOCK_DESTROY(l)  pthread_spin_destroy(l)
 #define NVM_SPINLOCK_ACQUIRE(l)  pthread_spin_lock(l)
+#define NVM_SPINLOCK_TRYACQUIRE(l) pthread_spin_trylock(l)
 #define NVM_SPINLOCK_RELEASE(l)  pthread_spin_unlock(l)
+#endif
+
+// --- 2. 互斥锁 (Mutex) 与条件变量 (Condition) ---
+// 场景: 持有时间较长、涉及系统调用 (如 SpaceManager 扩容)；后台线程等待任务
+#if defined(NVM_MUTEX_ADAPTIVE)
+typedef nvm_adaptive_mutex_t nvm_mutex_t;
+typedef nvm_futex_cond_t     nvm_cond_t;
+#define NVM_MUTEX_BACKEND_NAME "adaptive"
 
-// --- 2. 互斥锁 (Mutex) ---
-// 场景: 持有时间较长、涉及系统调用 (如 SpaceManager 扩容)
+#define NVM_MUTEX_INIT(l)        nvm_adaptive_mutex_init(l)
+#define NVM_MUTEX_DESTROY(l)     nvm_adaptive_mutex_destroy(l)
+#define NVM_MUTEX_ACQUIRE(l)     nvm_adaptive_mutex_acquire(l)
+#define NVM_MUTEX_TRYACQUIRE(l)  nvm_adaptive_mutex_try_acquire(l)
+#define NVM_MUTEX_RELEASE(l)     nvm_adaptive_mutex_release(l)
+
+#define NVM_COND_INIT(c)         nvm_futex_cond_init(c)
+#define NVM_COND_DESTROY(c)      nvm_futex_cond_destroy(c)
+#define NVM_COND_WAIT(c, l)      nvm_futex_cond_timedwait(c, l, 0)
+#define NVM_COND_SIGNAL(c)       nvm_futex_cond_signal(c)
+#define NVM_COND_BROADCAST(c)    nvm_futex_cond_broadcast(c)
+
+#define NVM_COND_TIMEDWAIT_MS(c, l, ms) nvm_futex_cond_timedwait(c, l, ms)
+#else
 typedef pthread_mutex_t nvm_mutex_t;
+typedef pthread_cond_t  nvm_cond_t;
+#define NVM_MUTEX_BACKEND_NAME "pthread"
 
 #define NVM_MUTEX_INIT(l)        pthread_mutex_init(l, NULL)
 #define NVM_MUTEX_DESTROY(l)     pthread_mutex_destroy(l)
 #define NVM_MUTEX_ACQUIRE(l)     pthread_mutex_lock(l)
+#define NVM_MUTEX_TRYACQUIRE(l)  pthread_mutex_trylock(l)
 #define NVM_MUTEX_RELEASE(l)     pthread_mutex_unlock(l)
 
+#define NVM_COND_INIT(c)         pthread_cond_init(c, NULL)
+#define NVM_COND_DESTROY(c)      pthread_cond_destroy(c)
+#define NVM_COND_WAIT(c, l)      pthread_cond_wait(c, l)
+#define NVM_COND_SIGNAL(c)       pthread_cond_signal(c)
+#define NVM_COND_BROADCAST(c)    pthread_cond_broadcast(c)
+
+/**
+ * @brief 带超时的条件等待
+ * @param timeout_ms 超时时间 (毫秒)
+ * @return 0 被唤醒, 非 0 超时或出错
+ */
+static inline int nvm_cond_timedwait_ms(nvm_cond_t* cond, nvm_mutex_t* lock, uint32_t timeout_ms) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec  += timeout_ms / 1000;
+    ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec  += 1;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return pthread_cond_timedwait(cond, lock, &ts);
+}
+
+#define NVM_COND_TIMEDWAIT_MS(c, l, ms) nvm_cond_timedwait_ms(c, l, ms)
+#endif
+
 // --- 3. 读写锁 (RWLock) ---
 // 场景: 读多写少 (如全局 Slab 哈希表查找)
+#if defined(NVM_RWLOCK_PERCPU)
+typedef nvm_percpu_rwlock_t nvm_rwlock_t;
+#define NVM_RWLOCK_BACKEND_NAME "percpu"
+
+#define NVM_RWLOCK_INIT(l)       nvm_percpu_rwlock_init(l)
+#define NVM_RWLOCK_DESTROY(l)    nvm_percpu_rwlock_destroy(l)
+#define NVM_RWLOCK_READ_LOCK(l)  nvm_percpu_rwlock_read_lock(l)
+#define NVM_RWLOCK_WRITE_LOCK(l) nvm_percpu_rwlock_write_lock(l)
+#define NVM_RWLOCK_UNLOCK(l)     nvm_percpu_rwlock_unlock(l)
+#else
 typedef pthread_rwlock_t nvm_rwlock_t;
+#define NVM_RWLOCK_BACKEND_NAME "pthread"
 
 #define NVM_RWLOCK_INIT(l)       pthread_rwlock_init(l, NULL)
 #define NVM_RWLOCK_DESTROY(l)    pthread_rwlock_destroy(l)
 #define NVM_RWLOCK_READ_LOCK(l)  pthread_rwlock_rdlock(l)
 #define NVM_RWLOCK_WRITE_LOCK(l) pthread_rwlock_wrlock(l)
 #define NVM_RWLOCK_UNLOCK(l)     pthread_rwlock_unlock(l)
+#endif
+
+// ============================================================================
+//                          OS 适配层 (后台线程)
+// ============================================================================
+
+typedef pthread_t nvm_thread_t;
+
+#define NVM_THREAD_CREATE(t, fn, arg) pthread_create(t, NULL, fn, arg)
+#define NVM_THREAD_JOIN(t)            pthread_join(t, NULL)
 
 #ifdef __cplusplus
 }
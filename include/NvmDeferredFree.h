@@ -0,0 +1,108 @@
+#ifndef NVM_DEFERRED_FREE_H
+#define NVM_DEFERRED_FREE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// ============================================================================
+//                          常量定义
+// ============================================================================
+
+// 每线程环形队列容量 (2 的幂)
+#define NVM_DEFERRED_RING_SIZE      256
+
+// 队列积压达到该数量时唤醒后台回收线程
+#define NVM_DEFERRED_WAKE_THRESHOLD (NVM_DEFERRED_RING_SIZE / 2)
+
+// ============================================================================
+//                          类型定义
+// ============================================================================
+
+/**
+ * @brief 环形队列满时的背压策略 (按线程设置)
+ */
+typedef enum {
+    NVM_DEFER_FULL_FLUSH = 0,   // 调用线程同步处理自己的整个队列后再入队 (默认)
+    NVM_DEFER_FULL_WAIT,        // 唤醒后台回收线程并等待空位；未启动回收线程时退化为 FLUSH
+    NVM_DEFER_FULL_REJECT       // 立即返回失败，指针仍归调用方所有
+} NvmDeferFullPolicy;
+
+/**
+ * @brief 批量释放回调
+ * @param ctx 创建时传入的上下文
+ * @param ptrs 待释放指针 (回调可原地重排)
+ * @param count 指针数量
+ */
+typedef void (*nvm_deferred_batch_fn)(void* ctx, void** ptrs, uint32_t count);
+
+/**
+ * @brief 延迟释放队列 (不透明句柄)
+ *
+ * 每个生产线程首次入队时注册一个单生产者环形队列，入队只写本线程的队尾，
+ * 不获取任何锁。队列内容由后台回收线程或线程自己的空闲钩子 (flush) 成批取出，
+ * 交给批量释放回调；消费端之间由每个队列的消费锁互斥，生产端不受影响。
+ * 线程退出后其队列保留，由后台线程继续处理，并被之后新注册的线程复用。
+ *
+ * @note 入队与 flush 只作用于调用线程自己的队列；销毁时处理所有剩余指针。
+ */
+typedef struct NvmDeferredFree NvmDeferredFree;
+
+// ============================================================================
+//                          生命周期管理
+// ============================================================================
+
+/**
+ * @brief 创建延迟释放队列 (不启动后台线程)
+ * @return 成功返回句柄，失败返回 NULL
+ */
+NvmDeferredFree* deferred_free_create(nvm_deferred_batch_fn batch_fn, void* ctx);
+
+/**
+ * @brief 停止后台线程，处理所有队列中剩余的指针后销毁
+ * 调用时不得有线程仍在入队。
+ */
+void deferred_free_destroy(NvmDeferredFree* queue);
+
+// ============================================================================
+//                          核心操作 API
+// ============================================================================
+
+/**
+ * @brief 把指针放入调用线程的环形队列
+ * 队列满时按本线程的背压策略处理。
+ * @return 0 已入队 (或已同步处理), -1 被拒绝 (REJECT 策略) 或注册队列失败
+ */
+int deferred_free_push(NvmDeferredFree* queue, void* ptr);
+
+/**
+ * @brief 设置调用线程的背压策略
+ */
+void deferred_free_set_policy(NvmDeferFullPolicy policy);
+
+/**
+ * @brief 同步处理调用线程自己的队列 (空闲钩子)
+ * @return 处理的指针数
+ */
+uint32_t deferred_free_flush_local(NvmDeferredFree* queue);
+
+/**
+ * @brief 同步处理所有线程的队列
+ * @return 处理的指针数
+ */
+uint32_t deferred_free_flush_all(NvmDeferredFree* queue);
+
+/**
+ * @brief 启动、调整或停止后台回收线程
+ * @param interval_ms 轮询间隔 (毫秒)；0 表示停止线程 (队列内容保留)
+ * @return 0 成功, -1 失败
+ */
+int deferred_free_set_reclaimer(NvmDeferredFree* queue, uint32_t interval_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NVM_DEFERRED_FREE_H
@@ -21,9 +21,13 @@ extern "C" {
 // 标准 Slab 大小: 2MB (Huge Page Friendly)
 #define NVM_SLAB_SIZE     (2 * 1024 * 1024)
 
-// Slab 本地缓存 (FreeList) 配置
+// Slab 本地缓存 (FreeList) 配置：默认深度与批量，深度可在运行时调到 SLAB_CACHE_MAX_SIZE
 #define SLAB_CACHE_SIZE        64
 #define SLAB_CACHE_BATCH_SIZE  (SLAB_CACHE_SIZE / 2)
+#define SLAB_CACHE_MAX_SIZE    4096
+
+// Slab 远程释放暂存区容量 (满时由释放者批量交还持有者)
+#define SLAB_REMOTE_BUFFER_SIZE 32
 
 // 哈希表初始容量 (建议为素数以减少冲突)
 #define INITIAL_HASHTABLE_CAPACITY 101
@@ -0,0 +1,97 @@
+#ifndef NVM_EPOCH_H
+#define NVM_EPOCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "NvmDefs.h"
+
+// ============================================================================
+//                          常量定义
+// ============================================================================
+
+// 单个 CPU 的延迟释放链表达到该长度时，退休操作顺带尝试推进纪元并回收
+#define NVM_EPOCH_RECLAIM_BATCH 64
+
+// ============================================================================
+//                          类型定义
+// ============================================================================
+
+/**
+ * @brief 延迟释放回调
+ */
+typedef void (*nvm_epoch_free_fn)(void* ptr);
+
+/**
+ * @brief 基于纪元的内存回收 (EBR，进程级单例)
+ *
+ * 读者在访问无锁结构 (哈希表桶链、Slab 描述符等) 前进入临界区，
+ * 只把本 CPU、当前纪元奇偶位对应的计数加一，不获取任何锁。
+ * 写者把对象从结构中摘下后调用 nvm_epoch_retire，对象挂到本 CPU 的延迟链表，
+ * 记下退休时的全局纪元 e；全局纪元推进到 e + 2 时，退休前进入的读者必然已离开，
+ * 对象才被释放。全局纪元只有在上一纪元的读者计数总和为 0 时才能推进。
+ *
+ * 读者在临界区内可能迁移到其他 CPU，因此单个 CPU 的计数可为负，只有总和有意义。
+ *
+ * @note 临界区可嵌套；临界区内不得调用 nvm_epoch_barrier。
+ */
+
+// ============================================================================
+//                          核心操作 API
+// ============================================================================
+
+/**
+ * @brief 进入读者临界区
+ * @return 令牌，退出时原样传给 nvm_epoch_exit
+ */
+uint32_t nvm_epoch_enter(void);
+
+/**
+ * @brief 离开读者临界区
+ */
+void nvm_epoch_exit(uint32_t token);
+
+/**
+ * @brief 延迟释放一个已从所有共享结构中摘下的对象
+ * 在所有可能仍持有其引用的读者离开后调用 free_fn(ptr)。
+ * 内部节点分配失败时退化为同步等待 (nvm_epoch_barrier) 后立即释放。
+ */
+void nvm_epoch_retire(void* ptr, nvm_epoch_free_fn free_fn);
+
+/**
+ * @brief 尝试推进全局纪元，并回收所有 CPU 延迟链表中已安全的对象
+ * @return 本次释放的对象数
+ */
+uint32_t nvm_epoch_reclaim(void);
+
+/**
+ * @brief 阻塞直到调用前退休的全部对象都已释放
+ * 用于销毁路径与测试，不得在读者临界区内调用。
+ */
+void nvm_epoch_barrier(void);
+
+/**
+ * @brief 设置单个 CPU 延迟链表触发顺带回收的长度 (默认 NVM_EPOCH_RECLAIM_BATCH)
+ * @return 0 成功, -1 参数为 0
+ */
+int nvm_epoch_set_reclaim_batch(uint32_t batch);
+
+/**
+ * @brief 当前的顺带回收触发长度
+ */
+uint32_t nvm_epoch_get_reclaim_batch(void);
+
+/**
+ * @brief 尚未释放的退休对象数 (近似值)
+ */
+uint64_t nvm_epoch_pending(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NVM_EPOCH_H
@@ -0,0 +1,320 @@
+#ifndef NVM_LOCK_H
+#define NVM_LOCK_H
+
+// 本文件是 OSAL 的一部分，由 NvmConfig.h 在锁原语一节之前包含
+#ifndef NVM_CONFIG_H
+#error "Include NvmConfig.h instead of NvmLock.h"
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+// ============================================================================
+//                          常量定义
+// ============================================================================
+
+// 单个线程可同时持有的 MCS/CLH 锁数量上限 (队列节点按线程预留)
+#define NVM_LOCK_MAX_NESTING     8
+
+// 自旋等待超过该次数后让出 CPU：线程数多于核数时，排队锁的下一个持有者
+// 可能已被抢占，继续空转只会把整个时间片耗在交接上
+#define NVM_SPIN_YIELD_THRESHOLD 1024
+
+// 自适应互斥锁在睡眠前的自旋次数
+#define NVM_ADAPTIVE_SPIN_LIMIT  128
+
+/**
+ * @brief 自旋等待提示 (降低功耗，让出超线程资源)
+ */
+static inline void nvm_cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield" ::: "memory");
+#else
+    __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+// 进程可运行的 CPU 是否只有一个：-1 未查询，0 否，1 是 (NvmLock.c)
+extern int nvm_lock_single_cpu_state;
+
+/**
+ * @brief 查询并记录进程是否只能在一个 CPU 上运行 (首次自旋等待时调用一次)
+ * @return 1 只有一个可运行 CPU, 0 否
+ */
+int nvm_lock_detect_single_cpu(void);
+
+/**
+ * @brief 只有一个可运行 CPU 时，锁的持有者只能在等待者让出后继续，空转毫无意义
+ */
+static inline bool nvm_lock_single_cpu(void) {
+    int state = __atomic_load_n(&nvm_lock_single_cpu_state, __ATOMIC_RELAXED);
+    if (NVM_UNLIKELY(state < 0)) state = nvm_lock_detect_single_cpu();
+    return state != 0;
+}
+
+/**
+ * @brief 自旋等待的一步：先 pause，超过阈值后 sched_yield；单 CPU 时每一步都 sched_yield
+ * @param spins 调用方维护的计数 (初始为 0)
+ */
+static inline void nvm_spin_backoff(uint32_t* spins) {
+    if (NVM_LIKELY(++*spins < NVM_SPIN_YIELD_THRESHOLD) && !nvm_lock_single_cpu()) {
+        nvm_cpu_relax();
+    } else {
+        *spins = 0;
+        sched_yield();
+    }
+}
+
+// ============================================================================
+//                          Futex 封装 (NvmLock.c)
+// ============================================================================
+
+/**
+ * @brief 若 *addr == expected 则睡眠，直到被唤醒或超时
+ * @param timeout_ms 超时 (毫秒)，0 表示无限等待
+ * @return 0 被唤醒 (或值已改变), -1 超时
+ * @note 非 Linux 平台退化为 sched_yield
+ */
+int  nvm_futex_wait(uint32_t* addr, uint32_t expected, uint32_t timeout_ms);
+
+/**
+ * @brief 唤醒最多 count 个在 addr 上睡眠的线程
+ */
+void nvm_futex_wake(uint32_t* addr, int count);
+
+// ============================================================================
+//                          票据锁 (Ticket Lock)
+// ============================================================================
+// FIFO 公平：按取号顺序获得锁，远程释放风暴下不会饿死。
+// 等待者按与持有者的距离比例退避，减少对 owner 所在缓存行的争用。
+
+typedef struct {
+    uint32_t next;    // 下一个待分配的号
+    uint32_t owner;   // 当前持有者的号
+} nvm_ticket_lock_t;
+
+static inline int nvm_ticket_lock_init(nvm_ticket_lock_t* l) {
+    l->next = 0;
+    l->owner = 0;
+    return 0;
+}
+
+static inline int nvm_ticket_lock_destroy(nvm_ticket_lock_t* l) {
+    (void)l;
+    return 0;
+}
+
+static inline int nvm_ticket_lock_acquire(nvm_ticket_lock_t* l) {
+    uint32_t ticket = __atomic_fetch_add(&l->next, 1, __ATOMIC_RELAXED);
+    uint32_t spins = 0;
+    for (;;) {
+        uint32_t owner = __atomic_load_n(&l->owner, __ATOMIC_ACQUIRE);
+        if (owner == ticket) return 0;
+        // 按前面的排队人数成比例退避；单 CPU 时每次让出后都重新检查
+        uint32_t waits = nvm_lock_single_cpu() ? 1 : ticket - owner;
+        for (uint32_t i = waits; i > 0; --i) nvm_spin_backoff(&spins);
+    }
+}
+
+// 仅在无人持有也无人排队时取号，否则不改变锁状态
+static inline int nvm_ticket_lock_try_acquire(nvm_ticket_lock_t* l) {
+    uint32_t owner = __atomic_load_n(&l->owner, __ATOMIC_RELAXED);
+    uint32_t expected = owner;
+    return __atomic_compare_exchange_n(&l->next, &expected, owner + 1, false,
+                                       __ATOMIC_ACQUIRE, __ATOMIC_RELAXED) ? 0 : EBUSY;
+}
+
+static inline int nvm_ticket_lock_release(nvm_ticket_lock_t* l) {
+    // 只有持有者写 owner，普通读即可
+    __atomic_store_n(&l->owner, l->owner + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// ============================================================================
+//                          MCS 队列锁
+// ============================================================================
+// 每个等待者只在自己的队列节点上自旋，释放时仅写后继节点，
+// 锁字本身只在入队/出队时被 CAS 一次。队列节点来自线程本地的固定数组。
+
+typedef struct nvm_mcs_node {
+    struct nvm_mcs_node* next;
+    uint32_t             locked;
+} __attribute__((aligned(CACHE_LINE_SIZE))) nvm_mcs_node_t;
+
+typedef struct {
+    nvm_mcs_node_t* tail;     // 队尾 (NULL 表示空闲)
+    nvm_mcs_node_t* holder;   // 持有者的节点 (仅持有者读写)
+} nvm_mcs_lock_t;
+
+static inline int nvm_mcs_lock_init(nvm_mcs_lock_t* l) {
+    l->tail = NULL;
+    l->holder = NULL;
+    return 0;
+}
+
+static inline int nvm_mcs_lock_destroy(nvm_mcs_lock_t* l) {
+    (void)l;
+    return 0;
+}
+
+int nvm_mcs_lock_acquire(nvm_mcs_lock_t* l);
+int nvm_mcs_lock_try_acquire(nvm_mcs_lock_t* l);
+int nvm_mcs_lock_release(nvm_mcs_lock_t* l);
+
+// ============================================================================
+//                          CLH 队列锁
+// ============================================================================
+// 等待者在前驱节点上自旋；释放后当前节点留在队列中，线程回收前驱节点复用。
+// 锁始终持有一个节点 (初始为哑节点)，因此 init 需要分配内存。
+
+typedef struct nvm_clh_node {
+    uint32_t locked;
+} __attribute__((aligned(CACHE_LINE_SIZE))) nvm_clh_node_t;
+
+typedef struct {
+    nvm_clh_node_t* tail;     // 队尾节点
+    nvm_clh_node_t* holder;   // 持有者的节点 (仅持有者读写)
+    nvm_clh_node_t* pred;     // 持有者的前驱节点 (释放时回收)
+} nvm_clh_lock_t;
+
+int nvm_clh_lock_init(nvm_clh_lock_t* l);
+int nvm_clh_lock_destroy(nvm_clh_lock_t* l);
+int nvm_clh_lock_acquire(nvm_clh_lock_t* l);
+int nvm_clh_lock_try_acquire(nvm_clh_lock_t* l);
+int nvm_clh_lock_release(nvm_clh_lock_t* l);
+
+// ============================================================================
+//                          自适应互斥锁 (Spin-then-Futex)
+// ============================================================================
+// 三态锁字：0 空闲，1 已锁无等待者，2 已锁且可能有等待者。
+// 无竞争时加解锁各一次原子操作；竞争时先自旋，仍失败才睡眠。
+
+typedef struct {
+    uint32_t state;
+} nvm_adaptive_mutex_t;
+
+int nvm_adaptive_mutex_acquire_slow(nvm_adaptive_mutex_t* m);
+
+static inline int nvm_adaptive_mutex_init(nvm_adaptive_mutex_t* m) {
+    m->state = 0;
+    return 0;
+}
+
+static inline int nvm_adaptive_mutex_destroy(nvm_adaptive_mutex_t* m) {
+    (void)m;
+    return 0;
+}
+
+static inline int nvm_adaptive_mutex_acquire(nvm_adaptive_mutex_t* m) {
+    uint32_t expected = 0;
+    if (NVM_LIKELY(__atomic_compare_exchange_n(&m->state, &expected, 1, false,
+                                               __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))) {
+        return 0;
+    }
+    return nvm_adaptive_mutex_acquire_slow(m);
+}
+
+static inline int nvm_adaptive_mutex_try_acquire(nvm_adaptive_mutex_t* m) {
+    uint32_t expected = 0;
+    return __atomic_compare_exchange_n(&m->state, &expected, 1, false,
+                                       __ATOMIC_ACQUIRE, __ATOMIC_RELAXED) ? 0 : EBUSY;
+}
+
+static inline int nvm_adaptive_mutex_release(nvm_adaptive_mutex_t* m) {
+    if (NVM_UNLIKELY(__atomic_exchange_n(&m->state, 0, __ATOMIC_RELEASE) == 2)) {
+        nvm_futex_wake(&m->state, 1);
+    }
+    return 0;
+}
+
+// 与自适应互斥锁配套的条件变量 (序号 + futex，允许虚假唤醒)
+typedef struct {
+    uint32_t seq;
+} nvm_futex_cond_t;
+
+static inline int nvm_futex_cond_init(nvm_futex_cond_t* c) {
+    c->seq = 0;
+    return 0;
+}
+
+static inline int nvm_futex_cond_destroy(nvm_futex_cond_t* c) {
+    (void)c;
+    return 0;
+}
+
+int nvm_futex_cond_timedwait(nvm_futex_cond_t* c, nvm_adaptive_mutex_t* m, uint32_t timeout_ms);
+
+static inline int nvm_futex_cond_signal(nvm_futex_cond_t* c) {
+    __atomic_fetch_add(&c->seq, 1, __ATOMIC_RELEASE);
+    nvm_futex_wake(&c->seq, 1);
+    return 0;
+}
+
+static inline int nvm_futex_cond_broadcast(nvm_futex_cond_t* c) {
+    __atomic_fetch_add(&c->seq, 1, __ATOMIC_RELEASE);
+    nvm_futex_wake(&c->seq, INT32_MAX);
+    return 0;
+}
+
+// ============================================================================
+//                          每 CPU 读者计数的读写锁
+// ============================================================================
+// 读者只修改本 CPU 的计数 (独占缓存行)，读路径不与其他读者共享写入。
+// 写者先置位 writer 阻止新读者，再等待所有计数之和归零。
+// 读者解锁时线程可能已迁移，因此计数可为负，只有总和有意义。
+
+typedef struct {
+    int32_t count;
+    char    _pad[CACHE_LINE_SIZE - sizeof(int32_t)];
+} nvm_rw_reader_slot_t;
+
+typedef struct {
+    nvm_rw_reader_slot_t readers[MAX_CPUS];
+    uint32_t             writer;       // 1 表示有写者持有或等待
+    const void*          write_owner;  // 写者的线程标识 (区分读解锁与写解锁)
+} nvm_percpu_rwlock_t;
+
+// 线程标识：取线程本地变量的地址 (NvmLock.c 中定义)
+extern _Thread_local char nvm_lock_thread_tag;
+
+static inline int nvm_percpu_rwlock_init(nvm_percpu_rwlock_t* l) {
+    for (int i = 0; i < MAX_CPUS; ++i) l->readers[i].count = 0;
+    l->writer = 0;
+    l->write_owner = NULL;
+    return 0;
+}
+
+static inline int nvm_percpu_rwlock_destroy(nvm_percpu_rwlock_t* l) {
+    (void)l;
+    return 0;
+}
+
+static inline int nvm_percpu_rwlock_read_lock(nvm_percpu_rwlock_t* l) {
+    uint32_t spins = 0;
+    for (;;) {
+        int32_t* slot = &l->readers[nvm_get_current_cpu_id()].count;
+        // 先登记再检查写者 (均为 SEQ_CST)，与写者的"先置位再扫描"构成 Dekker 式互斥
+        __atomic_fetch_add(slot, 1, __ATOMIC_SEQ_CST);
+        if (NVM_LIKELY(!__atomic_load_n(&l->writer, __ATOMIC_SEQ_CST))) return 0;
+
+        __atomic_fetch_sub(slot, 1, __ATOMIC_RELEASE);
+        while (__atomic_load_n(&l->writer, __ATOMIC_RELAXED)) nvm_spin_backoff(&spins);
+    }
+}
+
+int nvm_percpu_rwlock_write_lock(nvm_percpu_rwlock_t* l);
+
+static inline int nvm_percpu_rwlock_unlock(nvm_percpu_rwlock_t* l) {
+    if (__atomic_load_n(&l->write_owner, __ATOMIC_RELAXED) == &nvm_lock_thread_tag) {
+        l->write_owner = NULL;
+        __atomic_store_n(&l->writer, 0, __ATOMIC_RELEASE);
+        return 0;
+    }
+    __atomic_fetch_sub(&l->readers[nvm_get_current_cpu_id()].count, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+#endif // NVM_LOCK_H
@@ -0,0 +1,180 @@
+#ifndef NVM_LOG_H
+#define NVM_LOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "NvmDefs.h"
+
+// ============================================================================
+//                          常量定义
+// ============================================================================
+
+// 每个 CPU 日志的环形记录数 (每条记录 8 字节)
+#define NVM_LOG_CAPACITY        2048
+
+// 后台检查点默认周期 (毫秒)
+#define NVM_LOG_CHECKPOINT_MS   50
+
+// 持久化 Slab 镜像中表示"未使用"的尺寸类别
+#define NVM_LOG_SC_NONE         0xFF
+
+// ============================================================================
+//                          类型定义
+// ============================================================================
+
+/**
+ * @brief 日志记录操作类型
+ */
+typedef enum {
+    NVM_LOG_OP_ALLOC = 1,
+    NVM_LOG_OP_FREE  = 2
+} NvmLogOp;
+
+/**
+ * @brief 解码后的日志记录 (离线检查用)
+ */
+typedef struct NvmLogRecord {
+    uint64_t block_offset;     // 块的 NVM 偏移
+    uint8_t  sc_id;            // 尺寸类别 (未校验，可能 >= SC_COUNT)
+    uint8_t  op;               // NvmLogOp (未校验)
+} NvmLogRecord;
+
+/**
+ * @brief 元数据区头部描述的布局 (离线检查用)
+ */
+typedef struct NvmLogLayout {
+    uint64_t meta_size;        // 元数据区大小 (nvm_log_region_size(data_size))
+    uint64_t data_offset;      // 数据区起始偏移
+    uint64_t data_size;        // 数据区大小
+    uint32_t slab_count;       // 数据区 Slab 数 (Slab 镜像数)
+} NvmLogLayout;
+
+/**
+ * @brief 日志式分配元数据区 (不透明句柄)
+ *
+ * 分配/释放时，不直接在 NVM 中随机更新 Slab 位图，而是向 Slab 所属 CPU 的
+ * 顺序日志追加一条 8 字节记录 (一次 flush + fence)。后台检查点线程周期性地
+ * 把日志折叠进持久化的 Slab 位图镜像并截断日志；恢复时从镜像出发重放日志尾部。
+ *
+ * NVM 布局 (起始于 meta_addr)：
+ *   [头部] [每 CPU 日志头 x MAX_CPUS] [每 CPU 记录环 x MAX_CPUS] [Slab 镜像 x slab_count]
+ *
+ * 同一 Slab 的记录总是写入其所属 CPU 的日志，因此单个日志内的顺序即该 Slab
+ * 上操作的真实顺序，各日志可独立折叠。
+ *
+ * @note 线程安全：每个日志由独立互斥锁保护。
+ */
+typedef struct NvmLogRegion NvmLogRegion;
+
+// ============================================================================
+//                          生命周期管理
+// ============================================================================
+
+/**
+ * @brief 计算管理 data_size 字节数据区所需的元数据区大小 (按 NVM_SLAB_SIZE 向上对齐)
+ */
+uint64_t nvm_log_region_size(uint64_t data_size);
+
+/**
+ * @brief 打开 (或格式化) 日志元数据区
+ *
+ * @param meta_addr 元数据区起始地址 (至少 nvm_log_region_size(data_size) 字节)
+ * @param data_offset 数据区起始偏移 (按 NVM_SLAB_SIZE 对齐)
+ * @param data_size 数据区大小
+ * @param recover true: 校验已有头部，重放各日志尾部并折叠进镜像；false: 格式化
+ * @param checkpoint_ms 后台检查点周期，0 表示不启动后台线程 (仅在日志满或显式调用时折叠)
+ * @return 成功返回句柄；失败 (含恢复时头部不匹配) 返回 NULL
+ */
+NvmLogRegion* nvm_log_region_create(void* meta_addr, uint64_t data_offset, uint64_t data_size,
+                                    bool recover, uint32_t checkpoint_ms);
+
+/**
+ * @brief 停止检查点线程，执行最后一次检查点并释放 DRAM 状态
+ */
+void nvm_log_region_destroy(NvmLogRegion* region);
+
+// ============================================================================
+//                          核心操作 API
+// ============================================================================
+
+/**
+ * @brief 追加一条记录并持久化
+ * 日志已满时先在调用线程上同步折叠该日志。
+ * @param cpu 记录所属日志 (Slab 的持有 CPU)
+ * @param block_offset 块的 NVM 偏移
+ * @return 0 成功, -1 参数无效
+ */
+int nvm_log_append(NvmLogRegion* region, int cpu, NvmLogOp op, uint64_t block_offset, SizeClassID sc_id);
+
+/**
+ * @brief 非阻塞地追加一条记录
+ * 日志锁被占用或日志已满 (需要折叠) 时立即失败，不唤醒检查点线程。
+ * @return 0 成功, -1 参数无效或无法立即追加
+ */
+int nvm_log_try_append(NvmLogRegion* region, int cpu, NvmLogOp op, uint64_t block_offset, SizeClassID sc_id);
+
+/**
+ * @brief 立即把所有日志折叠进 Slab 镜像并截断
+ */
+void nvm_log_checkpoint(NvmLogRegion* region);
+
+/**
+ * @brief 读取持久化的 Slab 镜像 (用于恢复时重建 DRAM 元数据)
+ * @param slab_idx 相对数据区起点的 Slab 序号
+ * @param out_sc [输出] 尺寸类别，未使用时为 NVM_LOG_SC_NONE
+ * @param out_bitmap [输出] 位图 (块 i 占用时第 i 位为 1)
+ * @return 0 成功, -1 序号越界
+ */
+int nvm_log_slab_image(NvmLogRegion* region, uint32_t slab_idx, uint8_t* out_sc, const unsigned char** out_bitmap);
+
+/**
+ * @brief 数据区包含的 Slab 数
+ */
+uint32_t nvm_log_slab_count(NvmLogRegion* region);
+
+/**
+ * @brief 指定 CPU 日志中尚未折叠的记录数
+ */
+uint32_t nvm_log_pending(NvmLogRegion* region, int cpu);
+
+// ============================================================================
+//                          离线检查 API
+// ============================================================================
+// 以下接口直接解析一段已映射的元数据区，不创建句柄、不启动线程，也不修改任何内容，
+// 可用于只读映射的池文件。调用者必须保证没有进程正以该区域运行分配器。
+
+/**
+ * @brief 校验头部并读取布局
+ * @param avail meta_addr 起可访问的字节数 (通常为池文件大小)
+ * @return 0 成功, -1 头部无效、版本或编译期参数不匹配，或区域不完整
+ */
+int nvm_log_inspect_layout(const void* meta_addr, uint64_t avail, NvmLogLayout* out);
+
+/**
+ * @brief 获取 Slab 镜像的尺寸类别与位图地址
+ *
+ * 返回的指针指向映射本身：只读映射时只能读取；可写映射时修改后需自行持久化。
+ * @param out_sc [输出] 尺寸类别字节的地址 (NVM_LOG_SC_NONE 表示未使用)
+ * @param out_bitmap [输出] 位图地址 (NVM_SLAB_SIZE / 64 字节)
+ * @return 0 成功, -1 序号越界
+ */
+int nvm_log_inspect_image(const void* meta_addr, uint32_t slab_idx, uint8_t** out_sc, unsigned char** out_bitmap);
+
+/**
+ * @brief 解码指定 CPU 日志中尚未折叠的记录 (按追加顺序)
+ * @param out 输出数组，容量至少 NVM_LOG_CAPACITY
+ * @return 记录数
+ */
+uint32_t nvm_log_inspect_pending(const void* meta_addr, int cpu, NvmLogRecord* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NVM_LOG_H
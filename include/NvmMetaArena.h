@@ -0,0 +1,79 @@
+#ifndef NVM_META_ARENA_H
+#define NVM_META_ARENA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "NvmDefs.h"
+
+// ============================================================================
+//                          常量定义
+// ============================================================================
+
+// 每次向操作系统申请的块大小 (一个大页)
+#define NVM_META_CHUNK_SIZE     NVM_HUGE_PAGE_SIZE
+
+// 小尺寸类别按缓存行递增，直到 NVM_META_SMALL_MAX
+#define NVM_META_SMALL_STEP     CACHE_LINE_SIZE
+#define NVM_META_SMALL_MAX      1024
+
+// 大尺寸类别按 1KB 递增，直到 NVM_META_MAX_SIZE (覆盖 8B 类别 Slab 的位图)
+#define NVM_META_LARGE_STEP     1024
+#define NVM_META_MAX_SIZE       (64 * 1024)
+
+#define NVM_META_CLASS_COUNT    (NVM_META_SMALL_MAX / NVM_META_SMALL_STEP + \
+                                 (NVM_META_MAX_SIZE - NVM_META_SMALL_MAX) / NVM_META_LARGE_STEP)
+
+// ============================================================================
+//                          类型定义
+// ============================================================================
+
+/**
+ * @brief 元数据 arena 统计
+ */
+typedef struct NvmMetaArenaStats {
+    uint64_t chunk_count;       // 已映射的大页块数
+    uint64_t hugetlb_chunks;    // 其中由 hugetlbfs 大页承载的块数
+    uint64_t bytes_in_use;      // 已交付的字节数 (按尺寸类别取整)
+    uint64_t bytes_cached;      // 空闲链表中待复用的字节数
+} NvmMetaArenaStats;
+
+// ============================================================================
+//                          核心操作 API
+// ============================================================================
+
+/**
+ * @brief 从元数据 arena 分配清零内存 (进程级单例，每个 NUMA 节点一个 arena)
+ *
+ * Slab 描述符、哈希节点、空闲段节点等分配器内部元数据不经过系统 malloc，
+ * 而是从按大页映射的块中切分：同一尺寸类别的空闲块组成单链表，优先复用；
+ * 否则从当前块顺序切分，块剩余空间不足时映射新块。块从不归还操作系统。
+ * 超过 NVM_META_MAX_SIZE 的请求直接由 nvm_numa_alloc 承担。
+ *
+ * @param size 请求大小，按尺寸类别向上取整
+ * @param node 所在 NUMA 节点，-1 表示不绑定
+ * @return 按 CACHE_LINE_SIZE 对齐的清零内存，失败返回 NULL
+ */
+void* nvm_meta_alloc(size_t size, int node);
+
+/**
+ * @brief 归还 nvm_meta_alloc 分配的内存
+ * @note size 与 node 必须与分配时一致
+ */
+void nvm_meta_free(void* ptr, size_t size, int node);
+
+/**
+ * @brief 读取指定节点 arena 的统计 (node = -1 为不绑定节点的 arena)
+ * @return 0 成功, -1 参数无效
+ */
+int nvm_meta_arena_stats(int node, NvmMetaArenaStats* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NVM_META_ARENA_H
@@ -0,0 +1,162 @@
+#ifndef NVM_PERSIST_H
+#define NVM_PERSIST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "NvmConfig.h"
+
+// ============================================================================
+//                          常量定义
+// ============================================================================
+
+// 不小于该长度的写入使用非临时存储，更短的写入使用普通写 + flush
+#define NVM_PERSIST_NT_THRESHOLD  512
+
+// ============================================================================
+//                          类型定义
+// ============================================================================
+
+/**
+ * @brief 运行时探测到的缓存行回写指令
+ *
+ * 首次调用持久化接口时通过 CPUID 探测，优先级 CLWB > CLFLUSHOPT > CLFLUSH。
+ * 非 x86 平台退化为 NVM_FLUSH_NONE (仅保留内存屏障)。
+ */
+typedef enum {
+    NVM_FLUSH_NONE = 0,
+    NVM_FLUSH_CLFLUSH,
+    NVM_FLUSH_CLFLUSHOPT,
+    NVM_FLUSH_CLWB
+} NvmFlushKind;
+
+/**
+ * @brief 运行时选定的批量写内核
+ *
+ * 与 NvmFlushKind 在同一次 CPU 特性探测中确定，优先级 AVX-512 > SSE2。
+ * NVM_STORE_CACHED 表示平台不支持流式写入，批量写退化为普通写 + flush。
+ */
+typedef enum {
+    NVM_STORE_CACHED = 0,
+    NVM_STORE_NT_SSE2,
+    NVM_STORE_NT_AVX512
+} NvmStoreKind;
+
+/**
+ * @brief 持久化仿真统计 (写放大计数器)
+ *
+ * 仿真模型参考 Optane 的 XPBuffer：介质以 NVM_MEDIA_LINE_SIZE (256B) 为单位写入，
+ * 控制器前端有一个小的写合并缓冲 (FIFO 替换)。同一介质行的 4 个缓存行若在
+ * 缓冲驻留期间全部被回写，逐出时合并为一次整行写；否则需要一次读-改-写 (RMW)。
+ */
+typedef struct NvmPersistStats {
+    uint64_t flushed_lines;   // 回写的缓存行数 (CACHE_LINE_SIZE 单位)
+    uint64_t media_writes;    // 介质写次数 (NVM_MEDIA_LINE_SIZE 单位)
+    uint64_t media_rmw;       // 其中需要读-改-写的次数 (介质行未被写满)
+} NvmPersistStats;
+
+// ============================================================================
+//                          持久化原语
+// ============================================================================
+
+/**
+ * @brief 返回当前使用的回写指令 (首次调用时完成 CPU 特性探测)
+ */
+NvmFlushKind nvm_persist_flush_kind(void);
+
+/**
+ * @brief 回写 [addr, addr + len) 覆盖的所有缓存行 (不含屏障)
+ */
+void nvm_persist_flush(const void* addr, size_t len);
+
+/**
+ * @brief 持久化屏障 (x86 上为 SFENCE)
+ */
+void nvm_persist_fence(void);
+
+/**
+ * @brief 回写并等待持久化完成 (flush + fence)
+ */
+void nvm_persist(const void* addr, size_t len);
+
+// ============================================================================
+//                          批量写内核 (Non-Temporal)
+// ============================================================================
+
+/**
+ * @brief 非临时存储清零/填充并持久化
+ *
+ * 对齐的缓存行主体使用 MOVNT 流式写入 (绕过缓存，无需逐行 flush)，
+ * 首尾不足一行的部分使用普通写 + flush，最后只发出一次 SFENCE。
+ * 用于 nvm_calloc 与 Slab 预清零等大块写入场景。
+ */
+void nvm_persist_memset_nt(void* dst, int c, size_t len);
+
+/**
+ * @brief 非临时存储拷贝并持久化 (语义同 memcpy，区间不得重叠)
+ */
+void nvm_persist_memcpy_nt(void* dst, const void* src, size_t len);
+
+/**
+ * @brief 返回当前使用的批量写内核 (首次调用时完成 CPU 特性探测)
+ */
+NvmStoreKind nvm_persist_store_kind(void);
+
+// ============================================================================
+//                          应用层持久化写入 API
+// ============================================================================
+
+/**
+ * @brief 拷贝并持久化 (返回时数据已到达持久域)
+ *
+ * 长度小于 NVM_PERSIST_NT_THRESHOLD 时使用普通写 + flush (数据留在缓存中，
+ * 便于随后读取)；否则使用非临时存储批量写入。两条路径都只发出一次屏障。
+ * 区间不得重叠。
+ *
+ * @return dst
+ */
+void* nvm_memcpy_persist(void* dst, const void* src, size_t len);
+
+/**
+ * @brief 填充并持久化，策略同 nvm_memcpy_persist
+ * @return dst
+ */
+void* nvm_memset_persist(void* dst, int c, size_t len);
+
+// ============================================================================
+//                          仿真与统计 API
+// ============================================================================
+
+/**
+ * @brief 开启/关闭写放大仿真
+ * @note 关闭时 flush 路径上只有一次 relaxed 读，开销可忽略
+ */
+void nvm_persist_emu_enable(bool enable);
+
+/**
+ * @brief 清空仿真写合并缓冲与全部计数器
+ */
+void nvm_persist_emu_reset(void);
+
+/**
+ * @brief 读取仿真统计
+ * 读取前会先把写合并缓冲中尚未落盘的介质行全部逐出，使计数完整。
+ */
+void nvm_persist_emu_get_stats(NvmPersistStats* out_stats);
+
+/**
+ * @brief 根据统计计算写放大系数 (介质写入字节 / 回写字节)
+ * @return 1.0 表示无放大；无数据时返回 0
+ */
+double nvm_persist_emu_write_amplification(const NvmPersistStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NVM_PERSIST_H
@@ -0,0 +1,115 @@
+#ifndef NVM_REMOTE_BATCH_H
+#define NVM_REMOTE_BATCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "NvmSlab.h"
+
+// ============================================================================
+//                          常量定义
+// ============================================================================
+
+// 每组最多暂存的块数 (组大小可在运行时调小)
+#define NVM_REMOTE_BATCH_MAX           64
+
+// 默认组大小，与 Slab 远程暂存区容量一致，一次刷新恰好填满暂存区
+#define NVM_REMOTE_BATCH_DEFAULT       SLAB_REMOTE_BUFFER_SIZE
+
+// 每个线程同时暂存的目标 Slab 数，满时刷新块数最多的一组腾出位置
+#define NVM_REMOTE_BATCH_GROUPS        8
+
+// 最早暂存的块超过这么久 (微秒) 时，下一次入队顺带刷新整个线程缓存
+#define NVM_REMOTE_BATCH_MAX_AGE_US    1000
+
+// 每隔这么多次入队才读一次时钟
+#define NVM_REMOTE_BATCH_CLOCK_EVERY   16
+
+// ============================================================================
+//                          类型定义
+// ============================================================================
+
+/**
+ * @brief 每线程远程释放批处理器 (不透明句柄)
+ *
+ * 线程释放其他 CPU 分配的块时，块先按目标 Slab 分组暂存在线程本地缓存中，
+ * 组满、组位用尽、暂存超时或显式刷新时整组交给 nvm_slab_free_remote_batch，
+ * 每批只获取一次目标 Slab 的远程锁。
+ *
+ * 暂存中的块在 Slab 看来仍是已分配的，因此 Slab 不会被判空回收，缓存持有的
+ * 描述符指针始终有效。线程缓存带一把几乎无竞争的锁，供 flush_all 与后台刷新
+ * 线程跨线程刷新；线程退出时刷新自己的缓存，缓存留给之后注册的线程复用。
+ */
+typedef struct NvmRemoteBatcher NvmRemoteBatcher;
+
+// ============================================================================
+//                          生命周期管理
+// ============================================================================
+
+/**
+ * @brief 创建批处理器 (不启动后台刷新线程)
+ * @param group_size 组大小 [0, NVM_REMOTE_BATCH_MAX]，0 表示不暂存
+ * @return 成功返回句柄，失败返回 NULL
+ */
+NvmRemoteBatcher* remote_batch_create(uint32_t group_size);
+
+/**
+ * @brief 停止后台线程，刷新所有线程缓存后销毁
+ * 调用时不得有线程仍在入队，且所有目标 Slab 必须仍然有效。
+ */
+void remote_batch_destroy(NvmRemoteBatcher* batcher);
+
+// ============================================================================
+//                          核心操作 API
+// ============================================================================
+
+/**
+ * @brief 把一个远程释放放入调用线程的缓存
+ * @return 0 已暂存 (或已随所在组刷新), -1 未启用暂存或注册缓存失败 (调用方应直接远程释放)
+ */
+int remote_batch_push(NvmRemoteBatcher* batcher, NvmSlab* slab, uint32_t block_idx);
+
+/**
+ * @brief 刷新调用线程自己的缓存 (空闲钩子)
+ * @return 刷新的块数
+ */
+uint32_t remote_batch_flush_local(NvmRemoteBatcher* batcher);
+
+/**
+ * @brief 刷新所有线程的缓存
+ * @return 刷新的块数
+ */
+uint32_t remote_batch_flush_all(NvmRemoteBatcher* batcher);
+
+/**
+ * @brief 调整组大小；调小时已超过新大小的组在下一次入队时刷新
+ * @return 0 成功, -1 超过 NVM_REMOTE_BATCH_MAX
+ */
+int remote_batch_set_group_size(NvmRemoteBatcher* batcher, uint32_t group_size);
+
+uint32_t remote_batch_get_group_size(NvmRemoteBatcher* batcher);
+
+/**
+ * @brief 启动、调整或停止后台刷新线程
+ * @param interval_ms 刷新间隔 (毫秒)；0 表示停止
+ * @return 0 成功, -1 失败
+ */
+int remote_batch_set_flusher(NvmRemoteBatcher* batcher, uint32_t interval_ms);
+
+uint32_t remote_batch_get_flusher(NvmRemoteBatcher* batcher);
+
+/**
+ * @brief 累计统计 (各线程缓存之和，近似值)
+ * @param out_frees 经过暂存的远程释放数
+ * @param out_flushes 交给 Slab 的批次数 (即远程锁获取次数)
+ */
+void remote_batch_stats(NvmRemoteBatcher* batcher, uint64_t* out_frees, uint64_t* out_flushes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NVM_REMOTE_BATCH_H
@@ -17,43 +17,102 @@ extern "C" {
  * 
  * 管理 NVM 中的一个固定大小的内存页 (2MB)，将其切分为固定大小的小块。
  * 包含 DRAM 中的元数据、自旋锁、本地缓存 (FreeList) 和位图。
+ *
+ * 描述符按访问者分为三组，各自从新的缓存行开始，远程释放与持有者分配互不伪共享：
+ *   1. 冷元数据：创建后基本只读，链表遍历与块地址换算使用
+ *   2. 持有者热数据：分配路径在 lock 下读写的计数、环形缓存与位图
+ *   3. 远程释放：其他 CPU 的释放只写入暂存区，由持有者在缓存耗尽时批量吸收
+ *
+ * 易失模式 (nvm_slab_create_volatile) 下空闲块的前 8 字节存放下一个空闲块的地址，
+ * 环形缓存与远程暂存区分别让位于本地与远程两条侵入式链表，描述符不带位图。
+ *
+ * @note 描述符必须按 CACHE_LINE_SIZE 对齐分配 (nvm_meta_alloc 保证)
  */
 typedef struct NvmSlab {
-    
-    // --- 1. 链表链接 ---
+
+    // ---------------- 1. 冷元数据 ----------------
     // 指向同尺寸类别 (Size Class) 链表中的下一个 Slab
-    // 仅被拥有该 Slab 的 CPU 在本地堆中访问，或在创建/销毁时访问
+    // 仅在所属 CPU 堆锁或仓库锁下修改
     struct NvmSlab* next_in_chain;
 
-    // --- 2. 并发控制 ---
-    // 保护位图 (bitmap) 和 本地缓存 (free_block_buffer) 的并发访问
-    // 处理 Remote Free (跨线程释放) 时的竞争
-    nvm_spinlock_t lock;
-
-    // --- 3. 核心元数据 ---
     uint64_t nvm_base_offset;         // Slab 在 NVM 物理空间中的起始偏移量
     uint8_t  size_type_id;            // 对应的 SizeClassID
-    uint8_t  _padding[3];             // 内存对齐填充 (保证后续 uint32 对齐)
+    int8_t   numa_node;               // 元数据所在 NUMA 节点 (-1 表示未绑定)
+    uint8_t  owner_cpu;               // 首个持有该 Slab 的 CPU 堆 (决定日志归属，窃取后不变)
+    uint8_t  heap_cpu;                // 当前挂载该 Slab 的 CPU 堆 (决定释放走本地还是远程路径)
     uint32_t block_size;              // 每个块的大小 (字节)
     uint32_t total_block_count;       // 该 Slab 能容纳的总块数
-    uint32_t allocated_block_count;   // 当前已分配的块数 (用于判断是否满/空)
+    char*    block_base;              // 易失模式：块区域的虚拟地址 (持久模式为 NULL)
+
+    // ---------------- 2. 持有者热数据 ----------------
+    // 保护位图、本地缓存与本组其余字段
+    nvm_spinlock_t lock __attribute__((aligned(CACHE_LINE_SIZE)));
+
+    uint8_t  flags;                   // 行为标志 (NVM_SLAB_FLAG_*)
+    uint16_t cache_depth;             // 环形缓存最多容纳的块数 (<= SLAB_CACHE_MAX_SIZE，创建时确定)
+    uint16_t cache_batch;             // refill 一次填充、drain 回写后保留的块数
+    uint16_t cache_mask;              // 环形缓冲区容量 - 1 (容量为不小于 cache_depth 的 2 的幂)
+    // 已交付且未被吸收回来的块数；仍在远程暂存区中的块也计入，实际占用见 nvm_slab_used_blocks
+    uint32_t allocated_block_count;
 
-    // --- 4. 本地缓存 (Software Cache / FreeList) ---
     // 使用环形缓冲区作为一个固定大小的 LIFO/FIFO 缓存
     // 用于加速分配和释放，减少位图扫描的开销
     uint32_t cache_head;
     uint32_t cache_tail;
     uint32_t cache_count;
-    uint32_t free_block_buffer[SLAB_CACHE_SIZE];
 
-    // --- 5. 位图区域 (Flexible Array Member) ---
+    // 介质行放置模式下，下一次寻找完全空闲介质行的起点
+    uint32_t line_cursor;
+
+    // 预清零 Slab: 曾被释放过的最大块索引 + 1，不低于此值的块仍保持全零
+    uint32_t dirty_watermark;
+
+    // 切分游标：不低于此值的块从未交付过，缓存为空时直接推进游标分配，不扫描位图。
+    // 持久模式下游标进入新的 64 块字时整字预标记位图；到达 total_block_count 后改由位图填充缓存
+    uint32_t bump_cursor;
+
+    // 原子位图引擎：下一次分配开始扫描的位图字 (只由分配方更新)
+    uint32_t atomic_hint;
+
+    union {
+        // 持久模式：环形缓存，存储紧随位图之后 (容量 cache_mask + 1，原子位图引擎为 NULL)
+        uint32_t* free_block_buffer;
+        // 易失模式：空闲块链表
+        void*     free_head;
+    };
+
+    // ---------------- 3. 远程释放 ----------------
+    // 保护暂存区；持有者吸收时先持 lock 再持 remote_lock
+    nvm_spinlock_t remote_lock __attribute__((aligned(CACHE_LINE_SIZE)));
+    uint32_t remote_count;            // 暂存区中的块数
+    union {
+        uint32_t remote_buffer[SLAB_REMOTE_BUFFER_SIZE];
+        // 易失模式：远程释放的块链表 (无容量上限) 及其中最大块索引 + 1
+        struct {
+            void*    remote_head;
+            uint32_t remote_watermark;
+        };
+    };
+
+    // ---------------- 位图 (Flexible Array Member) ----------------
     // 必须位于结构体末尾。用于记录所有块的分配状态 (0=空闲, 1=占用)
-    // 实际大小在创建时根据 block_size 动态计算分配
-    unsigned char bitmap[];
+    // 实际大小在创建时根据 block_size 动态计算分配；只在持有者锁下访问。易失模式下长度为 0。
+    // 持久模式下其后按缓存行对齐放置环形缓冲区
+    unsigned char bitmap[] __attribute__((aligned(CACHE_LINE_SIZE)));
 
 } NvmSlab;
 
 
+// Slab 行为标志
+#define NVM_SLAB_FLAG_MEDIA_LINE    0x01  // 按 256B 介质行整行交付小块
+#define NVM_SLAB_FLAG_NO_FREE_LINE  0x02  // [内部] 已无完全空闲的介质行
+#define NVM_SLAB_FLAG_PREZEROED     0x04  // NVM 区域在创建前已被整体清零
+#define NVM_SLAB_FLAG_VOLATILE      0x08  // 易失模式：侵入式空闲链表，无位图
+#define NVM_SLAB_FLAG_ATOMIC        0x10  // 原子位图引擎：分配与释放直接原子修改位图字，不持锁
+
+// heap_cpu 取值：Slab 未挂载到任何 CPU 堆 (新建或位于仓库中)
+#define NVM_SLAB_NO_HEAP            0xFF
+
 #define IS_BIT_SET(bitmap, n)   ((bitmap[(n) / 8] >> ((n) % 8)) & 1)
 #define SET_BIT(bitmap, n)      (bitmap[(n) / 8] |= (1 << ((n) % 8)))
 #define CLEAR_BIT(bitmap, n)    (bitmap[(n) / 8] &= ~(1 << ((n) % 8)))
@@ -70,12 +129,78 @@ typedef struct NvmSlab {
  */
 NvmSlab* nvm_slab_create(SizeClassID sc_id, uint64_t nvm_base_offset);
 
+/**
+ * @brief 在指定 NUMA 节点上创建 Slab 元数据
+ * @param numa_node 元数据所在节点，-1 表示不绑定 (等价于 nvm_slab_create)
+ * @return 成功返回指针，失败返回 NULL
+ */
+NvmSlab* nvm_slab_create_on_node(SizeClassID sc_id, uint64_t nvm_base_offset, int numa_node);
+
+/**
+ * @brief 创建易失模式的 Slab (DRAM 或内存模式 NVM，不需要持久化分配状态)
+ *
+ * 空闲块自身保存下一个空闲块的地址，分配与释放只是链表的弹出与压入；
+ * 从未交付过的块按顺序切分，不预先串链。描述符不含位图，因此不支持
+ * 介质行放置与 nvm_slab_set_bitmap_at_idx。块索引接口与持久模式相同。
+ *
+ * @param block_base 该 Slab 块区域的虚拟地址 (对应 nvm_base_offset)
+ * @param numa_node 元数据所在节点，-1 表示不绑定
+ * @return 成功返回指针，失败返回 NULL
+ */
+NvmSlab* nvm_slab_create_volatile(SizeClassID sc_id, uint64_t nvm_base_offset, void* block_base, int numa_node);
+
+/**
+ * @brief 创建原子位图引擎的 Slab (面向没有线程缓存、远程释放密集的负载)
+ *
+ * 不使用自旋锁、环形缓存与远程暂存区：分配先原子预留计数，再从提示字开始用 CAS
+ * 抢占 64 位位图字中最低的空闲位；释放 (本地或远程相同) 用 fetch_and 清位。
+ * 位图始终等于实际占用。不支持介质行放置。
+ *
+ * @param numa_node 元数据所在节点，-1 表示不绑定
+ * @return 成功返回指针，失败返回 NULL
+ */
+NvmSlab* nvm_slab_create_atomic(SizeClassID sc_id, uint64_t nvm_base_offset, int numa_node);
+
+/**
+ * @brief 设置之后创建的 Slab 的环形缓存深度与填充批量 (进程级)
+ *
+ * 默认 SLAB_CACHE_SIZE / SLAB_CACHE_BATCH_SIZE。两者在创建时复制进描述符的持有者热数据，
+ * 分配与释放路径读取的是与 cache_count 同一缓存行的字段；环形缓冲区随描述符一起按深度
+ * 分配 (向上取 2 的幂)，已创建的 Slab 不受影响。
+ *
+ * @return 0 成功, -1 参数无效 (要求 1 <= batch < depth <= SLAB_CACHE_MAX_SIZE)
+ */
+int nvm_slab_set_cache_params(uint32_t depth, uint32_t batch);
+
+/**
+ * @brief 读取当前的新建 Slab 缓存深度与填充批量
+ */
+void nvm_slab_get_cache_params(uint32_t* depth, uint32_t* batch);
+
 /**
  * @brief 销毁 Slab 元数据
  * 注意：不负责释放 NVM 物理空间，仅释放 DRAM 元数据
  */
 void nvm_slab_destroy(NvmSlab* self);
 
+/**
+ * @brief 开启介质行感知放置 (Media-Line Placement)
+ *
+ * 开启后 refill 优先整行交付完全空闲的 NVM_MEDIA_LINE_SIZE 介质行，
+ * 使连续分配的小块写满同一介质行后再前进，减少介质读-改-写。
+ * 仅对块大小小于介质行的尺寸类别 (8B ~ 128B) 生效。
+ *
+ * @note 需在 Slab 发布 (挂入链表/哈希表) 之前调用
+ * @return true 已开启, false 该尺寸类别不适用
+ */
+bool nvm_slab_enable_media_line_placement(NvmSlab* self);
+
+/**
+ * @brief 标记 Slab 的 NVM 区域已被整体清零 (来自预清零池)
+ * @note 需在 Slab 发布之前调用
+ */
+void nvm_slab_mark_prezeroed(NvmSlab* self);
+
 // ============================================================================
 //                          核心操作 API
 // ============================================================================
@@ -87,12 +212,42 @@ void nvm_slab_destroy(NvmSlab* self);
  */
 int nvm_slab_alloc(NvmSlab* self, uint32_t* out_block_idx);
 
+/**
+ * @brief 非阻塞地分配一个块：Slab 锁被占用时立即失败 (原子位图引擎从不阻塞，等价于 nvm_slab_alloc)
+ * @return 0 成功, -1 Slab 已满或锁被占用
+ */
+int nvm_slab_try_alloc(NvmSlab* self, uint32_t* out_block_idx);
+
 /**
  * @brief 归还一个块到 Slab
  * @param block_idx 块索引
  */
 void nvm_slab_free(NvmSlab* self, uint32_t block_idx);
 
+/**
+ * @brief 从其他 CPU 归还一个块
+ *
+ * 只获取远程锁并写入暂存区，不触碰持有者的锁与环形缓存；暂存区满时由调用者
+ * 获取持有者锁把整批块吸收回缓存。块在被吸收之前不会重新分配。
+ * 易失模式下块直接压入远程链表，从不获取持有者锁。
+ */
+void nvm_slab_free_remote(NvmSlab* self, uint32_t block_idx);
+
+/**
+ * @brief 从其他 CPU 批量归还同一 Slab 中的多个块
+ *
+ * 远程锁只获取一次，整批写入暂存区；暂存区装不下的部分与 nvm_slab_free_remote 相同，
+ * 由调用者获取一次持有者锁吸收暂存区后直接释放。
+ */
+void nvm_slab_free_remote_batch(NvmSlab* self, const uint32_t* block_idxs, uint32_t count);
+
+/**
+ * @brief 批量归还同一 Slab 中的多个块 (只获取一次锁)
+ * @param block_idxs 块索引数组
+ * @param count 块数量
+ */
+void nvm_slab_free_batch(NvmSlab* self, const uint32_t* block_idxs, uint32_t count);
+
 // ============================================================================
 //                          状态查询与恢复 API
 // ============================================================================
@@ -100,9 +255,32 @@ void nvm_slab_free(NvmSlab* self, uint32_t block_idx);
 /**
  * @brief 手动设置位图状态 (用于故障恢复)
  * 将指定索引的块标记为已占用
+ * @return 0 成功, -1 参数无效或易失模式 Slab
  */
 int nvm_slab_set_bitmap_at_idx(NvmSlab* self, uint32_t block_idx);
 
+/**
+ * @brief 检查刚分配到的块是否仍保持全零
+ *
+ * 预清零 Slab 中从未被释放过的块自创建以来没有交付给任何用户，内容必为零。
+ * 判断基于 dirty_watermark，偏保守：可能把干净块判为脏块，但不会反之。
+ * @note 仅对调用者当前持有的块有意义
+ */
+bool nvm_slab_block_is_zeroed(const NvmSlab* self, uint32_t block_idx);
+
+/**
+ * @brief 当前被用户持有的块数 (已分配数减去远程暂存区中的块数，乐观读取)
+ */
+uint32_t nvm_slab_used_blocks(const NvmSlab* self);
+
+/**
+ * @brief 复制被用户持有的块位图 (堆快照用)
+ * 短暂持有本 Slab 的两把锁复制位图，并去掉环形缓存与远程暂存区中的块。
+ * @param out 至少 (total_block_count + 7) / 8 字节
+ * @return 用户持有的块数；易失模式 Slab 没有位图，返回 -1 且不写 out
+ */
+int nvm_slab_copy_live_bitmap(NvmSlab* self, unsigned char* out);
+
 /**
  * @brief 检查 Slab 是否已满
  * @note 这是一个乐观检查 (Relaxed Read)，通常不加锁
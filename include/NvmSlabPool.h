@@ -0,0 +1,95 @@
+#ifndef NVM_SLAB_POOL_H
+#define NVM_SLAB_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "NvmSpaceManager.h"
+
+// ============================================================================
+//                          常量定义
+// ============================================================================
+
+// 预备池最大深度 (每个池最多持有的预清零 Slab 数)
+#define NVM_SLAB_POOL_MAX_DEPTH   16
+
+// 空间耗尽时后台线程的重试间隔 (毫秒)
+#define NVM_SLAB_POOL_RETRY_MS    100
+
+// 池行为标志
+#define NVM_SLAB_POOL_ZERO        0x01  // 使用非临时存储整体清零 (否则只预缺页)
+#define NVM_SLAB_POOL_ON_DEMAND   0x02  // 仅在 slab_pool_request 后补充，而非始终保持满深度
+
+// ============================================================================
+//                          类型定义
+// ============================================================================
+
+/**
+ * @brief 预备 Slab 池 (不透明句柄)
+ *
+ * 从空间管理器预先申请若干 Slab 大小的 NVM 区域，由后台线程准备好后放入池中：
+ * - 清零模式：使用非临时存储整体清零并持久化，使 calloc 密集型负载无需内联清零；
+ * - 预缺页模式：只触发写缺页建立页表，把首次访问的缺页延迟移出 nvm_malloc。
+ * 清零同样会触碰所有页，因此清零池取出的 Slab 也已完成预缺页。
+ *
+ * @note 线程安全：内部操作由互斥锁保护，后台线程通过条件变量唤醒。
+ */
+typedef struct NvmSlabPool NvmSlabPool;
+
+// ============================================================================
+//                          生命周期管理
+// ============================================================================
+
+/**
+ * @brief 创建预备池并启动后台线程
+ * @param manager 提供 NVM 空间的空间管理器 (生命周期须长于池)
+ * @param nvm_base_addr NVM 映射基地址 (用于计算 Slab 地址)
+ * @param depth 目标深度，超过 NVM_SLAB_POOL_MAX_DEPTH 时截断
+ * @param flags NVM_SLAB_POOL_* 组合
+ * @return 成功返回句柄，失败返回 NULL
+ */
+NvmSlabPool* slab_pool_create(FreeSpaceManager* manager, void* nvm_base_addr, uint32_t depth, uint32_t flags);
+
+/**
+ * @brief 停止后台线程并销毁池
+ * 池中尚未取走的 Slab 会归还给空间管理器。
+ */
+void slab_pool_destroy(NvmSlabPool* pool);
+
+// ============================================================================
+//                          核心操作 API
+// ============================================================================
+
+/**
+ * @brief 取出一个已准备好的 Slab 偏移量，并唤醒后台线程补充
+ * @param out_offset [输出] Slab 的 NVM 偏移量
+ * @return 0 成功, -1 池为空
+ */
+int slab_pool_take(NvmSlabPool* pool, uint64_t* out_offset);
+
+/**
+ * @brief 请求准备一个 Slab (按需模式)
+ * 未完成的请求与池中可用数之和不超过深度，多余的请求被忽略；可在热路径调用。
+ */
+void slab_pool_request(NvmSlabPool* pool);
+
+/**
+ * @brief 调整目标深度
+ * 调小时多余的 Slab 保留在池中直到被取走；调为 0 即停止补充。
+ */
+void slab_pool_set_depth(NvmSlabPool* pool, uint32_t depth);
+
+/**
+ * @brief 查询当前池中可用的 Slab 数量
+ */
+uint32_t slab_pool_available(NvmSlabPool* pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NVM_SLAB_POOL_H
@@ -0,0 +1,186 @@
+#ifndef NVM_SNAPSHOT_H
+#define NVM_SNAPSHOT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "NvmDefs.h"
+
+// ============================================================================
+//                          常量定义
+// ============================================================================
+
+/*
+ * 快照格式 (版本 1，多字节定长整数一律小端，varint 为 LEB128)：
+ *
+ *   文件头 (32B): magic "NVMSNAP\0" | u16 version | u16 header_size | u32 slab_size
+ *                | u64 timestamp_ns | u32 heap_count | u32 reserved
+ *   记录流，每条以 1 字节标签开头：
+ *     'H' 中心堆: u8 index | u8 numa_node + 1 | u64 range_offset | u64 range_size
+ *     'S' Slab  : u64 offset | u8 size_class | u8 flags | varint total | varint used
+ *                 | 游程...  (空闲、占用交替，以空闲开头，长度之和等于 total；
+ *                            第一个游程可为 0，易失模式 Slab 没有游程)
+ *     'E' 空闲段: u64 offset | varint size
+ *     'Z' 结束  : varint slab_count | varint extent_count
+ *
+ * 'S' 与 'E' 属于之前最近的 'H'。
+ */
+#define NVM_SNAPSHOT_MAGIC         "NVMSNAP"
+#define NVM_SNAPSHOT_VERSION       1
+#define NVM_SNAPSHOT_HEADER_SIZE   32
+
+// 快照中 Slab 的标志
+#define NVM_SNAPSHOT_SLAB_VOLATILE 0x01   // 易失模式 Slab，没有位图游程
+
+// 占用率低于该百分比 (且非空) 的 Slab 视为搁浅：少量存活块占住整个 Slab
+#define NVM_SNAPSHOT_STRANDED_PCT  10
+
+// 差异报告中保留的新增搁浅 Slab 偏移样本数
+#define NVM_SNAPSHOT_SAMPLE        16
+
+// ============================================================================
+//                          类型定义
+// ============================================================================
+
+/**
+ * @brief 快照中的一个 Slab
+ */
+typedef struct NvmSnapshotSlab {
+    uint64_t offset;           // NVM 偏移
+    uint8_t  heap;             // 所属中心堆下标
+    uint8_t  size_class;
+    uint8_t  flags;            // NVM_SNAPSHOT_SLAB_*
+    uint32_t total;            // 总块数
+    uint32_t used;             // 用户持有的块数
+    uint32_t live_runs;        // 连续占用游程数 (碎片程度；易失模式为 0)
+} NvmSnapshotSlab;
+
+/**
+ * @brief 快照中的一个空闲段
+ */
+typedef struct NvmSnapshotExtent {
+    uint64_t offset;
+    uint64_t size;
+    uint8_t  heap;
+} NvmSnapshotExtent;
+
+/**
+ * @brief 快照中的中心堆
+ */
+typedef struct NvmSnapshotHeap {
+    int32_t  numa_node;        // -1 表示非 NUMA 模式
+    uint64_t range_offset;
+    uint64_t range_size;
+} NvmSnapshotHeap;
+
+/**
+ * @brief 解析后的快照 (Slab 与空闲段均按偏移升序)
+ */
+typedef struct NvmSnapshot {
+    uint16_t           version;
+    uint32_t           slab_size;
+    uint64_t           timestamp_ns;
+    uint32_t           heap_count;
+    NvmSnapshotHeap    heaps[MAX_NUMA_NODES];
+    NvmSnapshotSlab*   slabs;
+    uint64_t           slab_count;
+    NvmSnapshotExtent* extents;
+    uint64_t           extent_count;
+} NvmSnapshot;
+
+/**
+ * @brief 两份快照的差异
+ *
+ * 下标 0 为旧快照，1 为新快照。Slab 按偏移配对：
+ * 只在新快照中出现为新增，只在旧快照中出现为移除，两边尺寸类别不同为改类。
+ * 新增搁浅指两边同类别、旧快照中未搁浅而新快照中搁浅的 Slab。
+ */
+typedef struct NvmSnapshotDiff {
+    uint64_t class_slabs[2][SC_COUNT];
+    uint64_t class_blocks[2][SC_COUNT];
+    uint64_t stranded[2];                       // 各快照中的搁浅 Slab 数
+
+    uint64_t slabs_kept;                        // 两边同偏移同类别
+    uint64_t slabs_added;
+    uint64_t slabs_removed;
+    uint64_t slabs_reclassed;
+
+    uint64_t newly_stranded;
+    uint64_t stranded_sample[NVM_SNAPSHOT_SAMPLE];   // 前若干个新增搁浅 Slab 的偏移
+
+    uint64_t free_bytes[2];
+    uint64_t free_extents[2];
+    uint64_t largest_extent[2];                 // 最大空闲段 (字节)
+} NvmSnapshotDiff;
+
+/**
+ * @brief 快照写入器 (不透明句柄，分配器内部使用)
+ */
+typedef struct NvmSnapshotWriter NvmSnapshotWriter;
+
+// ============================================================================
+//                          写入 API
+// ============================================================================
+
+/**
+ * @brief 创建写入器并写出文件头
+ * 记录先写入 DRAM 缓冲区，满时整块 write()，不持有任何分配器锁。
+ * @return 成功返回句柄，失败返回 NULL
+ */
+NvmSnapshotWriter* nvm_snapshot_writer_create(int fd, uint32_t heap_count);
+
+void nvm_snapshot_write_heap(NvmSnapshotWriter* writer, uint32_t index, int numa_node,
+                             uint64_t range_offset, uint64_t range_size);
+
+/**
+ * @brief 写出一个 Slab
+ * @param live_bitmap 用户持有块的位图 (nvm_slab_copy_live_bitmap)，NULL 表示易失模式 Slab
+ */
+void nvm_snapshot_write_slab(NvmSnapshotWriter* writer, uint64_t offset, SizeClassID sc_id,
+                             uint32_t total, uint32_t used, const unsigned char* live_bitmap);
+
+void nvm_snapshot_write_extent(NvmSnapshotWriter* writer, uint64_t offset, uint64_t size);
+
+/**
+ * @brief 写出结束记录、刷新缓冲区并销毁写入器
+ * @return 0 成功, -1 期间任一次写入失败
+ */
+int nvm_snapshot_writer_finish(NvmSnapshotWriter* writer);
+
+// ============================================================================
+//                          读取与比较 API
+// ============================================================================
+
+/**
+ * @brief 从文件描述符读取并解析一份完整快照
+ * 校验文件头、记录边界与游程总长；Slab 与空闲段按偏移排序。
+ * @return 0 成功, -1 读取失败或格式无效 (out 不需要释放)
+ */
+int nvm_snapshot_load(int fd, NvmSnapshot* out);
+
+/**
+ * @brief 释放 nvm_snapshot_load 分配的数组
+ */
+void nvm_snapshot_release(NvmSnapshot* snap);
+
+/**
+ * @brief Slab 是否搁浅 (非空且占用率低于 NVM_SNAPSHOT_STRANDED_PCT)
+ */
+bool nvm_snapshot_slab_stranded(const NvmSnapshotSlab* slab);
+
+/**
+ * @brief 比较两份快照
+ * @param before 旧快照，NULL 视为空快照 (此时只汇总 after)
+ */
+void nvm_snapshot_diff(const NvmSnapshot* before, const NvmSnapshot* after, NvmSnapshotDiff* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NVM_SNAPSHOT_H
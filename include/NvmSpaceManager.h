@@ -16,12 +16,19 @@ extern "C" {
  * @brief NVM 空闲空间管理器 (不透明句柄)
  * 
  * 负责管理大块连续的 NVM 物理空间。
- * 内部维护一个按地址排序的双向链表，支持合并与分割。
+ * 地址空间按固定条带轮流划分给若干分片，每个分片维护按地址排序的双向链表
+ * (支持合并与分割) 和独立的互斥锁。分配优先使用当前 CPU 的归属分片，
+ * 耗尽时从其他分片窃取；释放总是回到地址所属分片。小空间只使用一个分片。
  * 
- * @note 线程安全：内部操作由互斥锁 (Mutex) 保护。
+ * @note 线程安全：各分片由独立的互斥锁 (Mutex) 保护。
  */
 typedef struct FreeSpaceManager FreeSpaceManager;
 
+/**
+ * @brief 空闲段遍历回调
+ */
+typedef void (*space_extent_fn)(uint64_t offset, uint64_t size, void* ctx);
+
 // ============================================================================
 //                          生命周期管理
 // ============================================================================
@@ -58,6 +65,15 @@ uint64_t space_manager_alloc_slab(FreeSpaceManager* manager);
  */
 void space_manager_free_slab(FreeSpaceManager* manager, uint64_t offset_to_free);
 
+/**
+ * @brief 向管理器加入一段新的空闲空间 (运行时扩容)
+ * 与相邻空闲段自动合并；偏移不要求与已有空间连续。
+ * @param offset 起始偏移 (按 NVM_SLAB_SIZE 对齐)
+ * @param size 大小 (字节，至少一个 Slab)
+ * @return 0 成功, -1 失败 (参数无效或与空闲空间重叠)
+ */
+int space_manager_add_range(FreeSpaceManager* manager, uint64_t offset, uint64_t size);
+
 /**
  * @brief [故障恢复] 在指定偏移处强制占位
  * 用于在系统重启后，根据持久化数据恢复已分配的块状态。
@@ -65,6 +81,19 @@ void space_manager_free_slab(FreeSpaceManager* manager, uint64_t offset_to_free)
  */
 int space_manager_alloc_at_offset(FreeSpaceManager* manager, uint64_t offset);
 
+/**
+ * @brief 当前空闲字节数 (各分片之和，并发修改时为近似值)
+ */
+uint64_t space_manager_free_bytes(FreeSpaceManager* manager);
+
+/**
+ * @brief 依次回调当前的空闲段 (逐分片，分片内按地址升序)
+ * 每次在分片锁下复制一小批段，回调在锁外执行，不会因回调阻塞分配。
+ * 并发修改时结果是近似的：批次之间被分割或合并的段可能只出现一部分。
+ * @return 回调的段数
+ */
+uint64_t space_manager_for_each_extent(FreeSpaceManager* manager, space_extent_fn fn, void* ctx);
+
 #ifdef __cplusplus
 }
 #endif
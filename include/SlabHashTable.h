@@ -18,10 +18,16 @@ extern "C" {
  * 映射关系: NVM Offset (Key) -> Slab Metadata Pointer (Value)
  * 用于在 free() 时根据 NVM 指针快速找到对应的 Slab 元数据。
  * 
- * @note 线程安全：内部操作由读写锁 (RWLock) 保护。
+ * @note 线程安全：插入/移除由读写锁串行化；查找不加锁，
+ *       被移除的节点经纪元回收 (NvmEpoch.h) 延迟释放。
  */
 typedef struct SlabHashTable SlabHashTable;
 
+/**
+ * @brief 映射遍历回调
+ */
+typedef void (*slab_visit_fn)(uint64_t nvm_offset, NvmSlab* slab, void* ctx);
+
 // ============================================================================
 //                          生命周期管理
 // ============================================================================
@@ -49,8 +55,9 @@ void slab_hashtable_destroy(SlabHashTable* table);
 int slab_hashtable_insert(SlabHashTable* table, uint64_t nvm_offset, NvmSlab* slab_ptr);
 
 /**
- * @brief 查找映射
+ * @brief 查找映射 (无锁)
  * @return 成功返回 Slab 指针，未找到返回 NULL
+ * @note 返回的 Slab 描述符只在调用方自身的纪元临界区内保证有效
  */
 NvmSlab* slab_hashtable_lookup(SlabHashTable* table, uint64_t nvm_offset);
 
@@ -60,6 +67,15 @@ NvmSlab* slab_hashtable_lookup(SlabHashTable* table, uint64_t nvm_offset);
  */
 NvmSlab* slab_hashtable_remove(SlabHashTable* table, uint64_t nvm_offset);
 
+/**
+ * @brief 无锁遍历全部映射
+ * 与查找相同，逐桶在纪元临界区内遍历，不阻塞插入与移除；
+ * 遍历期间插入或移除的映射可能出现也可能不出现。
+ * @note 回调收到的 Slab 描述符只在回调返回前保证有效
+ * @return 回调的映射数
+ */
+uint32_t slab_hashtable_for_each(SlabHashTable* table, slab_visit_fn fn, void* ctx);
+
 
 // ============================================================================
 //                          调试工具 API
@@ -1,4 +1,11 @@
 #include "NvmAllocator.h"
+#include "NvmPersist.h"
+#include "NvmSlabPool.h"
+#include "NvmLog.h"
+#include "NvmEpoch.h"
+#include "NvmDeferredFree.h"
+#include "NvmRemoteBatch.h"
+#include "NvmSnapshot.h"
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
@@ -8,50 +15,289 @@
 //                          核心数据结构
 // ============================================================================
 
-// 中心堆：全局共享，组件内部自带锁保护
+// 中心堆：每个 NUMA 节点一个，管理该节点的 NVM 区间，组件内部自带锁保护
 typedef struct NvmCentralHeap {
     void*             nvm_base_addr;
+    uint64_t          range_offset;      // 本节点区间起点 (相对 nvm_base_addr)
+    uint64_t          range_size;        // 本节点区间大小
+    int               numa_node;         // 所属 NUMA 节点 (-1 表示非 NUMA 模式)
     FreeSpaceManager* space_manager;
     SlabHashTable*    slab_lookup_table;
+    NvmSlabPool*      zero_pool;         // 预清零 Slab 池 (未启用时为 NULL)
+    NvmSlabPool*      prefault_pool;     // 按需预缺页 Slab 池 (未启用时为 NULL)
 } NvmCentralHeap;
 
-// CPU 堆：每个 CPU 独享，无锁访问，填充以避免伪共享
+// 区域表项：一段连续的 NVM 偏移区间及其所属中心堆。
+// 偏移一律相对 nvm_base_addr；运行时扩展的区域可能位于基址之下，此时按模 2^64 回绕，
+// base + offset 仍得到正确地址，Slab 对齐关系也保持不变。
+typedef struct NvmRegion {
+    uint64_t offset;
+    uint64_t size;
+    int      heap;                       // 所属中心堆下标 (central_heaps)
+} NvmRegion;
+
+// CPU 堆：每个 CPU 一个，对齐以避免伪共享。
+// 链表锁几乎只被所属 CPU 获取 (无竞争)，drain/trim 借它安全地摘取其他 CPU 的 Slab
 typedef struct NvmCpuHeap {
-    NvmSlab* slab_lists[SC_COUNT];
-    char     _padding[CACHE_LINE_SIZE - ((sizeof(NvmSlab*) * SC_COUNT) % CACHE_LINE_SIZE)];
+    nvm_spinlock_t lock;
+    NvmSlab*       slab_lists[SC_COUNT];
+    int            home_heap;            // 本地中心堆下标 (central_heaps)
+    uint32_t       allocs_since_trim;    // 距上次检查过剩 Slab 的分配次数
+    uint64_t       class_allocs[SC_COUNT]; // 各尺寸类别累计分配次数 (持锁递增，预备线程无锁读取)
 } __attribute__((aligned(CACHE_LINE_SIZE))) NvmCpuHeap;
 
+// 部分空闲 Slab 仓库：每个尺寸类别一个。CPU 堆把过剩的未满 Slab 捐到这里，
+// 本地 Slab 全满时先从这里窃取，再向中心堆申请新 Slab。
+// 仓库中的 Slab 无人分配，只会因 (远程) 释放变得更空，因此取出时必然未满。
+typedef struct NvmSlabDepot {
+    nvm_spinlock_t lock;
+    NvmSlab*       head;                 // 通过 next_in_chain 链接
+    uint32_t       count;
+} NvmSlabDepot;
+
+// Slab 预备线程：按各 CPU 堆每个尺寸类别的消耗速率，提前挂入就绪 Slab，
+// 使分配路径几乎不必同步创建 Slab。速率与快照只由工作线程访问
+typedef struct NvmProvisioner {
+    uint32_t     slabs_ahead;                        // 目标余量 (Slab 数)；0 = 关闭
+    uint32_t     interval_ms;                        // 采样间隔
+    bool         running;
+    bool         stopping;
+    nvm_mutex_t  lock;
+    nvm_cond_t   cond;
+    nvm_thread_t worker;
+    uint64_t     last_allocs[MAX_CPUS][SC_COUNT];    // 上次采样时的 class_allocs
+    uint64_t     rate[MAX_CPUS][SC_COUNT];           // 每个采样周期的分配数 (指数滑动平均)
+    uint64_t     provisioned;                        // 累计预备的 Slab 数
+} NvmProvisioner;
+
 // 顶层分配器结构
 typedef struct NvmAllocator {
-    NvmCentralHeap central_heap;
-    NvmCpuHeap     cpu_heaps[MAX_CPUS];
+    NvmCentralHeap   central_heaps[MAX_NUMA_NODES];
+    int              central_heap_count;
+    NvmCpuHeap       cpu_heaps[MAX_CPUS];
+    NvmSlabDepot     depots[SC_COUNT];
+    uint32_t         heap_count;       // 使用中的 CPU 堆数，CPU 编号按取模映射 (NvmAllocatorConfig)
+    uint32_t         depot_keep;       // 每个 CPU 堆每个尺寸类别保留的未满 Slab 数
+    uint32_t         depot_trim_interval; // CPU 堆每分配这么多次检查一次过剩 Slab
+    NvmPlacementMode placement_mode;   // 新建 Slab 采用的块放置策略
+    uint32_t         prefault_pct;     // 当前 Slab 填充率达到该百分比时预缺页下一个 (0 = 关闭)
+    uint32_t         zero_pool_depth;  // 最近一次设置的预清零池深度 (供 nvm_ctl 读取)
+    uint32_t         deferred_reclaim_ms; // 最近一次设置的延迟释放后台线程间隔 (0 = 停止)
+    NvmLogRegion*    log;              // 日志式元数据持久化 (未启用时为 NULL)
+    bool             volatile_mode;    // 易失模式：侵入式空闲链表，无持久化写入
+    bool             atomic_mode;      // 原子位图 Slab 引擎 (NVM_CREATE_ATOMIC)
+    NvmRegion        regions[NVM_MAX_REGIONS];
+    uint32_t         region_count;     // 只增不减，发布新表项时 release 写入
+    nvm_mutex_t      extend_lock;      // 串行化 nvm_allocator_extend
+    NvmDeferredFree* deferred;         // nvm_free_deferred 的每线程环形队列
+    NvmRemoteBatcher* remote;          // 远程释放的每线程分组暂存
+    nvm_replenish_fn replenish_fn;     // nvm_try_malloc 的补充请求回调
+    void*            replenish_arg;
+    uint64_t         slow_path_hits;   // 分配路径上同步创建 Slab 的次数
+    NvmProvisioner   provisioner;
 } NvmAllocator;
 
+// 快照遍历上下文
+typedef struct SnapshotContext {
+    NvmSnapshotWriter* writer;
+    unsigned char*     bitmap;           // 单个 Slab 占用位图的复制缓冲区
+} SnapshotContext;
+
+// 各尺寸类别的 Slab 统计 (nvm_ctl stats.class.*)
+typedef struct ClassStatsContext {
+    uint64_t slabs[SC_COUNT];
+    uint64_t active[SC_COUNT];           // 用户持有的块数
+    uint64_t capacity[SC_COUNT];         // 总块数
+} ClassStatsContext;
+
+// nvm_ctl 的值类型；动作节点每次调用都执行，旧值为处理的数量 (uint64_t)
+typedef enum {
+    CTL_U32,
+    CTL_U64,
+    CTL_STR,
+    CTL_ACTION
+} CtlType;
+
+typedef int (*ctl_get_fn)(NvmAllocator* allocator, const uint32_t* index, void* out);
+typedef int (*ctl_set_fn)(NvmAllocator* allocator, const uint32_t* index, const void* in);
+
+// nvm_ctl 名称表项：pattern 中的 '#' 匹配一个十进制下标；set 为 NULL 表示只读
+typedef struct CtlNode {
+    const char* pattern;
+    CtlType     type;
+    ctl_get_fn  get;
+    ctl_set_fn  set;
+} CtlNode;
+
 static struct NvmAllocator* global_nvm_allocator = NULL;
 
+// CPU 编号到 CPU 堆下标。堆数不少于 CPU 数时是恒等映射，快速路径只多一次可预测的比较
+static inline int heap_index_of_cpu(const NvmAllocator* allocator, int cpu) {
+    return NVM_LIKELY(cpu < (int)allocator->heap_count) ? cpu : cpu % (int)allocator->heap_count;
+}
+
+// 每个中心堆最多预缺页的 Slab 数 (按需补充)
+#define NVM_PREFAULT_POOL_DEPTH 4
+
+// 预备线程的默认采样间隔与余量上限
+#define NVM_PROVISION_DEFAULT_INTERVAL_MS 10
+#define NVM_PROVISION_MAX_AHEAD           8
+
+// nvm_ctl 名称中数字下标的最大个数
+#define NVM_CTL_MAX_INDEX 2
+
+// 快照时复制单个 Slab 占用位图的缓冲区大小 (按最小块 8B 计)
+#define NVM_SNAPSHOT_BITMAP_BYTES (NVM_SLAB_SIZE / 8 / 8)
+
+// 除固定余量外，再按速率预留这么多个采样周期的消耗
+#define NVM_PROVISION_HORIZON_TICKS       2
+
+// 每个 (CPU, 尺寸类别) 每个周期最多挂入的 Slab 数，避免突发速率一次性占用大量空间
+#define NVM_PROVISION_MAX_PER_TICK        4
+
 // ============================================================================
 //                          内部函数前向声明
 // ============================================================================
 
 static SizeClassID   map_size_to_sc_id(size_t size);
 static void          remove_slab_from_list(NvmSlab** list_head, NvmSlab* slab_to_remove);
-static NvmAllocator* nvm_allocator_create_impl(void* nvm_base_addr, uint64_t nvm_size_bytes);
+static NvmCentralHeap* find_central_heap(NvmAllocator* allocator, uint64_t nvm_offset);
+static NvmSlab*       create_slab_from_central(NvmAllocator* allocator, NvmCpuHeap* cpu_heap, SizeClassID sc_id);
+static NvmSlab*       create_persistent_slab(const NvmAllocator* allocator, SizeClassID sc_id, uint64_t offset, int numa_node);
+static NvmAllocator*  nvm_allocator_create_impl(void* nvm_base_addr, const NvmNumaRange* ranges, int range_count,
+                                               const NvmAllocatorConfig* config);
+static int           resolve_config(const NvmAllocatorConfig* config, NvmAllocatorConfig* out);
 static void          nvm_allocator_destroy_impl(NvmAllocator* allocator);
 static void*         nvm_malloc_impl(NvmAllocator* allocator, size_t size);
+static void*         nvm_malloc_block(NvmAllocator* allocator, size_t size, NvmSlab** out_slab, uint32_t* out_block_idx);
+static void*         nvm_try_malloc_impl(NvmAllocator* allocator, size_t size, NvmTryStatus* out_status);
+static int           replenish_cpu_heap(NvmAllocator* allocator, int cpu, SizeClassID sc_id);
+static NvmSlab*      obtain_slab_for_cpu(NvmAllocator* allocator, int cpu, SizeClassID sc_id);
+static void          link_slab_locked(NvmCpuHeap* cpu_heap, int heap_id, SizeClassID sc_id, NvmSlab* slab,
+                                      bool at_tail);
+static int           set_provisioning_impl(NvmAllocator* allocator, uint32_t slabs_ahead, uint32_t interval_ms);
+static void*         provisioner_main(void* arg);
+static void          provision_tick(NvmAllocator* allocator, uint32_t slabs_ahead);
+static uint64_t      local_free_blocks(NvmCpuHeap* cpu_heap, SizeClassID sc_id);
+static NvmSlab*      lookup_slab(NvmAllocator* allocator, void* nvm_ptr, uint64_t* out_offset);
+static void*         nvm_calloc_impl(NvmAllocator* allocator, size_t nmemb, size_t size);
+static void*         nvm_realloc_impl(NvmAllocator* allocator, void* nvm_ptr, size_t size);
+static int           nvm_allocator_set_zero_pool_depth_impl(NvmAllocator* allocator, uint32_t depth);
+static int           nvm_allocator_set_prefault_impl(NvmAllocator* allocator, uint32_t threshold_pct);
+static void          maybe_request_prefault(NvmAllocator* allocator, NvmCpuHeap* cpu_heap, NvmSlab* slab);
+static int           rebuild_from_log(NvmAllocator* allocator);
+static int           nvm_allocator_extend_impl(NvmAllocator* allocator, void* addr, uint64_t size);
+static void          donate_partial_slabs(NvmAllocator* allocator, NvmCpuHeap* cpu_heap, uint32_t keep);
+static NvmSlab*      depot_steal(NvmSlabDepot* depot);
+static uint32_t      unlink_empty_slabs(NvmSlab** list_head, NvmSlab** empty_out);
+static uint32_t      release_empty_slabs(NvmAllocator* allocator, NvmSlab* list);
+static int           drain_cpu_heap(NvmAllocator* allocator, int cpu);
+static int           trim_impl(NvmAllocator* allocator);
 static void          nvm_free_impl(NvmAllocator* allocator, void* nvm_ptr);
+static int           compare_ptrs(const void* a, const void* b);
+static void          deferred_free_batch(void* ctx, void** ptrs, uint32_t count);
 static int           nvm_allocator_restore_allocation_impl(NvmAllocator* allocator, void* nvm_ptr, size_t size);
+static int           heap_snapshot_impl(NvmAllocator* allocator, int fd);
+static void          snapshot_visit_slab(uint64_t nvm_offset, NvmSlab* slab, void* ctx);
+static void          snapshot_visit_extent(uint64_t offset, uint64_t size, void* ctx);
+static const CtlNode* ctl_lookup(const char* name, uint32_t* index);
+static bool          ctl_match(const char* pattern, const char* name, uint32_t* index);
+static int           ctl_dispatch(NvmAllocator* allocator, const char* name, const CtlNode* node,
+                                  const uint32_t* index, void* oldp, size_t* oldlenp,
+                                  const void* newp, size_t newlen);
 
 // ============================================================================
 //                          公共 API 实现
 // ============================================================================
 
 int nvm_allocator_create(void* nvm_base_addr, uint64_t nvm_size_bytes) {
+    return nvm_allocator_create_config(nvm_base_addr, nvm_size_bytes, 0, NULL);
+}
+
+int nvm_allocator_create_ex(void* nvm_base_addr, uint64_t nvm_size_bytes, uint32_t flags) {
+    return nvm_allocator_create_config(nvm_base_addr, nvm_size_bytes, flags, NULL);
+}
+
+int nvm_allocator_create_config(void* nvm_base_addr, uint64_t nvm_size_bytes, uint32_t flags,
+                                const NvmAllocatorConfig* config) {
     if (global_nvm_allocator != NULL) {
         LOG_ERR("Allocator already initialized.");
         return -1;
     }
-    
-    global_nvm_allocator = nvm_allocator_create_impl(nvm_base_addr, nvm_size_bytes);
+    if ((flags & NVM_CREATE_VOLATILE) && (flags & (NVM_CREATE_LOG | NVM_CREATE_RECOVER))) {
+        LOG_ERR("Volatile mode cannot be combined with log metadata.");
+        return -1;
+    }
+    if ((flags & NVM_CREATE_RECOVER) && !(flags & NVM_CREATE_LOG)) {
+        // 没有日志可供重建，格式化一个新堆会覆盖池中可能存活的数据
+        LOG_ERR("Recover requires log metadata.");
+        return -1;
+    }
+    if ((flags & NVM_CREATE_VOLATILE) && (flags & NVM_CREATE_ATOMIC)) {
+        LOG_ERR("Volatile mode cannot be combined with the atomic slab engine.");
+        return -1;
+    }
+    NvmAllocatorConfig resolved;
+    if (resolve_config(config, &resolved) != 0) return -1;
+
+    if (!(flags & NVM_CREATE_LOG)) {
+        // 非 NUMA 模式：整个区间由单个中心堆管理，元数据不绑定节点
+        NvmNumaRange range = { NVM_START_OFFSET, nvm_size_bytes, -1 };
+        NvmAllocator* allocator = nvm_allocator_create_impl(nvm_base_addr, &range, 1, &resolved);
+        if (!allocator) return -1;
+        allocator->volatile_mode = (flags & NVM_CREATE_VOLATILE) != 0;
+        allocator->atomic_mode = (flags & NVM_CREATE_ATOMIC) != 0;
+        global_nvm_allocator = allocator;
+        return 0;
+    }
+    if (!nvm_base_addr) return -1;
+
+    // 区间前部保留给日志元数据，其余作为数据区
+    uint64_t meta_size = nvm_log_region_size(nvm_size_bytes);
+    if (meta_size + NVM_SLAB_SIZE > nvm_size_bytes) {
+        LOG_ERR("NVM region too small for log metadata.");
+        return -1;
+    }
+    uint64_t data_size = NVM_ALIGN_DOWN(nvm_size_bytes - meta_size, (uint64_t)NVM_SLAB_SIZE);
+
+    NvmNumaRange range = { meta_size, data_size, -1 };
+    NvmAllocator* allocator = nvm_allocator_create_impl(nvm_base_addr, &range, 1, &resolved);
+    if (!allocator) return -1;
+    allocator->atomic_mode = (flags & NVM_CREATE_ATOMIC) != 0;
+
+    allocator->log = nvm_log_region_create(nvm_base_addr, meta_size, data_size,
+                                           (flags & NVM_CREATE_RECOVER) != 0, NVM_LOG_CHECKPOINT_MS);
+    if (!allocator->log || ((flags & NVM_CREATE_RECOVER) && rebuild_from_log(allocator) != 0)) {
+        LOG_ERR("Failed to open log metadata region.");
+        nvm_allocator_destroy_impl(allocator);
+        return -1;
+    }
+
+    global_nvm_allocator = allocator;
+    return 0;
+}
+
+int nvm_allocator_checkpoint(void) {
+    if (global_nvm_allocator == NULL) {
+        LOG_ERR("Allocator not initialized.");
+        return -1;
+    }
+    if (!global_nvm_allocator->log) return -1;
+
+    nvm_log_checkpoint(global_nvm_allocator->log);
+    return 0;
+}
+
+int nvm_allocator_create_numa(void* nvm_base_addr, const NvmNumaRange* ranges, int range_count) {
+    if (global_nvm_allocator != NULL) {
+        LOG_ERR("Allocator already initialized.");
+        return -1;
+    }
+
+    NvmAllocatorConfig resolved;
+    if (resolve_config(NULL, &resolved) != 0) return -1;
+
+    global_nvm_allocator = nvm_allocator_create_impl(nvm_base_addr, ranges, range_count, &resolved);
     return (global_nvm_allocator == NULL) ? -1 : 0;
 }
 
@@ -78,6 +324,202 @@ void nvm_free(void* nvm_ptr) {
     nvm_free_impl(global_nvm_allocator, nvm_ptr);
 }
 
+void* nvm_try_malloc(size_t size, NvmTryStatus* out_status) {
+    if (global_nvm_allocator == NULL) {
+        if (out_status) *out_status = NVM_TRY_UNINITIALIZED;
+        return NULL;
+    }
+    return nvm_try_malloc_impl(global_nvm_allocator, size, out_status);
+}
+
+void nvm_try_malloc_set_replenish(nvm_replenish_fn fn, void* arg) {
+    if (global_nvm_allocator == NULL) {
+        LOG_ERR("Allocator not initialized.");
+        return;
+    }
+    // 回调与参数分别发布：切换回调期间的并发请求可能拿到新旧混合的一对，由调用方避免
+    __atomic_store_n(&global_nvm_allocator->replenish_arg, arg, __ATOMIC_RELAXED);
+    __atomic_store_n(&global_nvm_allocator->replenish_fn, fn, __ATOMIC_RELEASE);
+}
+
+int nvm_cpu_heap_replenish(int cpu, size_t size) {
+    if (global_nvm_allocator == NULL) {
+        LOG_ERR("Allocator not initialized.");
+        return -1;
+    }
+    SizeClassID sc_id = map_size_to_sc_id(size);
+    if (cpu < 0 || cpu >= MAX_CPUS || size == 0 || sc_id == SC_COUNT) return -1;
+    return replenish_cpu_heap(global_nvm_allocator, heap_index_of_cpu(global_nvm_allocator, cpu), sc_id);
+}
+
+int nvm_free_deferred(void* nvm_ptr) {
+    if (global_nvm_allocator == NULL) {
+        LOG_ERR("Allocator not initialized.");
+        return -1;
+    }
+    if (!nvm_ptr) return 0;
+    return deferred_free_push(global_nvm_allocator->deferred, nvm_ptr);
+}
+
+void nvm_free_deferred_set_policy(NvmDeferFullPolicy policy) {
+    deferred_free_set_policy(policy);
+}
+
+int nvm_free_deferred_flush(void) {
+    if (global_nvm_allocator == NULL) {
+        LOG_ERR("Allocator not initialized.");
+        return -1;
+    }
+    return (int)deferred_free_flush_local(global_nvm_allocator->deferred);
+}
+
+int nvm_free_remote_flush(void) {
+    if (global_nvm_allocator == NULL) {
+        LOG_ERR("Allocator not initialized.");
+        return -1;
+    }
+    return (int)remote_batch_flush_local(global_nvm_allocator->remote);
+}
+
+int nvm_allocator_set_deferred_reclaim(uint32_t interval_ms) {
+    if (global_nvm_allocator == NULL) {
+        LOG_ERR("Allocator not initialized.");
+        return -1;
+    }
+    if (deferred_free_set_reclaimer(global_nvm_allocator->deferred, interval_ms) != 0) return -1;
+    __atomic_store_n(&global_nvm_allocator->deferred_reclaim_ms, interval_ms, __ATOMIC_RELAXED);
+    return 0;
+}
+
+int nvm_allocator_set_provisioning(uint32_t slabs_ahead, uint32_t interval_ms) {
+    if (global_nvm_allocator == NULL) {
+        LOG_ERR("Allocator not initialized.");
+        return -1;
+    }
+    if (slabs_ahead > NVM_PROVISION_MAX_AHEAD) {
+        LOG_ERR("Provisioning ahead count too large: %u", slabs_ahead);
+        return -1;
+    }
+    return set_provisioning_impl(global_nvm_allocator, slabs_ahead, interval_ms);
+}
+
+void* nvm_calloc(size_t nmemb, size_t size) {
+    if (global_nvm_allocator == NULL) {
+        LOG_ERR("Allocator not initialized.");
+        return NULL;
+    }
+    return nvm_calloc_impl(global_nvm_allocator, nmemb, size);
+}
+
+void* nvm_realloc(void* nvm_ptr, size_t size) {
+    if (global_nvm_allocator == NULL) {
+        LOG_ERR("Allocator not initialized.");
+        return NULL;
+    }
+    return nvm_realloc_impl(global_nvm_allocator, nvm_ptr, size);
+}
+
+int nvm_allocator_set_zero_pool_depth(uint32_t depth) {
+    if (global_nvm_allocator == NULL) {
+        LOG_ERR("Allocator not initialized.");
+        return -1;
+    }
+    if (nvm_allocator_set_zero_pool_depth_impl(global_nvm_allocator, depth) != 0) return -1;
+    __atomic_store_n(&global_nvm_allocator->zero_pool_depth, depth, __ATOMIC_RELAXED);
+    return 0;
+}
+
+int nvm_allocator_set_prefault(uint32_t threshold_pct) {
+    if (global_nvm_allocator == NULL) {
+        LOG_ERR("Allocator not initialized.");
+        return -1;
+    }
+    if (threshold_pct > 100) {
+        LOG_ERR("Invalid prefault threshold: %u%%", threshold_pct);
+        return -1;
+    }
+    return nvm_allocator_set_prefault_impl(global_nvm_allocator, threshold_pct);
+}
+
+int nvm_allocator_set_placement_mode(NvmPlacementMode mode) {
+    if (global_nvm_allocator == NULL) {
+        LOG_ERR("Allocator not initialized.");
+        return -1;
+    }
+    if (mode != NVM_PLACEMENT_DEFAULT && mode != NVM_PLACEMENT_MEDIA_LINE) {
+        LOG_ERR("Invalid placement mode: %d", (int)mode);
+        return -1;
+    }
+    __atomic_store_n(&global_nvm_allocator->placement_mode, mode, __ATOMIC_RELAXED);
+    return 0;
+}
+
+int nvm_allocator_extend(void* addr, uint64_t size) {
+    if (global_nvm_allocator == NULL) {
+        LOG_ERR("Allocator not initialized.");
+        return -1;
+    }
+    return nvm_allocator_extend_impl(global_nvm_allocator, addr, size);
+}
+
+int nvm_allocator_donate_partial(void) {
+    if (global_nvm_allocator == NULL) {
+        LOG_ERR("Allocator not initialized.");
+        return -1;
+    }
+    NvmCpuHeap* cpu_heap =
+        &global_nvm_allocator->cpu_heaps[heap_index_of_cpu(global_nvm_allocator, NVM_GET_CURRENT_CPU_ID())];
+    NVM_SPINLOCK_ACQUIRE(&cpu_heap->lock);
+    donate_partial_slabs(global_nvm_allocator, cpu_heap, 0);
+    NVM_SPINLOCK_RELEASE(&cpu_heap->lock);
+    return 0;
+}
+
+int nvm_cpu_heap_drain(int cpu) {
+    if (global_nvm_allocator == NULL) {
+        LOG_ERR("Allocator not initialized.");
+        return -1;
+    }
+    if (cpu < 0 || cpu >= MAX_CPUS) {
+        LOG_ERR("Invalid CPU id: %d", cpu);
+        return -1;
+    }
+    return drain_cpu_heap(global_nvm_allocator, heap_index_of_cpu(global_nvm_allocator, cpu));
+}
+
+int nvm_allocator_trim(void) {
+    if (global_nvm_allocator == NULL) {
+        LOG_ERR("Allocator not initialized.");
+        return -1;
+    }
+    return trim_impl(global_nvm_allocator);
+}
+
+int nvm_allocator_on_affinity_change(void) {
+    if (global_nvm_allocator == NULL) {
+        LOG_ERR("Allocator not initialized.");
+        return -1;
+    }
+
+    uint8_t allowed[MAX_CPUS];
+    if (nvm_get_allowed_cpus(allowed) != 0) {
+        LOG_ERR("Failed to query CPU affinity.");
+        return -1;
+    }
+
+    // 多个 CPU 共用一个堆时，只要有一个仍被允许，该堆就保留
+    uint8_t in_use[MAX_CPUS] = { 0 };
+    for (int cpu = 0; cpu < MAX_CPUS; ++cpu) {
+        if (allowed[cpu]) in_use[heap_index_of_cpu(global_nvm_allocator, cpu)] = 1;
+    }
+
+    int released = 0;
+    for (int heap = 0; heap < (int)global_nvm_allocator->heap_count; ++heap) {
+        if (!in_use[heap]) released += drain_cpu_heap(global_nvm_allocator, heap);
+    }
+    return released + trim_impl(global_nvm_allocator);
+}
+
 int nvm_allocator_restore_allocation(void* nvm_ptr, size_t size) {
     if (global_nvm_allocator == NULL) {
         LOG_ERR("Allocator not initialized.");
@@ -122,147 +564,944 @@ static void remove_slab_from_list(NvmSlab** list_head, NvmSlab* slab_to_remove)
     }
 }
 
-static NvmAllocator* nvm_allocator_create_impl(void* nvm_base_addr, uint64_t nvm_size_bytes) {
-    if (!nvm_base_addr) return NULL;
+// 把 CPU 堆中排在前 keep 个之后的未满 Slab 摘下并捐给仓库 (调用方持有 CPU 堆锁)。
+// 全满的 Slab 留在原处，它们因远程释放变空后仍由本 CPU 使用。
+static void donate_partial_slabs(NvmAllocator* allocator, NvmCpuHeap* cpu_heap, uint32_t keep) {
+    for (int sc = 0; sc < SC_COUNT; ++sc) {
+        NvmSlab** link = &cpu_heap->slab_lists[sc];
+        uint32_t kept = 0;
 
-    // 使用 calloc 自动初始化为 0，省去手动循环初始化 CPU Heaps
-    NvmAllocator* allocator = (NvmAllocator*)calloc(1, sizeof(NvmAllocator));
-    if (!allocator) {
-        LOG_ERR("Failed to allocate allocator struct.");
-        return NULL;
+        while (*link) {
+            NvmSlab* slab = *link;
+            if (nvm_slab_is_full(slab) || kept < keep) {
+                if (!nvm_slab_is_full(slab)) kept++;
+                link = &slab->next_in_chain;
+                continue;
+            }
+
+            *link = slab->next_in_chain;
+            __atomic_store_n(&slab->heap_cpu, NVM_SLAB_NO_HEAP, __ATOMIC_RELAXED);
+            NvmSlabDepot* depot = &allocator->depots[sc];
+            NVM_SPINLOCK_ACQUIRE(&depot->lock);
+            slab->next_in_chain = depot->head;
+            __atomic_store_n(&depot->head, slab, __ATOMIC_RELAXED);
+            depot->count++;
+            NVM_SPINLOCK_RELEASE(&depot->lock);
+        }
     }
+}
 
-    // 初始化中心堆组件
-    allocator->central_heap.nvm_base_addr = nvm_base_addr;
-    allocator->central_heap.space_manager = space_manager_create(nvm_size_bytes, NVM_START_OFFSET);
-    allocator->central_heap.slab_lookup_table = slab_hashtable_create(INITIAL_HASHTABLE_CAPACITY);
+static NvmSlab* depot_steal(NvmSlabDepot* depot) {
+    // 无锁预检：仓库为空是常态，避免每次慢路径都争用锁
+    if (!__atomic_load_n(&depot->head, __ATOMIC_RELAXED)) return NULL;
 
-    if (!allocator->central_heap.space_manager || !allocator->central_heap.slab_lookup_table) {
-        LOG_ERR("Failed to create central heap components.");
-        nvm_allocator_destroy_impl(allocator);
-        return NULL;
+    NVM_SPINLOCK_ACQUIRE(&depot->lock);
+    NvmSlab* slab = depot->head;
+    if (slab) {
+        __atomic_store_n(&depot->head, slab->next_in_chain, __ATOMIC_RELAXED);
+        depot->count--;
     }
-
-    return allocator;
+    NVM_SPINLOCK_RELEASE(&depot->lock);
+    return slab;
 }
 
-static void nvm_allocator_destroy_impl(NvmAllocator* allocator) {
-    if (!allocator) return;
+// 从链表中摘下所有空 Slab，头插到 *empty_out，返回摘下的数量。
+// 调用方持有链表所属的锁，期间无人从这些 Slab 分配，因此摘下后保持为空。
+static uint32_t unlink_empty_slabs(NvmSlab** list_head, NvmSlab** empty_out) {
+    uint32_t count = 0;
+    NvmSlab** link = list_head;
 
-    // 销毁所有 CPU 堆中的 Slab
-    for (int i = 0; i < MAX_CPUS; ++i) {
-        for (int j = 0; j < SC_COUNT; ++j) {
-            NvmSlab* curr = allocator->cpu_heaps[i].slab_lists[j];
-            while (curr) {
-                NvmSlab* next = curr->next_in_chain;
-                nvm_slab_destroy(curr);
-                curr = next;
-            }
+    while (*link) {
+        NvmSlab* slab = *link;
+        if (!nvm_slab_is_empty(slab)) {
+            link = &slab->next_in_chain;
+            continue;
         }
+        *link = slab->next_in_chain;
+        slab->next_in_chain = *empty_out;
+        *empty_out = slab;
+        count++;
     }
+    return count;
+}
 
-    // 销毁中心堆组件
-    if (allocator->central_heap.space_manager) 
-        space_manager_destroy(allocator->central_heap.space_manager);
-    if (allocator->central_heap.slab_lookup_table) 
-        slab_hashtable_destroy(allocator->central_heap.slab_lookup_table);
-
-    free(allocator);
+// 纪元回收的释放回调
+static void retire_slab_descriptor(void* slab) {
+    nvm_slab_destroy((NvmSlab*)slab);
 }
 
-static void* nvm_malloc_impl(NvmAllocator* allocator, size_t size) {
-    if (!allocator || size == 0) return NULL;
+// 归还已从所有链表摘下的空 Slab：注销索引、折叠日志，归还空间并延迟销毁元数据
+static uint32_t release_empty_slabs(NvmAllocator* allocator, NvmSlab* list) {
+    if (!list) return 0;
 
-    SizeClassID sc_id = map_size_to_sc_id(size);
-    if (sc_id == SC_COUNT) {
-        LOG_ERR("Size too large for slab allocation: %zu", size);
-        return NULL;
+    for (NvmSlab* slab = list; slab; slab = slab->next_in_chain) {
+        NvmCentralHeap* central = find_central_heap(allocator, slab->nvm_base_offset);
+        slab_hashtable_remove(central->slab_lookup_table, slab->nvm_base_offset);
     }
 
-    // 获取当前 CPU 堆
-    int cpu_id = NVM_GET_CURRENT_CPU_ID();
-    NvmCpuHeap* current_cpu_heap = &allocator->cpu_heaps[cpu_id];
-    NvmSlab* target_slab = current_cpu_heap->slab_lists[sc_id];
-
-    // [Fast Path] 查找本地缓存的可用 Slab
-    while (target_slab && nvm_slab_is_full(target_slab)) {
-        target_slab = target_slab->next_in_chain;
+    // 释放记录先于计数归零写入日志。空间以其他尺寸类别被另一 CPU 重用前必须先折叠，
+    // 否则旧日志中的记录可能在新 Slab 的记录之后才被应用
+    if (allocator->log) {
+        nvm_log_checkpoint(allocator->log);
     }
 
-    // [Slow Path] 需要从中心堆分配
-    if (!target_slab) {
-        // 1. 申请 NVM 空间
-        uint64_t offset = space_manager_alloc_slab(allocator->central_heap.space_manager);
-        if (offset == (uint64_t)-1) return NULL;
-
-        // 2. 创建 DRAM 元数据
-        target_slab = nvm_slab_create(sc_id, offset);
-        if (!target_slab) {
-            space_manager_free_slab(allocator->central_heap.space_manager, offset);
-            LOG_ERR("Failed to create slab metadata.");
-            return NULL;
-        }
+    uint32_t released = 0;
+    while (list) {
+        NvmSlab* next = list->next_in_chain;
+        uint64_t offset = list->nvm_base_offset;
 
-        // 3. 注册到全局哈希表
-        if (slab_hashtable_insert(allocator->central_heap.slab_lookup_table, offset, target_slab) != 0) {
-            nvm_slab_destroy(target_slab);
-            space_manager_free_slab(allocator->central_heap.space_manager, offset);
-            LOG_ERR("Failed to insert slab into hashtable.");
-            return NULL;
-        }
+        // 并发的 free 可能刚查到该描述符 (最后一次释放也可能尚未解锁)，
+        // 描述符交给纪元回收，待这些读者离开后再销毁；NVM 空间不被其引用，可立即归还
+        nvm_epoch_retire(list, retire_slab_descriptor);
 
-        // 4. 挂载到本地堆 (头插法)
-        target_slab->next_in_chain = current_cpu_heap->slab_lists[sc_id];
-        current_cpu_heap->slab_lists[sc_id] = target_slab;
+        space_manager_free_slab(find_central_heap(allocator, offset)->space_manager, offset);
+        released++;
+        list = next;
     }
+    return released;
+}
 
-    // 执行分配 (Slab 内部自旋锁保护)
-    uint32_t block_idx;
-    if (nvm_slab_alloc(target_slab, &block_idx) == 0) {
-        uint64_t final_offset = target_slab->nvm_base_offset + (block_idx * target_slab->block_size);
-        return (char*)allocator->central_heap.nvm_base_addr + final_offset;
+// 清空指定 CPU 堆：空 Slab 归还中心堆，未满 Slab 捐给仓库，全满 Slab 留待下次
+static int drain_cpu_heap(NvmAllocator* allocator, int cpu) {
+    NvmCpuHeap* cpu_heap = &allocator->cpu_heaps[cpu];
+    NvmSlab* empty = NULL;
+
+    NVM_SPINLOCK_ACQUIRE(&cpu_heap->lock);
+    for (int sc = 0; sc < SC_COUNT; ++sc) {
+        unlink_empty_slabs(&cpu_heap->slab_lists[sc], &empty);
     }
+    donate_partial_slabs(allocator, cpu_heap, 0);
+    NVM_SPINLOCK_RELEASE(&cpu_heap->lock);
 
-    LOG_ERR("Unexpected allocation failure in slab.");
-    return NULL;
+    return (int)release_empty_slabs(allocator, empty);
 }
 
-static void nvm_free_impl(NvmAllocator* allocator, void* nvm_ptr) {
-    if (!allocator || !nvm_ptr) return;
+// 归还仓库与各 CPU 堆中的全部空 Slab
+static int trim_impl(NvmAllocator* allocator) {
+    NvmSlab* empty = NULL;
 
-    // 计算相对偏移并对齐到 Slab 边界
-    uint64_t nvm_offset = (uint64_t)((char*)nvm_ptr - (char*)allocator->central_heap.nvm_base_addr);
-    uint64_t slab_base = (nvm_offset / NVM_SLAB_SIZE) * NVM_SLAB_SIZE;
+    // 暂存的远程释放使 Slab 看似未空，先全部刷新
+    remote_batch_flush_all(allocator->remote);
 
-    // 全局查表获取元数据
-    NvmSlab* target_slab = slab_hashtable_lookup(allocator->central_heap.slab_lookup_table, slab_base);
-    if (!target_slab) return;
+    for (int sc = 0; sc < SC_COUNT; ++sc) {
+        NvmSlabDepot* depot = &allocator->depots[sc];
+        NVM_SPINLOCK_ACQUIRE(&depot->lock);
+        depot->count -= unlink_empty_slabs(&depot->head, &empty);
+        NVM_SPINLOCK_RELEASE(&depot->lock);
+    }
 
-    // 计算块索引并释放
-    uint32_t block_idx = (nvm_offset - target_slab->nvm_base_offset) / target_slab->block_size;
-    nvm_slab_free(target_slab, block_idx);
+    for (int cpu = 0; cpu < MAX_CPUS; ++cpu) {
+        NvmCpuHeap* cpu_heap = &allocator->cpu_heaps[cpu];
+        NVM_SPINLOCK_ACQUIRE(&cpu_heap->lock);
+        for (int sc = 0; sc < SC_COUNT; ++sc) {
+            unlink_empty_slabs(&cpu_heap->slab_lists[sc], &empty);
+        }
+        NVM_SPINLOCK_RELEASE(&cpu_heap->lock);
+    }
+
+    return (int)release_empty_slabs(allocator, empty);
 }
 
-static int nvm_allocator_restore_allocation_impl(NvmAllocator* allocator, void* nvm_ptr, size_t size) {
-    if (!allocator || !nvm_ptr || size == 0) return -1;
+// 按区域表定位偏移所属的中心堆。表项只追加不修改，与 extend 并发时无需加锁
+static NvmCentralHeap* find_central_heap(NvmAllocator* allocator, uint64_t nvm_offset) {
+    uint32_t count = __atomic_load_n(&allocator->region_count, __ATOMIC_ACQUIRE);
+    for (uint32_t i = 0; i < count; ++i) {
+        const NvmRegion* region = &allocator->regions[i];
+        if (nvm_offset - region->offset < region->size) {
+            return &allocator->central_heaps[region->heap];
+        }
+    }
+    return NULL;
+}
 
-    SizeClassID sc_id = map_size_to_sc_id(size);
-    if (sc_id == SC_COUNT) return -1;
+// 按本池选择的引擎创建带位图的 Slab 描述符
+static NvmSlab* create_persistent_slab(const NvmAllocator* allocator, SizeClassID sc_id, uint64_t offset, int numa_node) {
+    return allocator->atomic_mode ? nvm_slab_create_atomic(sc_id, offset, numa_node)
+                                  : nvm_slab_create_on_node(sc_id, offset, numa_node);
+}
 
-    uint64_t nvm_offset = (uint64_t)((char*)nvm_ptr - (char*)allocator->central_heap.nvm_base_addr);
-    uint64_t slab_base = (nvm_offset / NVM_SLAB_SIZE) * NVM_SLAB_SIZE;
+// 优先从本地节点申请 NVM 空间，本地耗尽时按顺序回退到远端节点。
+// 每个节点依次尝试预清零池、预缺页池，最后才是空间管理器。
+// 元数据始终分配在 CPU 所在节点 (Slab 的访问者)，并注册到空间所属中心堆。
+static NvmSlab* create_slab_from_central(NvmAllocator* allocator, NvmCpuHeap* cpu_heap, SizeClassID sc_id) {
+    NvmCentralHeap* home = &allocator->central_heaps[cpu_heap->home_heap];
+    NvmCentralHeap* owner = NULL;
+    uint64_t offset = (uint64_t)-1;
+    bool prezeroed = false;
 
-    NvmCentralHeap* central = &allocator->central_heap;
-    NvmSlab* slab = slab_hashtable_lookup(central->slab_lookup_table, slab_base);
+    for (int i = 0; i < allocator->central_heap_count; ++i) {
+        NvmCentralHeap* central = &allocator->central_heaps[(cpu_heap->home_heap + i) % allocator->central_heap_count];
+        NvmSlabPool* pool = __atomic_load_n(&central->zero_pool, __ATOMIC_ACQUIRE);
+        if (pool && slab_pool_take(pool, &offset) == 0) {
+            owner = central;
+            prezeroed = true;
+            break;
+        }
+        pool = __atomic_load_n(&central->prefault_pool, __ATOMIC_ACQUIRE);
+        if (pool && slab_pool_take(pool, &offset) == 0) {
+            owner = central;
+            break;
+        }
+        offset = space_manager_alloc_slab(central->space_manager);
+        if (offset != (uint64_t)-1) {
+            owner = central;
+            break;
+        }
+    }
+    if (!owner) return NULL;
 
+    // 1. 创建 DRAM 元数据
+    NvmSlab* slab = allocator->volatile_mode
+        ? nvm_slab_create_volatile(sc_id, offset, (char*)owner->nvm_base_addr + offset, home->numa_node)
+        : create_persistent_slab(allocator, sc_id, offset, home->numa_node);
     if (!slab) {
-        // Slab 不存在：重建并占位
+        space_manager_free_slab(owner->space_manager, offset);
+        LOG_ERR("Failed to create slab metadata.");
+        return NULL;
+    }
+    if (__atomic_load_n(&allocator->placement_mode, __ATOMIC_RELAXED) == NVM_PLACEMENT_MEDIA_LINE) {
+        nvm_slab_enable_media_line_placement(slab);
+    }
+    if (prezeroed) {
+        nvm_slab_mark_prezeroed(slab);
+    }
+
+    // 2. 注册到空间所属节点的哈希表
+    if (slab_hashtable_insert(owner->slab_lookup_table, offset, slab) != 0) {
+        nvm_slab_destroy(slab);
+        space_manager_free_slab(owner->space_manager, offset);
+        LOG_ERR("Failed to insert slab into hashtable.");
+        return NULL;
+    }
+
+    return slab;
+}
+
+// 默认值 < 调用方配置 < NVM_MALLOC_CONF，合并后校验
+static int resolve_config(const NvmAllocatorConfig* config, NvmAllocatorConfig* out) {
+    if (config) {
+        *out = *config;
+    } else {
+        nvm_allocator_config_default(out);
+    }
+    if (nvm_allocator_config_apply_env(out) != 0 || nvm_allocator_config_validate(out) != 0) {
+        LOG_ERR("Invalid allocator configuration.");
+        return -1;
+    }
+    return 0;
+}
+
+static NvmAllocator* nvm_allocator_create_impl(void* nvm_base_addr, const NvmNumaRange* ranges, int range_count,
+                                               const NvmAllocatorConfig* config) {
+    if (!nvm_base_addr || !ranges || range_count <= 0 || range_count > MAX_NUMA_NODES) return NULL;
+
+    // 校验区间：Slab 对齐、互不重叠、节点号有效
+    for (int i = 0; i < range_count; ++i) {
+        if (ranges[i].offset % NVM_SLAB_SIZE != 0 || ranges[i].numa_node >= MAX_NUMA_NODES) {
+            LOG_ERR("Invalid NUMA range #%d.", i);
+            return NULL;
+        }
+        for (int j = 0; j < i; ++j) {
+            if (ranges[i].offset < ranges[j].offset + ranges[j].size &&
+                ranges[j].offset < ranges[i].offset + ranges[i].size) {
+                LOG_ERR("NUMA ranges #%d and #%d overlap.", j, i);
+                return NULL;
+            }
+        }
+    }
+
+    // 进程级参数：之后新建的 Slab 与退休的对象按新值处理 (config 已校验)
+    if (nvm_slab_set_cache_params(config->cache_depth, config->cache_batch) != 0 ||
+        nvm_epoch_set_reclaim_batch(config->epoch_reclaim_batch) != 0) {
+        return NULL;
+    }
+
+    // 使用 calloc 自动初始化为 0，省去手动循环初始化 CPU Heaps
+    NvmAllocator* allocator = (NvmAllocator*)calloc(1, sizeof(NvmAllocator));
+    if (!allocator) {
+        LOG_ERR("Failed to allocate allocator struct.");
+        return NULL;
+    }
+    allocator->heap_count          = config->heap_count;
+    allocator->depot_keep          = config->depot_keep;
+    allocator->depot_trim_interval = config->depot_trim_interval;
+
+    if (NVM_MUTEX_INIT(&allocator->extend_lock) != 0) {
+        LOG_ERR("Failed to init extend mutex.");
+        free(allocator);
+        return NULL;
+    }
+    if (NVM_MUTEX_INIT(&allocator->provisioner.lock) != 0) {
+        LOG_ERR("Failed to init provisioner mutex.");
+        goto err_destroy_extend;
+    }
+    if (NVM_COND_INIT(&allocator->provisioner.cond) != 0) {
+        LOG_ERR("Failed to init provisioner cond.");
+        goto err_destroy_prov_lock;
+    }
+    for (int sc = 0; sc < SC_COUNT; ++sc) {
+        if (NVM_SPINLOCK_INIT(&allocator->depots[sc].lock) != 0) {
+            LOG_ERR("Failed to init depot lock.");
+            nvm_allocator_destroy_impl(allocator);
+            return NULL;
+        }
+    }
+    for (int cpu = 0; cpu < MAX_CPUS; ++cpu) {
+        if (NVM_SPINLOCK_INIT(&allocator->cpu_heaps[cpu].lock) != 0) {
+            LOG_ERR("Failed to init CPU heap lock.");
+            nvm_allocator_destroy_impl(allocator);
+            return NULL;
+        }
+    }
+    allocator->deferred = deferred_free_create(deferred_free_batch, allocator);
+    if (!allocator->deferred) {
+        LOG_ERR("Failed to create deferred free queue.");
+        nvm_allocator_destroy_impl(allocator);
+        return NULL;
+    }
+    allocator->remote = remote_batch_create(config->remote_batch);
+    if (!allocator->remote) {
+        LOG_ERR("Failed to create remote free batcher.");
+        nvm_allocator_destroy_impl(allocator);
+        return NULL;
+    }
+
+    // 初始化各节点的中心堆组件
+    allocator->central_heap_count = range_count;
+    for (int i = 0; i < range_count; ++i) {
+        NvmCentralHeap* central = &allocator->central_heaps[i];
+        central->nvm_base_addr     = nvm_base_addr;
+        central->range_offset      = ranges[i].offset;
+        central->range_size        = ranges[i].size;
+        central->numa_node         = ranges[i].numa_node;
+        central->space_manager     = space_manager_create(ranges[i].size, ranges[i].offset);
+        central->slab_lookup_table = slab_hashtable_create(config->hashtable_capacity);
+        allocator->regions[i] = (NvmRegion){ ranges[i].offset, ranges[i].size, i };
+
+        if (!central->space_manager || !central->slab_lookup_table) {
+            LOG_ERR("Failed to create central heap components.");
+            nvm_allocator_destroy_impl(allocator);
+            return NULL;
+        }
+    }
+
+    allocator->region_count = (uint32_t)range_count;
+
+    // 将每个 CPU 堆绑定到其所在节点的中心堆 (无对应区间时使用第 0 个)
+    for (int cpu = 0; cpu < MAX_CPUS; ++cpu) {
+        int node = nvm_numa_node_of_cpu(cpu);
+        for (int i = 0; i < range_count; ++i) {
+            if (allocator->central_heaps[i].numa_node == node) {
+                allocator->cpu_heaps[cpu].home_heap = i;
+                break;
+            }
+        }
+    }
+
+    return allocator;
+
+err_destroy_prov_lock:
+    NVM_MUTEX_DESTROY(&allocator->provisioner.lock);
+err_destroy_extend:
+    NVM_MUTEX_DESTROY(&allocator->extend_lock);
+    free(allocator);
+    return NULL;
+}
+
+static void nvm_allocator_destroy_impl(NvmAllocator* allocator) {
+    if (!allocator) return;
+
+    // 预备线程会向 CPU 堆挂入 Slab，最先停止
+    set_provisioning_impl(allocator, 0, 0);
+
+    // 先处理尚未完成的延迟释放，其释放记录要进入最后一次检查点
+    deferred_free_destroy(allocator->deferred);
+    allocator->deferred = NULL;
+    remote_batch_destroy(allocator->remote);
+    allocator->remote = NULL;
+
+    // 最后一次检查点，之后日志与镜像一致
+    nvm_log_region_destroy(allocator->log);
+    allocator->log = NULL;
+
+    // 先停止后台线程，池中剩余 Slab 归还给空间管理器
+    for (int i = 0; i < allocator->central_heap_count; ++i) {
+        slab_pool_destroy(allocator->central_heaps[i].zero_pool);
+        slab_pool_destroy(allocator->central_heaps[i].prefault_pool);
+        allocator->central_heaps[i].zero_pool = NULL;
+        allocator->central_heaps[i].prefault_pool = NULL;
+    }
+
+    // 销毁所有 CPU 堆中的 Slab
+    for (int i = 0; i < MAX_CPUS; ++i) {
+        for (int j = 0; j < SC_COUNT; ++j) {
+            NvmSlab* curr = allocator->cpu_heaps[i].slab_lists[j];
+            while (curr) {
+                NvmSlab* next = curr->next_in_chain;
+                nvm_slab_destroy(curr);
+                curr = next;
+            }
+        }
+        NVM_SPINLOCK_DESTROY(&allocator->cpu_heaps[i].lock);
+    }
+
+    // 销毁仓库中的 Slab
+    for (int sc = 0; sc < SC_COUNT; ++sc) {
+        NvmSlab* curr = allocator->depots[sc].head;
+        while (curr) {
+            NvmSlab* next = curr->next_in_chain;
+            nvm_slab_destroy(curr);
+            curr = next;
+        }
+        NVM_SPINLOCK_DESTROY(&allocator->depots[sc].lock);
+    }
+
+    // 销毁各节点的中心堆组件
+    for (int i = 0; i < allocator->central_heap_count; ++i) {
+        NvmCentralHeap* central = &allocator->central_heaps[i];
+        if (central->space_manager) 
+            space_manager_destroy(central->space_manager);
+        if (central->slab_lookup_table) 
+            slab_hashtable_destroy(central->slab_lookup_table);
+    }
+
+    // 等待 trim 退休的 Slab 描述符与哈希节点全部释放
+    nvm_epoch_barrier();
+
+    NVM_COND_DESTROY(&allocator->provisioner.cond);
+    NVM_MUTEX_DESTROY(&allocator->provisioner.lock);
+    NVM_MUTEX_DESTROY(&allocator->extend_lock);
+    free(allocator);
+}
+
+static void* nvm_malloc_impl(NvmAllocator* allocator, size_t size) {
+    NvmSlab* slab;
+    uint32_t block_idx;
+    return nvm_malloc_block(allocator, size, &slab, &block_idx);
+}
+
+// 分配并返回块所在 Slab 与块索引，供 calloc 判断是否需要清零
+static void* nvm_malloc_block(NvmAllocator* allocator, size_t size, NvmSlab** out_slab, uint32_t* out_block_idx) {
+    if (!allocator || size == 0) return NULL;
+
+    SizeClassID sc_id = map_size_to_sc_id(size);
+    if (sc_id == SC_COUNT) {
+        LOG_ERR("Size too large for slab allocation: %zu", size);
+        return NULL;
+    }
+
+    // 获取当前 CPU 堆 (链表锁仅与 drain/trim 竞争)
+    int heap_id = heap_index_of_cpu(allocator, NVM_GET_CURRENT_CPU_ID());
+    NvmCpuHeap* current_cpu_heap = &allocator->cpu_heaps[heap_id];
+    NVM_SPINLOCK_ACQUIRE(&current_cpu_heap->lock);
+    __atomic_store_n(&current_cpu_heap->class_allocs[sc_id],
+                     current_cpu_heap->class_allocs[sc_id] + 1, __ATOMIC_RELAXED);
+
+    // 周期性地把过剩的未满 Slab 捐给仓库，供其他 CPU 窃取。
+    // 预备线程挂入的余量不算过剩，否则刚预备的 Slab 又被捐出
+    if (NVM_UNLIKELY(++current_cpu_heap->allocs_since_trim >=
+                     __atomic_load_n(&allocator->depot_trim_interval, __ATOMIC_RELAXED))) {
+        current_cpu_heap->allocs_since_trim = 0;
+        donate_partial_slabs(allocator, current_cpu_heap, __atomic_load_n(&allocator->depot_keep, __ATOMIC_RELAXED) +
+                             __atomic_load_n(&allocator->provisioner.slabs_ahead, __ATOMIC_RELAXED));
+    }
+
+    // [Fast Path] 查找本地缓存的可用 Slab
+    NvmSlab* target_slab = current_cpu_heap->slab_lists[sc_id];
+    while (target_slab && nvm_slab_is_full(target_slab)) {
+        target_slab = target_slab->next_in_chain;
+    }
+
+    // [Slow Path] 先从仓库窃取其他 CPU 捐出的 Slab，再向中心堆申请 (本地节点优先)
+    if (!target_slab) {
+        // 窃取的 Slab 保持原 owner_cpu：同一 Slab 的日志记录必须留在同一条日志中；
+        // 释放路由只看 heap_cpu，挂载后本 CPU 的释放仍走本地路径
+        target_slab = depot_steal(&allocator->depots[sc_id]);
+
+        if (!target_slab) {
+            // 中心堆操作涉及互斥锁与元数据分配，不在 CPU 堆锁内进行
+            NVM_SPINLOCK_RELEASE(&current_cpu_heap->lock);
+            __atomic_fetch_add(&allocator->slow_path_hits, 1, __ATOMIC_RELAXED);
+            target_slab = create_slab_from_central(allocator, current_cpu_heap, sc_id);
+            if (!target_slab) return NULL;
+            target_slab->owner_cpu = (uint8_t)heap_id;
+            NVM_SPINLOCK_ACQUIRE(&current_cpu_heap->lock);
+        }
+
+        // 挂载到本地堆 (头插法)
+        link_slab_locked(current_cpu_heap, heap_id, sc_id, target_slab, false);
+    }
+
+    // 执行分配 (Slab 内部自旋锁保护)。持有 CPU 堆锁直到 Slab 非空，防止其被 trim 回收
+    uint32_t block_idx;
+    int ret = nvm_slab_alloc(target_slab, &block_idx);
+    NVM_SPINLOCK_RELEASE(&current_cpu_heap->lock);
+
+    if (ret == 0) {
+        maybe_request_prefault(allocator, current_cpu_heap, target_slab);
+
+        uint64_t final_offset = target_slab->nvm_base_offset + (block_idx * target_slab->block_size);
+        if (allocator->log) {
+            nvm_log_append(allocator->log, target_slab->owner_cpu, NVM_LOG_OP_ALLOC, final_offset, sc_id);
+        }
+        *out_slab = target_slab;
+        *out_block_idx = block_idx;
+        return (char*)allocator->central_heaps[0].nvm_base_addr + final_offset;
+    }
+
+    LOG_ERR("Unexpected allocation failure in slab.");
+    return NULL;
+}
+
+static void* nvm_try_malloc_impl(NvmAllocator* allocator, size_t size, NvmTryStatus* out_status) {
+    NvmTryStatus status = NVM_TRY_OK;
+    void* result = NULL;
+
+    SizeClassID sc_id = map_size_to_sc_id(size);
+    if (size == 0 || sc_id == SC_COUNT) {
+        status = NVM_TRY_BAD_SIZE;
+        goto out;
+    }
+
+    int cpu_id = NVM_GET_CURRENT_CPU_ID();
+    NvmCpuHeap* cpu_heap = &allocator->cpu_heaps[heap_index_of_cpu(allocator, cpu_id)];
+    if (NVM_SPINLOCK_TRYACQUIRE(&cpu_heap->lock) != 0) {
+        status = NVM_TRY_CONTENDED;
+        goto out;
+    }
+
+    // 只遍历本地链表；Slab 锁被远程释放占用时换下一个
+    NvmSlab* slab = cpu_heap->slab_lists[sc_id];
+    uint32_t block_idx = 0;
+    bool contended = false;
+    for (; slab; slab = slab->next_in_chain) {
+        if (nvm_slab_is_full(slab)) continue;
+        if (nvm_slab_try_alloc(slab, &block_idx) == 0) break;
+        contended = true;
+    }
+    if (slab) {
+        __atomic_store_n(&cpu_heap->class_allocs[sc_id], cpu_heap->class_allocs[sc_id] + 1, __ATOMIC_RELAXED);
+    }
+    NVM_SPINLOCK_RELEASE(&cpu_heap->lock);
+
+    if (!slab) {
+        status = contended ? NVM_TRY_CONTENDED : NVM_TRY_NO_LOCAL_SLAB;
+        if (!contended) {
+            nvm_replenish_fn fn = __atomic_load_n(&allocator->replenish_fn, __ATOMIC_ACQUIRE);
+            if (fn) fn(cpu_id, size, __atomic_load_n(&allocator->replenish_arg, __ATOMIC_RELAXED));
+        }
+        goto out;
+    }
+
+    uint64_t final_offset = slab->nvm_base_offset + (uint64_t)block_idx * slab->block_size;
+    if (allocator->log &&
+        nvm_log_try_append(allocator->log, slab->owner_cpu, NVM_LOG_OP_ALLOC, final_offset, sc_id) != 0) {
+        // 记录未写入，块不能交付；归还时 Slab 非空，不会被并发 trim 回收
+        nvm_slab_free(slab, block_idx);
+        status = NVM_TRY_LOG_BUSY;
+        goto out;
+    }
+    result = (char*)allocator->central_heaps[0].nvm_base_addr + final_offset;
+
+out:
+    if (out_status) *out_status = status;
+    return result;
+}
+
+// 为指定 CPU 堆准备一个未满 Slab：先窃取仓库，再向中心堆申请
+static int replenish_cpu_heap(NvmAllocator* allocator, int cpu, SizeClassID sc_id) {
+    NvmCpuHeap* cpu_heap = &allocator->cpu_heaps[cpu];
+
+    NVM_SPINLOCK_ACQUIRE(&cpu_heap->lock);
+    for (NvmSlab* slab = cpu_heap->slab_lists[sc_id]; slab; slab = slab->next_in_chain) {
+        if (!nvm_slab_is_full(slab)) {
+            NVM_SPINLOCK_RELEASE(&cpu_heap->lock);
+            return 0;
+        }
+    }
+    NVM_SPINLOCK_RELEASE(&cpu_heap->lock);
+
+    NvmSlab* slab = obtain_slab_for_cpu(allocator, cpu, sc_id);
+    if (!slab) return -1;
+
+    NVM_SPINLOCK_ACQUIRE(&cpu_heap->lock);
+    link_slab_locked(cpu_heap, cpu, sc_id, slab, false);
+    NVM_SPINLOCK_RELEASE(&cpu_heap->lock);
+    return 0;
+}
+
+// 为指定 CPU 取得一个尚未挂载的 Slab：先窃取仓库，再向中心堆申请 (不持有 CPU 堆锁)
+static NvmSlab* obtain_slab_for_cpu(NvmAllocator* allocator, int cpu, SizeClassID sc_id) {
+    NvmSlab* slab = depot_steal(&allocator->depots[sc_id]);
+    if (slab) return slab;
+
+    slab = create_slab_from_central(allocator, &allocator->cpu_heaps[cpu], sc_id);
+    if (slab) slab->owner_cpu = (uint8_t)cpu;
+    return slab;
+}
+
+// 把 Slab 挂到 CPU 堆的链表头部或尾部，并记录它挂载在哪个堆 (决定释放路由)。
+// 假设已持 cpu_heap->lock
+static void link_slab_locked(NvmCpuHeap* cpu_heap, int heap_id, SizeClassID sc_id, NvmSlab* slab,
+                             bool at_tail) {
+    __atomic_store_n(&slab->heap_cpu, (uint8_t)heap_id, __ATOMIC_RELAXED);
+    if (at_tail) {
+        NvmSlab** link = &cpu_heap->slab_lists[sc_id];
+        while (*link) link = &(*link)->next_in_chain;
+        slab->next_in_chain = NULL;
+        *link = slab;
+    } else {
+        slab->next_in_chain = cpu_heap->slab_lists[sc_id];
+        cpu_heap->slab_lists[sc_id] = slab;
+    }
+}
+
+// 启动、调整或停止预备线程
+static int set_provisioning_impl(NvmAllocator* allocator, uint32_t slabs_ahead, uint32_t interval_ms) {
+    NvmProvisioner* prov = &allocator->provisioner;
+
+    NVM_MUTEX_ACQUIRE(&prov->lock);
+    if (slabs_ahead == 0) {
+        __atomic_store_n(&prov->slabs_ahead, 0, __ATOMIC_RELAXED);
+        if (!prov->running) {
+            NVM_MUTEX_RELEASE(&prov->lock);
+            return 0;
+        }
+        prov->stopping = true;
+        NVM_COND_BROADCAST(&prov->cond);
+        NVM_MUTEX_RELEASE(&prov->lock);
+
+        NVM_THREAD_JOIN(prov->worker);
+
+        NVM_MUTEX_ACQUIRE(&prov->lock);
+        prov->running = false;
+        prov->stopping = false;
+        NVM_MUTEX_RELEASE(&prov->lock);
+        return 0;
+    }
+
+    __atomic_store_n(&prov->slabs_ahead, slabs_ahead, __ATOMIC_RELAXED);
+    prov->interval_ms = interval_ms ? interval_ms : NVM_PROVISION_DEFAULT_INTERVAL_MS;
+    if (prov->running) {
+        NVM_COND_SIGNAL(&prov->cond);
+        NVM_MUTEX_RELEASE(&prov->lock);
+        return 0;
+    }
+    // 启动前重新建立基线：停用期间的分配不计入速率，启动之后的分配都会被采样到
+    for (int cpu = 0; cpu < MAX_CPUS; ++cpu) {
+        for (int sc = 0; sc < SC_COUNT; ++sc) {
+            prov->last_allocs[cpu][sc] =
+                __atomic_load_n(&allocator->cpu_heaps[cpu].class_allocs[sc], __ATOMIC_RELAXED);
+            prov->rate[cpu][sc] = 0;
+        }
+    }
+    if (NVM_THREAD_CREATE(&prov->worker, provisioner_main, allocator) != 0) {
+        LOG_ERR("Failed to start slab provisioner.");
+        __atomic_store_n(&prov->slabs_ahead, 0, __ATOMIC_RELAXED);
+        NVM_MUTEX_RELEASE(&prov->lock);
+        return -1;
+    }
+    prov->running = true;
+    NVM_MUTEX_RELEASE(&prov->lock);
+    return 0;
+}
+
+static void* provisioner_main(void* arg) {
+    NvmAllocator* allocator = (NvmAllocator*)arg;
+    NvmProvisioner* prov = &allocator->provisioner;
+
+    NVM_MUTEX_ACQUIRE(&prov->lock);
+    while (!prov->stopping) {
+        NVM_COND_TIMEDWAIT_MS(&prov->cond, &prov->lock, prov->interval_ms);
+        if (prov->stopping) break;
+
+        uint32_t slabs_ahead = prov->slabs_ahead;
+        NVM_MUTEX_RELEASE(&prov->lock);
+        provision_tick(allocator, slabs_ahead);
+        NVM_MUTEX_ACQUIRE(&prov->lock);
+    }
+    NVM_MUTEX_RELEASE(&prov->lock);
+
+    return NULL;
+}
+
+// 一个采样周期：更新各 (CPU, 尺寸类别) 的消耗速率，对有需求者补足余量。
+// 目标空闲块数 = slabs_ahead 个 Slab 的容量 + NVM_PROVISION_HORIZON_TICKS 个周期的消耗。
+// 预备的 Slab 挂到链表尾部，分配路径先用完已有的未满 Slab
+static void provision_tick(NvmAllocator* allocator, uint32_t slabs_ahead) {
+    NvmProvisioner* prov = &allocator->provisioner;
+
+    for (int cpu = 0; cpu < MAX_CPUS; ++cpu) {
+        NvmCpuHeap* cpu_heap = &allocator->cpu_heaps[cpu];
+
+        for (int sc = 0; sc < SC_COUNT; ++sc) {
+            uint64_t allocs = __atomic_load_n(&cpu_heap->class_allocs[sc], __ATOMIC_RELAXED);
+            uint64_t delta = allocs - prov->last_allocs[cpu][sc];
+            prov->last_allocs[cpu][sc] = allocs;
+
+            // 权重 1/4 的指数滑动平均；有分配时速率至少为 1，无分配时逐步衰减到 0
+            uint64_t rate = (3 * prov->rate[cpu][sc] + delta) / 4;
+            if (delta && rate == 0) rate = 1;
+            prov->rate[cpu][sc] = rate;
+            if (rate == 0) continue;
+
+            uint64_t capacity = (uint64_t)NVM_SLAB_SIZE >> (3 + sc);
+            uint64_t target = slabs_ahead * capacity + rate * NVM_PROVISION_HORIZON_TICKS;
+
+            for (int added = 0; added < NVM_PROVISION_MAX_PER_TICK; ++added) {
+                if (local_free_blocks(cpu_heap, (SizeClassID)sc) >= target) break;
+
+                NvmSlab* slab = obtain_slab_for_cpu(allocator, cpu, (SizeClassID)sc);
+                if (!slab) break;
+
+                NVM_SPINLOCK_ACQUIRE(&cpu_heap->lock);
+                link_slab_locked(cpu_heap, cpu, (SizeClassID)sc, slab, true);
+                NVM_SPINLOCK_RELEASE(&cpu_heap->lock);
+
+                __atomic_fetch_add(&prov->provisioned, 1, __ATOMIC_RELAXED);
+            }
+        }
+    }
+}
+
+// CPU 堆某尺寸类别链表中的空闲块总数
+static uint64_t local_free_blocks(NvmCpuHeap* cpu_heap, SizeClassID sc_id) {
+    uint64_t free_blocks = 0;
+
+    NVM_SPINLOCK_ACQUIRE(&cpu_heap->lock);
+    for (NvmSlab* slab = cpu_heap->slab_lists[sc_id]; slab; slab = slab->next_in_chain) {
+        uint32_t used = nvm_slab_used_blocks(slab);
+        if (used < slab->total_block_count) free_blocks += slab->total_block_count - used;
+    }
+    NVM_SPINLOCK_RELEASE(&cpu_heap->lock);
+    return free_blocks;
+}
+
+static NvmSlab* lookup_slab(NvmAllocator* allocator, void* nvm_ptr, uint64_t* out_offset) {
+    // 计算相对偏移并对齐到 Slab 边界
+    uint64_t nvm_offset = (uint64_t)((char*)nvm_ptr - (char*)allocator->central_heaps[0].nvm_base_addr);
+    uint64_t slab_base = (nvm_offset / NVM_SLAB_SIZE) * NVM_SLAB_SIZE;
+
+    // 按区间定位所属节点，再查表获取元数据
+    NvmCentralHeap* central = find_central_heap(allocator, slab_base);
+    if (!central) return NULL;
+
+    *out_offset = nvm_offset;
+    return slab_hashtable_lookup(central->slab_lookup_table, slab_base);
+}
+
+static void* nvm_calloc_impl(NvmAllocator* allocator, size_t nmemb, size_t size) {
+    if (!allocator || nmemb == 0 || size == 0) return NULL;
+    if (nmemb > SIZE_MAX / size) {
+        LOG_ERR("calloc size overflow: %zu * %zu", nmemb, size);
+        return NULL;
+    }
+
+    NvmSlab* slab;
+    uint32_t block_idx;
+    size_t total = nmemb * size;
+    void* ptr = nvm_malloc_block(allocator, total, &slab, &block_idx);
+    if (!ptr) return NULL;
+
+    // 来自预清零 Slab 且从未被使用过的块无需再清零
+    if (!nvm_slab_block_is_zeroed(slab, block_idx)) {
+        if (allocator->volatile_mode) {
+            memset(ptr, 0, total);
+        } else {
+            nvm_memset_persist(ptr, 0, total);
+        }
+    }
+    return ptr;
+}
+
+static void* nvm_realloc_impl(NvmAllocator* allocator, void* nvm_ptr, size_t size) {
+    if (!allocator) return NULL;
+    if (!nvm_ptr) return nvm_malloc_impl(allocator, size);
+    if (size == 0) {
+        nvm_free_impl(allocator, nvm_ptr);
+        return NULL;
+    }
+
+    uint64_t nvm_offset;
+    NvmSlab* old_slab = lookup_slab(allocator, nvm_ptr, &nvm_offset);
+    if (!old_slab) {
+        LOG_ERR("realloc on unknown pointer %p", nvm_ptr);
+        return NULL;
+    }
+
+    // 原块容量足够时原地返回
+    if (size <= old_slab->block_size) return nvm_ptr;
+
+    void* new_ptr = nvm_malloc_impl(allocator, size);
+    if (!new_ptr) return NULL;
+
+    if (allocator->volatile_mode) {
+        memcpy(new_ptr, nvm_ptr, old_slab->block_size);
+    } else {
+        nvm_memcpy_persist(new_ptr, nvm_ptr, old_slab->block_size);
+    }
+    nvm_free_impl(allocator, nvm_ptr);
+    return new_ptr;
+}
+
+static int nvm_allocator_set_zero_pool_depth_impl(NvmAllocator* allocator, uint32_t depth) {
+    for (int i = 0; i < allocator->central_heap_count; ++i) {
+        NvmCentralHeap* central = &allocator->central_heaps[i];
+
+        if (central->zero_pool) {
+            slab_pool_set_depth(central->zero_pool, depth);
+            continue;
+        }
+        if (depth == 0) continue;
+
+        NvmSlabPool* pool = slab_pool_create(central->space_manager, central->nvm_base_addr,
+                                             depth, NVM_SLAB_POOL_ZERO);
+        if (!pool) {
+            LOG_ERR("Failed to create zero pool for central heap #%d.", i);
+            return -1;
+        }
+        __atomic_store_n(&central->zero_pool, pool, __ATOMIC_RELEASE);
+    }
+    return 0;
+}
+
+static int nvm_allocator_set_prefault_impl(NvmAllocator* allocator, uint32_t threshold_pct) {
+    for (int i = 0; threshold_pct > 0 && i < allocator->central_heap_count; ++i) {
+        NvmCentralHeap* central = &allocator->central_heaps[i];
+        if (central->prefault_pool) continue;
+
+        NvmSlabPool* pool = slab_pool_create(central->space_manager, central->nvm_base_addr,
+                                             NVM_PREFAULT_POOL_DEPTH, NVM_SLAB_POOL_ON_DEMAND);
+        if (!pool) {
+            LOG_ERR("Failed to create prefault pool for central heap #%d.", i);
+            return -1;
+        }
+        __atomic_store_n(&central->prefault_pool, pool, __ATOMIC_RELEASE);
+    }
+
+    __atomic_store_n(&allocator->prefault_pct, threshold_pct, __ATOMIC_RELAXED);
+    return 0;
+}
+
+// 当前 Slab 的填充率恰好越过阈值时，请求本地节点在后台预缺页一个 Slab。
+// 计数为乐观读，偶尔漏报或重复请求都无害 (请求数受池深度限制)。
+static void maybe_request_prefault(NvmAllocator* allocator, NvmCpuHeap* cpu_heap, NvmSlab* slab) {
+    uint32_t pct = __atomic_load_n(&allocator->prefault_pct, __ATOMIC_RELAXED);
+    if (NVM_LIKELY(pct == 0)) return;
+
+    uint32_t trigger = (uint32_t)(((uint64_t)slab->total_block_count * pct + 99) / 100);
+    if (trigger == 0) trigger = 1;
+    if (__atomic_load_n(&slab->allocated_block_count, __ATOMIC_RELAXED) != trigger) return;
+
+    NvmCentralHeap* home = &allocator->central_heaps[cpu_heap->home_heap];
+    slab_pool_request(__atomic_load_n(&home->prefault_pool, __ATOMIC_ACQUIRE));
+}
+
+static void nvm_free_impl(NvmAllocator* allocator, void* nvm_ptr) {
+    if (!allocator || !nvm_ptr) return;
+
+    // 查找到释放完成期间描述符不得被 trim 回收
+    uint32_t token = nvm_epoch_enter();
+
+    uint64_t nvm_offset;
+    NvmSlab* target_slab = lookup_slab(allocator, nvm_ptr, &nvm_offset);
+    if (!target_slab) goto out_exit_epoch;
+
+    // 计算块索引并释放
+    uint32_t block_idx = (nvm_offset - target_slab->nvm_base_offset) / target_slab->block_size;
+
+    // 释放记录必须先于块重新可分配落盘，否则同一日志中可能出现"分配-分配-释放"的错误顺序
+    if (allocator->log) {
+        uint64_t block_offset = target_slab->nvm_base_offset + (uint64_t)block_idx * target_slab->block_size;
+        nvm_log_append(allocator->log, target_slab->owner_cpu, NVM_LOG_OP_FREE,
+                       block_offset, (SizeClassID)target_slab->size_type_id);
+    }
+    // Slab 挂载在其他 CPU 堆 (或仓库) 中时只写远程暂存区，不与持有者争用分配侧的锁与缓存行；
+    // 先按目标 Slab 在线程本地攒成一组，每组只获取一次远程锁。原子位图引擎的释放本身无锁，直接清位
+    if (__atomic_load_n(&target_slab->heap_cpu, __ATOMIC_RELAXED) ==
+            heap_index_of_cpu(allocator, NVM_GET_CURRENT_CPU_ID()) ||
+        (target_slab->flags & NVM_SLAB_FLAG_ATOMIC)) {
+        nvm_slab_free(target_slab, block_idx);
+    } else if (remote_batch_push(allocator->remote, target_slab, block_idx) != 0) {
+        nvm_slab_free_remote(target_slab, block_idx);
+    }
+
+out_exit_epoch:
+    nvm_epoch_exit(token);
+}
+
+static int compare_ptrs(const void* a, const void* b) {
+    uintptr_t pa = (uintptr_t)*(void* const*)a;
+    uintptr_t pb = (uintptr_t)*(void* const*)b;
+    return (pa > pb) - (pa < pb);
+}
+
+// 延迟释放的批量回调：按地址排序后同一 Slab 的块相邻，每个 Slab 只查表、加锁一次
+static void deferred_free_batch(void* ctx, void** ptrs, uint32_t count) {
+    NvmAllocator* allocator = (NvmAllocator*)ctx;
+    uint32_t block_idxs[NVM_DEFERRED_RING_SIZE];
+
+    qsort(ptrs, count, sizeof(void*), compare_ptrs);
+
+    uint32_t token = nvm_epoch_enter();
+    uint32_t i = 0;
+    while (i < count) {
+        uint64_t nvm_offset;
+        NvmSlab* slab = lookup_slab(allocator, ptrs[i], &nvm_offset);
+        if (!slab) {
+            LOG_ERR("Deferred free on unknown pointer %p", ptrs[i]);
+            i++;
+            continue;
+        }
+
+        uint32_t n = 0;
+        for (; i < count && n < NVM_DEFERRED_RING_SIZE; ++i) {
+            nvm_offset = (uint64_t)((char*)ptrs[i] - (char*)allocator->central_heaps[0].nvm_base_addr);
+            if (nvm_offset - slab->nvm_base_offset >= NVM_SLAB_SIZE) break;
+
+            uint32_t block_idx = (uint32_t)((nvm_offset - slab->nvm_base_offset) / slab->block_size);
+            if (allocator->log) {
+                nvm_log_append(allocator->log, slab->owner_cpu, NVM_LOG_OP_FREE,
+                               slab->nvm_base_offset + (uint64_t)block_idx * slab->block_size,
+                               (SizeClassID)slab->size_type_id);
+            }
+            block_idxs[n++] = block_idx;
+        }
+        nvm_slab_free_batch(slab, block_idxs, n);
+    }
+    nvm_epoch_exit(token);
+}
+
+static int nvm_allocator_restore_allocation_impl(NvmAllocator* allocator, void* nvm_ptr, size_t size) {
+    if (!allocator || !nvm_ptr || size == 0) return -1;
+    if (allocator->volatile_mode) {
+        LOG_ERR("Restore is not supported in volatile mode.");
+        return -1;
+    }
+
+    SizeClassID sc_id = map_size_to_sc_id(size);
+    if (sc_id == SC_COUNT) return -1;
+
+    uint64_t nvm_offset = (uint64_t)((char*)nvm_ptr - (char*)allocator->central_heaps[0].nvm_base_addr);
+    uint64_t slab_base = (nvm_offset / NVM_SLAB_SIZE) * NVM_SLAB_SIZE;
+
+    NvmCentralHeap* central = find_central_heap(allocator, slab_base);
+    if (!central) {
+        LOG_ERR("Restore failed: Offset outside managed ranges.");
+        return -1;
+    }
+    NvmSlab* slab = slab_hashtable_lookup(central->slab_lookup_table, slab_base);
+
+    if (!slab) {
+        // Slab 不存在：重建并占位
         if (space_manager_alloc_at_offset(central->space_manager, slab_base) != 0) {
             LOG_ERR("Restore failed: Space occupied.");
             return -1;
         }
 
-        slab = nvm_slab_create(sc_id, slab_base);
+        // 恢复的 Slab 挂载到 CPU 0，元数据放在 CPU 0 所在节点
+        int meta_node = allocator->central_heaps[allocator->cpu_heaps[0].home_heap].numa_node;
+        slab = create_persistent_slab(allocator, sc_id, slab_base, meta_node);
         if (!slab) {
             space_manager_free_slab(central->space_manager, slab_base);
             return -1;
@@ -270,8 +1509,9 @@ static int nvm_allocator_restore_allocation_impl(NvmAllocator* allocator, void*
 
         // 注册并挂载到默认 CPU 0
         slab_hashtable_insert(central->slab_lookup_table, slab_base, slab);
-        slab->next_in_chain = allocator->cpu_heaps[0].slab_lists[sc_id];
-        allocator->cpu_heaps[0].slab_lists[sc_id] = slab;
+        NVM_SPINLOCK_ACQUIRE(&allocator->cpu_heaps[0].lock);
+        link_slab_locked(&allocator->cpu_heaps[0], 0, sc_id, slab, false);
+        NVM_SPINLOCK_RELEASE(&allocator->cpu_heaps[0].lock);
     } else {
         // Slab 已存在：校验一致性
         if (slab->size_type_id != sc_id) {
@@ -282,9 +1522,109 @@ static int nvm_allocator_restore_allocation_impl(NvmAllocator* allocator, void*
 
     // 标记位图
     uint32_t block_idx = (nvm_offset - slab_base) / slab->block_size;
-    return nvm_slab_set_bitmap_at_idx(slab, block_idx);
+    if (nvm_slab_set_bitmap_at_idx(slab, block_idx) != 0) return -1;
+
+    if (allocator->log) {
+        nvm_log_append(allocator->log, slab->owner_cpu, NVM_LOG_OP_ALLOC,
+                       slab_base + (uint64_t)block_idx * slab->block_size, sc_id);
+    }
+    return 0;
+}
+
+// 新区域交给调用线程本地节点的中心堆。先发布区域表项再加入空闲空间，
+// 因此任何来自新区域的 Slab 被分配出去之前，指针查找都已能定位到它。
+static int nvm_allocator_extend_impl(NvmAllocator* allocator, void* addr, uint64_t size) {
+    if (!addr || size == 0) return -1;
+    if (allocator->log) {
+        // 持久化镜像只覆盖初始数据区
+        LOG_ERR("Extend is not supported with log metadata.");
+        return -1;
+    }
+
+    // 起点按 Slab 对齐 (相对基址)，首尾不足一个 Slab 的部分舍弃
+    uint64_t raw = (uint64_t)((uintptr_t)addr - (uintptr_t)allocator->central_heaps[0].nvm_base_addr);
+    uint64_t offset = NVM_ALIGN_UP(raw, (uint64_t)NVM_SLAB_SIZE);
+    uint64_t skip = offset - raw;
+    uint64_t usable = (size > skip) ? NVM_ALIGN_DOWN(size - skip, (uint64_t)NVM_SLAB_SIZE) : 0;
+    if (usable > 0 && offset + usable == 0) {
+        usable -= NVM_SLAB_SIZE;  // 区域紧贴基址下方：避免区间终点回绕为 0
+    }
+    if (usable == 0 || offset + usable < offset) {
+        LOG_ERR("Region %p (+%llu) holds no aligned slab.", addr, (unsigned long long)size);
+        return -1;
+    }
+
+    int heap = allocator->cpu_heaps[heap_index_of_cpu(allocator, NVM_GET_CURRENT_CPU_ID())].home_heap;
+    int ret = -1;
+
+    NVM_MUTEX_ACQUIRE(&allocator->extend_lock);
+
+    uint32_t count = allocator->region_count;
+    if (count >= NVM_MAX_REGIONS) {
+        LOG_ERR("Region table full (%d regions).", NVM_MAX_REGIONS);
+        goto out_unlock;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        const NvmRegion* region = &allocator->regions[i];
+        if (offset < region->offset + region->size && region->offset < offset + usable) {
+            LOG_ERR("Region %p overlaps managed region #%u.", addr, i);
+            goto out_unlock;
+        }
+    }
+
+    allocator->regions[count] = (NvmRegion){ offset, usable, heap };
+    __atomic_store_n(&allocator->region_count, count + 1, __ATOMIC_RELEASE);
+
+    if (space_manager_add_range(allocator->central_heaps[heap].space_manager, offset, usable) != 0) {
+        // 空间尚未交付，撤回表项是安全的
+        __atomic_store_n(&allocator->region_count, count, __ATOMIC_RELEASE);
+        goto out_unlock;
+    }
+    ret = 0;
+
+out_unlock:
+    NVM_MUTEX_RELEASE(&allocator->extend_lock);
+    return ret;
 }
 
+// 根据持久化的 Slab 镜像重建 DRAM 元数据，恢复出的 Slab 挂载到 CPU 0
+static int rebuild_from_log(NvmAllocator* allocator) {
+    NvmCentralHeap* central = &allocator->central_heaps[0];
+    int meta_node = allocator->central_heaps[allocator->cpu_heaps[0].home_heap].numa_node;
+
+    for (uint32_t i = 0; i < nvm_log_slab_count(allocator->log); ++i) {
+        uint8_t sc;
+        const unsigned char* bitmap;
+        if (nvm_log_slab_image(allocator->log, i, &sc, &bitmap) != 0 || sc >= SC_COUNT) continue;
+
+        uint64_t slab_base = central->range_offset + (uint64_t)i * NVM_SLAB_SIZE;
+        if (space_manager_alloc_at_offset(central->space_manager, slab_base) != 0) {
+            LOG_ERR("Rebuild failed: Space occupied at 0x%llx.", (unsigned long long)slab_base);
+            return -1;
+        }
+
+        NvmSlab* slab = create_persistent_slab(allocator, (SizeClassID)sc, slab_base, meta_node);
+        if (!slab || slab_hashtable_insert(central->slab_lookup_table, slab_base, slab) != 0) {
+            nvm_slab_destroy(slab);
+            space_manager_free_slab(central->space_manager, slab_base);
+            return -1;
+        }
+        slab->owner_cpu = 0;
+        slab->heap_cpu = 0;
+        slab->next_in_chain = allocator->cpu_heaps[0].slab_lists[sc];
+        allocator->cpu_heaps[0].slab_lists[sc] = slab;
+
+        for (uint32_t byte = 0; byte < (slab->total_block_count + 7) / 8; ++byte) {
+            if (!bitmap[byte]) continue;
+            for (uint32_t bit = 0; bit < 8; ++bit) {
+                if (bitmap[byte] & (1u << bit)) {
+                    nvm_slab_set_bitmap_at_idx(slab, byte * 8 + bit);
+                }
+            }
+        }
+    }
+    return 0;
+}
 
 // ============================================================================
 //                          调试与监控 API 实现
@@ -296,21 +1636,670 @@ void nvm_allocator_debug_print(void) {
         return;
     }
 
-    NvmCentralHeap* central = &global_nvm_allocator->central_heap;
-
     printf("================================================================\n");
     printf("                  NVM Allocator Debug Dump                      \n");
     printf("================================================================\n");
     
-    printf("Global Info:\n");
-    printf("  NVM Base Address : %p\n", central->nvm_base_addr);
-    
-    // 修改处：传入基地址，并且 verbose 设为 true
-    if (central->slab_lookup_table) {
-        slab_hashtable_print_layout(central->slab_lookup_table, central->nvm_base_addr, true);
-    } else {
-        printf("[NvmAllocator] Warning: Hash table is NULL.\n");
+    for (int i = 0; i < global_nvm_allocator->central_heap_count; ++i) {
+        NvmCentralHeap* central = &global_nvm_allocator->central_heaps[i];
+
+        printf("Central Heap #%d:\n", i);
+        printf("  NVM Base Address : %p\n", central->nvm_base_addr);
+        printf("  Range            : [0x%llx, 0x%llx) NUMA Node %d\n",
+               (unsigned long long)central->range_offset,
+               (unsigned long long)(central->range_offset + central->range_size),
+               central->numa_node);
+        for (uint32_t r = 0; r < global_nvm_allocator->region_count; ++r) {
+            const NvmRegion* region = &global_nvm_allocator->regions[r];
+            if (region->heap != i) continue;
+            printf("  Region #%-2u       : %p (%llu bytes)\n", r,
+                   (void*)((char*)central->nvm_base_addr + region->offset),
+                   (unsigned long long)region->size);
+        }
+
+        // 传入基地址，并且 verbose 设为 true
+        if (central->slab_lookup_table) {
+            slab_hashtable_print_layout(central->slab_lookup_table, central->nvm_base_addr, true);
+        } else {
+            printf("[NvmAllocator] Warning: Hash table is NULL.\n");
+        }
     }
 
     printf("================================================================\n");
-}
\ No newline at end of file
+}
+
+int nvm_heap_snapshot(int fd) {
+    if (!global_nvm_allocator) {
+        LOG_ERR("Allocator is not initialized.");
+        return -1;
+    }
+    return heap_snapshot_impl(global_nvm_allocator, fd);
+}
+
+static int heap_snapshot_impl(NvmAllocator* allocator, int fd) {
+    SnapshotContext ctx;
+    ctx.bitmap = (unsigned char*)malloc(NVM_SNAPSHOT_BITMAP_BYTES);
+    if (!ctx.bitmap) {
+        LOG_ERR("Failed to allocate snapshot bitmap buffer.");
+        return -1;
+    }
+    ctx.writer = nvm_snapshot_writer_create(fd, (uint32_t)allocator->central_heap_count);
+    if (!ctx.writer) {
+        free(ctx.bitmap);
+        return -1;
+    }
+
+    for (int i = 0; i < allocator->central_heap_count; ++i) {
+        NvmCentralHeap* central = &allocator->central_heaps[i];
+        nvm_snapshot_write_heap(ctx.writer, (uint32_t)i, central->numa_node,
+                                central->range_offset, central->range_size);
+        slab_hashtable_for_each(central->slab_lookup_table, snapshot_visit_slab, &ctx);
+        space_manager_for_each_extent(central->space_manager, snapshot_visit_extent, ctx.writer);
+    }
+
+    free(ctx.bitmap);
+    return nvm_snapshot_writer_finish(ctx.writer);
+}
+
+static void snapshot_visit_slab(uint64_t nvm_offset, NvmSlab* slab, void* ctx) {
+    SnapshotContext* snap = (SnapshotContext*)ctx;
+
+    // 易失模式没有位图，只记录占用数
+    int used = nvm_slab_copy_live_bitmap(slab, snap->bitmap);
+    if (used < 0) {
+        nvm_snapshot_write_slab(snap->writer, nvm_offset, (SizeClassID)slab->size_type_id,
+                                slab->total_block_count, nvm_slab_used_blocks(slab), NULL);
+    } else {
+        nvm_snapshot_write_slab(snap->writer, nvm_offset, (SizeClassID)slab->size_type_id,
+                                slab->total_block_count, (uint32_t)used, snap->bitmap);
+    }
+}
+
+static void snapshot_visit_extent(uint64_t offset, uint64_t size, void* ctx) {
+    nvm_snapshot_write_extent((NvmSnapshotWriter*)ctx, offset, size);
+}
+
+// ============================================================================
+//                          控制与查询命名空间 (nvm_ctl)
+// ============================================================================
+
+int nvm_ctl(const char* name, void* oldp, size_t* oldlenp, const void* newp, size_t newlen) {
+    if (global_nvm_allocator == NULL) {
+        LOG_ERR("Allocator not initialized.");
+        return -1;
+    }
+    if (!name) return -1;
+
+    uint32_t index[NVM_CTL_MAX_INDEX] = { 0 };
+    const CtlNode* node = ctl_lookup(name, index);
+    if (!node) {
+        LOG_ERR("Unknown ctl name '%s'.", name);
+        return -1;
+    }
+    return ctl_dispatch(global_nvm_allocator, name, node, index, oldp, oldlenp, newp, newlen);
+}
+
+static size_t ctl_type_size(CtlType type) {
+    switch (type) {
+        case CTL_U32: return sizeof(uint32_t);
+        case CTL_STR: return sizeof(const char*);
+        default:      return sizeof(uint64_t);
+    }
+}
+
+// 先读出旧值再写入新值；普通节点只在调用方要旧值时才读取 (统计需要遍历)
+static int ctl_dispatch(NvmAllocator* allocator, const char* name, const CtlNode* node,
+                        const uint32_t* index, void* oldp, size_t* oldlenp,
+                        const void* newp, size_t newlen) {
+    size_t size = ctl_type_size(node->type);
+    if (newp && !node->set) {
+        LOG_ERR("ctl '%s' is read-only.", name);
+        return -1;
+    }
+    if ((newp && newlen != size) || (oldp && (!oldlenp || *oldlenp != size))) {
+        LOG_ERR("ctl '%s' expects a %zu-byte value.", name, size);
+        return -1;
+    }
+
+    union {
+        uint32_t    u32;
+        uint64_t    u64;
+        const char* str;
+    } value = { 0 };
+    if ((oldp || node->type == CTL_ACTION) && node->get(allocator, index, &value) != 0) return -1;
+
+    if (oldp) {
+        memcpy(oldp, &value, size);
+    } else if (oldlenp) {
+        *oldlenp = size;
+    }
+    return newp ? node->set(allocator, index, newp) : 0;
+}
+
+static bool ctl_match(const char* pattern, const char* name, uint32_t* index) {
+    int count = 0;
+    while (*pattern && *name) {
+        if (*pattern == '#') {
+            if (*name < '0' || *name > '9' || count == NVM_CTL_MAX_INDEX) return false;
+            uint64_t value = 0;
+            for (; *name >= '0' && *name <= '9'; ++name) {
+                value = value * 10 + (uint64_t)(*name - '0');
+                if (value > UINT32_MAX) return false;
+            }
+            index[count++] = (uint32_t)value;
+            pattern++;
+            continue;
+        }
+        if (*pattern++ != *name++) return false;
+    }
+    return *pattern == '\0' && *name == '\0';
+}
+
+// ---------------------------------------------------------------------------
+// opt.*
+// ---------------------------------------------------------------------------
+
+static int ctl_get_heap_count(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)index;
+    *(uint32_t*)out = allocator->heap_count;
+    return 0;
+}
+
+static int ctl_get_slab_size(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)allocator; (void)index;
+    *(uint64_t*)out = NVM_SLAB_SIZE;
+    return 0;
+}
+
+static int ctl_get_spinlock(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)allocator; (void)index;
+    *(const char**)out = NVM_SPINLOCK_BACKEND_NAME;
+    return 0;
+}
+
+static int ctl_get_mutex(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)allocator; (void)index;
+    *(const char**)out = NVM_MUTEX_BACKEND_NAME;
+    return 0;
+}
+
+static int ctl_get_rwlock(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)allocator; (void)index;
+    *(const char**)out = NVM_RWLOCK_BACKEND_NAME;
+    return 0;
+}
+
+static int ctl_get_slab_engine(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)index;
+    *(const char**)out = allocator->atomic_mode ? "atomic" : "locked";
+    return 0;
+}
+
+static int ctl_get_cache_depth(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)allocator; (void)index;
+    nvm_slab_get_cache_params((uint32_t*)out, NULL);
+    return 0;
+}
+
+static int ctl_set_cache_depth(NvmAllocator* allocator, const uint32_t* index, const void* in) {
+    (void)allocator; (void)index;
+    uint32_t batch;
+    nvm_slab_get_cache_params(NULL, &batch);
+    return nvm_slab_set_cache_params(*(const uint32_t*)in, batch);
+}
+
+static int ctl_get_cache_batch(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)allocator; (void)index;
+    nvm_slab_get_cache_params(NULL, (uint32_t*)out);
+    return 0;
+}
+
+static int ctl_set_cache_batch(NvmAllocator* allocator, const uint32_t* index, const void* in) {
+    (void)allocator; (void)index;
+    uint32_t depth;
+    nvm_slab_get_cache_params(&depth, NULL);
+    return nvm_slab_set_cache_params(depth, *(const uint32_t*)in);
+}
+
+static int ctl_get_depot_keep(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)index;
+    *(uint32_t*)out = __atomic_load_n(&allocator->depot_keep, __ATOMIC_RELAXED);
+    return 0;
+}
+
+static int ctl_set_depot_keep(NvmAllocator* allocator, const uint32_t* index, const void* in) {
+    (void)index;
+    __atomic_store_n(&allocator->depot_keep, *(const uint32_t*)in, __ATOMIC_RELAXED);
+    return 0;
+}
+
+static int ctl_get_depot_trim_interval(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)index;
+    *(uint32_t*)out = __atomic_load_n(&allocator->depot_trim_interval, __ATOMIC_RELAXED);
+    return 0;
+}
+
+static int ctl_set_depot_trim_interval(NvmAllocator* allocator, const uint32_t* index, const void* in) {
+    (void)index;
+    uint32_t interval = *(const uint32_t*)in;
+    if (interval == 0) {
+        LOG_ERR("depot_trim_interval must be positive.");
+        return -1;
+    }
+    __atomic_store_n(&allocator->depot_trim_interval, interval, __ATOMIC_RELAXED);
+    return 0;
+}
+
+static int ctl_get_epoch_reclaim_batch(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)allocator; (void)index;
+    *(uint32_t*)out = nvm_epoch_get_reclaim_batch();
+    return 0;
+}
+
+static int ctl_set_epoch_reclaim_batch(NvmAllocator* allocator, const uint32_t* index, const void* in) {
+    (void)allocator; (void)index;
+    return nvm_epoch_set_reclaim_batch(*(const uint32_t*)in);
+}
+
+static int ctl_get_prefault_pct(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)index;
+    *(uint32_t*)out = __atomic_load_n(&allocator->prefault_pct, __ATOMIC_RELAXED);
+    return 0;
+}
+
+static int ctl_set_prefault_pct(NvmAllocator* allocator, const uint32_t* index, const void* in) {
+    (void)allocator; (void)index;
+    return nvm_allocator_set_prefault(*(const uint32_t*)in);
+}
+
+static int ctl_get_zero_pool_depth(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)index;
+    *(uint32_t*)out = __atomic_load_n(&allocator->zero_pool_depth, __ATOMIC_RELAXED);
+    return 0;
+}
+
+static int ctl_set_zero_pool_depth(NvmAllocator* allocator, const uint32_t* index, const void* in) {
+    (void)allocator; (void)index;
+    return nvm_allocator_set_zero_pool_depth(*(const uint32_t*)in);
+}
+
+static int ctl_get_deferred_reclaim_ms(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)index;
+    *(uint32_t*)out = __atomic_load_n(&allocator->deferred_reclaim_ms, __ATOMIC_RELAXED);
+    return 0;
+}
+
+static int ctl_set_deferred_reclaim_ms(NvmAllocator* allocator, const uint32_t* index, const void* in) {
+    (void)allocator; (void)index;
+    return nvm_allocator_set_deferred_reclaim(*(const uint32_t*)in);
+}
+
+static int ctl_get_remote_batch(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)index;
+    *(uint32_t*)out = remote_batch_get_group_size(allocator->remote);
+    return 0;
+}
+
+static int ctl_set_remote_batch(NvmAllocator* allocator, const uint32_t* index, const void* in) {
+    (void)index;
+    return remote_batch_set_group_size(allocator->remote, *(const uint32_t*)in);
+}
+
+static int ctl_get_remote_flush_ms(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)index;
+    *(uint32_t*)out = remote_batch_get_flusher(allocator->remote);
+    return 0;
+}
+
+static int ctl_set_remote_flush_ms(NvmAllocator* allocator, const uint32_t* index, const void* in) {
+    (void)index;
+    return remote_batch_set_flusher(allocator->remote, *(const uint32_t*)in);
+}
+
+static int ctl_get_provision_ahead(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)index;
+    *(uint32_t*)out = __atomic_load_n(&allocator->provisioner.slabs_ahead, __ATOMIC_RELAXED);
+    return 0;
+}
+
+static int ctl_set_provision_ahead(NvmAllocator* allocator, const uint32_t* index, const void* in) {
+    (void)index;
+    NVM_MUTEX_ACQUIRE(&allocator->provisioner.lock);
+    uint32_t interval_ms = allocator->provisioner.interval_ms;
+    NVM_MUTEX_RELEASE(&allocator->provisioner.lock);
+    return nvm_allocator_set_provisioning(*(const uint32_t*)in, interval_ms);
+}
+
+static int ctl_get_provision_interval(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)index;
+    NVM_MUTEX_ACQUIRE(&allocator->provisioner.lock);
+    uint32_t interval_ms = allocator->provisioner.interval_ms;
+    NVM_MUTEX_RELEASE(&allocator->provisioner.lock);
+    *(uint32_t*)out = interval_ms ? interval_ms : NVM_PROVISION_DEFAULT_INTERVAL_MS;
+    return 0;
+}
+
+// 预备线程未运行时只记下间隔，下次启动时生效
+static int ctl_set_provision_interval(NvmAllocator* allocator, const uint32_t* index, const void* in) {
+    (void)index;
+    uint32_t interval_ms = *(const uint32_t*)in;
+    uint32_t slabs_ahead = __atomic_load_n(&allocator->provisioner.slabs_ahead, __ATOMIC_RELAXED);
+    if (slabs_ahead) return nvm_allocator_set_provisioning(slabs_ahead, interval_ms);
+
+    NVM_MUTEX_ACQUIRE(&allocator->provisioner.lock);
+    allocator->provisioner.interval_ms = interval_ms;
+    NVM_MUTEX_RELEASE(&allocator->provisioner.lock);
+    return 0;
+}
+
+static int ctl_get_placement(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)index;
+    *(uint32_t*)out = (uint32_t)__atomic_load_n(&allocator->placement_mode, __ATOMIC_RELAXED);
+    return 0;
+}
+
+static int ctl_set_placement(NvmAllocator* allocator, const uint32_t* index, const void* in) {
+    (void)allocator; (void)index;
+    return nvm_allocator_set_placement_mode((NvmPlacementMode)*(const uint32_t*)in);
+}
+
+// ---------------------------------------------------------------------------
+// stats.*
+// ---------------------------------------------------------------------------
+
+static void class_stats_visit_slab(uint64_t nvm_offset, NvmSlab* slab, void* ctx) {
+    (void)nvm_offset;
+    ClassStatsContext* stats = (ClassStatsContext*)ctx;
+    SizeClassID sc = (SizeClassID)slab->size_type_id;
+    stats->slabs[sc]++;
+    stats->active[sc] += nvm_slab_used_blocks(slab);
+    stats->capacity[sc] += slab->total_block_count;
+}
+
+static void count_visit_slab(uint64_t nvm_offset, NvmSlab* slab, void* ctx) {
+    (void)nvm_offset; (void)slab; (void)ctx;
+}
+
+// 与快照相同，哈希表无锁遍历，结果不是某一时刻的精确切面
+static int collect_class_stats(NvmAllocator* allocator, uint32_t sc, ClassStatsContext* stats) {
+    if (sc >= SC_COUNT) {
+        LOG_ERR("Invalid size class: %u", sc);
+        return -1;
+    }
+    memset(stats, 0, sizeof(*stats));
+    for (int i = 0; i < allocator->central_heap_count; ++i) {
+        slab_hashtable_for_each(allocator->central_heaps[i].slab_lookup_table, class_stats_visit_slab, stats);
+    }
+    return 0;
+}
+
+static int ctl_get_class_slabs(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    ClassStatsContext stats;
+    if (collect_class_stats(allocator, index[0], &stats) != 0) return -1;
+    *(uint64_t*)out = stats.slabs[index[0]];
+    return 0;
+}
+
+static int ctl_get_class_active(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    ClassStatsContext stats;
+    if (collect_class_stats(allocator, index[0], &stats) != 0) return -1;
+    *(uint64_t*)out = stats.active[index[0]];
+    return 0;
+}
+
+static int ctl_get_class_capacity(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    ClassStatsContext stats;
+    if (collect_class_stats(allocator, index[0], &stats) != 0) return -1;
+    *(uint64_t*)out = stats.capacity[index[0]];
+    return 0;
+}
+
+static int ctl_get_class_allocs(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    if (index[0] >= SC_COUNT) {
+        LOG_ERR("Invalid size class: %u", index[0]);
+        return -1;
+    }
+    uint64_t allocs = 0;
+    for (uint32_t heap = 0; heap < allocator->heap_count; ++heap) {
+        allocs += __atomic_load_n(&allocator->cpu_heaps[heap].class_allocs[index[0]], __ATOMIC_RELAXED);
+    }
+    *(uint64_t*)out = allocs;
+    return 0;
+}
+
+static int ctl_get_class_depot(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    if (index[0] >= SC_COUNT) {
+        LOG_ERR("Invalid size class: %u", index[0]);
+        return -1;
+    }
+    *(uint64_t*)out = __atomic_load_n(&allocator->depots[index[0]].count, __ATOMIC_RELAXED);
+    return 0;
+}
+
+static int ctl_get_heap_slabs(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    if (index[0] >= (uint32_t)allocator->central_heap_count) {
+        LOG_ERR("Invalid central heap: %u", index[0]);
+        return -1;
+    }
+    *(uint64_t*)out = slab_hashtable_for_each(allocator->central_heaps[index[0]].slab_lookup_table,
+                                              count_visit_slab, NULL);
+    return 0;
+}
+
+static int ctl_get_heap_free_bytes(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    if (index[0] >= (uint32_t)allocator->central_heap_count) {
+        LOG_ERR("Invalid central heap: %u", index[0]);
+        return -1;
+    }
+    *(uint64_t*)out = space_manager_free_bytes(allocator->central_heaps[index[0]].space_manager);
+    return 0;
+}
+
+static int ctl_get_slabs(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)index;
+    uint64_t slabs = 0;
+    for (int i = 0; i < allocator->central_heap_count; ++i) {
+        slabs += slab_hashtable_for_each(allocator->central_heaps[i].slab_lookup_table, count_visit_slab, NULL);
+    }
+    *(uint64_t*)out = slabs;
+    return 0;
+}
+
+static int ctl_get_free_bytes(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)index;
+    uint64_t free_bytes = 0;
+    for (int i = 0; i < allocator->central_heap_count; ++i) {
+        free_bytes += space_manager_free_bytes(allocator->central_heaps[i].space_manager);
+    }
+    *(uint64_t*)out = free_bytes;
+    return 0;
+}
+
+static int ctl_get_slow_path_hits(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)index;
+    *(uint64_t*)out = __atomic_load_n(&allocator->slow_path_hits, __ATOMIC_RELAXED);
+    return 0;
+}
+
+static int ctl_get_provisioned(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)index;
+    *(uint64_t*)out = __atomic_load_n(&allocator->provisioner.provisioned, __ATOMIC_RELAXED);
+    return 0;
+}
+
+static int ctl_get_epoch_pending(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)allocator; (void)index;
+    *(uint64_t*)out = nvm_epoch_pending();
+    return 0;
+}
+
+static int ctl_get_remote_frees(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)index;
+    remote_batch_stats(allocator->remote, (uint64_t*)out, NULL);
+    return 0;
+}
+
+static int ctl_get_remote_flushes(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)index;
+    remote_batch_stats(allocator->remote, NULL, (uint64_t*)out);
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// heap.* (动作)
+// ---------------------------------------------------------------------------
+
+static int ctl_heap_of_cpu(NvmAllocator* allocator, uint32_t cpu) {
+    if (cpu >= MAX_CPUS) {
+        LOG_ERR("Invalid CPU id: %u", cpu);
+        return -1;
+    }
+    return heap_index_of_cpu(allocator, (int)cpu);
+}
+
+static int ctl_do_trim(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)index;
+    *(uint64_t*)out = (uint64_t)trim_impl(allocator);
+    return 0;
+}
+
+static int ctl_do_donate_partial(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)index;
+    NvmCpuHeap* cpu_heap = &allocator->cpu_heaps[heap_index_of_cpu(allocator, NVM_GET_CURRENT_CPU_ID())];
+    uint32_t before = 0, after = 0;
+    for (int sc = 0; sc < SC_COUNT; ++sc) before += __atomic_load_n(&allocator->depots[sc].count, __ATOMIC_RELAXED);
+    NVM_SPINLOCK_ACQUIRE(&cpu_heap->lock);
+    donate_partial_slabs(allocator, cpu_heap, 0);
+    NVM_SPINLOCK_RELEASE(&cpu_heap->lock);
+    for (int sc = 0; sc < SC_COUNT; ++sc) after += __atomic_load_n(&allocator->depots[sc].count, __ATOMIC_RELAXED);
+    // 其他线程可能同时窃取，差值只是近似
+    *(uint64_t*)out = after > before ? after - before : 0;
+    return 0;
+}
+
+static int ctl_do_deferred_flush(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)index;
+    *(uint64_t*)out = deferred_free_flush_all(allocator->deferred);
+    return 0;
+}
+
+static int ctl_do_remote_flush(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)index;
+    *(uint64_t*)out = remote_batch_flush_all(allocator->remote);
+    return 0;
+}
+
+static int ctl_do_epoch_reclaim(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)allocator; (void)index;
+    *(uint64_t*)out = nvm_epoch_reclaim();
+    return 0;
+}
+
+static int ctl_do_checkpoint(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    (void)index;
+    if (!allocator->log) {
+        LOG_ERR("Log metadata not enabled.");
+        return -1;
+    }
+    nvm_log_checkpoint(allocator->log);
+    *(uint64_t*)out = 0;
+    return 0;
+}
+
+// 只归还该 CPU 堆中的空 Slab，未满 Slab 保留在本地
+static int ctl_do_cpu_trim(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    int heap = ctl_heap_of_cpu(allocator, index[0]);
+    if (heap < 0) return -1;
+
+    NvmCpuHeap* cpu_heap = &allocator->cpu_heaps[heap];
+    NvmSlab* empty = NULL;
+    NVM_SPINLOCK_ACQUIRE(&cpu_heap->lock);
+    for (int sc = 0; sc < SC_COUNT; ++sc) {
+        unlink_empty_slabs(&cpu_heap->slab_lists[sc], &empty);
+    }
+    NVM_SPINLOCK_RELEASE(&cpu_heap->lock);
+
+    *(uint64_t*)out = release_empty_slabs(allocator, empty);
+    return 0;
+}
+
+static int ctl_do_cpu_drain(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    int heap = ctl_heap_of_cpu(allocator, index[0]);
+    if (heap < 0) return -1;
+    *(uint64_t*)out = (uint64_t)drain_cpu_heap(allocator, heap);
+    return 0;
+}
+
+static int ctl_get_cpu_slabs(NvmAllocator* allocator, const uint32_t* index, void* out) {
+    int heap = ctl_heap_of_cpu(allocator, index[0]);
+    if (heap < 0) return -1;
+
+    NvmCpuHeap* cpu_heap = &allocator->cpu_heaps[heap];
+    uint64_t slabs = 0;
+    NVM_SPINLOCK_ACQUIRE(&cpu_heap->lock);
+    for (int sc = 0; sc < SC_COUNT; ++sc) {
+        for (NvmSlab* slab = cpu_heap->slab_lists[sc]; slab; slab = slab->next_in_chain) slabs++;
+    }
+    NVM_SPINLOCK_RELEASE(&cpu_heap->lock);
+
+    *(uint64_t*)out = slabs;
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// 名称表
+// ---------------------------------------------------------------------------
+
+static const CtlNode g_ctl_nodes[] = {
+    { "opt.heap_count",            CTL_U32,    ctl_get_heap_count,          NULL },
+    { "opt.slab_size",             CTL_U64,    ctl_get_slab_size,           NULL },
+    { "opt.spinlock",              CTL_STR,    ctl_get_spinlock,            NULL },
+    { "opt.mutex",                 CTL_STR,    ctl_get_mutex,               NULL },
+    { "opt.rwlock",                CTL_STR,    ctl_get_rwlock,              NULL },
+    { "opt.slab_engine",           CTL_STR,    ctl_get_slab_engine,         NULL },
+    { "opt.cache_depth",           CTL_U32,    ctl_get_cache_depth,         ctl_set_cache_depth },
+    { "opt.cache_batch",           CTL_U32,    ctl_get_cache_batch,         ctl_set_cache_batch },
+    { "opt.depot_keep",            CTL_U32,    ctl_get_depot_keep,          ctl_set_depot_keep },
+    { "opt.depot_trim_interval",   CTL_U32,    ctl_get_depot_trim_interval, ctl_set_depot_trim_interval },
+    { "opt.epoch_reclaim_batch",   CTL_U32,    ctl_get_epoch_reclaim_batch, ctl_set_epoch_reclaim_batch },
+    { "opt.prefault_pct",          CTL_U32,    ctl_get_prefault_pct,        ctl_set_prefault_pct },
+    { "opt.zero_pool_depth",       CTL_U32,    ctl_get_zero_pool_depth,     ctl_set_zero_pool_depth },
+    { "opt.deferred_reclaim_ms",   CTL_U32,    ctl_get_deferred_reclaim_ms, ctl_set_deferred_reclaim_ms },
+    { "opt.remote_batch",          CTL_U32,    ctl_get_remote_batch,        ctl_set_remote_batch },
+    { "opt.remote_flush_ms",       CTL_U32,    ctl_get_remote_flush_ms,     ctl_set_remote_flush_ms },
+    { "opt.provision.slabs_ahead", CTL_U32,    ctl_get_provision_ahead,     ctl_set_provision_ahead },
+    { "opt.provision.interval_ms", CTL_U32,    ctl_get_provision_interval,  ctl_set_provision_interval },
+    { "opt.placement",             CTL_U32,    ctl_get_placement,           ctl_set_placement },
+
+    { "stats.slabs",               CTL_U64,    ctl_get_slabs,               NULL },
+    { "stats.free_bytes",          CTL_U64,    ctl_get_free_bytes,          NULL },
+    { "stats.slow_path_hits",      CTL_U64,    ctl_get_slow_path_hits,      NULL },
+    { "stats.provisioned",         CTL_U64,    ctl_get_provisioned,         NULL },
+    { "stats.epoch_pending",       CTL_U64,    ctl_get_epoch_pending,       NULL },
+    { "stats.remote_batch.frees",  CTL_U64,    ctl_get_remote_frees,        NULL },
+    { "stats.remote_batch.flushes", CTL_U64,   ctl_get_remote_flushes,      NULL },
+    { "stats.class.#.slabs",       CTL_U64,    ctl_get_class_slabs,         NULL },
+    { "stats.class.#.active",      CTL_U64,    ctl_get_class_active,        NULL },
+    { "stats.class.#.capacity",    CTL_U64,    ctl_get_class_capacity,      NULL },
+    { "stats.class.#.allocs",      CTL_U64,    ctl_get_class_allocs,        NULL },
+    { "stats.class.#.depot",       CTL_U64,    ctl_get_class_depot,         NULL },
+    { "stats.heap.#.slabs",        CTL_U64,    ctl_get_heap_slabs,          NULL },
+    { "stats.heap.#.free_bytes",   CTL_U64,    ctl_get_heap_free_bytes,     NULL },
+
+    { "heap.trim",                 CTL_ACTION, ctl_do_trim,                 NULL },
+    { "heap.donate_partial",       CTL_ACTION, ctl_do_donate_partial,       NULL },
+    { "heap.deferred_flush",       CTL_ACTION, ctl_do_deferred_flush,       NULL },
+    { "heap.remote_flush",         CTL_ACTION, ctl_do_remote_flush,         NULL },
+    { "heap.epoch_reclaim",        CTL_ACTION, ctl_do_epoch_reclaim,        NULL },
+    { "heap.checkpoint",           CTL_ACTION, ctl_do_checkpoint,           NULL },
+    { "heap.cpu.#.trim",           CTL_ACTION, ctl_do_cpu_trim,             NULL },
+    { "heap.cpu.#.drain",          CTL_ACTION, ctl_do_cpu_drain,            NULL },
+    { "heap.cpu.#.slabs",          CTL_U64,    ctl_get_cpu_slabs,           NULL },
+};
+
+static const CtlNode* ctl_lookup(const char* name, uint32_t* index) {
+    for (size_t i = 0; i < sizeof(g_ctl_nodes) / sizeof(g_ctl_nodes[0]); ++i) {
+        if (ctl_match(g_ctl_nodes[i].pattern, name, index)) return &g_ctl_nodes[i];
+    }
+    return NULL;
+}
@@ -0,0 +1,225 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+
+#include "NvmDefs.h"
+#include "NvmConfig.h"
+#include "NvmEpoch.h"
+#include "NvmRemoteBatch.h"
+#include "NvmAllocator.h"
+
+// ============================================================================
+//                          常量定义
+// ============================================================================
+
+// 配置串中单个键或值的最大长度
+#define CONF_TOKEN_MAX 32
+
+// ============================================================================
+//                          核心数据结构
+// ============================================================================
+
+typedef enum {
+    CONF_U32,
+    CONF_U64,
+    CONF_NAME
+} ConfValueType;
+
+// 键名到字段的映射表
+typedef struct ConfKey {
+    const char*   name;
+    ConfValueType type;
+    size_t        offset;
+} ConfKey;
+
+#define CONF_FIELD(field, type) { #field, type, offsetof(NvmAllocatorConfig, field) }
+
+static const ConfKey g_conf_keys[] = {
+    CONF_FIELD(cache_depth,         CONF_U32),
+    CONF_FIELD(cache_batch,         CONF_U32),
+    CONF_FIELD(slab_size,           CONF_U64),
+    CONF_FIELD(heap_count,          CONF_U32),
+    CONF_FIELD(hashtable_capacity,  CONF_U32),
+    CONF_FIELD(depot_keep,          CONF_U32),
+    CONF_FIELD(depot_trim_interval, CONF_U32),
+    CONF_FIELD(epoch_reclaim_batch, CONF_U32),
+    CONF_FIELD(remote_batch,        CONF_U32),
+    CONF_FIELD(spinlock,            CONF_NAME),
+    CONF_FIELD(mutex,               CONF_NAME),
+    CONF_FIELD(rwlock,              CONF_NAME),
+};
+
+#define CONF_KEY_COUNT (sizeof(g_conf_keys) / sizeof(g_conf_keys[0]))
+
+// ============================================================================
+//                          内部函数前向声明
+// ============================================================================
+
+static int parse_number(const char* text, uint64_t* out);
+static int parse_pair(const char* key, const char* value, NvmAllocatorConfig* config);
+static int check_backend(const char* kind, const char* wanted, const char* compiled);
+
+// ============================================================================
+//                          公共 API 实现
+// ============================================================================
+
+void nvm_allocator_config_default(NvmAllocatorConfig* config) {
+    if (!config) return;
+    memset(config, 0, sizeof(*config));
+    config->cache_depth         = SLAB_CACHE_SIZE;
+    config->cache_batch         = SLAB_CACHE_BATCH_SIZE;
+    config->slab_size           = NVM_SLAB_SIZE;
+    config->heap_count          = MAX_CPUS;
+    config->hashtable_capacity  = INITIAL_HASHTABLE_CAPACITY;
+    config->depot_keep          = NVM_DEPOT_CPU_KEEP;
+    config->depot_trim_interval = NVM_DEPOT_TRIM_INTERVAL;
+    config->epoch_reclaim_batch = NVM_EPOCH_RECLAIM_BATCH;
+    config->remote_batch        = NVM_REMOTE_BATCH_DEFAULT;
+}
+
+int nvm_allocator_config_parse(const char* conf, NvmAllocatorConfig* config) {
+    if (!conf || !config) return -1;
+
+    // 先解析到副本，任一项出错时调用方的配置保持不变
+    NvmAllocatorConfig parsed = *config;
+    const char* p = conf;
+    while (*p) {
+        const char* end = strchr(p, ',');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        if (len > 0) {
+            const char* colon = memchr(p, ':', len);
+            size_t key_len = colon ? (size_t)(colon - p) : 0;
+            size_t value_len = colon ? len - key_len - 1 : 0;
+            if (!colon || key_len == 0 || value_len == 0 ||
+                key_len >= CONF_TOKEN_MAX || value_len >= CONF_TOKEN_MAX) {
+                LOG_ERR("Malformed allocator config entry: '%.*s'.", (int)len, p);
+                return -1;
+            }
+            char key[CONF_TOKEN_MAX], value[CONF_TOKEN_MAX];
+            memcpy(key, p, key_len);
+            key[key_len] = '\0';
+            memcpy(value, colon + 1, value_len);
+            value[value_len] = '\0';
+            if (parse_pair(key, value, &parsed) != 0) return -1;
+        }
+        if (!end) break;
+        p = end + 1;
+    }
+
+    *config = parsed;
+    return 0;
+}
+
+int nvm_allocator_config_apply_env(NvmAllocatorConfig* config) {
+    const char* conf = getenv(NVM_MALLOC_CONF_ENV);
+    if (!conf) return 0;
+    if (nvm_allocator_config_parse(conf, config) != 0) {
+        LOG_ERR("Invalid %s: '%s'.", NVM_MALLOC_CONF_ENV, conf);
+        return -1;
+    }
+    return 0;
+}
+
+int nvm_allocator_config_validate(const NvmAllocatorConfig* config) {
+    if (!config) return -1;
+
+    if (config->slab_size != 0 && config->slab_size != NVM_SLAB_SIZE) {
+        LOG_ERR("slab_size %llu differs from the compiled slab size %u.",
+                (unsigned long long)config->slab_size, NVM_SLAB_SIZE);
+        return -1;
+    }
+    if (config->cache_depth > SLAB_CACHE_MAX_SIZE || config->cache_batch == 0 ||
+        config->cache_batch >= config->cache_depth) {
+        LOG_ERR("Invalid cache_depth/cache_batch: %u/%u (max depth %u).",
+                config->cache_depth, config->cache_batch, SLAB_CACHE_MAX_SIZE);
+        return -1;
+    }
+    if (config->heap_count == 0 || config->heap_count > MAX_CPUS) {
+        LOG_ERR("heap_count %u out of range [1, %d].", config->heap_count, MAX_CPUS);
+        return -1;
+    }
+    if (config->hashtable_capacity == 0 || config->depot_trim_interval == 0 ||
+        config->epoch_reclaim_batch == 0) {
+        LOG_ERR("hashtable_capacity, depot_trim_interval and epoch_reclaim_batch must be positive.");
+        return -1;
+    }
+    if (config->remote_batch > NVM_REMOTE_BATCH_MAX) {
+        LOG_ERR("remote_batch %u exceeds %u.", config->remote_batch, NVM_REMOTE_BATCH_MAX);
+        return -1;
+    }
+    if (check_backend("spinlock", config->spinlock, NVM_SPINLOCK_BACKEND_NAME) != 0 ||
+        check_backend("mutex", config->mutex, NVM_MUTEX_BACKEND_NAME) != 0 ||
+        check_backend("rwlock", config->rwlock, NVM_RWLOCK_BACKEND_NAME) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// ============================================================================
+//                          内部辅助函数实现
+// ============================================================================
+
+// 十进制或 0x 十六进制，可带 k/m/g 后缀 (1024 进制)
+static int parse_number(const char* text, uint64_t* out) {
+    if (*text == '-') return -1;
+    errno = 0;
+    char* end = NULL;
+    unsigned long long value = strtoull(text, &end, 0);
+    if (errno != 0 || end == text) return -1;
+
+    unsigned shift = 0;
+    switch (*end) {
+        case '\0':           break;
+        case 'k': case 'K':  shift = 10; end++; break;
+        case 'm': case 'M':  shift = 20; end++; break;
+        case 'g': case 'G':  shift = 30; end++; break;
+        default:             return -1;
+    }
+    if (*end != '\0' || (shift && value > (UINT64_MAX >> shift))) return -1;
+
+    *out = (uint64_t)value << shift;
+    return 0;
+}
+
+static int parse_pair(const char* key, const char* value, NvmAllocatorConfig* config) {
+    for (size_t i = 0; i < CONF_KEY_COUNT; ++i) {
+        const ConfKey* entry = &g_conf_keys[i];
+        if (strcmp(entry->name, key) != 0) continue;
+
+        void* field = (char*)config + entry->offset;
+        if (entry->type == CONF_NAME) {
+            if (strlen(value) >= sizeof(config->spinlock)) {
+                LOG_ERR("Backend name too long for allocator config '%s'.", key);
+                return -1;
+            }
+            strcpy((char*)field, value);
+            return 0;
+        }
+
+        uint64_t number;
+        if (parse_number(value, &number) != 0 ||
+            (entry->type == CONF_U32 && number > UINT32_MAX)) {
+            LOG_ERR("Invalid value for allocator config '%s': '%s'.", key, value);
+            return -1;
+        }
+        if (entry->type == CONF_U32) {
+            *(uint32_t*)field = (uint32_t)number;
+        } else {
+            *(uint64_t*)field = number;
+        }
+        return 0;
+    }
+
+    LOG_ERR("Unknown allocator config key '%s'.", key);
+    return -1;
+}
+
+static int check_backend(const char* kind, const char* wanted, const char* compiled) {
+    if (wanted[0] == '\0' || strcmp(wanted, compiled) == 0) return 0;
+    LOG_ERR("%s backend '%s' requested, but this build uses '%s' (selected at compile time).",
+            kind, wanted, compiled);
+    return -1;
+}
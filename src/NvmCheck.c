@@ -0,0 +1,491 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "NvmDefs.h"
+#include "NvmLog.h"
+#include "NvmPersist.h"
+#include "NvmCheck.h"
+
+// ============================================================================
+//                          常量定义
+// ============================================================================
+
+// Slab 镜像位图字节数 (按最小块 8B 计)
+#define CHECK_BITMAP_BYTES   (NVM_SLAB_SIZE / 8 / 8)
+
+// ============================================================================
+//                          核心数据结构
+// ============================================================================
+
+// 重放用的记录 (附带所属日志与顺序)
+typedef struct CheckRecord {
+    uint64_t block_offset;
+    uint32_t slab_idx;
+    uint32_t block_idx;
+    uint32_t seq;              // 在所属 CPU 日志中的位置
+    uint8_t  cpu;
+    uint8_t  sc_id;
+    uint8_t  op;
+} CheckRecord;
+
+// 重放时块状态的稀疏覆盖层 (开放寻址)，只记录被日志触及的块
+typedef struct BlockOverlay {
+    uint32_t* keys;            // 块索引 + 1 (0 表示空槽)
+    uint8_t*  states;
+    uint32_t  mask;
+    uint32_t* touched;         // 已占用槽位，便于按组清空
+    uint32_t  touched_count;
+} BlockOverlay;
+
+// 扫描线程的分段与局部结果
+typedef struct ScanTask {
+    void*              meta;
+    uint32_t           begin;
+    uint32_t           end;
+    bool               repair;
+    const uint32_t*    referenced;         // 日志触及的 Slab 序号 (升序)
+    uint32_t           referenced_count;
+    NvmCheckReport     partial;
+
+    // 空闲区间拼接信息
+    uint64_t           leading_free;       // 段首连续空闲数
+    uint64_t           trailing_free;      // 段尾连续空闲数
+    bool               all_free;
+} ScanTask;
+
+// ============================================================================
+//                          内部函数前向声明
+// ============================================================================
+
+static int      collect_records(void* meta, const NvmLogLayout* layout, CheckRecord** out, uint32_t* out_count,
+                                NvmCheckReport* report);
+static int      compare_records(const void* a, const void* b);
+static int      compare_u32(const void* a, const void* b);
+static int      replay_records(void* meta, CheckRecord* recs, uint32_t count, NvmCheckReport* report);
+static void     replay_slab(void* meta, const CheckRecord* recs, uint32_t count, BlockOverlay* overlay,
+                            NvmCheckReport* report);
+static uint8_t* overlay_slot(BlockOverlay* overlay, uint32_t block_idx, bool* found);
+static void     overlay_clear(BlockOverlay* overlay);
+static void*    scan_worker_main(void* arg);
+static void     scan_slab(ScanTask* task, uint32_t slab_idx, bool* is_free);
+static uint64_t count_bits(const unsigned char* bitmap, uint32_t bytes);
+static void     merge_report(NvmCheckReport* dst, const NvmCheckReport* src);
+static uint32_t default_worker_count(void);
+
+// ============================================================================
+//                          公共 API 实现
+// ============================================================================
+
+int nvm_check_pool(void* pool_base, uint64_t pool_size, const NvmCheckOptions* opts, NvmCheckReport* out) {
+    if (!pool_base || !out) return -1;
+    memset(out, 0, sizeof(*out));
+
+    NvmLogLayout layout;
+    if (nvm_log_inspect_layout(pool_base, pool_size, &layout) != 0) {
+        LOG_ERR("Pool header is invalid or does not match the pool size.");
+        return -1;
+    }
+    out->data_offset = layout.data_offset;
+    out->data_size   = layout.data_size;
+    out->slab_count  = layout.slab_count;
+
+    bool repair = opts && opts->repair;
+    uint32_t workers = (opts && opts->workers) ? opts->workers : default_worker_count();
+    if (workers > MAX_CPUS) workers = MAX_CPUS;
+    if (workers > layout.slab_count) workers = layout.slab_count ? layout.slab_count : 1;
+
+    int ret = -1;
+    CheckRecord* recs = NULL;
+    uint32_t rec_count = 0;
+    uint32_t* referenced = NULL;
+    uint32_t referenced_count = 0;
+    ScanTask* tasks = NULL;
+    nvm_thread_t* threads = NULL;
+
+    // 1. 收集并重放日志尾部 (修复之前的原始状态)
+    if (collect_records(pool_base, &layout, &recs, &rec_count, out) != 0) goto out_free;
+    if (replay_records(pool_base, recs, rec_count, out) != 0) goto out_free;
+
+    // 日志触及的 Slab 不算孤立：恢复时重放会为它们重新填充位图
+    referenced = (uint32_t*)malloc(sizeof(uint32_t) * (rec_count ? rec_count : 1));
+    if (!referenced) goto out_free;
+    for (uint32_t i = 0; i < rec_count; ++i) {
+        if (referenced_count == 0 || referenced[referenced_count - 1] != recs[i].slab_idx) {
+            referenced[referenced_count++] = recs[i].slab_idx;
+        }
+    }
+
+    // 2. 分段并行扫描镜像
+    tasks = (ScanTask*)calloc(workers, sizeof(ScanTask));
+    threads = (nvm_thread_t*)calloc(workers, sizeof(nvm_thread_t));
+    if (!tasks || !threads) goto out_free;
+
+    uint32_t per_task = (layout.slab_count + workers - 1) / workers;
+    uint32_t started = 0;
+    for (uint32_t i = 0; i < workers; ++i) {
+        ScanTask* task = &tasks[i];
+        task->meta             = pool_base;
+        task->begin            = i * per_task < layout.slab_count ? i * per_task : layout.slab_count;
+        task->end              = task->begin + per_task < layout.slab_count ? task->begin + per_task : layout.slab_count;
+        task->repair           = repair;
+        task->referenced       = referenced;
+        task->referenced_count = referenced_count;
+        if (NVM_THREAD_CREATE(&threads[i], scan_worker_main, task) != 0) {
+            LOG_ERR("Failed to start scan worker #%u.", i);
+            break;
+        }
+        started++;
+    }
+    for (uint32_t i = 0; i < started; ++i) {
+        NVM_THREAD_JOIN(threads[i]);
+    }
+    if (started != workers) goto out_free;
+
+    // 3. 按段顺序合并，拼接跨段的空闲区间
+    uint64_t carry = 0;
+    for (uint32_t i = 0; i < workers; ++i) {
+        ScanTask* task = &tasks[i];
+        if (task->begin == task->end) continue;
+
+        merge_report(out, &task->partial);
+        if (carry > 0 && task->leading_free > 0) {
+            out->free_extents--;
+        }
+        uint64_t joined = carry + task->leading_free;
+        if (joined > out->largest_free_extent) out->largest_free_extent = joined;
+        if (task->partial.largest_free_extent > out->largest_free_extent) {
+            out->largest_free_extent = task->partial.largest_free_extent;
+        }
+        carry = task->all_free ? carry + (task->end - task->begin) : task->trailing_free;
+    }
+
+    ret = nvm_check_error_count(out) ? 1 : 0;
+
+out_free:
+    free(threads);
+    free(tasks);
+    free(referenced);
+    free(recs);
+    return ret;
+}
+
+uint64_t nvm_check_error_count(const NvmCheckReport* report) {
+    if (!report) return 0;
+    return report->bad_class_slabs + report->stray_bit_slabs + report->bad_records +
+           report->overlapping_slabs + report->double_allocs + report->double_frees;
+}
+
+// ============================================================================
+//                          内部函数实现
+// ============================================================================
+
+// 解码所有 CPU 日志的未折叠记录；无效记录只计数，不参与重放
+static int collect_records(void* meta, const NvmLogLayout* layout, CheckRecord** out, uint32_t* out_count,
+                           NvmCheckReport* report) {
+    NvmLogRecord* raw = (NvmLogRecord*)malloc(sizeof(NvmLogRecord) * NVM_LOG_CAPACITY);
+    CheckRecord* recs = NULL;
+    uint32_t count = 0;
+    uint32_t capacity = 0;
+
+    if (!raw) goto err_nomem;
+
+    for (int cpu = 0; cpu < MAX_CPUS; ++cpu) {
+        uint32_t n = nvm_log_inspect_pending(meta, cpu, raw);
+        report->pending_records += n;
+        if (n == 0) continue;
+
+        if (count + n > capacity) {
+            capacity = count + n;
+            CheckRecord* grown = (CheckRecord*)realloc(recs, sizeof(CheckRecord) * capacity);
+            if (!grown) goto err_nomem;
+            recs = grown;
+        }
+
+        for (uint32_t i = 0; i < n; ++i) {
+            const NvmLogRecord* r = &raw[i];
+            uint64_t rel = r->block_offset - layout->data_offset;
+            if ((r->op != NVM_LOG_OP_ALLOC && r->op != NVM_LOG_OP_FREE) || r->sc_id >= SC_COUNT ||
+                r->block_offset < layout->data_offset || rel / NVM_SLAB_SIZE >= layout->slab_count ||
+                (rel % NVM_SLAB_SIZE) % (8u << r->sc_id) != 0) {
+                report->bad_records++;
+                continue;
+            }
+
+            CheckRecord* rec = &recs[count++];
+            rec->block_offset = r->block_offset;
+            rec->slab_idx     = (uint32_t)(rel / NVM_SLAB_SIZE);
+            rec->block_idx    = (uint32_t)((rel % NVM_SLAB_SIZE) / (8u << r->sc_id));
+            rec->seq          = i;
+            rec->cpu          = (uint8_t)cpu;
+            rec->sc_id        = r->sc_id;
+            rec->op           = r->op;
+        }
+    }
+
+    // 同一 Slab 的记录相邻，组内按日志顺序
+    if (count > 1) qsort(recs, count, sizeof(CheckRecord), compare_records);
+
+    free(raw);
+    *out = recs;
+    *out_count = count;
+    return 0;
+
+err_nomem:
+    LOG_ERR("Out of memory while collecting log records.");
+    free(recs);
+    free(raw);
+    return -1;
+}
+
+static int compare_records(const void* a, const void* b) {
+    const CheckRecord* ra = (const CheckRecord*)a;
+    const CheckRecord* rb = (const CheckRecord*)b;
+    if (ra->slab_idx != rb->slab_idx) return ra->slab_idx < rb->slab_idx ? -1 : 1;
+    if (ra->cpu != rb->cpu) return ra->cpu < rb->cpu ? -1 : 1;
+    return (ra->seq > rb->seq) - (ra->seq < rb->seq);
+}
+
+static int compare_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static int replay_records(void* meta, CheckRecord* recs, uint32_t count, NvmCheckReport* report) {
+    if (count == 0) return 0;
+
+    // 覆盖层容量按最大的一组记录数的两倍取 2 的幂
+    uint32_t max_group = 0;
+    for (uint32_t i = 0, begin = 0; i <= count; ++i) {
+        if (i == count || recs[i].slab_idx != recs[begin].slab_idx) {
+            if (i - begin > max_group) max_group = i - begin;
+            begin = i;
+        }
+    }
+    uint32_t slots = 2;
+    while (slots < max_group * 2) slots <<= 1;
+
+    BlockOverlay overlay = { 0 };
+    overlay.keys    = (uint32_t*)calloc(slots, sizeof(uint32_t));
+    overlay.states  = (uint8_t*)calloc(slots, sizeof(uint8_t));
+    overlay.touched = (uint32_t*)malloc(sizeof(uint32_t) * slots);
+    overlay.mask    = slots - 1;
+    if (!overlay.keys || !overlay.states || !overlay.touched) {
+        LOG_ERR("Out of memory while replaying log records.");
+        free(overlay.keys);
+        free(overlay.states);
+        free(overlay.touched);
+        return -1;
+    }
+
+    for (uint32_t i = 0, begin = 0; i <= count; ++i) {
+        if (i < count && recs[i].slab_idx == recs[begin].slab_idx) continue;
+        replay_slab(meta, &recs[begin], i - begin, &overlay, report);
+        overlay_clear(&overlay);
+        begin = i;
+    }
+
+    free(overlay.keys);
+    free(overlay.states);
+    free(overlay.touched);
+    return 0;
+}
+
+// 按日志顺序重放同一 Slab 的记录，起点为已折叠的镜像。
+// 与 apply_record 一致：尺寸类别变化视为 Slab 被重新创建，此时镜像中不得仍有存活块
+static void replay_slab(void* meta, const CheckRecord* recs, uint32_t count, BlockOverlay* overlay,
+                        NvmCheckReport* report) {
+    // 一个 Slab 的记录只会写入其持有 CPU 的日志；出现在两条日志中说明有两个描述符
+    if (recs[0].cpu != recs[count - 1].cpu) {
+        report->overlapping_slabs++;
+        return;
+    }
+
+    uint8_t* image_sc;
+    unsigned char* bitmap;
+    if (nvm_log_inspect_image(meta, recs[0].slab_idx, &image_sc, &bitmap) != 0) return;
+
+    uint8_t cls = *image_sc;
+    bool base_valid = cls < SC_COUNT;
+    uint64_t live = base_valid ? count_bits(bitmap, (uint32_t)((NVM_SLAB_SIZE >> (3 + cls)) / 8)) : 0;
+
+    for (uint32_t i = 0; i < count; ++i) {
+        const CheckRecord* rec = &recs[i];
+        if (rec->sc_id != cls) {
+            if (cls < SC_COUNT && live > 0) {
+                report->overlapping_slabs++;
+                return;
+            }
+            cls = rec->sc_id;
+            base_valid = false;
+            live = 0;
+            overlay_clear(overlay);
+        }
+
+        bool found;
+        uint8_t* state = overlay_slot(overlay, rec->block_idx, &found);
+        if (!found) {
+            *state = base_valid ? (uint8_t)((bitmap[rec->block_idx / 8] >> (rec->block_idx % 8)) & 1) : 0;
+        }
+
+        if (rec->op == NVM_LOG_OP_ALLOC) {
+            if (*state) {
+                report->double_allocs++;
+            } else {
+                *state = 1;
+                live++;
+            }
+        } else {
+            if (!*state) {
+                report->double_frees++;
+            } else {
+                *state = 0;
+                live--;
+            }
+        }
+    }
+}
+
+static uint8_t* overlay_slot(BlockOverlay* overlay, uint32_t block_idx, bool* found) {
+    uint32_t key = block_idx + 1;
+    uint32_t slot = (block_idx * 2654435761u) & overlay->mask;
+    while (overlay->keys[slot] != 0 && overlay->keys[slot] != key) {
+        slot = (slot + 1) & overlay->mask;
+    }
+
+    *found = (overlay->keys[slot] == key);
+    if (!*found) {
+        overlay->keys[slot] = key;
+        overlay->touched[overlay->touched_count++] = slot;
+    }
+    return &overlay->states[slot];
+}
+
+static void overlay_clear(BlockOverlay* overlay) {
+    for (uint32_t i = 0; i < overlay->touched_count; ++i) {
+        overlay->keys[overlay->touched[i]] = 0;
+    }
+    overlay->touched_count = 0;
+}
+
+static void* scan_worker_main(void* arg) {
+    ScanTask* task = (ScanTask*)arg;
+    uint64_t run = 0;
+    bool in_leading = true;
+
+    task->all_free = true;
+    for (uint32_t i = task->begin; i < task->end; ++i) {
+        bool is_free;
+        scan_slab(task, i, &is_free);
+
+        if (is_free) {
+            if (run++ == 0) task->partial.free_extents++;
+            if (in_leading) task->leading_free++;
+            if (run > task->partial.largest_free_extent) task->partial.largest_free_extent = run;
+        } else {
+            run = 0;
+            in_leading = false;
+            task->all_free = false;
+            task->partial.slabs_in_use++;
+        }
+    }
+    task->trailing_free = run;
+    return NULL;
+}
+
+// 检查一个镜像；修复模式下就地改写并持久化
+static void scan_slab(ScanTask* task, uint32_t slab_idx, bool* is_free) {
+    uint8_t* image_sc;
+    unsigned char* bitmap;
+    *is_free = true;
+    if (nvm_log_inspect_image(task->meta, slab_idx, &image_sc, &bitmap) != 0) return;
+
+    uint8_t sc = *image_sc;
+    if (sc == NVM_LOG_SC_NONE) return;
+
+    if (sc >= SC_COUNT) {
+        task->partial.bad_class_slabs++;
+        if (task->repair) {
+            *image_sc = NVM_LOG_SC_NONE;
+            nvm_persist(image_sc, sizeof(*image_sc));
+            task->partial.repaired_slabs++;
+            return;
+        }
+        *is_free = false;
+        return;
+    }
+
+    // 块数总是 8 的倍数，有效位图之后的字节必须全零
+    uint32_t used_bytes = (uint32_t)((NVM_SLAB_SIZE >> (3 + sc)) / 8);
+    bool stray = false;
+    for (uint32_t b = used_bytes; b < CHECK_BITMAP_BYTES; ++b) {
+        if (bitmap[b]) {
+            stray = true;
+            break;
+        }
+    }
+    if (stray) {
+        task->partial.stray_bit_slabs++;
+        if (task->repair) {
+            memset(bitmap + used_bytes, 0, CHECK_BITMAP_BYTES - used_bytes);
+            nvm_persist(bitmap + used_bytes, CHECK_BITMAP_BYTES - used_bytes);
+            task->partial.repaired_slabs++;
+        }
+    }
+
+    uint64_t blocks = count_bits(bitmap, used_bytes);
+    if (blocks == 0 &&
+        !bsearch(&slab_idx, task->referenced, task->referenced_count, sizeof(uint32_t), compare_u32)) {
+        task->partial.orphaned_slabs++;
+        if (task->repair) {
+            *image_sc = NVM_LOG_SC_NONE;
+            nvm_persist(image_sc, sizeof(*image_sc));
+            task->partial.repaired_slabs++;
+            return;
+        }
+    }
+
+    task->partial.class_slabs[sc]++;
+    task->partial.class_blocks[sc] += blocks;
+    *is_free = false;
+}
+
+static uint64_t count_bits(const unsigned char* bitmap, uint32_t bytes) {
+    uint64_t bits = 0;
+    uint32_t i = 0;
+    for (; i + sizeof(uint64_t) <= bytes; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, bitmap + i, sizeof(word));
+        bits += (uint64_t)__builtin_popcountll(word);
+    }
+    for (; i < bytes; ++i) {
+        bits += (uint64_t)__builtin_popcount(bitmap[i]);
+    }
+    return bits;
+}
+
+// 累加计数类字段 (空闲区间由调用者拼接)
+static void merge_report(NvmCheckReport* dst, const NvmCheckReport* src) {
+    dst->slabs_in_use    += src->slabs_in_use;
+    dst->free_extents    += src->free_extents;
+    dst->bad_class_slabs += src->bad_class_slabs;
+    dst->stray_bit_slabs += src->stray_bit_slabs;
+    dst->orphaned_slabs  += src->orphaned_slabs;
+    dst->repaired_slabs  += src->repaired_slabs;
+    for (int sc = 0; sc < SC_COUNT; ++sc) {
+        dst->class_slabs[sc]  += src->class_slabs[sc];
+        dst->class_blocks[sc] += src->class_blocks[sc];
+    }
+}
+
+static uint32_t default_worker_count(void) {
+    uint8_t allowed[MAX_CPUS];
+    nvm_get_allowed_cpus(allowed);
+
+    uint32_t count = 0;
+    for (int cpu = 0; cpu < MAX_CPUS; ++cpu) {
+        count += allowed[cpu];
+    }
+    return count ? count : 1;
+}
@@ -0,0 +1,354 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "NvmDefs.h"
+#include "NvmDeferredFree.h"
+
+// ============================================================================
+//                          核心数据结构
+// ============================================================================
+
+#define RING_MASK ((uint64_t)NVM_DEFERRED_RING_SIZE - 1)
+
+// 单生产者环形队列：tail 只由所属线程写，head 只在消费锁内写，两者分处不同缓存行
+typedef struct NvmDeferredRing {
+    uint64_t                tail;
+    uint64_t                head __attribute__((aligned(CACHE_LINE_SIZE)));
+    nvm_spinlock_t          consume_lock;
+    uint32_t                owner_exited;   // 1 表示所属线程已退出，可被新线程接管
+    struct NvmDeferredRing* next;           // 注册链表 (只增不减，销毁时统一释放)
+    void*                   slots[NVM_DEFERRED_RING_SIZE];
+} __attribute__((aligned(CACHE_LINE_SIZE))) NvmDeferredRing;
+
+typedef struct NvmDeferredFree {
+    nvm_deferred_batch_fn   batch_fn;
+    void*                   ctx;
+    uint64_t                id;             // 进程内唯一，用于校验线程本地缓存
+    NvmDeferredRing*        rings;          // 注册链表头 (release 发布)
+    struct NvmDeferredFree* next_live;      // 存活队列链表 (g_registry_lock 保护)
+
+    uint32_t                interval_ms;    // 后台线程轮询间隔
+    bool                    running;        // 后台线程是否在运行 (生产者无锁读取)
+    bool                    stopping;
+
+    nvm_mutex_t             lock;
+    nvm_cond_t              cond;
+    nvm_thread_t            worker;
+} NvmDeferredFree;
+
+// 线程本地状态：缓存本线程在某个队列中的环形队列
+typedef struct DeferredThreadState {
+    uint64_t           queue_id;            // 0 表示未注册
+    NvmDeferredRing*   ring;
+    NvmDeferFullPolicy policy;
+} DeferredThreadState;
+
+static _Thread_local DeferredThreadState t_state;
+
+// 注册与线程退出都要确认队列仍然存活，由全局锁串行化 (均为低频操作)
+static pthread_mutex_t  g_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static NvmDeferredFree* g_live_queues;
+static uint64_t         g_next_queue_id = 1;
+static pthread_once_t   g_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t    g_thread_key;
+
+// ============================================================================
+//                          内部函数前向声明
+// ============================================================================
+
+static void             create_thread_key(void);
+static void             on_thread_exit(void* arg);
+static void             orphan_ring_locked(uint64_t queue_id, NvmDeferredRing* ring);
+static NvmDeferredRing* register_ring(NvmDeferredFree* queue);
+static uint32_t         flush_ring(NvmDeferredFree* queue, NvmDeferredRing* ring);
+static int              handle_full_ring(NvmDeferredFree* queue, NvmDeferredRing* ring);
+static void*            reclaimer_main(void* arg);
+
+// ============================================================================
+//                          公共 API 实现
+// ============================================================================
+
+NvmDeferredFree* deferred_free_create(nvm_deferred_batch_fn batch_fn, void* ctx) {
+    if (!batch_fn) return NULL;
+
+    NvmDeferredFree* queue = (NvmDeferredFree*)calloc(1, sizeof(NvmDeferredFree));
+    if (!queue) {
+        LOG_ERR("Failed to allocate deferred free queue.");
+        return NULL;
+    }
+    queue->batch_fn = batch_fn;
+    queue->ctx      = ctx;
+
+    if (NVM_MUTEX_INIT(&queue->lock) != 0) {
+        LOG_ERR("Failed to init mutex.");
+        goto err_free_queue;
+    }
+    if (NVM_COND_INIT(&queue->cond) != 0) {
+        LOG_ERR("Failed to init condition.");
+        goto err_destroy_mutex;
+    }
+
+    pthread_mutex_lock(&g_registry_lock);
+    queue->id = g_next_queue_id++;
+    queue->next_live = g_live_queues;
+    g_live_queues = queue;
+    pthread_mutex_unlock(&g_registry_lock);
+    return queue;
+
+err_destroy_mutex:
+    NVM_MUTEX_DESTROY(&queue->lock);
+err_free_queue:
+    free(queue);
+    return NULL;
+}
+
+void deferred_free_destroy(NvmDeferredFree* queue) {
+    if (!queue) return;
+
+    deferred_free_set_reclaimer(queue, 0);
+
+    // 先摘出存活链表，之后退出的线程不再触碰本队列的环形队列
+    pthread_mutex_lock(&g_registry_lock);
+    for (NvmDeferredFree** link = &g_live_queues; *link; link = &(*link)->next_live) {
+        if (*link == queue) {
+            *link = queue->next_live;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_registry_lock);
+
+    deferred_free_flush_all(queue);
+
+    NvmDeferredRing* ring = queue->rings;
+    while (ring) {
+        NvmDeferredRing* next = ring->next;
+        NVM_SPINLOCK_DESTROY(&ring->consume_lock);
+        free(ring);
+        ring = next;
+    }
+
+    NVM_COND_DESTROY(&queue->cond);
+    NVM_MUTEX_DESTROY(&queue->lock);
+    free(queue);
+}
+
+int deferred_free_push(NvmDeferredFree* queue, void* ptr) {
+    if (!queue || !ptr) return -1;
+
+    NvmDeferredRing* ring = (NVM_LIKELY(t_state.queue_id == queue->id)) ? t_state.ring : register_ring(queue);
+    if (NVM_UNLIKELY(!ring)) return -1;
+
+    uint64_t tail = ring->tail;
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    if (NVM_UNLIKELY(tail - head >= NVM_DEFERRED_RING_SIZE)) {
+        if (handle_full_ring(queue, ring) != 0) return -1;
+        head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    }
+
+    ring->slots[tail & RING_MASK] = ptr;
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+
+    // 积压恰好越过阈值时唤醒后台线程。不持锁通知可能丢失一次唤醒，最多延迟一个轮询间隔
+    if (tail + 1 - head == NVM_DEFERRED_WAKE_THRESHOLD &&
+        __atomic_load_n(&queue->running, __ATOMIC_RELAXED)) {
+        NVM_COND_SIGNAL(&queue->cond);
+    }
+    return 0;
+}
+
+void deferred_free_set_policy(NvmDeferFullPolicy policy) {
+    t_state.policy = policy;
+}
+
+uint32_t deferred_free_flush_local(NvmDeferredFree* queue) {
+    if (!queue || t_state.queue_id != queue->id) return 0;
+    return flush_ring(queue, t_state.ring);
+}
+
+uint32_t deferred_free_flush_all(NvmDeferredFree* queue) {
+    if (!queue) return 0;
+
+    uint32_t total = 0;
+    for (NvmDeferredRing* ring = __atomic_load_n(&queue->rings, __ATOMIC_ACQUIRE); ring; ring = ring->next) {
+        total += flush_ring(queue, ring);
+    }
+    return total;
+}
+
+int deferred_free_set_reclaimer(NvmDeferredFree* queue, uint32_t interval_ms) {
+    if (!queue) return -1;
+
+    NVM_MUTEX_ACQUIRE(&queue->lock);
+    if (interval_ms == 0) {
+        if (!queue->running) {
+            NVM_MUTEX_RELEASE(&queue->lock);
+            return 0;
+        }
+        queue->stopping = true;
+        NVM_COND_BROADCAST(&queue->cond);
+        NVM_MUTEX_RELEASE(&queue->lock);
+
+        NVM_THREAD_JOIN(queue->worker);
+
+        NVM_MUTEX_ACQUIRE(&queue->lock);
+        __atomic_store_n(&queue->running, false, __ATOMIC_RELAXED);
+        queue->stopping = false;
+        NVM_MUTEX_RELEASE(&queue->lock);
+        return 0;
+    }
+
+    queue->interval_ms = interval_ms;
+    if (queue->running) {
+        NVM_COND_SIGNAL(&queue->cond);
+        NVM_MUTEX_RELEASE(&queue->lock);
+        return 0;
+    }
+    if (NVM_THREAD_CREATE(&queue->worker, reclaimer_main, queue) != 0) {
+        LOG_ERR("Failed to start deferred free reclaimer.");
+        NVM_MUTEX_RELEASE(&queue->lock);
+        return -1;
+    }
+    __atomic_store_n(&queue->running, true, __ATOMIC_RELAXED);
+    NVM_MUTEX_RELEASE(&queue->lock);
+    return 0;
+}
+
+// ============================================================================
+//                          内部函数实现
+// ============================================================================
+
+static void create_thread_key(void) {
+    pthread_key_create(&g_thread_key, on_thread_exit);
+}
+
+static void on_thread_exit(void* arg) {
+    DeferredThreadState* state = (DeferredThreadState*)arg;
+
+    pthread_mutex_lock(&g_registry_lock);
+    orphan_ring_locked(state->queue_id, state->ring);
+    pthread_mutex_unlock(&g_registry_lock);
+}
+
+// 假设已持 g_registry_lock：队列仍存活时把环形队列交还，供其他线程接管
+static void orphan_ring_locked(uint64_t queue_id, NvmDeferredRing* ring) {
+    for (NvmDeferredFree* queue = g_live_queues; queue; queue = queue->next_live) {
+        if (queue->id == queue_id) {
+            __atomic_store_n(&ring->owner_exited, 1, __ATOMIC_RELEASE);
+            return;
+        }
+    }
+}
+
+// 注册调用线程的环形队列：优先接管已退出线程留下的队列 (其中的积压一并接管)
+static NvmDeferredRing* register_ring(NvmDeferredFree* queue) {
+    pthread_once(&g_key_once, create_thread_key);
+
+    pthread_mutex_lock(&g_registry_lock);
+
+    // 线程此前服务于另一个队列：交还旧队列中的环形队列
+    if (t_state.queue_id != 0) {
+        orphan_ring_locked(t_state.queue_id, t_state.ring);
+    }
+
+    NvmDeferredRing* ring = NULL;
+    for (NvmDeferredRing* r = queue->rings; r; r = r->next) {
+        uint32_t expected = 1;
+        if (__atomic_compare_exchange_n(&r->owner_exited, &expected, 0, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            ring = r;
+            break;
+        }
+    }
+
+    if (!ring) {
+        ring = (NvmDeferredRing*)aligned_alloc(CACHE_LINE_SIZE, sizeof(NvmDeferredRing));
+        if (!ring) {
+            LOG_ERR("Failed to allocate deferred free ring.");
+            goto out_unlock;
+        }
+        memset(ring, 0, sizeof(NvmDeferredRing));
+        if (NVM_SPINLOCK_INIT(&ring->consume_lock) != 0) {
+            LOG_ERR("Failed to init ring consume lock.");
+            free(ring);
+            ring = NULL;
+            goto out_unlock;
+        }
+        ring->next = queue->rings;
+        __atomic_store_n(&queue->rings, ring, __ATOMIC_RELEASE);
+    }
+
+    t_state.queue_id = queue->id;
+    t_state.ring     = ring;
+    pthread_setspecific(g_thread_key, &t_state);
+
+out_unlock:
+    pthread_mutex_unlock(&g_registry_lock);
+    return ring;
+}
+
+// 取出环形队列的全部积压后在锁外交给批量回调
+static uint32_t flush_ring(NvmDeferredFree* queue, NvmDeferredRing* ring) {
+    void* batch[NVM_DEFERRED_RING_SIZE];
+
+    NVM_SPINLOCK_ACQUIRE(&ring->consume_lock);
+    uint64_t head = ring->head;
+    uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    uint32_t count = (uint32_t)(tail - head);
+    for (uint32_t i = 0; i < count; ++i) {
+        batch[i] = ring->slots[(head + i) & RING_MASK];
+    }
+    __atomic_store_n(&ring->head, tail, __ATOMIC_RELEASE);
+    NVM_SPINLOCK_RELEASE(&ring->consume_lock);
+
+    if (count > 0) {
+        queue->batch_fn(queue->ctx, batch, count);
+    }
+    return count;
+}
+
+static int handle_full_ring(NvmDeferredFree* queue, NvmDeferredRing* ring) {
+    switch (t_state.policy) {
+    case NVM_DEFER_FULL_REJECT:
+        return -1;
+
+    case NVM_DEFER_FULL_WAIT:
+        if (__atomic_load_n(&queue->running, __ATOMIC_RELAXED)) {
+            NVM_COND_SIGNAL(&queue->cond);
+            uint32_t spins = 0;
+            while (ring->tail - __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) >= NVM_DEFERRED_RING_SIZE) {
+                if (!__atomic_load_n(&queue->running, __ATOMIC_RELAXED)) break;
+                nvm_spin_backoff(&spins);
+            }
+            if (ring->tail - __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) < NVM_DEFERRED_RING_SIZE) {
+                return 0;
+            }
+        }
+        // 后台线程未运行：退化为同步处理
+        /* fall through */
+
+    case NVM_DEFER_FULL_FLUSH:
+    default:
+        flush_ring(queue, ring);
+        return 0;
+    }
+}
+
+// 后台线程：按间隔 (或被积压唤醒时) 处理所有线程的队列
+static void* reclaimer_main(void* arg) {
+    NvmDeferredFree* queue = (NvmDeferredFree*)arg;
+
+    NVM_MUTEX_ACQUIRE(&queue->lock);
+    while (!queue->stopping) {
+        NVM_MUTEX_RELEASE(&queue->lock);
+        deferred_free_flush_all(queue);
+        NVM_MUTEX_ACQUIRE(&queue->lock);
+
+        if (queue->stopping) break;
+        NVM_COND_TIMEDWAIT_MS(&queue->cond, &queue->lock, queue->interval_ms);
+    }
+    NVM_MUTEX_RELEASE(&queue->lock);
+
+    return NULL;
+}
@@ -0,0 +1,203 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "NvmDefs.h"
+#include "NvmEpoch.h"
+
+// ============================================================================
+//                          核心数据结构
+// ============================================================================
+
+// 每 CPU 读者计数，按纪元奇偶位分两组，独占缓存行
+typedef struct NvmEpochSlot {
+    int64_t active[2];
+} __attribute__((aligned(CACHE_LINE_SIZE))) NvmEpochSlot;
+
+// 待释放对象
+typedef struct NvmEpochNode {
+    struct NvmEpochNode* next;
+    void*                ptr;
+    nvm_epoch_free_fn    free_fn;
+    uint64_t             epoch;       // 退休时的全局纪元
+} NvmEpochNode;
+
+// 每 CPU 延迟释放链表。纪元在锁内读取，因此链表按退休纪元非递减排列
+typedef struct NvmEpochLimbo {
+    nvm_spinlock_t lock;
+    NvmEpochNode*  head;
+    NvmEpochNode*  tail;
+    uint32_t       count;
+} __attribute__((aligned(CACHE_LINE_SIZE))) NvmEpochLimbo;
+
+static uint64_t       g_epoch;
+static uint64_t       g_pending;
+static uint32_t       g_reclaim_batch = NVM_EPOCH_RECLAIM_BATCH;
+static NvmEpochSlot   g_slots[MAX_CPUS];
+static NvmEpochLimbo  g_limbo[MAX_CPUS];
+static pthread_once_t g_limbo_once = PTHREAD_ONCE_INIT;
+
+// ============================================================================
+//                          内部函数前向声明
+// ============================================================================
+
+static void     init_limbo(void);
+static bool     try_advance(void);
+static uint32_t reclaim_limbo(NvmEpochLimbo* limbo);
+static void     wait_for_epoch(uint64_t target);
+
+// ============================================================================
+//                          公共 API 实现
+// ============================================================================
+
+uint32_t nvm_epoch_enter(void) {
+    for (;;) {
+        uint64_t e = __atomic_load_n(&g_epoch, __ATOMIC_SEQ_CST);
+        int64_t* count = &g_slots[nvm_get_current_cpu_id()].active[e & 1];
+
+        // 先登记再复查 (均为 SEQ_CST)：复查时纪元未变，则推进到 e + 2 之前必然看到本次登记
+        __atomic_fetch_add(count, 1, __ATOMIC_SEQ_CST);
+        if (NVM_LIKELY(__atomic_load_n(&g_epoch, __ATOMIC_SEQ_CST) == e)) {
+            return (uint32_t)(e & 1);
+        }
+        __atomic_fetch_sub(count, 1, __ATOMIC_RELEASE);
+    }
+}
+
+void nvm_epoch_exit(uint32_t token) {
+    __atomic_fetch_sub(&g_slots[nvm_get_current_cpu_id()].active[token & 1], 1, __ATOMIC_RELEASE);
+}
+
+void nvm_epoch_retire(void* ptr, nvm_epoch_free_fn free_fn) {
+    if (!ptr || !free_fn) return;
+    pthread_once(&g_limbo_once, init_limbo);
+
+    NvmEpochNode* node = (NvmEpochNode*)malloc(sizeof(NvmEpochNode));
+    if (NVM_UNLIKELY(!node)) {
+        // 无法延迟：同步等待当前所有读者离开后直接释放
+        wait_for_epoch(__atomic_load_n(&g_epoch, __ATOMIC_SEQ_CST) + 2);
+        free_fn(ptr);
+        return;
+    }
+    node->next    = NULL;
+    node->ptr     = ptr;
+    node->free_fn = free_fn;
+
+    NvmEpochLimbo* limbo = &g_limbo[nvm_get_current_cpu_id()];
+    NVM_SPINLOCK_ACQUIRE(&limbo->lock);
+    node->epoch = __atomic_load_n(&g_epoch, __ATOMIC_SEQ_CST);
+    if (limbo->tail) limbo->tail->next = node;
+    else             limbo->head = node;
+    limbo->tail = node;
+    bool batch_full = (++limbo->count >= __atomic_load_n(&g_reclaim_batch, __ATOMIC_RELAXED));
+    NVM_SPINLOCK_RELEASE(&limbo->lock);
+
+    __atomic_fetch_add(&g_pending, 1, __ATOMIC_RELAXED);
+    if (batch_full) {
+        try_advance();
+        reclaim_limbo(limbo);
+    }
+}
+
+uint32_t nvm_epoch_reclaim(void) {
+    pthread_once(&g_limbo_once, init_limbo);
+    try_advance();
+
+    uint32_t freed = 0;
+    for (int cpu = 0; cpu < MAX_CPUS; ++cpu) {
+        freed += reclaim_limbo(&g_limbo[cpu]);
+    }
+    return freed;
+}
+
+void nvm_epoch_barrier(void) {
+    pthread_once(&g_limbo_once, init_limbo);
+
+    // 此前退休的对象纪元均不超过当前纪元
+    wait_for_epoch(__atomic_load_n(&g_epoch, __ATOMIC_SEQ_CST) + 2);
+    for (int cpu = 0; cpu < MAX_CPUS; ++cpu) {
+        reclaim_limbo(&g_limbo[cpu]);
+    }
+}
+
+int nvm_epoch_set_reclaim_batch(uint32_t batch) {
+    if (batch == 0) return -1;
+    __atomic_store_n(&g_reclaim_batch, batch, __ATOMIC_RELAXED);
+    return 0;
+}
+
+uint32_t nvm_epoch_get_reclaim_batch(void) {
+    return __atomic_load_n(&g_reclaim_batch, __ATOMIC_RELAXED);
+}
+
+uint64_t nvm_epoch_pending(void) {
+    return __atomic_load_n(&g_pending, __ATOMIC_RELAXED);
+}
+
+// ============================================================================
+//                          内部函数实现
+// ============================================================================
+
+static void init_limbo(void) {
+    for (int cpu = 0; cpu < MAX_CPUS; ++cpu) {
+        if (NVM_SPINLOCK_INIT(&g_limbo[cpu].lock) != 0) {
+            LOG_ERR("Failed to init epoch limbo lock.");
+            abort();
+        }
+    }
+}
+
+// 当前纪元为 e 时，推进到 e + 1 要求 e - 1 (与 e + 1 同奇偶) 的读者全部离开
+static bool try_advance(void) {
+    uint64_t e = __atomic_load_n(&g_epoch, __ATOMIC_SEQ_CST);
+    uint32_t idx = (uint32_t)((e + 1) & 1);
+
+    int64_t sum = 0;
+    for (int cpu = 0; cpu < MAX_CPUS; ++cpu) {
+        sum += __atomic_load_n(&g_slots[cpu].active[idx], __ATOMIC_SEQ_CST);
+    }
+    if (sum != 0) return false;
+
+    return __atomic_compare_exchange_n(&g_epoch, &e, e + 1, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+
+// 摘下链表头部已安全的对象 (退休纪元 + 2 <= 当前纪元)，在锁外释放
+static uint32_t reclaim_limbo(NvmEpochLimbo* limbo) {
+    if (!__atomic_load_n(&limbo->head, __ATOMIC_RELAXED)) return 0;
+
+    uint64_t now = __atomic_load_n(&g_epoch, __ATOMIC_SEQ_CST);
+    NvmEpochNode* safe = NULL;
+    uint32_t count = 0;
+
+    NVM_SPINLOCK_ACQUIRE(&limbo->lock);
+    NvmEpochNode* last = NULL;
+    for (NvmEpochNode* node = limbo->head; node && node->epoch + 2 <= now; node = node->next) {
+        last = node;
+        count++;
+    }
+    if (last) {
+        safe = limbo->head;
+        __atomic_store_n(&limbo->head, last->next, __ATOMIC_RELAXED);
+        if (!last->next) limbo->tail = NULL;
+        last->next = NULL;
+        limbo->count -= count;
+    }
+    NVM_SPINLOCK_RELEASE(&limbo->lock);
+
+    while (safe) {
+        NvmEpochNode* next = safe->next;
+        safe->free_fn(safe->ptr);
+        free(safe);
+        safe = next;
+    }
+    __atomic_fetch_sub(&g_pending, count, __ATOMIC_RELAXED);
+    return count;
+}
+
+static void wait_for_epoch(uint64_t target) {
+    uint32_t spins = 0;
+    while (__atomic_load_n(&g_epoch, __ATOMIC_SEQ_CST) < target) {
+        if (!try_advance()) nvm_spin_backoff(&spins);
+    }
+}
@@ -0,0 +1,346 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <limits.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+#include "NvmDefs.h"
+#include "NvmConfig.h"
+
+// ============================================================================
+//                          核心数据结构
+// ============================================================================
+
+_Thread_local char nvm_lock_thread_tag;
+
+int nvm_lock_single_cpu_state = -1;
+
+// MCS：每个线程固定 NVM_LOCK_MAX_NESTING 个节点，位图记录占用情况
+static _Thread_local nvm_mcs_node_t t_mcs_nodes[NVM_LOCK_MAX_NESTING];
+static _Thread_local uint32_t       t_mcs_used;
+
+// CLH：节点在线程间流转，每个线程缓存释放时回收的前驱节点；
+// 线程退出时由 pthread key 的析构函数释放。其他 key 的析构函数可能在其后
+// 仍持 CLH 锁 (如远程释放缓存的退出刷新)，此后回收的节点直接释放
+typedef struct ClhNodeCache {
+    nvm_clh_node_t* nodes[NVM_LOCK_MAX_NESTING];
+    uint32_t        count;
+} ClhNodeCache;
+
+static pthread_once_t              g_clh_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t               g_clh_key;
+static _Thread_local ClhNodeCache* t_clh_cache;
+static _Thread_local bool          t_clh_cache_gone;
+
+// ============================================================================
+//                          内部函数前向声明
+// ============================================================================
+
+static void            clh_create_key(void);
+static void            clh_cache_destroy(void* arg);
+static nvm_clh_node_t* clh_node_get(void);
+static void            clh_node_put(nvm_clh_node_t* node);
+
+// ============================================================================
+//                          自旋策略
+// ============================================================================
+
+int nvm_lock_detect_single_cpu(void) {
+    // 亲和性之后若再变化不重新查询：只影响让出时机，不影响正确性
+    uint8_t allowed[MAX_CPUS];
+    int count = 0;
+    if (nvm_get_allowed_cpus(allowed) == 0) {
+        for (int cpu = 0; cpu < MAX_CPUS; ++cpu) count += allowed[cpu] != 0;
+    }
+    int state = count == 1;
+    __atomic_store_n(&nvm_lock_single_cpu_state, state, __ATOMIC_RELAXED);
+    return state;
+}
+
+// ============================================================================
+//                          Futex 封装
+// ============================================================================
+
+int nvm_futex_wait(uint32_t* addr, uint32_t expected, uint32_t timeout_ms) {
+#ifdef __linux__
+    struct timespec ts;
+    struct timespec* pts = NULL;
+    if (timeout_ms > 0) {
+        ts.tv_sec  = timeout_ms / 1000;
+        ts.tv_nsec = (long)(timeout_ms % 1000) * 1000000L;
+        pts = &ts;
+    }
+    if (syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, pts, NULL, 0) != 0 && errno == ETIMEDOUT) {
+        return -1;
+    }
+    return 0;
+#else
+    (void)addr; (void)expected; (void)timeout_ms;
+    sched_yield();
+    return 0;
+#endif
+}
+
+void nvm_futex_wake(uint32_t* addr, int count) {
+#ifdef __linux__
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+#else
+    (void)addr; (void)count;
+#endif
+}
+
+// ============================================================================
+//                          MCS 队列锁
+// ============================================================================
+
+int nvm_mcs_lock_acquire(nvm_mcs_lock_t* l) {
+    if (NVM_UNLIKELY(t_mcs_used == (1u << NVM_LOCK_MAX_NESTING) - 1)) {
+        LOG_ERR("MCS lock nesting exceeds %d.", NVM_LOCK_MAX_NESTING);
+        abort();
+    }
+    uint32_t idx = (uint32_t)__builtin_ctz(~t_mcs_used);
+    t_mcs_used |= 1u << idx;
+
+    nvm_mcs_node_t* node = &t_mcs_nodes[idx];
+    node->next = NULL;
+    node->locked = 1;
+
+    nvm_mcs_node_t* pred = __atomic_exchange_n(&l->tail, node, __ATOMIC_ACQ_REL);
+    if (pred) {
+        uint32_t spins = 0;
+        __atomic_store_n(&pred->next, node, __ATOMIC_RELEASE);
+        while (__atomic_load_n(&node->locked, __ATOMIC_ACQUIRE)) nvm_spin_backoff(&spins);
+    }
+    l->holder = node;
+    return 0;
+}
+
+int nvm_mcs_lock_try_acquire(nvm_mcs_lock_t* l) {
+    // 只有队列为空时才入队，因此无需等待前驱
+    if (__atomic_load_n(&l->tail, __ATOMIC_RELAXED) != NULL) return EBUSY;
+    if (NVM_UNLIKELY(t_mcs_used == (1u << NVM_LOCK_MAX_NESTING) - 1)) return EBUSY;
+
+    uint32_t idx = (uint32_t)__builtin_ctz(~t_mcs_used);
+    nvm_mcs_node_t* node = &t_mcs_nodes[idx];
+    node->next = NULL;
+    node->locked = 1;
+
+    nvm_mcs_node_t* expected = NULL;
+    if (!__atomic_compare_exchange_n(&l->tail, &expected, node, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        return EBUSY;
+    }
+    t_mcs_used |= 1u << idx;
+    l->holder = node;
+    return 0;
+}
+
+int nvm_mcs_lock_release(nvm_mcs_lock_t* l) {
+    nvm_mcs_node_t* node = l->holder;
+    nvm_mcs_node_t* next = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE);
+
+    if (!next) {
+        // 没有后继：尝试把队尾置空；失败说明有线程正在入队，等它链接上来
+        nvm_mcs_node_t* expected = node;
+        if (__atomic_compare_exchange_n(&l->tail, &expected, NULL, false,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+            goto out_put_node;
+        }
+        uint32_t spins = 0;
+        while (!(next = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE))) nvm_spin_backoff(&spins);
+    }
+    __atomic_store_n(&next->locked, 0, __ATOMIC_RELEASE);
+
+out_put_node:
+    t_mcs_used &= ~(1u << (uint32_t)(node - t_mcs_nodes));
+    return 0;
+}
+
+// ============================================================================
+//                          CLH 队列锁
+// ============================================================================
+
+int nvm_clh_lock_init(nvm_clh_lock_t* l) {
+    l->tail = (nvm_clh_node_t*)aligned_alloc(CACHE_LINE_SIZE, sizeof(nvm_clh_node_t));
+    if (!l->tail) return -1;
+    l->tail->locked = 0;
+    l->holder = NULL;
+    l->pred = NULL;
+    return 0;
+}
+
+int nvm_clh_lock_destroy(nvm_clh_lock_t* l) {
+    // 空闲时队尾节点不属于任何线程
+    free(l->tail);
+    l->tail = NULL;
+    return 0;
+}
+
+int nvm_clh_lock_acquire(nvm_clh_lock_t* l) {
+    nvm_clh_node_t* node = clh_node_get();
+    if (NVM_UNLIKELY(!node)) {
+        LOG_ERR("Failed to allocate CLH node.");
+        abort();
+    }
+    node->locked = 1;
+
+    uint32_t spins = 0;
+    nvm_clh_node_t* pred = __atomic_exchange_n(&l->tail, node, __ATOMIC_ACQ_REL);
+    while (__atomic_load_n(&pred->locked, __ATOMIC_ACQUIRE)) nvm_spin_backoff(&spins);
+
+    l->holder = node;
+    l->pred = pred;
+    return 0;
+}
+
+int nvm_clh_lock_try_acquire(nvm_clh_lock_t* l) {
+    // 队尾节点已释放说明无人持有也无人排队，此时以 CAS 接在其后
+    nvm_clh_node_t* pred = __atomic_load_n(&l->tail, __ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&pred->locked, __ATOMIC_ACQUIRE)) return EBUSY;
+
+    nvm_clh_node_t* node = clh_node_get();
+    if (NVM_UNLIKELY(!node)) return EBUSY;
+    node->locked = 1;
+
+    if (!__atomic_compare_exchange_n(&l->tail, &pred, node, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        clh_node_put(node);
+        return EBUSY;
+    }
+    // 极少数情况下 pred 已被回收并重新入队 (ABA)，此时退化为正常排队，保证互斥
+    uint32_t spins = 0;
+    while (__atomic_load_n(&pred->locked, __ATOMIC_ACQUIRE)) nvm_spin_backoff(&spins);
+
+    l->holder = node;
+    l->pred = pred;
+    return 0;
+}
+
+int nvm_clh_lock_release(nvm_clh_lock_t* l) {
+    nvm_clh_node_t* node = l->holder;
+    nvm_clh_node_t* pred = l->pred;
+
+    // 自己的节点留给后继自旋，前驱节点已无人引用，回收复用
+    __atomic_store_n(&node->locked, 0, __ATOMIC_RELEASE);
+    clh_node_put(pred);
+    return 0;
+}
+
+// ============================================================================
+//                          自适应互斥锁
+// ============================================================================
+
+int nvm_adaptive_mutex_acquire_slow(nvm_adaptive_mutex_t* m) {
+    // 1. 有限自旋：持有时间短时避免睡眠/唤醒的系统调用开销
+    for (int i = 0; i < NVM_ADAPTIVE_SPIN_LIMIT; ++i) {
+        uint32_t expected = 0;
+        if (__atomic_load_n(&m->state, __ATOMIC_RELAXED) == 0 &&
+            __atomic_compare_exchange_n(&m->state, &expected, 1, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            return 0;
+        }
+        nvm_cpu_relax();
+    }
+
+    // 2. 标记存在等待者后睡眠；被唤醒后仍以状态 2 获取，保证后续释放会继续唤醒
+    while (__atomic_exchange_n(&m->state, 2, __ATOMIC_ACQUIRE) != 0) {
+        nvm_futex_wait(&m->state, 2, 0);
+    }
+    return 0;
+}
+
+int nvm_futex_cond_timedwait(nvm_futex_cond_t* c, nvm_adaptive_mutex_t* m, uint32_t timeout_ms) {
+    uint32_t seq = __atomic_load_n(&c->seq, __ATOMIC_ACQUIRE);
+
+    nvm_adaptive_mutex_release(m);
+    int ret = nvm_futex_wait(&c->seq, seq, timeout_ms);
+    nvm_adaptive_mutex_acquire(m);
+
+    return (ret == 0) ? 0 : ETIMEDOUT;
+}
+
+// ============================================================================
+//                          每 CPU 读者计数的读写锁
+// ============================================================================
+
+int nvm_percpu_rwlock_write_lock(nvm_percpu_rwlock_t* l) {
+    // 1. 写者之间互斥，同时阻止新读者进入
+    uint32_t expected = 0;
+    uint32_t spins = 0;
+    while (!__atomic_compare_exchange_n(&l->writer, &expected, 1, false,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+        expected = 0;
+        nvm_spin_backoff(&spins);
+    }
+
+    // 2. 等待已进入的读者全部离开
+    for (;;) {
+        int64_t sum = 0;
+        for (int i = 0; i < MAX_CPUS; ++i) {
+            sum += __atomic_load_n(&l->readers[i].count, __ATOMIC_SEQ_CST);
+        }
+        if (sum == 0) break;
+        nvm_spin_backoff(&spins);
+    }
+
+    __atomic_store_n(&l->write_owner, (const void*)&nvm_lock_thread_tag, __ATOMIC_RELAXED);
+    return 0;
+}
+
+// ============================================================================
+//                          内部函数实现
+// ============================================================================
+
+static void clh_create_key(void) {
+    pthread_key_create(&g_clh_key, clh_cache_destroy);
+}
+
+static void clh_cache_destroy(void* arg) {
+    ClhNodeCache* cache = (ClhNodeCache*)arg;
+    for (uint32_t i = 0; i < cache->count; ++i) {
+        free(cache->nodes[i]);
+    }
+    free(cache);
+    t_clh_cache = NULL;
+    t_clh_cache_gone = true;
+}
+
+static nvm_clh_node_t* clh_node_get(void) {
+    ClhNodeCache* cache = t_clh_cache;
+    if (cache && cache->count > 0) {
+        return cache->nodes[--cache->count];
+    }
+    return (nvm_clh_node_t*)aligned_alloc(CACHE_LINE_SIZE, sizeof(nvm_clh_node_t));
+}
+
+static void clh_node_put(nvm_clh_node_t* node) {
+    ClhNodeCache* cache = t_clh_cache;
+    if (NVM_UNLIKELY(!cache)) {
+        // 线程正在退出：不再重建缓存，否则析构函数需再跑一轮且可能泄漏
+        if (t_clh_cache_gone) {
+            free(node);
+            return;
+        }
+        pthread_once(&g_clh_key_once, clh_create_key);
+        cache = (ClhNodeCache*)calloc(1, sizeof(ClhNodeCache));
+        if (!cache) {
+            free(node);
+            return;
+        }
+        pthread_setspecific(g_clh_key, cache);
+        t_clh_cache = cache;
+    }
+
+    if (cache->count < NVM_LOCK_MAX_NESTING) {
+        cache->nodes[cache->count++] = node;
+    } else {
+        free(node);
+    }
+}
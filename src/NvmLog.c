@@ -0,0 +1,486 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "NvmDefs.h"
+#include "NvmPersist.h"
+#include "NvmLog.h"
+
+// ============================================================================
+//                          常量定义
+// ============================================================================
+
+#define NVM_LOG_MAGIC           0x4E564D4C4F473031ULL   // "NVMLOG01"
+#define NVM_LOG_VERSION         1
+
+// 最小块 (8B) 时一个 Slab 的位图字节数
+#define NVM_LOG_BITMAP_BYTES    (NVM_SLAB_SIZE / 8 / 8)
+
+// 记录编码: [0,44) 块偏移 / 8 | [44,48) 尺寸类别 | [48,50) 操作 | [50,64) 圈号
+#define REC_OFFSET_BITS         44
+#define REC_SC_SHIFT            44
+#define REC_OP_SHIFT            48
+#define REC_LAP_SHIFT           50
+#define REC_LAP_MASK            0x3FFFULL
+
+// ============================================================================
+//                          核心数据结构
+// ============================================================================
+
+// NVM 头部 (格式化时最后写入 magic)
+typedef struct NvmLogHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t cpu_count;
+    uint32_t capacity;
+    uint32_t slab_count;
+    uint64_t data_offset;
+    uint64_t data_size;
+} __attribute__((aligned(CACHE_LINE_SIZE))) NvmLogHeader;
+
+// NVM 中每个 CPU 日志的持久化截断点
+typedef struct NvmLogCpuHeader {
+    uint64_t head;
+} __attribute__((aligned(CACHE_LINE_SIZE))) NvmLogCpuHeader;
+
+// NVM 中一个 Slab 的持久化位图镜像
+typedef struct NvmSlabImage {
+    uint8_t       size_class;                 // NVM_LOG_SC_NONE 表示未使用
+    uint8_t       _padding[CACHE_LINE_SIZE - 1];
+    unsigned char bitmap[NVM_LOG_BITMAP_BYTES];
+} NvmSlabImage;
+
+// DRAM 中每个 CPU 日志的运行状态
+typedef struct NvmCpuLog {
+    nvm_mutex_t lock;
+    uint64_t    head;      // 已折叠位置 (与 NVM 中一致)
+    uint64_t    tail;      // 下一条记录位置
+} __attribute__((aligned(CACHE_LINE_SIZE))) NvmCpuLog;
+
+typedef struct NvmLogRegion {
+    NvmLogHeader*    header;
+    NvmLogCpuHeader* cpu_headers;
+    uint64_t*        records;        // MAX_CPUS x NVM_LOG_CAPACITY
+    NvmSlabImage*    images;
+
+    uint64_t         data_offset;
+    uint32_t         slab_count;
+
+    NvmCpuLog        logs[MAX_CPUS];
+
+    // 后台检查点线程
+    uint32_t         checkpoint_ms;
+    bool             stopping;
+    nvm_mutex_t      worker_lock;
+    nvm_cond_t       worker_cond;
+    nvm_thread_t     worker;
+} NvmLogRegion;
+
+// ============================================================================
+//                          内部函数前向声明
+// ============================================================================
+
+static uint64_t layout_records_offset(void);
+static uint64_t layout_images_offset(void);
+static uint64_t encode_record(NvmLogOp op, uint64_t block_offset, SizeClassID sc_id, uint64_t pos);
+static bool     record_is_valid(uint64_t rec, uint64_t pos);
+static uint64_t* record_slot(NvmLogRegion* region, int cpu, uint64_t pos);
+static void     apply_record(NvmLogRegion* region, uint64_t rec, uintptr_t* last_flushed);
+static void     fold_log_locked(NvmLogRegion* region, int cpu);
+static void     format_region(NvmLogRegion* region, uint64_t data_size);
+static int      recover_region(NvmLogRegion* region, uint64_t data_size);
+static void     log_region_release(NvmLogRegion* region, bool checkpoint);
+static void*    checkpoint_worker_main(void* arg);
+
+// ============================================================================
+//                          公共 API 实现
+// ============================================================================
+
+uint64_t nvm_log_region_size(uint64_t data_size) {
+    uint64_t slab_count = data_size / NVM_SLAB_SIZE;
+    uint64_t bytes = layout_images_offset() + slab_count * sizeof(NvmSlabImage);
+    return NVM_ALIGN_UP(bytes, (uint64_t)NVM_SLAB_SIZE);
+}
+
+NvmLogRegion* nvm_log_region_create(void* meta_addr, uint64_t data_offset, uint64_t data_size,
+                                    bool recover, uint32_t checkpoint_ms) {
+    if (!meta_addr || data_offset % NVM_SLAB_SIZE != 0 || data_size < NVM_SLAB_SIZE) return NULL;
+
+    NvmLogRegion* region = (NvmLogRegion*)calloc(1, sizeof(NvmLogRegion));
+    if (!region) {
+        LOG_ERR("Failed to allocate log region struct.");
+        return NULL;
+    }
+
+    unsigned char* base = (unsigned char*)meta_addr;
+    region->header        = (NvmLogHeader*)base;
+    region->cpu_headers   = (NvmLogCpuHeader*)(base + sizeof(NvmLogHeader));
+    region->records       = (uint64_t*)(base + layout_records_offset());
+    region->images        = (NvmSlabImage*)(base + layout_images_offset());
+    region->data_offset   = data_offset;
+    region->slab_count    = (uint32_t)(data_size / NVM_SLAB_SIZE);
+    region->checkpoint_ms = checkpoint_ms;
+
+    int cpu = 0;
+    for (; cpu < MAX_CPUS; ++cpu) {
+        if (NVM_MUTEX_INIT(&region->logs[cpu].lock) != 0) {
+            LOG_ERR("Failed to init log mutex.");
+            goto err_destroy_logs;
+        }
+    }
+
+    if (recover) {
+        if (recover_region(region, data_size) != 0) goto err_destroy_logs;
+    } else {
+        format_region(region, data_size);
+    }
+
+    if (checkpoint_ms > 0) {
+        if (NVM_MUTEX_INIT(&region->worker_lock) != 0) {
+            LOG_ERR("Failed to init checkpoint mutex.");
+            goto err_destroy_logs;
+        }
+        if (NVM_COND_INIT(&region->worker_cond) != 0) {
+            LOG_ERR("Failed to init checkpoint condition.");
+            goto err_destroy_worker_lock;
+        }
+        if (NVM_THREAD_CREATE(&region->worker, checkpoint_worker_main, region) != 0) {
+            LOG_ERR("Failed to start checkpoint worker.");
+            goto err_destroy_worker_cond;
+        }
+    }
+
+    return region;
+
+err_destroy_worker_cond:
+    NVM_COND_DESTROY(&region->worker_cond);
+err_destroy_worker_lock:
+    NVM_MUTEX_DESTROY(&region->worker_lock);
+err_destroy_logs:
+    while (--cpu >= 0) {
+        NVM_MUTEX_DESTROY(&region->logs[cpu].lock);
+    }
+    free(region);
+    return NULL;
+}
+
+void nvm_log_region_destroy(NvmLogRegion* region) {
+    log_region_release(region, true);
+}
+
+int nvm_log_append(NvmLogRegion* region, int cpu, NvmLogOp op, uint64_t block_offset, SizeClassID sc_id) {
+    if (!region || cpu < 0 || cpu >= MAX_CPUS || sc_id >= SC_COUNT) return -1;
+    if (op != NVM_LOG_OP_ALLOC && op != NVM_LOG_OP_FREE) return -1;
+
+    NvmCpuLog* log = &region->logs[cpu];
+    NVM_MUTEX_ACQUIRE(&log->lock);
+
+    // 日志已满：在调用线程上同步折叠
+    if (log->tail - log->head >= NVM_LOG_CAPACITY) {
+        fold_log_locked(region, cpu);
+    }
+
+    uint64_t* slot = record_slot(region, cpu, log->tail);
+    __atomic_store_n(slot, encode_record(op, block_offset, sc_id, log->tail), __ATOMIC_RELAXED);
+    nvm_persist(slot, sizeof(*slot));
+    log->tail++;
+
+    bool half_full = (log->tail - log->head == NVM_LOG_CAPACITY / 2);
+    NVM_MUTEX_RELEASE(&log->lock);
+
+    // 过半时提前唤醒检查点线程，尽量避免在热路径上同步折叠
+    if (half_full && region->checkpoint_ms > 0) {
+        NVM_MUTEX_ACQUIRE(&region->worker_lock);
+        NVM_COND_SIGNAL(&region->worker_cond);
+        NVM_MUTEX_RELEASE(&region->worker_lock);
+    }
+    return 0;
+}
+
+int nvm_log_try_append(NvmLogRegion* region, int cpu, NvmLogOp op, uint64_t block_offset, SizeClassID sc_id) {
+    if (!region || cpu < 0 || cpu >= MAX_CPUS || sc_id >= SC_COUNT) return -1;
+    if (op != NVM_LOG_OP_ALLOC && op != NVM_LOG_OP_FREE) return -1;
+
+    NvmCpuLog* log = &region->logs[cpu];
+    if (NVM_MUTEX_TRYACQUIRE(&log->lock) != 0) return -1;
+
+    if (log->tail - log->head >= NVM_LOG_CAPACITY) {
+        NVM_MUTEX_RELEASE(&log->lock);
+        return -1;
+    }
+
+    uint64_t* slot = record_slot(region, cpu, log->tail);
+    __atomic_store_n(slot, encode_record(op, block_offset, sc_id, log->tail), __ATOMIC_RELAXED);
+    nvm_persist(slot, sizeof(*slot));
+    log->tail++;
+
+    NVM_MUTEX_RELEASE(&log->lock);
+    return 0;
+}
+
+void nvm_log_checkpoint(NvmLogRegion* region) {
+    if (!region) return;
+
+    for (int cpu = 0; cpu < MAX_CPUS; ++cpu) {
+        NvmCpuLog* log = &region->logs[cpu];
+        NVM_MUTEX_ACQUIRE(&log->lock);
+        if (log->tail != log->head) {
+            fold_log_locked(region, cpu);
+        }
+        NVM_MUTEX_RELEASE(&log->lock);
+    }
+}
+
+int nvm_log_slab_image(NvmLogRegion* region, uint32_t slab_idx, uint8_t* out_sc, const unsigned char** out_bitmap) {
+    if (!region || slab_idx >= region->slab_count || !out_sc || !out_bitmap) return -1;
+
+    *out_sc     = region->images[slab_idx].size_class;
+    *out_bitmap = region->images[slab_idx].bitmap;
+    return 0;
+}
+
+uint32_t nvm_log_slab_count(NvmLogRegion* region) {
+    return region ? region->slab_count : 0;
+}
+
+uint32_t nvm_log_pending(NvmLogRegion* region, int cpu) {
+    if (!region || cpu < 0 || cpu >= MAX_CPUS) return 0;
+
+    NvmCpuLog* log = &region->logs[cpu];
+    NVM_MUTEX_ACQUIRE(&log->lock);
+    uint32_t pending = (uint32_t)(log->tail - log->head);
+    NVM_MUTEX_RELEASE(&log->lock);
+    return pending;
+}
+
+int nvm_log_inspect_layout(const void* meta_addr, uint64_t avail, NvmLogLayout* out) {
+    if (!meta_addr || !out || avail < sizeof(NvmLogHeader)) return -1;
+
+    const NvmLogHeader* header = (const NvmLogHeader*)meta_addr;
+    if (header->magic != NVM_LOG_MAGIC || header->version != NVM_LOG_VERSION ||
+        header->cpu_count != MAX_CPUS || header->capacity != NVM_LOG_CAPACITY) {
+        return -1;
+    }
+
+    uint64_t meta_size = nvm_log_region_size(header->data_size);
+    if (header->slab_count != header->data_size / NVM_SLAB_SIZE || header->data_offset < meta_size ||
+        header->data_offset > avail || header->data_size > avail - header->data_offset) {
+        return -1;
+    }
+
+    out->meta_size   = meta_size;
+    out->data_offset = header->data_offset;
+    out->data_size   = header->data_size;
+    out->slab_count  = header->slab_count;
+    return 0;
+}
+
+int nvm_log_inspect_image(const void* meta_addr, uint32_t slab_idx, uint8_t** out_sc, unsigned char** out_bitmap) {
+    if (!meta_addr || !out_sc || !out_bitmap) return -1;
+
+    const NvmLogHeader* header = (const NvmLogHeader*)meta_addr;
+    if (slab_idx >= header->slab_count) return -1;
+
+    NvmSlabImage* image = (NvmSlabImage*)((char*)meta_addr + layout_images_offset()) + slab_idx;
+    *out_sc     = &image->size_class;
+    *out_bitmap = image->bitmap;
+    return 0;
+}
+
+uint32_t nvm_log_inspect_pending(const void* meta_addr, int cpu, NvmLogRecord* out) {
+    if (!meta_addr || !out || cpu < 0 || cpu >= MAX_CPUS) return 0;
+
+    const char* base = (const char*)meta_addr;
+    const NvmLogCpuHeader* cpu_header = (const NvmLogCpuHeader*)(base + sizeof(NvmLogHeader)) + cpu;
+    const uint64_t* records = (const uint64_t*)(base + layout_records_offset()) + (uint64_t)cpu * NVM_LOG_CAPACITY;
+
+    // 与恢复相同：从截断点向后扫描圈号匹配的记录
+    uint64_t head = cpu_header->head;
+    uint32_t count = 0;
+    while (count < NVM_LOG_CAPACITY) {
+        uint64_t pos = head + count;
+        uint64_t rec = records[pos % NVM_LOG_CAPACITY];
+        if (!record_is_valid(rec, pos)) break;
+
+        out[count].block_offset = (rec & ((1ULL << REC_OFFSET_BITS) - 1)) << 3;
+        out[count].sc_id        = (uint8_t)((rec >> REC_SC_SHIFT) & 0xF);
+        out[count].op           = (uint8_t)((rec >> REC_OP_SHIFT) & 0x3);
+        count++;
+    }
+    return count;
+}
+
+// ============================================================================
+//                          内部函数实现
+// ============================================================================
+
+static uint64_t layout_records_offset(void) {
+    return sizeof(NvmLogHeader) + (uint64_t)MAX_CPUS * sizeof(NvmLogCpuHeader);
+}
+
+static uint64_t layout_images_offset(void) {
+    uint64_t end = layout_records_offset() + (uint64_t)MAX_CPUS * NVM_LOG_CAPACITY * sizeof(uint64_t);
+    return NVM_ALIGN_UP(end, (uint64_t)CACHE_LINE_SIZE);
+}
+
+// 圈号从 1 开始，使全零的新日志槽位永远无效
+static uint64_t lap_of(uint64_t pos) {
+    return ((pos / NVM_LOG_CAPACITY) % REC_LAP_MASK) + 1;
+}
+
+static uint64_t encode_record(NvmLogOp op, uint64_t block_offset, SizeClassID sc_id, uint64_t pos) {
+    return ((block_offset >> 3) & ((1ULL << REC_OFFSET_BITS) - 1)) |
+           ((uint64_t)sc_id << REC_SC_SHIFT) |
+           ((uint64_t)op << REC_OP_SHIFT) |
+           (lap_of(pos) << REC_LAP_SHIFT);
+}
+
+// 槽位中残留的上一圈记录圈号不同，据此确定日志尾部
+static bool record_is_valid(uint64_t rec, uint64_t pos) {
+    return (rec >> REC_LAP_SHIFT) == lap_of(pos);
+}
+
+static uint64_t* record_slot(NvmLogRegion* region, int cpu, uint64_t pos) {
+    return &region->records[(uint64_t)cpu * NVM_LOG_CAPACITY + pos % NVM_LOG_CAPACITY];
+}
+
+// 把一条记录应用到 Slab 镜像并回写 (不含屏障)。连续落在同一缓存行的更新只回写一次。
+static void apply_record(NvmLogRegion* region, uint64_t rec, uintptr_t* last_flushed) {
+    uint64_t    block_offset = (rec & ((1ULL << REC_OFFSET_BITS) - 1)) << 3;
+    SizeClassID sc_id        = (SizeClassID)((rec >> REC_SC_SHIFT) & 0xF);
+    NvmLogOp    op           = (NvmLogOp)((rec >> REC_OP_SHIFT) & 0x3);
+
+    if (block_offset < region->data_offset || sc_id >= SC_COUNT) return;
+    uint64_t slab_idx = (block_offset - region->data_offset) / NVM_SLAB_SIZE;
+    if (slab_idx >= region->slab_count) return;
+
+    NvmSlabImage* image = &region->images[slab_idx];
+    if (image->size_class != sc_id) {
+        // Slab 首次使用 (或以新的尺寸类别重新使用)：清空镜像
+        nvm_persist_memset_nt(image->bitmap, 0, NVM_LOG_BITMAP_BYTES);
+        image->size_class = (uint8_t)sc_id;
+        nvm_persist(&image->size_class, sizeof(image->size_class));
+    }
+
+    uint32_t block_size = 8u << sc_id;
+    uint32_t block_idx  = (uint32_t)((block_offset - region->data_offset) % NVM_SLAB_SIZE / block_size);
+    unsigned char* byte = &image->bitmap[block_idx / 8];
+
+    if (op == NVM_LOG_OP_ALLOC) *byte |= (unsigned char)(1u << (block_idx % 8));
+    else                        *byte &= (unsigned char)~(1u << (block_idx % 8));
+
+    uintptr_t line = NVM_ALIGN_DOWN((uintptr_t)byte, CACHE_LINE_SIZE);
+    if (line != *last_flushed) {
+        nvm_persist_flush((const void*)line, CACHE_LINE_SIZE);
+        *last_flushed = line;
+    }
+}
+
+// 假设已持有该日志的锁
+static void fold_log_locked(NvmLogRegion* region, int cpu) {
+    NvmCpuLog* log = &region->logs[cpu];
+    uintptr_t last_flushed = 0;
+
+    for (uint64_t pos = log->head; pos < log->tail; ++pos) {
+        apply_record(region, *record_slot(region, cpu, pos), &last_flushed);
+    }
+    // 镜像先于截断点落盘：截断点之前崩溃只会导致幂等的重复应用
+    nvm_persist_fence();
+
+    log->head = log->tail;
+    region->cpu_headers[cpu].head = log->tail;
+    nvm_persist(&region->cpu_headers[cpu].head, sizeof(uint64_t));
+}
+
+static void format_region(NvmLogRegion* region, uint64_t data_size) {
+    NvmLogHeader* header = region->header;
+
+    // 头部 magic 最后写入：格式化中途崩溃时恢复会拒绝该区域
+    header->magic = 0;
+    nvm_persist(&header->magic, sizeof(header->magic));
+
+    nvm_persist_memset_nt(region->cpu_headers, 0, (uint64_t)MAX_CPUS * sizeof(NvmLogCpuHeader));
+    nvm_persist_memset_nt(region->records, 0, (uint64_t)MAX_CPUS * NVM_LOG_CAPACITY * sizeof(uint64_t));
+    for (uint32_t i = 0; i < region->slab_count; ++i) {
+        region->images[i].size_class = NVM_LOG_SC_NONE;
+        nvm_persist_flush(&region->images[i].size_class, 1);
+    }
+
+    header->version     = NVM_LOG_VERSION;
+    header->cpu_count   = MAX_CPUS;
+    header->capacity    = NVM_LOG_CAPACITY;
+    header->slab_count  = region->slab_count;
+    header->data_offset = region->data_offset;
+    header->data_size   = data_size;
+    nvm_persist(header, sizeof(*header));
+
+    header->magic = NVM_LOG_MAGIC;
+    nvm_persist(&header->magic, sizeof(header->magic));
+}
+
+static int recover_region(NvmLogRegion* region, uint64_t data_size) {
+    const NvmLogHeader* header = region->header;
+    if (header->magic != NVM_LOG_MAGIC || header->version != NVM_LOG_VERSION ||
+        header->cpu_count != MAX_CPUS || header->capacity != NVM_LOG_CAPACITY ||
+        header->data_offset != region->data_offset || header->data_size != data_size) {
+        LOG_ERR("Log region header mismatch, cannot recover.");
+        return -1;
+    }
+
+    // 从持久化截断点向后扫描有效记录，确定日志尾部后折叠
+    for (int cpu = 0; cpu < MAX_CPUS; ++cpu) {
+        NvmCpuLog* log = &region->logs[cpu];
+        log->head = region->cpu_headers[cpu].head;
+        log->tail = log->head;
+        while (log->tail - log->head < NVM_LOG_CAPACITY &&
+               record_is_valid(*record_slot(region, cpu, log->tail), log->tail)) {
+            log->tail++;
+        }
+        if (log->tail != log->head) {
+            fold_log_locked(region, cpu);
+        }
+    }
+    return 0;
+}
+
+static void log_region_release(NvmLogRegion* region, bool checkpoint) {
+    if (!region) return;
+
+    if (region->checkpoint_ms > 0) {
+        NVM_MUTEX_ACQUIRE(&region->worker_lock);
+        region->stopping = true;
+        NVM_COND_BROADCAST(&region->worker_cond);
+        NVM_MUTEX_RELEASE(&region->worker_lock);
+
+        NVM_THREAD_JOIN(region->worker);
+        NVM_COND_DESTROY(&region->worker_cond);
+        NVM_MUTEX_DESTROY(&region->worker_lock);
+    }
+
+    if (checkpoint) {
+        nvm_log_checkpoint(region);
+    }
+
+    for (int cpu = 0; cpu < MAX_CPUS; ++cpu) {
+        NVM_MUTEX_DESTROY(&region->logs[cpu].lock);
+    }
+    free(region);
+}
+
+// 后台线程：周期性 (或日志过半时被唤醒) 折叠所有日志
+static void* checkpoint_worker_main(void* arg) {
+    NvmLogRegion* region = (NvmLogRegion*)arg;
+
+    NVM_MUTEX_ACQUIRE(&region->worker_lock);
+    while (!region->stopping) {
+        NVM_COND_TIMEDWAIT_MS(&region->worker_cond, &region->worker_lock, region->checkpoint_ms);
+        if (region->stopping) break;
+
+        NVM_MUTEX_RELEASE(&region->worker_lock);
+        nvm_log_checkpoint(region);
+        NVM_MUTEX_ACQUIRE(&region->worker_lock);
+    }
+    NVM_MUTEX_RELEASE(&region->worker_lock);
+
+    return NULL;
+}
@@ -0,0 +1,193 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "NvmDefs.h"
+#include "NvmMetaArena.h"
+
+// ============================================================================
+//                          核心数据结构
+// ============================================================================
+
+#define NVM_META_SMALL_CLASSES  (NVM_META_SMALL_MAX / NVM_META_SMALL_STEP)
+
+// 空闲块 (侵入式单链表，复用块的前 8 字节)
+typedef struct NvmMetaFreeBlock {
+    struct NvmMetaFreeBlock* next;
+} NvmMetaFreeBlock;
+
+// 每个 NUMA 节点一个 arena。元数据分配只发生在慢路径 (新建 Slab、插入哈希表、切割空闲段)，
+// 一把自旋锁保护全部空闲链表与切分游标；映射新块在锁外进行
+typedef struct NvmMetaArena {
+    nvm_spinlock_t    lock;
+    char*             bump;                             // 当前块中下一个未切分的位置
+    size_t            bump_left;                        // 当前块剩余字节
+    NvmMetaFreeBlock* free_lists[NVM_META_CLASS_COUNT];
+    NvmMetaArenaStats stats;
+} __attribute__((aligned(CACHE_LINE_SIZE))) NvmMetaArena;
+
+// [0] 为不绑定节点的 arena，[node + 1] 为各节点的 arena
+static NvmMetaArena   g_arenas[MAX_NUMA_NODES + 1];
+static pthread_once_t g_arena_once = PTHREAD_ONCE_INIT;
+
+// ============================================================================
+//                          内部函数前向声明
+// ============================================================================
+
+static void          init_arenas(void);
+static NvmMetaArena* arena_of(int node);
+static uint32_t      size_to_class(size_t size);
+static size_t        class_size(uint32_t sc);
+static uint32_t      class_floor(size_t size);
+static void          retire_remainder_locked(NvmMetaArena* arena);
+
+// ============================================================================
+//                          公共 API 实现
+// ============================================================================
+
+void* nvm_meta_alloc(size_t size, int node) {
+    if (size == 0) return NULL;
+    if (size > NVM_META_MAX_SIZE) return nvm_numa_alloc(size, node);
+
+    NvmMetaArena* arena = arena_of(node);
+    if (!arena) {
+        LOG_ERR("Invalid metadata arena node: %d", node);
+        return NULL;
+    }
+
+    uint32_t sc = size_to_class(size);
+    size_t bytes = class_size(sc);
+
+    NVM_SPINLOCK_ACQUIRE(&arena->lock);
+    NvmMetaFreeBlock* block = arena->free_lists[sc];
+    if (block) {
+        arena->free_lists[sc] = block->next;
+        arena->stats.bytes_cached -= bytes;
+        arena->stats.bytes_in_use += bytes;
+        NVM_SPINLOCK_RELEASE(&arena->lock);
+        memset(block, 0, bytes);
+        return block;
+    }
+
+    if (arena->bump_left < bytes) {
+        NVM_SPINLOCK_RELEASE(&arena->lock);
+
+        bool hugetlb = false;
+        char* chunk = (char*)nvm_huge_page_alloc(NVM_META_CHUNK_SIZE, node, &hugetlb);
+        if (!chunk) {
+            LOG_ERR("Failed to map metadata chunk.");
+            return NULL;
+        }
+
+        // 并发映射的另一块可能已被装上：它的剩余部分同样切进空闲链表，不会丢失
+        NVM_SPINLOCK_ACQUIRE(&arena->lock);
+        retire_remainder_locked(arena);
+        arena->bump = chunk;
+        arena->bump_left = NVM_META_CHUNK_SIZE;
+        arena->stats.chunk_count++;
+        if (hugetlb) arena->stats.hugetlb_chunks++;
+    }
+
+    // 新块来自匿名映射，尚未切分的部分必为零
+    void* ptr = arena->bump;
+    arena->bump += bytes;
+    arena->bump_left -= bytes;
+    arena->stats.bytes_in_use += bytes;
+    NVM_SPINLOCK_RELEASE(&arena->lock);
+    return ptr;
+}
+
+void nvm_meta_free(void* ptr, size_t size, int node) {
+    if (!ptr || size == 0) return;
+    if (size > NVM_META_MAX_SIZE) {
+        nvm_numa_free(ptr, size, node);
+        return;
+    }
+
+    NvmMetaArena* arena = arena_of(node);
+    if (!arena) {
+        LOG_ERR("Invalid metadata arena node: %d", node);
+        return;
+    }
+
+    uint32_t sc = size_to_class(size);
+    NvmMetaFreeBlock* block = (NvmMetaFreeBlock*)ptr;
+
+    NVM_SPINLOCK_ACQUIRE(&arena->lock);
+    block->next = arena->free_lists[sc];
+    arena->free_lists[sc] = block;
+    arena->stats.bytes_in_use -= class_size(sc);
+    arena->stats.bytes_cached += class_size(sc);
+    NVM_SPINLOCK_RELEASE(&arena->lock);
+}
+
+int nvm_meta_arena_stats(int node, NvmMetaArenaStats* out) {
+    NvmMetaArena* arena = arena_of(node);
+    if (!arena || !out) return -1;
+
+    NVM_SPINLOCK_ACQUIRE(&arena->lock);
+    *out = arena->stats;
+    NVM_SPINLOCK_RELEASE(&arena->lock);
+    return 0;
+}
+
+// ============================================================================
+//                          内部函数实现
+// ============================================================================
+
+static void init_arenas(void) {
+    for (int i = 0; i <= MAX_NUMA_NODES; ++i) {
+        NVM_SPINLOCK_INIT(&g_arenas[i].lock);
+    }
+}
+
+static NvmMetaArena* arena_of(int node) {
+    if (node < -1 || node >= MAX_NUMA_NODES) return NULL;
+    pthread_once(&g_arena_once, init_arenas);
+    return &g_arenas[node + 1];
+}
+
+// 尺寸类别：(0, 1KB] 按 64B 递增，(1KB, 64KB] 按 1KB 递增
+static uint32_t size_to_class(size_t size) {
+    if (size <= NVM_META_SMALL_MAX) {
+        return (uint32_t)(NVM_ALIGN_UP(size, (size_t)NVM_META_SMALL_STEP) / NVM_META_SMALL_STEP) - 1;
+    }
+    return NVM_META_SMALL_CLASSES - 1 +
+           (uint32_t)((NVM_ALIGN_UP(size, (size_t)NVM_META_LARGE_STEP) - NVM_META_SMALL_MAX) / NVM_META_LARGE_STEP);
+}
+
+static size_t class_size(uint32_t sc) {
+    if (sc < NVM_META_SMALL_CLASSES) {
+        return (size_t)(sc + 1) * NVM_META_SMALL_STEP;
+    }
+    return NVM_META_SMALL_MAX + (size_t)(sc - NVM_META_SMALL_CLASSES + 1) * NVM_META_LARGE_STEP;
+}
+
+// 不超过 size 的最大尺寸类别 (size >= NVM_META_SMALL_STEP)
+static uint32_t class_floor(size_t size) {
+    if (size >= NVM_META_MAX_SIZE) return NVM_META_CLASS_COUNT - 1;
+    if (size < NVM_META_SMALL_MAX + NVM_META_LARGE_STEP) {
+        size_t small = size < NVM_META_SMALL_MAX ? size : NVM_META_SMALL_MAX;
+        return (uint32_t)(small / NVM_META_SMALL_STEP) - 1;
+    }
+    return NVM_META_SMALL_CLASSES - 1 + (uint32_t)((size - NVM_META_SMALL_MAX) / NVM_META_LARGE_STEP);
+}
+
+// 假设已持锁：把当前块的剩余空间按能容纳的最大类别切进空闲链表
+static void retire_remainder_locked(NvmMetaArena* arena) {
+    while (arena->bump_left >= NVM_META_SMALL_STEP) {
+        uint32_t sc = class_floor(arena->bump_left);
+        size_t bytes = class_size(sc);
+
+        NvmMetaFreeBlock* block = (NvmMetaFreeBlock*)arena->bump;
+        block->next = arena->free_lists[sc];
+        arena->free_lists[sc] = block;
+        arena->stats.bytes_cached += bytes;
+
+        arena->bump += bytes;
+        arena->bump_left -= bytes;
+    }
+    arena->bump = NULL;
+    arena->bump_left = 0;
+}
@@ -0,0 +1,356 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#endif
+
+#include "NvmDefs.h"
+#include "NvmConfig.h"
+
+// ============================================================================
+//                          常量定义
+// ============================================================================
+
+// mbind 策略: 优先在指定节点分配，不足时允许回退
+#define NVM_MPOL_PREFERRED 1
+
+// 旧版头文件可能缺少的常量 (内核 4.15 / 5.14 引入)
+#ifdef __linux__
+#ifndef MAP_SHARED_VALIDATE
+#define MAP_SHARED_VALIDATE 0x03
+#endif
+#ifndef MAP_SYNC
+#define MAP_SYNC 0x80000
+#endif
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+#ifndef MAP_HUGETLB
+#define MAP_HUGETLB 0x40000
+#endif
+#ifndef MADV_HUGEPAGE
+#define MADV_HUGEPAGE 14
+#endif
+#endif
+
+// touch-ahead 步长 (最小页大小)
+#define NVM_PREFAULT_STRIDE 4096
+
+// ============================================================================
+//                          核心数据结构
+// ============================================================================
+
+// CPU -> NUMA 节点映射表 (真实拓扑与伪拓扑各一份)
+typedef struct NvmNumaTopology {
+    int node_count;
+    int cpu_to_node[MAX_CPUS];
+} NvmNumaTopology;
+
+static pthread_once_t  g_topology_once = PTHREAD_ONCE_INIT;
+static NvmNumaTopology g_real_topology;
+static NvmNumaTopology g_fake_topology;
+static bool            g_fake_enabled = false;
+
+// ============================================================================
+//                          内部函数前向声明
+// ============================================================================
+
+static void                   probe_real_topology(void);
+static const NvmNumaTopology* current_topology(void);
+static void                   touch_ahead(void* addr, size_t len);
+static void*                  map_file_range(const char* path, uint64_t offset, uint64_t size, void* hint, int flags);
+static void*                  alloc_cache_aligned(size_t size);
+static void                   bind_to_node(void* ptr, size_t size, int node);
+
+// ============================================================================
+//                          公共 API 实现
+// ============================================================================
+
+int nvm_get_allowed_cpus(uint8_t allowed[MAX_CPUS]) {
+    if (!allowed) return -1;
+
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        memset(allowed, 0, MAX_CPUS);
+        // 编号不小于 MAX_CPUS 的 CPU 不参与折叠，否则会把其他 CPU ID 误报为可用
+        for (int cpu = 0; cpu < CPU_SETSIZE && cpu < MAX_CPUS; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) allowed[cpu] = 1;
+        }
+        return 0;
+    }
+    memset(allowed, 1, MAX_CPUS);
+    return -1;
+#else
+    memset(allowed, 1, MAX_CPUS);
+    return 0;
+#endif
+}
+
+int nvm_numa_node_count(void) {
+    return current_topology()->node_count;
+}
+
+int nvm_numa_node_of_cpu(int cpu_id) {
+    if (cpu_id < 0 || cpu_id >= MAX_CPUS) return 0;
+    return current_topology()->cpu_to_node[cpu_id];
+}
+
+void nvm_numa_set_fake_topology(int node_count, const int* cpu_to_node, int cpu_count) {
+    if (node_count <= 0 || node_count > MAX_NUMA_NODES) {
+        LOG_ERR("Invalid fake node count: %d", node_count);
+        return;
+    }
+
+    memset(&g_fake_topology, 0, sizeof(g_fake_topology));
+    g_fake_topology.node_count = node_count;
+    for (int i = 0; cpu_to_node && i < cpu_count && i < MAX_CPUS; ++i) {
+        int node = cpu_to_node[i];
+        g_fake_topology.cpu_to_node[i] = (node >= 0 && node < node_count) ? node : 0;
+    }
+    __atomic_store_n(&g_fake_enabled, true, __ATOMIC_RELEASE);
+}
+
+void nvm_numa_clear_fake_topology(void) {
+    __atomic_store_n(&g_fake_enabled, false, __ATOMIC_RELEASE);
+}
+
+void* nvm_numa_alloc(size_t size, int node) {
+    if (size == 0) return NULL;
+    if (node < 0) return alloc_cache_aligned(size);
+
+#ifdef __linux__
+    // 匿名映射天然清零，且只有首次访问时才真正分配物理页
+    void* ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) return NULL;
+
+    bind_to_node(ptr, size, node);
+    return ptr;
+#else
+    return alloc_cache_aligned(size);
+#endif
+}
+
+void nvm_numa_free(void* ptr, size_t size, int node) {
+    if (!ptr) return;
+    if (node < 0) {
+        free(ptr);
+        return;
+    }
+
+#ifdef __linux__
+    munmap(ptr, size);
+#else
+    (void)size;
+    free(ptr);
+#endif
+}
+
+void* nvm_huge_page_alloc(size_t size, int node, bool* out_hugetlb) {
+    if (out_hugetlb) *out_hugetlb = false;
+    if (size == 0 || size % NVM_HUGE_PAGE_SIZE != 0) return NULL;
+
+#ifdef __linux__
+    void* ptr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr != MAP_FAILED) {
+        if (out_hugetlb) *out_hugetlb = true;
+        bind_to_node(ptr, size, node);
+        return ptr;
+    }
+
+    // 未预留 hugetlbfs 页：多映射一个大页，裁掉首尾使起点对齐，交给透明大页
+    size_t span = size + NVM_HUGE_PAGE_SIZE;
+    char* raw = (char*)mmap(NULL, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return NULL;
+
+    char* aligned = (char*)NVM_ALIGN_UP((uintptr_t)raw, (uintptr_t)NVM_HUGE_PAGE_SIZE);
+    if (aligned > raw) munmap(raw, (size_t)(aligned - raw));
+    size_t tail = (size_t)(raw + span - (aligned + size));
+    if (tail > 0) munmap(aligned + size, tail);
+
+    (void)madvise(aligned, size, MADV_HUGEPAGE);
+    bind_to_node(aligned, size, node);
+    return aligned;
+#else
+    (void)node;
+    void* ptr = NULL;
+    if (posix_memalign(&ptr, NVM_HUGE_PAGE_SIZE, size) != 0) return NULL;
+    memset(ptr, 0, size);
+    return ptr;
+#endif
+}
+
+void nvm_huge_page_free(void* ptr, size_t size) {
+    if (!ptr) return;
+#ifdef __linux__
+    munmap(ptr, size);
+#else
+    (void)size;
+    free(ptr);
+#endif
+}
+
+void* nvm_pool_map(const char* path, uint64_t size, int flags) {
+    if (!path || size == 0) return NULL;
+    return map_file_range(path, 0, size, NULL, flags);
+}
+
+void* nvm_pool_grow(const char* path, void* base, uint64_t old_size, uint64_t new_size, int flags) {
+    if (!path || new_size <= old_size) return NULL;
+#ifdef __linux__
+    if (old_size % (uint64_t)sysconf(_SC_PAGESIZE) != 0) {
+        LOG_ERR("Pool grow offset %llu is not page aligned.", (unsigned long long)old_size);
+        return NULL;
+    }
+#endif
+
+    // 以原映射尾部为提示地址 (不使用 MAP_FIXED，绝不覆盖已有映射)
+    void* hint = base ? (char*)base + old_size : NULL;
+    return map_file_range(path, old_size, new_size - old_size, hint, flags);
+}
+
+void nvm_pool_unmap(void* base, uint64_t size) {
+    if (!base) return;
+#ifdef __linux__
+    munmap(base, size);
+#else
+    (void)size;
+#endif
+}
+
+void nvm_os_prefault(void* addr, size_t len) {
+    if (!addr || len == 0) return;
+
+#ifdef __linux__
+    // madvise 要求页对齐：对齐部分交给内核，首尾零头逐页触碰
+    uintptr_t page  = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t start = NVM_ALIGN_UP((uintptr_t)addr, page);
+    uintptr_t end   = NVM_ALIGN_DOWN((uintptr_t)addr + len, page);
+
+    if (start < end && madvise((void*)start, end - start, MADV_POPULATE_WRITE) == 0) {
+        touch_ahead(addr, start - (uintptr_t)addr);
+        touch_ahead((void*)end, (uintptr_t)addr + len - end);
+        return;
+    }
+#endif
+    touch_ahead(addr, len);
+}
+
+// ============================================================================
+//                          内部函数实现
+// ============================================================================
+
+// 把文件的 [offset, offset + size) 映射到内存，文件不足时先扩展
+static void* map_file_range(const char* path, uint64_t offset, uint64_t size, void* hint, int flags) {
+#ifdef __linux__
+    int fd = open(path, O_RDWR | O_CREAT, 0600);
+    if (fd < 0) {
+        LOG_ERR("Failed to open pool file %s.", path);
+        return NULL;
+    }
+
+    uint64_t end = offset + size;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || ((uint64_t)st.st_size < end && ftruncate(fd, (off_t)end) != 0)) {
+        LOG_ERR("Failed to size pool file %s.", path);
+        close(fd);
+        return NULL;
+    }
+
+    int extra = (flags & NVM_MAP_POPULATE) ? MAP_POPULATE : 0;
+    void* base = mmap(hint, size, PROT_READ | PROT_WRITE, MAP_SHARED_VALIDATE | MAP_SYNC | extra, fd, (off_t)offset);
+    if (base == MAP_FAILED) {
+        // 非 DAX 文件系统 (tmpfs、ext4 无 dax 挂载) 不支持 MAP_SYNC
+        base = mmap(hint, size, PROT_READ | PROT_WRITE, MAP_SHARED | extra, fd, (off_t)offset);
+    }
+    close(fd);
+
+    if (base == MAP_FAILED) {
+        LOG_ERR("Failed to map pool file %s.", path);
+        return NULL;
+    }
+    return base;
+#else
+    (void)path; (void)offset; (void)size; (void)hint; (void)flags;
+    LOG_ERR("nvm_pool_map is not supported on this platform.");
+    return NULL;
+#endif
+}
+
+static const NvmNumaTopology* current_topology(void) {
+    if (__atomic_load_n(&g_fake_enabled, __ATOMIC_ACQUIRE)) {
+        return &g_fake_topology;
+    }
+    pthread_once(&g_topology_once, probe_real_topology);
+    return &g_real_topology;
+}
+
+static void probe_real_topology(void) {
+    memset(&g_real_topology, 0, sizeof(g_real_topology));
+    g_real_topology.node_count = 1;
+
+#ifdef __linux__
+    char path[96];
+    int node_count = 0;
+
+    for (int node = 0; node < MAX_NUMA_NODES; ++node) {
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d", node);
+        if (access(path, F_OK) != 0) continue;
+        node_count = node + 1;
+
+        for (int cpu = 0; cpu < MAX_CPUS; ++cpu) {
+            snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpu%d", node, cpu);
+            if (access(path, F_OK) == 0) {
+                g_real_topology.cpu_to_node[cpu] = node;
+            }
+        }
+    }
+
+    if (node_count > 0) {
+        g_real_topology.node_count = node_count;
+    }
+#endif
+}
+
+// 逐页原子加 0：触发写缺页但不改变内容
+static void touch_ahead(void* addr, size_t len) {
+    if (len == 0) return;
+
+    unsigned char* p   = (unsigned char*)addr;
+    unsigned char* end = p + len;
+    for (; p < end; p += NVM_PREFAULT_STRIDE) {
+        __atomic_fetch_add(p, 0, __ATOMIC_RELAXED);
+    }
+    __atomic_fetch_add(end - 1, 0, __ATOMIC_RELAXED);
+}
+
+// 缓存行对齐的清零内存 (元数据结构按缓存行分组，需要对齐的起始地址)，可用 free 释放
+static void* alloc_cache_aligned(size_t size) {
+    void* ptr = NULL;
+    if (posix_memalign(&ptr, CACHE_LINE_SIZE, size) != 0) return NULL;
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+// 按 MPOL_PREFERRED 把区间绑定到节点 (node < 0 时不绑定)。
+// 绑定失败不影响正确性 (例如伪拓扑中不存在的节点)，只损失局部性
+static void bind_to_node(void* ptr, size_t size, int node) {
+#if defined(__linux__) && defined(SYS_mbind)
+    if (node < 0) return;
+    unsigned long node_mask = 1UL << node;
+    (void)syscall(SYS_mbind, ptr, size, NVM_MPOL_PREFERRED, &node_mask,
+                  sizeof(node_mask) * 8, 0);
+#else
+    (void)ptr; (void)size; (void)node;
+#endif
+}
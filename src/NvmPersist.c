@@ -0,0 +1,372 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "NvmDefs.h"
+#include "NvmPersist.h"
+
+// ============================================================================
+//                          仿真参数
+// ============================================================================
+
+// 写合并缓冲的介质行数 (XPBuffer 约 16KB = 64 x 256B)
+#define NVM_EMU_WCB_ENTRIES   64
+
+// 一个介质行包含的缓存行数，及其全部写满时的掩码
+#define NVM_EMU_SUBLINES      (NVM_MEDIA_LINE_SIZE / CACHE_LINE_SIZE)
+#define NVM_EMU_FULL_MASK     ((1u << NVM_EMU_SUBLINES) - 1)
+
+// ============================================================================
+//                          核心数据结构
+// ============================================================================
+
+// 写合并缓冲项：一个驻留的介质行及其已写入的子行掩码
+typedef struct NvmEmuLine {
+    uintptr_t media_line;   // 介质行号 (地址 / NVM_MEDIA_LINE_SIZE)
+    uint32_t  dirty_mask;   // 已回写的缓存行位图
+    bool      valid;
+} NvmEmuLine;
+
+// 仿真器状态：全局唯一，仅在开启仿真时加锁访问
+typedef struct NvmPersistEmu {
+    nvm_spinlock_t  lock;
+    bool            enabled;
+    uint32_t        next_victim;                    // FIFO 替换指针
+    NvmEmuLine      lines[NVM_EMU_WCB_ENTRIES];
+    NvmPersistStats stats;
+} NvmPersistEmu;
+
+// 流式写入内核：对 lines 个对齐缓存行执行填充/拷贝 (src 为 NULL 时填充 c)
+typedef void (*NvmStreamFn)(unsigned char* dst, const unsigned char* src, int c, size_t lines);
+
+static pthread_once_t g_persist_once = PTHREAD_ONCE_INIT;
+static NvmFlushKind   g_flush_kind   = NVM_FLUSH_NONE;
+static NvmStoreKind   g_store_kind   = NVM_STORE_CACHED;
+static NvmStreamFn    g_stream_fn    = NULL;
+static NvmPersistEmu  g_emu;
+
+// ============================================================================
+//                          内部函数前向声明
+// ============================================================================
+
+static void persist_init_once(void);
+static void flush_one_line(const void* line_addr);
+static void emu_record_line(uintptr_t line_addr);
+static void emu_evict(NvmEmuLine* entry);
+static void persist_bulk_nt(unsigned char* d, const unsigned char* s, int c, size_t len);
+static size_t head_bytes_to_line(const void* dst, size_t len);
+#if defined(__SSE2__)
+static void stream_lines_sse2(unsigned char* dst, const unsigned char* src, int c, size_t lines);
+#endif
+#if defined(__x86_64__)
+static void stream_lines_avx512(unsigned char* dst, const unsigned char* src, int c, size_t lines);
+#endif
+
+// ============================================================================
+//                          公共 API 实现
+// ============================================================================
+
+NvmFlushKind nvm_persist_flush_kind(void) {
+    pthread_once(&g_persist_once, persist_init_once);
+    return g_flush_kind;
+}
+
+void nvm_persist_flush(const void* addr, size_t len) {
+    if (!addr || len == 0) return;
+    pthread_once(&g_persist_once, persist_init_once);
+
+    uintptr_t start = NVM_ALIGN_DOWN((uintptr_t)addr, CACHE_LINE_SIZE);
+    uintptr_t end   = (uintptr_t)addr + len;
+    bool emulate = __atomic_load_n(&g_emu.enabled, __ATOMIC_RELAXED);
+
+    for (uintptr_t line = start; line < end; line += CACHE_LINE_SIZE) {
+        flush_one_line((const void*)line);
+        if (NVM_UNLIKELY(emulate)) {
+            emu_record_line(line);
+        }
+    }
+}
+
+void nvm_persist_fence(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __asm__ __volatile__("sfence" ::: "memory");
+#else
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#endif
+}
+
+void nvm_persist(const void* addr, size_t len) {
+    nvm_persist_flush(addr, len);
+    nvm_persist_fence();
+}
+
+NvmStoreKind nvm_persist_store_kind(void) {
+    pthread_once(&g_persist_once, persist_init_once);
+    return g_store_kind;
+}
+
+void nvm_persist_memset_nt(void* dst, int c, size_t len) {
+    if (!dst || len == 0) return;
+    persist_bulk_nt((unsigned char*)dst, NULL, c, len);
+}
+
+void nvm_persist_memcpy_nt(void* dst, const void* src, size_t len) {
+    if (!dst || !src || len == 0) return;
+    persist_bulk_nt((unsigned char*)dst, (const unsigned char*)src, 0, len);
+}
+
+void* nvm_memset_persist(void* dst, int c, size_t len) {
+    if (!dst || len == 0) return dst;
+
+    if (len < NVM_PERSIST_NT_THRESHOLD) {
+        memset(dst, c, len);
+        nvm_persist(dst, len);
+    } else {
+        persist_bulk_nt((unsigned char*)dst, NULL, c, len);
+    }
+    return dst;
+}
+
+void* nvm_memcpy_persist(void* dst, const void* src, size_t len) {
+    if (!dst || !src || len == 0) return dst;
+
+    if (len < NVM_PERSIST_NT_THRESHOLD) {
+        memcpy(dst, src, len);
+        nvm_persist(dst, len);
+    } else {
+        persist_bulk_nt((unsigned char*)dst, (const unsigned char*)src, 0, len);
+    }
+    return dst;
+}
+
+void nvm_persist_emu_enable(bool enable) {
+    pthread_once(&g_persist_once, persist_init_once);
+    __atomic_store_n(&g_emu.enabled, enable, __ATOMIC_RELEASE);
+}
+
+void nvm_persist_emu_reset(void) {
+    pthread_once(&g_persist_once, persist_init_once);
+
+    NVM_SPINLOCK_ACQUIRE(&g_emu.lock);
+    memset(g_emu.lines, 0, sizeof(g_emu.lines));
+    memset(&g_emu.stats, 0, sizeof(g_emu.stats));
+    g_emu.next_victim = 0;
+    NVM_SPINLOCK_RELEASE(&g_emu.lock);
+}
+
+void nvm_persist_emu_get_stats(NvmPersistStats* out_stats) {
+    if (!out_stats) return;
+    pthread_once(&g_persist_once, persist_init_once);
+
+    NVM_SPINLOCK_ACQUIRE(&g_emu.lock);
+    // 逐出所有驻留行，使统计包含尚未落盘的写入
+    for (uint32_t i = 0; i < NVM_EMU_WCB_ENTRIES; ++i) {
+        if (g_emu.lines[i].valid) {
+            emu_evict(&g_emu.lines[i]);
+        }
+    }
+    *out_stats = g_emu.stats;
+    NVM_SPINLOCK_RELEASE(&g_emu.lock);
+}
+
+double nvm_persist_emu_write_amplification(const NvmPersistStats* stats) {
+    if (!stats || stats->flushed_lines == 0) return 0.0;
+    return (double)(stats->media_writes * NVM_MEDIA_LINE_SIZE) /
+           (double)(stats->flushed_lines * CACHE_LINE_SIZE);
+}
+
+// ============================================================================
+//                          内部函数实现
+// ============================================================================
+
+static void persist_init_once(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (edx & (1u << 19))) {
+        g_flush_kind = NVM_FLUSH_CLFLUSH;
+    }
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        if (ebx & (1u << 24))      g_flush_kind = NVM_FLUSH_CLWB;
+        else if (ebx & (1u << 23)) g_flush_kind = NVM_FLUSH_CLFLUSHOPT;
+    }
+#endif
+
+    // 流式写入内核：AVX-512 (含 OS 的 ZMM 状态支持) > SSE2 > 普通写 + flush
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        g_store_kind = NVM_STORE_NT_AVX512;
+        g_stream_fn  = stream_lines_avx512;
+    } else
+#endif
+    {
+#if defined(__SSE2__)
+        g_store_kind = NVM_STORE_NT_SSE2;
+        g_stream_fn  = stream_lines_sse2;
+#endif
+    }
+
+    memset(&g_emu, 0, sizeof(g_emu));
+    if (NVM_SPINLOCK_INIT(&g_emu.lock) != 0) {
+        LOG_ERR("Failed to init persist emulation lock.");
+    }
+}
+
+static void flush_one_line(const void* line_addr) {
+#if defined(__x86_64__) || defined(__i386__)
+    // 直接使用编码，避免依赖 -mclwb / -mclflushopt 编译选项
+    switch (g_flush_kind) {
+        case NVM_FLUSH_CLWB:
+            __asm__ __volatile__(".byte 0x66; xsaveopt %0" : "+m"(*(volatile char*)line_addr));
+            break;
+        case NVM_FLUSH_CLFLUSHOPT:
+            __asm__ __volatile__(".byte 0x66; clflush %0" : "+m"(*(volatile char*)line_addr));
+            break;
+        case NVM_FLUSH_CLFLUSH:
+            __asm__ __volatile__("clflush %0" : "+m"(*(volatile char*)line_addr));
+            break;
+        default:
+            break;
+    }
+#else
+    (void)line_addr;
+#endif
+}
+
+// dst 到下一个缓存行边界的字节数 (不超过 len)
+static size_t head_bytes_to_line(const void* dst, size_t len) {
+    size_t head = (CACHE_LINE_SIZE - ((uintptr_t)dst & (CACHE_LINE_SIZE - 1))) & (CACHE_LINE_SIZE - 1);
+    return head < len ? head : len;
+}
+
+// 首尾不足一行的部分普通写 + flush，对齐主体流式写入，最后只发一次屏障。
+// src 为 NULL 时以 c 填充。
+static void persist_bulk_nt(unsigned char* d, const unsigned char* s, int c, size_t len) {
+    pthread_once(&g_persist_once, persist_init_once);
+
+    if (!g_stream_fn) {
+        if (s) memcpy(d, s, len);
+        else   memset(d, c, len);
+        nvm_persist(d, len);
+        return;
+    }
+
+    // 1. 头部：直到缓存行对齐
+    size_t head = head_bytes_to_line(d, len);
+    if (head > 0) {
+        if (s) memcpy(d, s, head);
+        else   memset(d, c, head);
+        nvm_persist_flush(d, head);
+        d += head;
+        if (s) s += head;
+        len -= head;
+    }
+
+    // 2. 主体：整行流式写入 (绕过缓存，无需 flush)
+    size_t lines = len / CACHE_LINE_SIZE;
+    if (lines > 0) {
+        g_stream_fn(d, s, c, lines);
+        if (NVM_UNLIKELY(__atomic_load_n(&g_emu.enabled, __ATOMIC_RELAXED))) {
+            for (size_t i = 0; i < lines; ++i) {
+                emu_record_line((uintptr_t)(d + i * CACHE_LINE_SIZE));
+            }
+        }
+        d += lines * CACHE_LINE_SIZE;
+        if (s) s += lines * CACHE_LINE_SIZE;
+        len -= lines * CACHE_LINE_SIZE;
+    }
+
+    // 3. 尾部
+    if (len > 0) {
+        if (s) memcpy(d, s, len);
+        else   memset(d, c, len);
+        nvm_persist_flush(d, len);
+    }
+
+    // 流式写入与 flush 共用一次屏障
+    nvm_persist_fence();
+}
+
+#if defined(__SSE2__)
+static void stream_lines_sse2(unsigned char* dst, const unsigned char* src, int c, size_t lines) {
+    const __m128i fill = _mm_set1_epi8((char)c);
+
+    for (size_t l = 0; l < lines; ++l, dst += CACHE_LINE_SIZE) {
+        for (size_t i = 0; i < CACHE_LINE_SIZE; i += sizeof(__m128i)) {
+            __m128i v = src ? _mm_loadu_si128((const __m128i*)(src + i)) : fill;
+            _mm_stream_si128((__m128i*)(dst + i), v);
+        }
+        if (src) src += CACHE_LINE_SIZE;
+    }
+}
+#endif
+
+#if defined(__x86_64__)
+// 运行时探测后才会调用，无需 -mavx512f 编译选项
+__attribute__((target("avx512f")))
+static void stream_lines_avx512(unsigned char* dst, const unsigned char* src, int c, size_t lines) {
+    const __m512i fill = _mm512_set1_epi8((char)c);
+
+    for (size_t l = 0; l < lines; ++l, dst += CACHE_LINE_SIZE) {
+        for (size_t i = 0; i < CACHE_LINE_SIZE; i += sizeof(__m512i)) {
+            __m512i v = src ? _mm512_loadu_si512((const void*)(src + i)) : fill;
+            _mm512_stream_si512((__m512i*)(dst + i), v);
+        }
+        if (src) src += CACHE_LINE_SIZE;
+    }
+}
+#endif
+
+// 调用者未持锁
+static void emu_record_line(uintptr_t line_addr) {
+    uintptr_t media_line = line_addr / NVM_MEDIA_LINE_SIZE;
+    uint32_t  sub_bit = 1u << ((line_addr % NVM_MEDIA_LINE_SIZE) / CACHE_LINE_SIZE);
+
+    NVM_SPINLOCK_ACQUIRE(&g_emu.lock);
+    g_emu.stats.flushed_lines++;
+
+    // 命中驻留行：合并写入 (整行写满也继续驻留，等待逐出时落盘)
+    for (uint32_t i = 0; i < NVM_EMU_WCB_ENTRIES; ++i) {
+        NvmEmuLine* entry = &g_emu.lines[i];
+        if (entry->valid && entry->media_line == media_line) {
+            entry->dirty_mask |= sub_bit;
+            NVM_SPINLOCK_RELEASE(&g_emu.lock);
+            return;
+        }
+    }
+
+    // 未命中：按 FIFO 逐出一个驻留行后插入
+    NvmEmuLine* victim = &g_emu.lines[g_emu.next_victim];
+    g_emu.next_victim = (g_emu.next_victim + 1) % NVM_EMU_WCB_ENTRIES;
+    if (victim->valid) {
+        emu_evict(victim);
+    }
+
+    victim->media_line = media_line;
+    victim->dirty_mask = sub_bit;
+    victim->valid      = true;
+
+    NVM_SPINLOCK_RELEASE(&g_emu.lock);
+}
+
+// 假设已持锁
+static void emu_evict(NvmEmuLine* entry) {
+    g_emu.stats.media_writes++;
+    if (entry->dirty_mask != NVM_EMU_FULL_MASK) {
+        g_emu.stats.media_rmw++;
+    }
+    entry->valid      = false;
+    entry->dirty_mask = 0;
+}
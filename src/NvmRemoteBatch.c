@@ -0,0 +1,421 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "NvmDefs.h"
+#include "NvmRemoteBatch.h"
+
+// ============================================================================
+//                          核心数据结构
+// ============================================================================
+
+// 一组发往同一 Slab 的远程释放
+typedef struct RemoteGroup {
+    NvmSlab* slab;                  // NULL 表示空闲组位
+    uint32_t count;
+    uint32_t block_idxs[NVM_REMOTE_BATCH_MAX];
+} RemoteGroup;
+
+// 线程缓存：只由所属线程入队，lock 供其他线程刷新 (几乎无竞争)
+typedef struct NvmRemoteCache {
+    nvm_spinlock_t         lock;
+    uint32_t               owner_exited;   // 1 表示所属线程已退出，可被新线程接管
+    uint32_t               pending;        // 所有组中的块数
+    uint32_t               pushes;         // 距上次读时钟的入队次数
+    uint64_t               oldest_ns;      // 最早一个暂存块的入队时间
+    uint64_t               frees;
+    uint64_t               flushes;
+    struct NvmRemoteCache* next;           // 注册链表 (只增不减，销毁时统一释放)
+    RemoteGroup            groups[NVM_REMOTE_BATCH_GROUPS];
+} __attribute__((aligned(CACHE_LINE_SIZE))) NvmRemoteCache;
+
+struct NvmRemoteBatcher {
+    uint32_t                 group_size;
+    uint64_t                 id;            // 进程内唯一，用于校验线程本地缓存
+    NvmRemoteCache*          caches;        // 注册链表头 (release 发布)
+    struct NvmRemoteBatcher* next_live;     // 存活批处理器链表 (g_remote_registry_lock 保护)
+
+    uint32_t                 interval_ms;   // 后台刷新间隔
+    bool                     running;
+    bool                     stopping;
+
+    nvm_mutex_t              lock;
+    nvm_cond_t               cond;
+    nvm_thread_t             worker;
+};
+
+// 线程本地状态：缓存本线程在某个批处理器中的缓存
+typedef struct RemoteThreadState {
+    uint64_t        batcher_id;             // 0 表示未注册
+    NvmRemoteCache* cache;
+} RemoteThreadState;
+
+static _Thread_local RemoteThreadState t_remote;
+
+// 注册与线程退出都要确认批处理器仍然存活，由全局锁串行化 (均为低频操作)
+static pthread_mutex_t   g_remote_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static NvmRemoteBatcher* g_live_batchers;
+static uint64_t          g_next_batcher_id = 1;
+static pthread_once_t    g_remote_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t     g_remote_thread_key;
+
+// ============================================================================
+//                          内部函数前向声明
+// ============================================================================
+
+static void            create_remote_thread_key(void);
+static void            on_remote_thread_exit(void* arg);
+static bool            batcher_live_locked(uint64_t batcher_id);
+static NvmRemoteCache* register_cache(NvmRemoteBatcher* batcher);
+static RemoteGroup*    group_for_slab(NvmRemoteCache* cache, NvmSlab* slab);
+static uint32_t        flush_group(NvmRemoteCache* cache, RemoteGroup* group);
+static uint32_t        flush_cache_locked(NvmRemoteCache* cache);
+static uint64_t        monotonic_ns(void);
+static void*           flusher_main(void* arg);
+
+// ============================================================================
+//                          公共 API 实现
+// ============================================================================
+
+NvmRemoteBatcher* remote_batch_create(uint32_t group_size) {
+    if (group_size > NVM_REMOTE_BATCH_MAX) {
+        LOG_ERR("Remote batch size too large: %u (max %u).", group_size, NVM_REMOTE_BATCH_MAX);
+        return NULL;
+    }
+
+    NvmRemoteBatcher* batcher = (NvmRemoteBatcher*)calloc(1, sizeof(NvmRemoteBatcher));
+    if (!batcher) {
+        LOG_ERR("Failed to allocate remote batcher.");
+        return NULL;
+    }
+    batcher->group_size = group_size;
+
+    if (NVM_MUTEX_INIT(&batcher->lock) != 0) {
+        LOG_ERR("Failed to init mutex.");
+        goto err_free_batcher;
+    }
+    if (NVM_COND_INIT(&batcher->cond) != 0) {
+        LOG_ERR("Failed to init condition.");
+        goto err_destroy_mutex;
+    }
+
+    pthread_mutex_lock(&g_remote_registry_lock);
+    batcher->id = g_next_batcher_id++;
+    batcher->next_live = g_live_batchers;
+    g_live_batchers = batcher;
+    pthread_mutex_unlock(&g_remote_registry_lock);
+    return batcher;
+
+err_destroy_mutex:
+    NVM_MUTEX_DESTROY(&batcher->lock);
+err_free_batcher:
+    free(batcher);
+    return NULL;
+}
+
+void remote_batch_destroy(NvmRemoteBatcher* batcher) {
+    if (!batcher) return;
+
+    remote_batch_set_flusher(batcher, 0);
+
+    // 先摘出存活链表，之后退出的线程不再触碰本批处理器的缓存
+    pthread_mutex_lock(&g_remote_registry_lock);
+    for (NvmRemoteBatcher** link = &g_live_batchers; *link; link = &(*link)->next_live) {
+        if (*link == batcher) {
+            *link = batcher->next_live;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_remote_registry_lock);
+
+    remote_batch_flush_all(batcher);
+
+    NvmRemoteCache* cache = batcher->caches;
+    while (cache) {
+        NvmRemoteCache* next = cache->next;
+        NVM_SPINLOCK_DESTROY(&cache->lock);
+        free(cache);
+        cache = next;
+    }
+
+    NVM_COND_DESTROY(&batcher->cond);
+    NVM_MUTEX_DESTROY(&batcher->lock);
+    free(batcher);
+}
+
+int remote_batch_push(NvmRemoteBatcher* batcher, NvmSlab* slab, uint32_t block_idx) {
+    uint32_t group_size = __atomic_load_n(&batcher->group_size, __ATOMIC_RELAXED);
+    if (group_size == 0) return -1;
+
+    NvmRemoteCache* cache = (NVM_LIKELY(t_remote.batcher_id == batcher->id)) ? t_remote.cache
+                                                                            : register_cache(batcher);
+    if (NVM_UNLIKELY(!cache)) return -1;
+
+    NVM_SPINLOCK_ACQUIRE(&cache->lock);
+    if (cache->pending == 0) {
+        cache->oldest_ns = monotonic_ns();
+        cache->pushes = 0;
+    }
+
+    RemoteGroup* group = group_for_slab(cache, slab);
+    group->block_idxs[group->count++] = block_idx;
+    cache->pending++;
+    cache->frees++;
+
+    if (group->count >= group_size) {
+        flush_group(cache, group);
+    } else if (++cache->pushes >= NVM_REMOTE_BATCH_CLOCK_EVERY) {
+        cache->pushes = 0;
+        if (monotonic_ns() - cache->oldest_ns >= NVM_REMOTE_BATCH_MAX_AGE_US * 1000ULL) {
+            flush_cache_locked(cache);
+        }
+    }
+    NVM_SPINLOCK_RELEASE(&cache->lock);
+    return 0;
+}
+
+uint32_t remote_batch_flush_local(NvmRemoteBatcher* batcher) {
+    if (!batcher || t_remote.batcher_id != batcher->id) return 0;
+
+    NVM_SPINLOCK_ACQUIRE(&t_remote.cache->lock);
+    uint32_t flushed = flush_cache_locked(t_remote.cache);
+    NVM_SPINLOCK_RELEASE(&t_remote.cache->lock);
+    return flushed;
+}
+
+uint32_t remote_batch_flush_all(NvmRemoteBatcher* batcher) {
+    if (!batcher) return 0;
+
+    uint32_t total = 0;
+    for (NvmRemoteCache* cache = __atomic_load_n(&batcher->caches, __ATOMIC_ACQUIRE); cache; cache = cache->next) {
+        if (__atomic_load_n(&cache->pending, __ATOMIC_RELAXED) == 0) continue;
+        NVM_SPINLOCK_ACQUIRE(&cache->lock);
+        total += flush_cache_locked(cache);
+        NVM_SPINLOCK_RELEASE(&cache->lock);
+    }
+    return total;
+}
+
+int remote_batch_set_group_size(NvmRemoteBatcher* batcher, uint32_t group_size) {
+    if (!batcher || group_size > NVM_REMOTE_BATCH_MAX) {
+        LOG_ERR("Invalid remote batch size: %u (max %u).", group_size, NVM_REMOTE_BATCH_MAX);
+        return -1;
+    }
+    __atomic_store_n(&batcher->group_size, group_size, __ATOMIC_RELAXED);
+    // 关闭暂存时不留下无人刷新的块
+    if (group_size == 0) remote_batch_flush_all(batcher);
+    return 0;
+}
+
+uint32_t remote_batch_get_group_size(NvmRemoteBatcher* batcher) {
+    return batcher ? __atomic_load_n(&batcher->group_size, __ATOMIC_RELAXED) : 0;
+}
+
+int remote_batch_set_flusher(NvmRemoteBatcher* batcher, uint32_t interval_ms) {
+    if (!batcher) return -1;
+
+    NVM_MUTEX_ACQUIRE(&batcher->lock);
+    if (interval_ms == 0) {
+        if (!batcher->running) {
+            NVM_MUTEX_RELEASE(&batcher->lock);
+            return 0;
+        }
+        batcher->stopping = true;
+        NVM_COND_BROADCAST(&batcher->cond);
+        NVM_MUTEX_RELEASE(&batcher->lock);
+
+        NVM_THREAD_JOIN(batcher->worker);
+
+        NVM_MUTEX_ACQUIRE(&batcher->lock);
+        batcher->running = false;
+        batcher->stopping = false;
+        batcher->interval_ms = 0;
+        NVM_MUTEX_RELEASE(&batcher->lock);
+        return 0;
+    }
+
+    batcher->interval_ms = interval_ms;
+    if (batcher->running) {
+        NVM_COND_SIGNAL(&batcher->cond);
+        NVM_MUTEX_RELEASE(&batcher->lock);
+        return 0;
+    }
+    if (NVM_THREAD_CREATE(&batcher->worker, flusher_main, batcher) != 0) {
+        LOG_ERR("Failed to start remote batch flusher.");
+        batcher->interval_ms = 0;
+        NVM_MUTEX_RELEASE(&batcher->lock);
+        return -1;
+    }
+    batcher->running = true;
+    NVM_MUTEX_RELEASE(&batcher->lock);
+    return 0;
+}
+
+uint32_t remote_batch_get_flusher(NvmRemoteBatcher* batcher) {
+    if (!batcher) return 0;
+    NVM_MUTEX_ACQUIRE(&batcher->lock);
+    uint32_t interval_ms = batcher->interval_ms;
+    NVM_MUTEX_RELEASE(&batcher->lock);
+    return interval_ms;
+}
+
+void remote_batch_stats(NvmRemoteBatcher* batcher, uint64_t* out_frees, uint64_t* out_flushes) {
+    uint64_t frees = 0, flushes = 0;
+    if (batcher) {
+        for (NvmRemoteCache* cache = __atomic_load_n(&batcher->caches, __ATOMIC_ACQUIRE); cache; cache = cache->next) {
+            frees   += __atomic_load_n(&cache->frees, __ATOMIC_RELAXED);
+            flushes += __atomic_load_n(&cache->flushes, __ATOMIC_RELAXED);
+        }
+    }
+    if (out_frees) *out_frees = frees;
+    if (out_flushes) *out_flushes = flushes;
+}
+
+// ============================================================================
+//                          内部函数实现
+// ============================================================================
+
+static void create_remote_thread_key(void) {
+    pthread_key_create(&g_remote_thread_key, on_remote_thread_exit);
+}
+
+// 线程退出：批处理器仍存活时刷新自己的缓存并交还。持全局锁刷新，与销毁互斥
+static void on_remote_thread_exit(void* arg) {
+    RemoteThreadState* state = (RemoteThreadState*)arg;
+
+    pthread_mutex_lock(&g_remote_registry_lock);
+    if (batcher_live_locked(state->batcher_id)) {
+        NVM_SPINLOCK_ACQUIRE(&state->cache->lock);
+        flush_cache_locked(state->cache);
+        NVM_SPINLOCK_RELEASE(&state->cache->lock);
+        __atomic_store_n(&state->cache->owner_exited, 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&g_remote_registry_lock);
+}
+
+// 假设已持 g_remote_registry_lock
+static bool batcher_live_locked(uint64_t batcher_id) {
+    for (NvmRemoteBatcher* batcher = g_live_batchers; batcher; batcher = batcher->next_live) {
+        if (batcher->id == batcher_id) return true;
+    }
+    return false;
+}
+
+// 注册调用线程的缓存：优先接管已退出线程留下的缓存 (退出时已刷新)
+static NvmRemoteCache* register_cache(NvmRemoteBatcher* batcher) {
+    pthread_once(&g_remote_key_once, create_remote_thread_key);
+
+    pthread_mutex_lock(&g_remote_registry_lock);
+
+    // 线程此前服务于另一个批处理器：刷新并交还旧缓存
+    if (t_remote.batcher_id != 0 && batcher_live_locked(t_remote.batcher_id)) {
+        NVM_SPINLOCK_ACQUIRE(&t_remote.cache->lock);
+        flush_cache_locked(t_remote.cache);
+        NVM_SPINLOCK_RELEASE(&t_remote.cache->lock);
+        __atomic_store_n(&t_remote.cache->owner_exited, 1, __ATOMIC_RELEASE);
+    }
+
+    NvmRemoteCache* cache = NULL;
+    for (NvmRemoteCache* c = batcher->caches; c; c = c->next) {
+        uint32_t expected = 1;
+        if (__atomic_compare_exchange_n(&c->owner_exited, &expected, 0, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            cache = c;
+            break;
+        }
+    }
+
+    if (!cache) {
+        cache = (NvmRemoteCache*)aligned_alloc(CACHE_LINE_SIZE, sizeof(NvmRemoteCache));
+        if (!cache) {
+            LOG_ERR("Failed to allocate remote batch cache.");
+            goto out_unlock;
+        }
+        memset(cache, 0, sizeof(NvmRemoteCache));
+        if (NVM_SPINLOCK_INIT(&cache->lock) != 0) {
+            LOG_ERR("Failed to init remote batch cache lock.");
+            free(cache);
+            cache = NULL;
+            goto out_unlock;
+        }
+        cache->next = batcher->caches;
+        __atomic_store_n(&batcher->caches, cache, __ATOMIC_RELEASE);
+    }
+
+    t_remote.batcher_id = batcher->id;
+    t_remote.cache      = cache;
+    pthread_setspecific(g_remote_thread_key, &t_remote);
+
+out_unlock:
+    pthread_mutex_unlock(&g_remote_registry_lock);
+    return cache;
+}
+
+// 找到发往 slab 的组；没有时占用空闲组位，组位用尽时刷新块数最多的一组腾出位置
+static RemoteGroup* group_for_slab(NvmRemoteCache* cache, NvmSlab* slab) {
+    RemoteGroup* empty = NULL;
+    RemoteGroup* fullest = &cache->groups[0];
+    for (int i = 0; i < NVM_REMOTE_BATCH_GROUPS; ++i) {
+        RemoteGroup* group = &cache->groups[i];
+        if (group->slab == slab) return group;
+        if (!group->slab) {
+            if (!empty) empty = group;
+        } else if (group->count > fullest->count) {
+            fullest = group;
+        }
+    }
+    if (!empty) {
+        flush_group(cache, fullest);
+        empty = fullest;
+    }
+    empty->slab = slab;
+    return empty;
+}
+
+// 假设已持 cache->lock
+static uint32_t flush_group(NvmRemoteCache* cache, RemoteGroup* group) {
+    uint32_t count = group->count;
+    if (count > 0) {
+        nvm_slab_free_remote_batch(group->slab, group->block_idxs, count);
+        __atomic_store_n(&cache->flushes, cache->flushes + 1, __ATOMIC_RELAXED);
+    }
+    group->slab = NULL;
+    group->count = 0;
+    __atomic_store_n(&cache->pending, cache->pending - count, __ATOMIC_RELAXED);
+    return count;
+}
+
+// 假设已持 cache->lock
+static uint32_t flush_cache_locked(NvmRemoteCache* cache) {
+    uint32_t flushed = 0;
+    for (int i = 0; i < NVM_REMOTE_BATCH_GROUPS && cache->pending > 0; ++i) {
+        if (cache->groups[i].slab) flushed += flush_group(cache, &cache->groups[i]);
+    }
+    return flushed;
+}
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// 后台线程：按间隔刷新所有线程的缓存，使空闲线程暂存的块也能及时归还
+static void* flusher_main(void* arg) {
+    NvmRemoteBatcher* batcher = (NvmRemoteBatcher*)arg;
+
+    NVM_MUTEX_ACQUIRE(&batcher->lock);
+    while (!batcher->stopping) {
+        NVM_COND_TIMEDWAIT_MS(&batcher->cond, &batcher->lock, batcher->interval_ms);
+        if (batcher->stopping) break;
+
+        NVM_MUTEX_RELEASE(&batcher->lock);
+        remote_batch_flush_all(batcher);
+        NVM_MUTEX_ACQUIRE(&batcher->lock);
+    }
+    NVM_MUTEX_RELEASE(&batcher->lock);
+
+    return NULL;
+}
@@ -6,131 +6,336 @@
 
 #include "NvmDefs.h"
 #include "NvmSlab.h"
+#include "NvmMetaArena.h"
+
+// 切分游标预标记与原子位图引擎都按 64 块的位图字操作，最大块类别的块数也必须是其整数倍
+_Static_assert((NVM_SLAB_SIZE / 4096) % 64 == 0, "slab bitmaps must consist of whole 64-bit words");
+
+// ============================================================================
+//                          全局状态
+// ============================================================================
+
+// 新建 Slab 的环形缓存深度与批量 (nvm_slab_set_cache_params)
+static uint32_t g_cache_depth = SLAB_CACHE_SIZE;
+static uint32_t g_cache_batch = SLAB_CACHE_BATCH_SIZE;
 
 // ============================================================================
 //                          内部函数前向声明
 // ============================================================================
 
 static uint32_t get_block_size_from_sc_id(SizeClassID sc_id);
+static size_t   get_metadata_size(uint32_t total_block_count, bool is_volatile, uint32_t ring_capacity);
+static size_t   get_ring_offset(uint32_t total_block_count);
+static uint32_t get_ring_capacity(const NvmSlab* self);
+static NvmSlab* create_slab(SizeClassID sc_id, uint64_t nvm_base_offset, void* block_base, int numa_node, uint8_t flags);
+static uint32_t bump_carve(NvmSlab* self);
+static void     bump_retire(NvmSlab* self);
 static uint32_t refill_cache(NvmSlab* self);
+static uint32_t refill_cache_media_line(NvmSlab* self);
 static uint32_t drain_cache(NvmSlab* self);
+static int      alloc_locked(NvmSlab* self, uint32_t* out_block_idx, bool try_only);
+static void     free_locked(NvmSlab* self, uint32_t block_idx);
+static uint32_t absorb_remote(NvmSlab* self, bool try_only);
+static int      alloc_volatile_locked(NvmSlab* self, uint32_t* out_block_idx, bool try_only);
+static uint32_t absorb_remote_volatile(NvmSlab* self, bool try_only);
+static uint32_t block_index_of(const NvmSlab* self, const void* block);
+static int      alloc_atomic(NvmSlab* self, uint32_t* out_block_idx);
+static void     free_atomic(NvmSlab* self, uint32_t block_idx);
+static void     raise_dirty_watermark(NvmSlab* self, uint32_t watermark);
+static bool     media_line_is_free(const NvmSlab* self, uint32_t first_idx, uint32_t per_line);
 
 // ============================================================================
 //                          公共 API 实现
 // ============================================================================
 
 NvmSlab* nvm_slab_create(SizeClassID sc_id, uint64_t nvm_base_offset) {
-    uint32_t block_size = get_block_size_from_sc_id(sc_id);
-    if (block_size == 0) {
-        LOG_ERR("Invalid SizeClassID: %d", sc_id);
-        return NULL;
-    }
+    return nvm_slab_create_on_node(sc_id, nvm_base_offset, -1);
+}
 
-    uint32_t total_block_count = NVM_SLAB_SIZE / block_size;
-    size_t bitmap_bytes = (total_block_count + 7) / 8;
-    
-    // 分配元数据 (含柔性数组)
-    NvmSlab* self = (NvmSlab*)calloc(1, sizeof(NvmSlab) + bitmap_bytes);
-    if (!self) {
-        LOG_ERR("Failed to allocate metadata.");
+NvmSlab* nvm_slab_create_on_node(SizeClassID sc_id, uint64_t nvm_base_offset, int numa_node) {
+    return create_slab(sc_id, nvm_base_offset, NULL, numa_node, 0);
+}
+
+NvmSlab* nvm_slab_create_volatile(SizeClassID sc_id, uint64_t nvm_base_offset, void* block_base, int numa_node) {
+    if (!block_base) {
+        LOG_ERR("Volatile slab requires a block base address.");
         return NULL;
     }
+    return create_slab(sc_id, nvm_base_offset, block_base, numa_node, NVM_SLAB_FLAG_VOLATILE);
+}
 
-    self->nvm_base_offset   = nvm_base_offset;
-    self->size_type_id      = (uint8_t)sc_id;
-    self->block_size        = block_size;
-    self->total_block_count = total_block_count;
+NvmSlab* nvm_slab_create_atomic(SizeClassID sc_id, uint64_t nvm_base_offset, int numa_node) {
+    return create_slab(sc_id, nvm_base_offset, NULL, numa_node, NVM_SLAB_FLAG_ATOMIC);
+}
 
-    if (NVM_SPINLOCK_INIT(&self->lock) != 0) {
-        LOG_ERR("Failed to init spinlock.");
-        free(self);
-        return NULL;
+int nvm_slab_set_cache_params(uint32_t depth, uint32_t batch) {
+    if (depth > SLAB_CACHE_MAX_SIZE || batch == 0 || batch >= depth) {
+        LOG_ERR("Invalid slab cache depth/batch: %u/%u (max depth %u).", depth, batch, SLAB_CACHE_MAX_SIZE);
+        return -1;
     }
+    __atomic_store_n(&g_cache_depth, depth, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_cache_batch, batch, __ATOMIC_RELAXED);
+    return 0;
+}
 
-    return self;
+void nvm_slab_get_cache_params(uint32_t* depth, uint32_t* batch) {
+    if (depth) *depth = __atomic_load_n(&g_cache_depth, __ATOMIC_RELAXED);
+    if (batch) *batch = __atomic_load_n(&g_cache_batch, __ATOMIC_RELAXED);
 }
 
 void nvm_slab_destroy(NvmSlab* self) {
     if (!self) return;
+    NVM_SPINLOCK_DESTROY(&self->remote_lock);
     NVM_SPINLOCK_DESTROY(&self->lock);
-    free(self);
+    nvm_meta_free(self, get_metadata_size(self->total_block_count, self->block_base != NULL, get_ring_capacity(self)),
+                  self->numa_node);
+}
+
+bool nvm_slab_enable_media_line_placement(NvmSlab* self) {
+    if (!self || self->block_size >= NVM_MEDIA_LINE_SIZE) return false;
+    if (self->flags & (NVM_SLAB_FLAG_VOLATILE | NVM_SLAB_FLAG_ATOMIC)) return false;
+
+    self->flags |= NVM_SLAB_FLAG_MEDIA_LINE;
+    self->line_cursor = 0;
+    return true;
+}
+
+void nvm_slab_mark_prezeroed(NvmSlab* self) {
+    if (!self) return;
+    self->flags |= NVM_SLAB_FLAG_PREZEROED;
+    self->dirty_watermark = 0;
 }
 
 int nvm_slab_alloc(NvmSlab* self, uint32_t* out_block_idx) {
     if (!self || !out_block_idx) return -1;
+    if (self->flags & NVM_SLAB_FLAG_ATOMIC) return alloc_atomic(self, out_block_idx);
 
     NVM_SPINLOCK_ACQUIRE(&self->lock);
+    int ret = alloc_locked(self, out_block_idx, false);
+    NVM_SPINLOCK_RELEASE(&self->lock);
+    return ret;
+}
 
-    // 缓存为空时尝试填充
-    if (self->cache_count == 0) {
-        refill_cache(self);
-    }
-
-    // 仍为空说明已满
-    if (self->cache_count == 0) {
-        NVM_SPINLOCK_RELEASE(&self->lock);
-        return -1;
-    }
-
-    // 从缓存分配
-    *out_block_idx = self->free_block_buffer[self->cache_head];
-    self->cache_head = (self->cache_head + 1) % SLAB_CACHE_SIZE;
-    self->cache_count--;
-    __atomic_fetch_add(&self->allocated_block_count, 1, __ATOMIC_RELAXED);
+int nvm_slab_try_alloc(NvmSlab* self, uint32_t* out_block_idx) {
+    if (!self || !out_block_idx) return -1;
+    if (self->flags & NVM_SLAB_FLAG_ATOMIC) return alloc_atomic(self, out_block_idx);
 
+    if (NVM_SPINLOCK_TRYACQUIRE(&self->lock) != 0) return -1;
+    int ret = alloc_locked(self, out_block_idx, true);
     NVM_SPINLOCK_RELEASE(&self->lock);
-    return 0;
+    return ret;
 }
 
 void nvm_slab_free(NvmSlab* self, uint32_t block_idx) {
+    nvm_slab_free_batch(self, &block_idx, 1);
+}
+
+void nvm_slab_free_remote(NvmSlab* self, uint32_t block_idx) {
     if (!self) return;
     if (block_idx >= self->total_block_count) {
         LOG_ERR("Block index out of bounds: %u", block_idx);
         return;
     }
+    if (self->flags & NVM_SLAB_FLAG_ATOMIC) {
+        free_atomic(self, block_idx);
+        return;
+    }
+
+    NVM_SPINLOCK_ACQUIRE(&self->remote_lock);
+    uint32_t count = self->remote_count;
+    if (self->flags & NVM_SLAB_FLAG_VOLATILE) {
+        void** block = (void**)(self->block_base + (size_t)block_idx * self->block_size);
+        *block = self->remote_head;
+        self->remote_head = block;
+        if (block_idx >= self->remote_watermark) self->remote_watermark = block_idx + 1;
+        __atomic_store_n(&self->remote_count, count + 1, __ATOMIC_RELAXED);
+        NVM_SPINLOCK_RELEASE(&self->remote_lock);
+        return;
+    }
+    if (count < SLAB_REMOTE_BUFFER_SIZE) {
+        self->remote_buffer[count] = block_idx;
+        __atomic_store_n(&self->remote_count, count + 1, __ATOMIC_RELAXED);
+        NVM_SPINLOCK_RELEASE(&self->remote_lock);
+        return;
+    }
+    NVM_SPINLOCK_RELEASE(&self->remote_lock);
 
+    // 暂存区已满：代替持有者把整批块吸收回缓存
     NVM_SPINLOCK_ACQUIRE(&self->lock);
+    absorb_remote(self, false);
+    free_locked(self, block_idx);
+    NVM_SPINLOCK_RELEASE(&self->lock);
+}
 
-    if (self->allocated_block_count > 0) {
-        __atomic_fetch_sub(&self->allocated_block_count, 1, __ATOMIC_RELAXED);
+void nvm_slab_free_remote_batch(NvmSlab* self, const uint32_t* block_idxs, uint32_t count) {
+    if (!self || !block_idxs || count == 0) return;
+    if (self->flags & NVM_SLAB_FLAG_ATOMIC) {
+        nvm_slab_free_batch(self, block_idxs, count);
+        return;
     }
 
-    // 缓存满时回写位图
-    if (self->cache_count >= SLAB_CACHE_SIZE) {
-        drain_cache(self);
+    uint32_t i = 0;
+    NVM_SPINLOCK_ACQUIRE(&self->remote_lock);
+    uint32_t queued = self->remote_count;
+    if (self->flags & NVM_SLAB_FLAG_VOLATILE) {
+        for (; i < count; ++i) {
+            uint32_t block_idx = block_idxs[i];
+            if (block_idx >= self->total_block_count) {
+                LOG_ERR("Block index out of bounds: %u", block_idx);
+                continue;
+            }
+            void** block = (void**)(self->block_base + (size_t)block_idx * self->block_size);
+            *block = self->remote_head;
+            self->remote_head = block;
+            if (block_idx >= self->remote_watermark) self->remote_watermark = block_idx + 1;
+            queued++;
+        }
+        __atomic_store_n(&self->remote_count, queued, __ATOMIC_RELAXED);
+        NVM_SPINLOCK_RELEASE(&self->remote_lock);
+        return;
+    }
+    for (; i < count && queued < SLAB_REMOTE_BUFFER_SIZE; ++i) {
+        if (block_idxs[i] >= self->total_block_count) {
+            LOG_ERR("Block index out of bounds: %u", block_idxs[i]);
+            continue;
+        }
+        self->remote_buffer[queued++] = block_idxs[i];
+    }
+    __atomic_store_n(&self->remote_count, queued, __ATOMIC_RELAXED);
+    NVM_SPINLOCK_RELEASE(&self->remote_lock);
+    if (i == count) return;
+
+    // 暂存区装不下：代替持有者吸收暂存区，其余块直接释放
+    NVM_SPINLOCK_ACQUIRE(&self->lock);
+    absorb_remote(self, false);
+    for (; i < count; ++i) {
+        if (block_idxs[i] >= self->total_block_count) {
+            LOG_ERR("Block index out of bounds: %u", block_idxs[i]);
+            continue;
+        }
+        free_locked(self, block_idxs[i]);
+    }
+    NVM_SPINLOCK_RELEASE(&self->lock);
+}
+
+void nvm_slab_free_batch(NvmSlab* self, const uint32_t* block_idxs, uint32_t count) {
+    if (!self || !block_idxs) return;
+
+    if (self->flags & NVM_SLAB_FLAG_ATOMIC) {
+        for (uint32_t i = 0; i < count; ++i) {
+            if (block_idxs[i] >= self->total_block_count) {
+                LOG_ERR("Block index out of bounds: %u", block_idxs[i]);
+                continue;
+            }
+            free_atomic(self, block_idxs[i]);
+        }
+        return;
+    }
+
+    NVM_SPINLOCK_ACQUIRE(&self->lock);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t block_idx = block_idxs[i];
+        if (block_idx >= self->total_block_count) {
+            LOG_ERR("Block index out of bounds: %u", block_idx);
+            continue;
+        }
+        free_locked(self, block_idx);
     }
-    
-    // 放入缓存
-    self->free_block_buffer[self->cache_tail] = block_idx;
-    self->cache_tail = (self->cache_tail + 1) % SLAB_CACHE_SIZE;
-    self->cache_count++;
 
     NVM_SPINLOCK_RELEASE(&self->lock);
 }
 
+bool nvm_slab_block_is_zeroed(const NvmSlab* self, uint32_t block_idx) {
+    if (!self || !(self->flags & NVM_SLAB_FLAG_PREZEROED)) return false;
+
+    // 块若曾被释放，释放时已在锁内推高水位线，并先于本次分配可见
+    return block_idx >= __atomic_load_n(&self->dirty_watermark, __ATOMIC_RELAXED);
+}
+
+uint32_t nvm_slab_used_blocks(const NvmSlab* self) {
+    if (!self) return 0;
+
+    // 吸收时先清空暂存计数、再 (release) 减少已分配数：读到新的已分配数就一定读到
+    // 新的暂存计数，结果只会偏大，不会把仍被持有的 Slab 误判为空
+    uint32_t allocated = __atomic_load_n(&self->allocated_block_count, __ATOMIC_ACQUIRE);
+    uint32_t pending = __atomic_load_n(&self->remote_count, __ATOMIC_RELAXED);
+    return allocated > pending ? allocated - pending : 0;
+}
+
+int nvm_slab_copy_live_bitmap(NvmSlab* self, unsigned char* out) {
+    if (!self || !out || (self->flags & NVM_SLAB_FLAG_VOLATILE)) return -1;
+
+    if (self->flags & NVM_SLAB_FLAG_ATOMIC) {
+        // 位图即占用；逐字原子读取，并发修改时不是某一时刻的精确切面
+        const uint64_t* words = (const uint64_t*)self->bitmap;
+        int used = 0;
+        for (uint32_t w = 0; w < self->total_block_count / 64; ++w) {
+            uint64_t word = __atomic_load_n(&words[w], __ATOMIC_RELAXED);
+            memcpy(out + (size_t)w * 8, &word, sizeof(word));
+            used += __builtin_popcountll(word);
+        }
+        return used;
+    }
+
+    // 位图中置位的块 = 用户持有 + 环形缓存 + 远程暂存，后两者逐个清除
+    NVM_SPINLOCK_ACQUIRE(&self->lock);
+    memcpy(out, self->bitmap, (self->total_block_count + 7) / 8);
+    for (uint32_t i = self->bump_cursor; i % 64 != 0 && i < self->total_block_count; ++i) {
+        CLEAR_BIT(out, i);   // 游标所在字中预标记但尚未交付的块
+    }
+    for (uint32_t i = 0, pos = self->cache_head; i < self->cache_count; ++i) {
+        CLEAR_BIT(out, self->free_block_buffer[pos]);
+        pos = (pos + 1) & self->cache_mask;
+    }
+    NVM_SPINLOCK_ACQUIRE(&self->remote_lock);
+    for (uint32_t i = 0; i < self->remote_count; ++i) {
+        CLEAR_BIT(out, self->remote_buffer[i]);
+    }
+    uint32_t used = self->allocated_block_count - self->remote_count;
+    NVM_SPINLOCK_RELEASE(&self->remote_lock);
+    NVM_SPINLOCK_RELEASE(&self->lock);
+    return (int)used;
+}
+
 bool nvm_slab_is_full(const NvmSlab* self) {
     if (!self) return false;
-    
-    uint32_t cnt = __atomic_load_n(&self->allocated_block_count, __ATOMIC_RELAXED);
-    return cnt >= self->total_block_count;
+    return nvm_slab_used_blocks(self) >= self->total_block_count;
 }
 
 bool nvm_slab_is_empty(const NvmSlab* self) {
     if (!self) return true;
-
-    uint32_t cnt = __atomic_load_n(&self->allocated_block_count, __ATOMIC_RELAXED);
-    return cnt == 0;
+    return nvm_slab_used_blocks(self) == 0;
 }
 
 int nvm_slab_set_bitmap_at_idx(NvmSlab* self, uint32_t block_idx) {
     if (!self || block_idx >= self->total_block_count) return -1;
+    if (self->flags & NVM_SLAB_FLAG_VOLATILE) return -1;
+
+    if (self->flags & NVM_SLAB_FLAG_ATOMIC) {
+        raise_dirty_watermark(self, block_idx + 1);
+        uint64_t mask = 1ULL << (block_idx % 64);
+        uint64_t old = __atomic_fetch_or(&((uint64_t*)self->bitmap)[block_idx / 64], mask, __ATOMIC_ACQ_REL);
+        if (!(old & mask)) {
+            __atomic_fetch_add(&self->allocated_block_count, 1, __ATOMIC_RELAXED);
+        }
+        return 0;
+    }
 
     NVM_SPINLOCK_ACQUIRE(&self->lock);
-    
+
+    // 恢复出的块可能位于游标之后，此后只信任位图
+    if (block_idx >= self->bump_cursor) {
+        bump_retire(self);
+    }
     if (!IS_BIT_SET(self->bitmap, block_idx)) {
         SET_BIT(self->bitmap, block_idx);    
         __atomic_fetch_add(&self->allocated_block_count, 1, __ATOMIC_RELAXED);
     }
+    // 恢复出的块承载着旧数据
+    if (block_idx >= self->dirty_watermark) {
+        self->dirty_watermark = block_idx + 1;
+    }
     
     NVM_SPINLOCK_RELEASE(&self->lock);
     return 0;
@@ -150,18 +355,120 @@ static uint32_t get_block_size_from_sc_id(SizeClassID sc_id) {
     return 0;
 }
 
+// 元数据大小 = 描述符 + 位图 (柔性数组，易失模式不需要) + 环形缓冲区
+static size_t get_metadata_size(uint32_t total_block_count, bool is_volatile, uint32_t ring_capacity) {
+    if (is_volatile) return sizeof(NvmSlab);
+    if (ring_capacity == 0) return sizeof(NvmSlab) + (total_block_count + 7) / 8;
+    return get_ring_offset(total_block_count) + (size_t)ring_capacity * sizeof(uint32_t);
+}
+
+// 环形缓冲区紧随位图，起点对齐到缓存行
+static size_t get_ring_offset(uint32_t total_block_count) {
+    return NVM_ALIGN_UP(sizeof(NvmSlab) + (total_block_count + 7) / 8, (size_t)CACHE_LINE_SIZE);
+}
+
+// 只有锁保护的持久模式 Slab 带环形缓冲区
+static uint32_t get_ring_capacity(const NvmSlab* self) {
+    if (self->flags & (NVM_SLAB_FLAG_VOLATILE | NVM_SLAB_FLAG_ATOMIC)) return 0;
+    return (uint32_t)self->cache_mask + 1;
+}
+
+// flags 含 NVM_SLAB_FLAG_VOLATILE 时 block_base 为块区域地址，否则为 NULL
+static NvmSlab* create_slab(SizeClassID sc_id, uint64_t nvm_base_offset, void* block_base, int numa_node, uint8_t flags) {
+    uint32_t block_size = get_block_size_from_sc_id(sc_id);
+    if (block_size == 0) {
+        LOG_ERR("Invalid SizeClassID: %d", sc_id);
+        return NULL;
+    }
+    if (numa_node >= MAX_NUMA_NODES) {
+        LOG_ERR("Invalid NUMA node: %d", numa_node);
+        return NULL;
+    }
+
+    uint32_t total_block_count = NVM_SLAB_SIZE / block_size;
+    uint32_t cache_depth = __atomic_load_n(&g_cache_depth, __ATOMIC_RELAXED);
+    uint32_t ring_capacity = 0;
+    if (!(flags & (NVM_SLAB_FLAG_VOLATILE | NVM_SLAB_FLAG_ATOMIC))) {
+        ring_capacity = 1;
+        while (ring_capacity < cache_depth) ring_capacity <<= 1;
+    }
+    size_t meta_size = get_metadata_size(total_block_count, block_base != NULL, ring_capacity);
+
+    // 分配元数据 (含柔性数组)
+    NvmSlab* self = (NvmSlab*)nvm_meta_alloc(meta_size, numa_node);
+    if (!self) {
+        LOG_ERR("Failed to allocate metadata.");
+        return NULL;
+    }
+
+    self->nvm_base_offset   = nvm_base_offset;
+    self->size_type_id      = (uint8_t)sc_id;
+    self->numa_node         = (int8_t)(numa_node < 0 ? -1 : numa_node);
+    self->heap_cpu          = NVM_SLAB_NO_HEAP;
+    self->block_size        = block_size;
+    self->total_block_count = total_block_count;
+    self->block_base        = (char*)block_base;
+    self->cache_depth       = (uint16_t)cache_depth;
+    self->cache_batch       = (uint16_t)__atomic_load_n(&g_cache_batch, __ATOMIC_RELAXED);
+    self->flags             = flags;
+    if (ring_capacity > 0) {
+        self->cache_mask        = (uint16_t)(ring_capacity - 1);
+        self->free_block_buffer = (uint32_t*)((char*)self + get_ring_offset(total_block_count));
+    }
+
+    if (NVM_SPINLOCK_INIT(&self->lock) != 0) {
+        LOG_ERR("Failed to init spinlock.");
+        goto err_free_meta;
+    }
+    if (NVM_SPINLOCK_INIT(&self->remote_lock) != 0) {
+        LOG_ERR("Failed to init remote spinlock.");
+        goto err_destroy_lock;
+    }
+
+    return self;
+
+err_destroy_lock:
+    NVM_SPINLOCK_DESTROY(&self->lock);
+err_free_meta:
+    nvm_meta_free(self, meta_size, self->numa_node);
+    return NULL;
+}
+
+// 假设已持锁且游标未到末尾：游标进入新的位图字时整字预标记，字内其余块随后直接交付
+static uint32_t bump_carve(NvmSlab* self) {
+    uint32_t block_idx = self->bump_cursor++;
+    if (block_idx % 64 == 0) {
+        memset(&self->bitmap[block_idx / 8], 0xFF, 8);
+    }
+    return block_idx;
+}
+
+// 假设已持锁：结束切分，清除游标所在字中预标记但未交付的位，此后位图完全反映占用
+static void bump_retire(NvmSlab* self) {
+    for (uint32_t i = self->bump_cursor; i % 64 != 0 && i < self->total_block_count; ++i) {
+        CLEAR_BIT(self->bitmap, i);
+    }
+    self->bump_cursor = self->total_block_count;
+}
+
 // 假设已持锁
 static uint32_t refill_cache(NvmSlab* self) {
     if (self->allocated_block_count >= self->total_block_count) {
         return 0;
     }
 
+    if (self->flags & NVM_SLAB_FLAG_MEDIA_LINE) {
+        uint32_t filled = refill_cache_media_line(self);
+        if (filled > 0) return filled;
+        // 没有完全空闲的介质行，退化为顺序填补空洞
+    }
+
     uint32_t filled = 0;
     // 批量填充缓存
-    for (uint32_t i = 0; i < self->total_block_count && filled < SLAB_CACHE_BATCH_SIZE; ++i) {
+    for (uint32_t i = 0; i < self->total_block_count && filled < self->cache_batch; ++i) {
         if (!IS_BIT_SET(self->bitmap, i)) {
             self->free_block_buffer[self->cache_tail] = i;
-            self->cache_tail = (self->cache_tail + 1) % SLAB_CACHE_SIZE;
+            self->cache_tail = (self->cache_tail + 1) & self->cache_mask;
             SET_BIT(self->bitmap, i); // 预标记
             filled++;
         }
@@ -171,21 +478,268 @@ static uint32_t refill_cache(NvmSlab* self) {
 }
 
 // 假设已持锁
+// 从 line_cursor 开始寻找完全空闲的介质行，整行放入缓存，
+// 保证同一介质行内的块被连续交付。找不到时返回 0。
+static uint32_t refill_cache_media_line(NvmSlab* self) {
+    if (self->flags & NVM_SLAB_FLAG_NO_FREE_LINE) {
+        return 0;
+    }
+
+    const uint32_t per_line   = NVM_MEDIA_LINE_SIZE / self->block_size;
+    const uint32_t line_count = self->total_block_count / per_line;
+    const uint32_t room       = self->cache_depth - self->cache_count;
+    uint32_t filled = 0;
+    uint32_t scanned = 0;
+
+    for (; scanned < line_count && filled < self->cache_batch; ++scanned) {
+        uint32_t line = (self->line_cursor + scanned) % line_count;
+        uint32_t first_idx = line * per_line;
+
+        if (!media_line_is_free(self, first_idx, per_line)) continue;
+        if (room - filled < per_line) break;
+
+        for (uint32_t i = first_idx; i < first_idx + per_line; ++i) {
+            self->free_block_buffer[self->cache_tail] = i;
+            self->cache_tail = (self->cache_tail + 1) & self->cache_mask;
+            SET_BIT(self->bitmap, i); // 预标记
+        }
+        filled += per_line;
+    }
+
+    self->line_cursor = (self->line_cursor + scanned) % line_count;
+    if (filled == 0 && scanned == line_count) {
+        // 整轮扫描无果，直到 drain 释放出整行之前不再尝试
+        self->flags |= NVM_SLAB_FLAG_NO_FREE_LINE;
+    }
+
+    self->cache_count += filled;
+    return filled;
+}
+
+static bool media_line_is_free(const NvmSlab* self, uint32_t first_idx, uint32_t per_line) {
+    // per_line 为 2 的幂且 first_idx 按 per_line 对齐，不会跨字节拼接
+    if (per_line >= 8) {
+        for (uint32_t b = first_idx / 8; b < (first_idx + per_line) / 8; ++b) {
+            if (self->bitmap[b] != 0) return false;
+        }
+        return true;
+    }
+
+    uint8_t mask = (uint8_t)(((1u << per_line) - 1) << (first_idx % 8));
+    return (self->bitmap[first_idx / 8] & mask) == 0;
+}
+
+// 假设已持锁
+static int alloc_locked(NvmSlab* self, uint32_t* out_block_idx, bool try_only) {
+    if (self->flags & NVM_SLAB_FLAG_VOLATILE) {
+        return alloc_volatile_locked(self, out_block_idx, try_only);
+    }
+
+    // 缓存为空时先吸收远程释放的块，再推进切分游标，切分完毕后才扫描位图填充
+    if (self->cache_count == 0) {
+        absorb_remote(self, try_only);
+    }
+    if (self->cache_count == 0) {
+        if (self->bump_cursor < self->total_block_count) {
+            *out_block_idx = bump_carve(self);
+            __atomic_fetch_add(&self->allocated_block_count, 1, __ATOMIC_RELAXED);
+            return 0;
+        }
+        refill_cache(self);
+    }
+
+    // 仍为空说明已满
+    if (self->cache_count == 0) return -1;
+
+    // 从缓存分配
+    *out_block_idx = self->free_block_buffer[self->cache_head];
+    self->cache_head = (self->cache_head + 1) & self->cache_mask;
+    self->cache_count--;
+    __atomic_fetch_add(&self->allocated_block_count, 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+// 假设已持锁：把一个块放回本地缓存
+static void free_locked(NvmSlab* self, uint32_t block_idx) {
+    if (self->allocated_block_count > 0) {
+        // release: 与 nvm_slab_used_blocks 配对，先于此的暂存计数清零对读者可见
+        __atomic_fetch_sub(&self->allocated_block_count, 1, __ATOMIC_RELEASE);
+    }
+
+    // 被用户写过的块不再是干净块
+    if (block_idx >= self->dirty_watermark) {
+        __atomic_store_n(&self->dirty_watermark, block_idx + 1, __ATOMIC_RELAXED);
+    }
+
+    if (self->flags & NVM_SLAB_FLAG_VOLATILE) {
+        void** block = (void**)(self->block_base + (size_t)block_idx * self->block_size);
+        *block = self->free_head;
+        self->free_head = block;
+        return;
+    }
+
+    // 缓存满时回写位图
+    if (self->cache_count >= self->cache_depth) {
+        drain_cache(self);
+    }
+
+    // 放入缓存
+    self->free_block_buffer[self->cache_tail] = block_idx;
+    self->cache_tail = (self->cache_tail + 1) & self->cache_mask;
+    self->cache_count++;
+}
+
+// 假设已持锁：取走远程暂存区中的全部块放回本地缓存。
+// try_only 时远程锁被占用则放弃 (nvm_slab_try_alloc 不得阻塞)
+static uint32_t absorb_remote(NvmSlab* self, bool try_only) {
+    if (__atomic_load_n(&self->remote_count, __ATOMIC_RELAXED) == 0) return 0;
+
+    if (try_only) {
+        if (NVM_SPINLOCK_TRYACQUIRE(&self->remote_lock) != 0) return 0;
+    } else {
+        NVM_SPINLOCK_ACQUIRE(&self->remote_lock);
+    }
+    uint32_t count = self->remote_count;
+    uint32_t idxs[SLAB_REMOTE_BUFFER_SIZE];
+    memcpy(idxs, self->remote_buffer, count * sizeof(uint32_t));
+    __atomic_store_n(&self->remote_count, 0, __ATOMIC_RELAXED);
+    NVM_SPINLOCK_RELEASE(&self->remote_lock);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        free_locked(self, idxs[i]);
+    }
+    return count;
+}
+
 static uint32_t drain_cache(NvmSlab* self) {
-    if (self->cache_count <= SLAB_CACHE_BATCH_SIZE) {
+    if (self->cache_count <= self->cache_batch) {
         return 0;
     }
 
-    uint32_t to_drain = self->cache_count - SLAB_CACHE_BATCH_SIZE;
+    uint32_t to_drain = self->cache_count - self->cache_batch;
     uint32_t drained = 0;
 
     for (uint32_t i = 0; i < to_drain; ++i) {
         uint32_t idx = self->free_block_buffer[self->cache_head];
-        self->cache_head = (self->cache_head + 1) % SLAB_CACHE_SIZE;
+        self->cache_head = (self->cache_head + 1) & self->cache_mask;
         CLEAR_BIT(self->bitmap, idx); // 回写位图
         drained++;
     }
+
+    if (self->flags & NVM_SLAB_FLAG_NO_FREE_LINE) {
+        // 有块回到位图，可能重新凑出完整空闲行，下次 refill 再扫描一轮
+        self->flags &= ~NVM_SLAB_FLAG_NO_FREE_LINE;
+    }
     
     self->cache_count -= drained;
     return drained;
+}
+
+// 假设已持锁：易失模式的分配只是弹出链表头。
+// 依次尝试本地链表、远程链表 (整条接管)，最后切分从未交付过的块
+static int alloc_volatile_locked(NvmSlab* self, uint32_t* out_block_idx, bool try_only) {
+    void** block = (void**)self->free_head;
+    if (!block && absorb_remote_volatile(self, try_only) > 0) {
+        block = (void**)self->free_head;
+    }
+
+    if (block) {
+        self->free_head = *block;
+        *out_block_idx = block_index_of(self, block);
+    } else if (self->bump_cursor < self->total_block_count) {
+        *out_block_idx = self->bump_cursor++;
+    } else {
+        return -1;
+    }
+
+    __atomic_fetch_add(&self->allocated_block_count, 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+// 假设已持锁且本地链表为空：把远程链表整条接管为本地链表，O(1)
+static uint32_t absorb_remote_volatile(NvmSlab* self, bool try_only) {
+    if (__atomic_load_n(&self->remote_count, __ATOMIC_RELAXED) == 0) return 0;
+
+    if (try_only) {
+        if (NVM_SPINLOCK_TRYACQUIRE(&self->remote_lock) != 0) return 0;
+    } else {
+        NVM_SPINLOCK_ACQUIRE(&self->remote_lock);
+    }
+    uint32_t count = self->remote_count;
+    void* list = self->remote_head;
+    uint32_t watermark = self->remote_watermark;
+    self->remote_head = NULL;
+    self->remote_watermark = 0;
+    __atomic_store_n(&self->remote_count, 0, __ATOMIC_RELAXED);
+    NVM_SPINLOCK_RELEASE(&self->remote_lock);
+
+    self->free_head = list;
+    if (watermark > self->dirty_watermark) {
+        __atomic_store_n(&self->dirty_watermark, watermark, __ATOMIC_RELAXED);
+    }
+    // release: 与 nvm_slab_used_blocks 配对，同 free_locked
+    __atomic_fetch_sub(&self->allocated_block_count, count, __ATOMIC_RELEASE);
+    return count;
+}
+
+// 块大小为 2 的幂，地址差移位即得索引
+static uint32_t block_index_of(const NvmSlab* self, const void* block) {
+    return (uint32_t)((size_t)((const char*)block - self->block_base) >> __builtin_ctz(self->block_size));
+}
+
+// ============================================================================
+//                          原子位图引擎
+// ============================================================================
+
+// 先预留计数再抢占空闲位。释放先清位再减计数，因此置位数始终不超过计数：
+// 预留成功时必然存在一个只属于本次预留的空闲位，扫描一定会结束
+static int alloc_atomic(NvmSlab* self, uint32_t* out_block_idx) {
+    uint32_t reserved = __atomic_fetch_add(&self->allocated_block_count, 1, __ATOMIC_RELAXED);
+    if (reserved >= self->total_block_count) {
+        __atomic_fetch_sub(&self->allocated_block_count, 1, __ATOMIC_RELAXED);
+        return -1;
+    }
+
+    uint64_t* words = (uint64_t*)self->bitmap;
+    const uint32_t word_count = self->total_block_count / 64;
+    const uint32_t hint = __atomic_load_n(&self->atomic_hint, __ATOMIC_RELAXED);
+    uint32_t w = hint;
+    for (;;) {
+        uint64_t word = __atomic_load_n(&words[w], __ATOMIC_RELAXED);
+        while (word != UINT64_MAX) {
+            uint32_t bit = (uint32_t)__builtin_ctzll(~word);
+            // acquire: 与释放方的 fetch_and (release) 配对，块内容在交付前可见
+            if (__atomic_compare_exchange_n(&words[w], &word, word | (1ULL << bit), true,
+                                            __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+                if (w != hint) __atomic_store_n(&self->atomic_hint, w, __ATOMIC_RELAXED);
+                *out_block_idx = w * 64 + bit;
+                return 0;
+            }
+        }
+        w = (w + 1 == word_count) ? 0 : w + 1;
+    }
+}
+
+// 本地与远程释放相同；不移动提示字，避免释放方与分配方争用同一缓存行
+static void free_atomic(NvmSlab* self, uint32_t block_idx) {
+    // 在块重新可分配之前推高水位线
+    raise_dirty_watermark(self, block_idx + 1);
+
+    uint64_t mask = 1ULL << (block_idx % 64);
+    uint64_t old = __atomic_fetch_and(&((uint64_t*)self->bitmap)[block_idx / 64], ~mask, __ATOMIC_RELEASE);
+    if (!(old & mask)) {
+        LOG_ERR("Double free of block %u.", block_idx);
+        return;
+    }
+    // release: 与 nvm_slab_used_blocks 配对，同 free_locked
+    __atomic_fetch_sub(&self->allocated_block_count, 1, __ATOMIC_RELEASE);
+}
+
+// 无锁地把水位线推高到不低于 watermark
+static void raise_dirty_watermark(NvmSlab* self, uint32_t watermark) {
+    uint32_t current = __atomic_load_n(&self->dirty_watermark, __ATOMIC_RELAXED);
+    while (current < watermark &&
+           !__atomic_compare_exchange_n(&self->dirty_watermark, &current, watermark, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
 }
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "NvmDefs.h"
+#include "NvmPersist.h"
+#include "NvmSlabPool.h"
+
+// ============================================================================
+//                          核心数据结构
+// ============================================================================
+
+typedef struct NvmSlabPool {
+    FreeSpaceManager* space_manager;
+    void*             nvm_base_addr;
+
+    uint32_t          flags;                              // NVM_SLAB_POOL_*
+    uint32_t          depth;                              // 目标深度
+    uint32_t          count;                              // 当前可用数量
+    uint32_t          pending;                            // 按需模式下未完成的请求数
+    uint64_t          offsets[NVM_SLAB_POOL_MAX_DEPTH];   // 已准备好的 Slab 偏移 (栈)
+    bool              stopping;
+
+    nvm_mutex_t       lock;
+    nvm_cond_t        cond;
+    nvm_thread_t      worker;
+} NvmSlabPool;
+
+// ============================================================================
+//                          内部函数前向声明
+// ============================================================================
+
+static void*    pool_worker_main(void* arg);
+static uint32_t clamp_depth(uint32_t depth);
+static bool     pool_needs_fill(const NvmSlabPool* pool);
+static void     prepare_slab(NvmSlabPool* pool, uint64_t offset);
+
+// ============================================================================
+//                          公共 API 实现
+// ============================================================================
+
+NvmSlabPool* slab_pool_create(FreeSpaceManager* manager, void* nvm_base_addr, uint32_t depth, uint32_t flags) {
+    if (!manager || !nvm_base_addr) return NULL;
+
+    NvmSlabPool* pool = (NvmSlabPool*)calloc(1, sizeof(NvmSlabPool));
+    if (!pool) {
+        LOG_ERR("Failed to allocate slab pool struct.");
+        return NULL;
+    }
+
+    pool->space_manager = manager;
+    pool->nvm_base_addr = nvm_base_addr;
+    pool->flags         = flags;
+    pool->depth         = clamp_depth(depth);
+
+    if (NVM_MUTEX_INIT(&pool->lock) != 0) {
+        LOG_ERR("Failed to init mutex.");
+        goto err_free_pool;
+    }
+    if (NVM_COND_INIT(&pool->cond) != 0) {
+        LOG_ERR("Failed to init condition.");
+        goto err_destroy_mutex;
+    }
+    if (NVM_THREAD_CREATE(&pool->worker, pool_worker_main, pool) != 0) {
+        LOG_ERR("Failed to start slab pool worker.");
+        goto err_destroy_cond;
+    }
+
+    return pool;
+
+err_destroy_cond:
+    NVM_COND_DESTROY(&pool->cond);
+err_destroy_mutex:
+    NVM_MUTEX_DESTROY(&pool->lock);
+err_free_pool:
+    free(pool);
+    return NULL;
+}
+
+void slab_pool_destroy(NvmSlabPool* pool) {
+    if (!pool) return;
+
+    NVM_MUTEX_ACQUIRE(&pool->lock);
+    pool->stopping = true;
+    NVM_COND_BROADCAST(&pool->cond);
+    NVM_MUTEX_RELEASE(&pool->lock);
+
+    NVM_THREAD_JOIN(pool->worker);
+
+    // 归还未被取走的 Slab
+    for (uint32_t i = 0; i < pool->count; ++i) {
+        space_manager_free_slab(pool->space_manager, pool->offsets[i]);
+    }
+
+    NVM_COND_DESTROY(&pool->cond);
+    NVM_MUTEX_DESTROY(&pool->lock);
+    free(pool);
+}
+
+int slab_pool_take(NvmSlabPool* pool, uint64_t* out_offset) {
+    if (!pool || !out_offset) return -1;
+
+    NVM_MUTEX_ACQUIRE(&pool->lock);
+    if (pool->count == 0) {
+        NVM_MUTEX_RELEASE(&pool->lock);
+        return -1;
+    }
+
+    *out_offset = pool->offsets[--pool->count];
+    NVM_COND_SIGNAL(&pool->cond);
+    NVM_MUTEX_RELEASE(&pool->lock);
+    return 0;
+}
+
+void slab_pool_request(NvmSlabPool* pool) {
+    if (!pool) return;
+
+    NVM_MUTEX_ACQUIRE(&pool->lock);
+    if (pool->count + pool->pending < pool->depth) {
+        pool->pending++;
+        NVM_COND_SIGNAL(&pool->cond);
+    }
+    NVM_MUTEX_RELEASE(&pool->lock);
+}
+
+void slab_pool_set_depth(NvmSlabPool* pool, uint32_t depth) {
+    if (!pool) return;
+
+    NVM_MUTEX_ACQUIRE(&pool->lock);
+    pool->depth = clamp_depth(depth);
+    NVM_COND_SIGNAL(&pool->cond);
+    NVM_MUTEX_RELEASE(&pool->lock);
+}
+
+uint32_t slab_pool_available(NvmSlabPool* pool) {
+    if (!pool) return 0;
+
+    NVM_MUTEX_ACQUIRE(&pool->lock);
+    uint32_t count = pool->count;
+    NVM_MUTEX_RELEASE(&pool->lock);
+    return count;
+}
+
+// ============================================================================
+//                          内部函数实现
+// ============================================================================
+
+static uint32_t clamp_depth(uint32_t depth) {
+    return depth > NVM_SLAB_POOL_MAX_DEPTH ? NVM_SLAB_POOL_MAX_DEPTH : depth;
+}
+
+// 假设已持锁
+static bool pool_needs_fill(const NvmSlabPool* pool) {
+    if (pool->count >= pool->depth) return false;
+    return !(pool->flags & NVM_SLAB_POOL_ON_DEMAND) || pool->pending > 0;
+}
+
+static void prepare_slab(NvmSlabPool* pool, uint64_t offset) {
+    void* addr = (char*)pool->nvm_base_addr + offset;
+    if (pool->flags & NVM_SLAB_POOL_ZERO) {
+        nvm_persist_memset_nt(addr, 0, NVM_SLAB_SIZE);
+    } else {
+        nvm_os_prefault(addr, NVM_SLAB_SIZE);
+    }
+}
+
+// 后台线程：需要补充时申请 Slab 并在锁外准备，空间耗尽时定期重试
+static void* pool_worker_main(void* arg) {
+    NvmSlabPool* pool = (NvmSlabPool*)arg;
+
+    NVM_MUTEX_ACQUIRE(&pool->lock);
+    while (!pool->stopping) {
+        if (!pool_needs_fill(pool)) {
+            NVM_COND_WAIT(&pool->cond, &pool->lock);
+            continue;
+        }
+        NVM_MUTEX_RELEASE(&pool->lock);
+
+        uint64_t offset = space_manager_alloc_slab(pool->space_manager);
+        if (offset != (uint64_t)-1) {
+            prepare_slab(pool, offset);
+        }
+
+        NVM_MUTEX_ACQUIRE(&pool->lock);
+        if (offset == (uint64_t)-1) {
+            NVM_COND_TIMEDWAIT_MS(&pool->cond, &pool->lock, NVM_SLAB_POOL_RETRY_MS);
+            continue;
+        }
+
+        if (pool->stopping || pool->count >= pool->depth) {
+            // 准备期间深度被调小或正在销毁，归还空间 (锁顺序: 池锁 -> 空间管理器锁)
+            space_manager_free_slab(pool->space_manager, offset);
+            continue;
+        }
+        pool->offsets[pool->count++] = offset;
+        if (pool->pending > 0) pool->pending--;
+    }
+    NVM_MUTEX_RELEASE(&pool->lock);
+
+    return NULL;
+}
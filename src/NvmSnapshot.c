@@ -0,0 +1,485 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "NvmDefs.h"
+#include "NvmSnapshot.h"
+
+// ============================================================================
+//                          常量定义
+// ============================================================================
+
+// 写入缓冲区大小：一次 write() 的粒度
+#define SNAPSHOT_BUFFER_SIZE   (64 * 1024)
+
+// 单条记录 (不含游程) 的最大编码长度
+#define SNAPSHOT_RECORD_MAX    32
+
+// varint 最大编码长度 (64 位)
+#define SNAPSHOT_VARINT_MAX    10
+
+// 读取整份快照时的初始缓冲区大小
+#define SNAPSHOT_READ_CHUNK    (256 * 1024)
+
+// 记录标签
+#define SNAPSHOT_TAG_HEAP      'H'
+#define SNAPSHOT_TAG_SLAB      'S'
+#define SNAPSHOT_TAG_EXTENT    'E'
+#define SNAPSHOT_TAG_END       'Z'
+
+#define SNAP_BIT(bitmap, n)    (((bitmap)[(n) / 8] >> ((n) % 8)) & 1)
+
+// ============================================================================
+//                          核心数据结构
+// ============================================================================
+
+struct NvmSnapshotWriter {
+    int           fd;
+    bool          failed;      // 任一次 write() 失败后不再写出，finish 时报告
+    uint32_t      len;
+    uint64_t      slab_count;
+    uint64_t      extent_count;
+    unsigned char buf[SNAPSHOT_BUFFER_SIZE];
+};
+
+// 解析游标：越界读取只置 bad，不越过缓冲区
+typedef struct SnapCursor {
+    const unsigned char* p;
+    const unsigned char* end;
+    bool                 bad;
+} SnapCursor;
+
+// ============================================================================
+//                          内部函数前向声明
+// ============================================================================
+
+static void     writer_flush(NvmSnapshotWriter* w);
+static void     writer_reserve(NvmSnapshotWriter* w, uint32_t bytes);
+static void     put_u8(NvmSnapshotWriter* w, uint8_t v);
+static void     put_u16(NvmSnapshotWriter* w, uint16_t v);
+static void     put_u32(NvmSnapshotWriter* w, uint32_t v);
+static void     put_u64(NvmSnapshotWriter* w, uint64_t v);
+static void     put_varint(NvmSnapshotWriter* w, uint64_t v);
+static uint32_t run_end(const unsigned char* bitmap, uint32_t pos, uint32_t total, bool live);
+static int      read_all(int fd, unsigned char** out_buf, size_t* out_len);
+static uint8_t  get_u8(SnapCursor* c);
+static uint64_t get_fixed(SnapCursor* c, uint32_t bytes);
+static uint64_t get_varint(SnapCursor* c);
+static int      parse_slab(SnapCursor* c, NvmSnapshotSlab* slab);
+static int      compare_slabs(const void* a, const void* b);
+static int      compare_extents(const void* a, const void* b);
+static void     summarize(const NvmSnapshot* snap, int side, NvmSnapshotDiff* out);
+
+// ============================================================================
+//                          写入 API 实现
+// ============================================================================
+
+NvmSnapshotWriter* nvm_snapshot_writer_create(int fd, uint32_t heap_count) {
+    if (fd < 0) return NULL;
+
+    NvmSnapshotWriter* w = (NvmSnapshotWriter*)malloc(sizeof(NvmSnapshotWriter));
+    if (!w) {
+        LOG_ERR("Failed to allocate snapshot writer.");
+        return NULL;
+    }
+    w->fd = fd;
+    w->failed = false;
+    w->len = 0;
+    w->slab_count = 0;
+    w->extent_count = 0;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    memcpy(w->buf, NVM_SNAPSHOT_MAGIC, sizeof(NVM_SNAPSHOT_MAGIC));
+    w->len = sizeof(NVM_SNAPSHOT_MAGIC);
+    put_u16(w, NVM_SNAPSHOT_VERSION);
+    put_u16(w, NVM_SNAPSHOT_HEADER_SIZE);
+    put_u32(w, (uint32_t)NVM_SLAB_SIZE);
+    put_u64(w, (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec);
+    put_u32(w, heap_count);
+    put_u32(w, 0);
+    return w;
+}
+
+void nvm_snapshot_write_heap(NvmSnapshotWriter* w, uint32_t index, int numa_node,
+                             uint64_t range_offset, uint64_t range_size) {
+    writer_reserve(w, SNAPSHOT_RECORD_MAX);
+    put_u8(w, SNAPSHOT_TAG_HEAP);
+    put_u8(w, (uint8_t)index);
+    put_u8(w, (uint8_t)(numa_node + 1));
+    put_u64(w, range_offset);
+    put_u64(w, range_size);
+}
+
+void nvm_snapshot_write_slab(NvmSnapshotWriter* w, uint64_t offset, SizeClassID sc_id,
+                             uint32_t total, uint32_t used, const unsigned char* live_bitmap) {
+    writer_reserve(w, SNAPSHOT_RECORD_MAX);
+    put_u8(w, SNAPSHOT_TAG_SLAB);
+    put_u64(w, offset);
+    put_u8(w, (uint8_t)sc_id);
+    put_u8(w, live_bitmap ? 0 : NVM_SNAPSHOT_SLAB_VOLATILE);
+    put_varint(w, total);
+    put_varint(w, used);
+    w->slab_count++;
+    if (!live_bitmap) return;
+
+    // 游程：空闲、占用交替，以空闲开头；全空或全满的 Slab 只需 1~2 个游程
+    bool live = false;
+    for (uint32_t pos = 0; pos < total; live = !live) {
+        uint32_t end = run_end(live_bitmap, pos, total, live);
+        writer_reserve(w, SNAPSHOT_VARINT_MAX);
+        put_varint(w, end - pos);
+        pos = end;
+    }
+}
+
+void nvm_snapshot_write_extent(NvmSnapshotWriter* w, uint64_t offset, uint64_t size) {
+    writer_reserve(w, SNAPSHOT_RECORD_MAX);
+    put_u8(w, SNAPSHOT_TAG_EXTENT);
+    put_u64(w, offset);
+    put_varint(w, size);
+    w->extent_count++;
+}
+
+int nvm_snapshot_writer_finish(NvmSnapshotWriter* w) {
+    if (!w) return -1;
+
+    writer_reserve(w, SNAPSHOT_RECORD_MAX);
+    put_u8(w, SNAPSHOT_TAG_END);
+    put_varint(w, w->slab_count);
+    put_varint(w, w->extent_count);
+    writer_flush(w);
+
+    int ret = w->failed ? -1 : 0;
+    free(w);
+    return ret;
+}
+
+// ============================================================================
+//                          读取与比较 API 实现
+// ============================================================================
+
+int nvm_snapshot_load(int fd, NvmSnapshot* out) {
+    if (!out) return -1;
+    memset(out, 0, sizeof(*out));
+
+    unsigned char* buf;
+    size_t len;
+    if (read_all(fd, &buf, &len) != 0) return -1;
+
+    SnapCursor c = { buf, buf + len, false };
+    uint64_t slab_cap = 0, extent_cap = 0;
+    int heap = -1;
+
+    if (len < NVM_SNAPSHOT_HEADER_SIZE || memcmp(buf, NVM_SNAPSHOT_MAGIC, sizeof(NVM_SNAPSHOT_MAGIC)) != 0) {
+        LOG_ERR("Not a heap snapshot.");
+        goto err_free;
+    }
+    c.p += sizeof(NVM_SNAPSHOT_MAGIC);
+    out->version = (uint16_t)get_fixed(&c, 2);
+    uint16_t header_size = (uint16_t)get_fixed(&c, 2);
+    out->slab_size = (uint32_t)get_fixed(&c, 4);
+    out->timestamp_ns = get_fixed(&c, 8);
+    out->heap_count = (uint32_t)get_fixed(&c, 4);
+    if (out->version != NVM_SNAPSHOT_VERSION || header_size < NVM_SNAPSHOT_HEADER_SIZE ||
+        header_size > len || out->heap_count > MAX_NUMA_NODES) {
+        LOG_ERR("Unsupported snapshot version %u.", (unsigned)out->version);
+        goto err_free;
+    }
+    c.p = buf + header_size;
+
+    for (;;) {
+        uint8_t tag = get_u8(&c);
+        if (c.bad) break;
+
+        if (tag == SNAPSHOT_TAG_HEAP) {
+            heap = get_u8(&c);
+            if (c.bad || (uint32_t)heap >= out->heap_count) goto err_format;
+            out->heaps[heap].numa_node = (int32_t)get_u8(&c) - 1;
+            out->heaps[heap].range_offset = get_fixed(&c, 8);
+            out->heaps[heap].range_size = get_fixed(&c, 8);
+        } else if (tag == SNAPSHOT_TAG_SLAB) {
+            if (heap < 0) goto err_format;
+            if (out->slab_count == slab_cap) {
+                slab_cap = slab_cap ? slab_cap * 2 : 256;
+                NvmSnapshotSlab* grown = (NvmSnapshotSlab*)realloc(out->slabs, slab_cap * sizeof(NvmSnapshotSlab));
+                if (!grown) goto err_format;
+                out->slabs = grown;
+            }
+            NvmSnapshotSlab* slab = &out->slabs[out->slab_count++];
+            slab->heap = (uint8_t)heap;
+            if (parse_slab(&c, slab) != 0) goto err_format;
+        } else if (tag == SNAPSHOT_TAG_EXTENT) {
+            if (heap < 0) goto err_format;
+            if (out->extent_count == extent_cap) {
+                extent_cap = extent_cap ? extent_cap * 2 : 64;
+                NvmSnapshotExtent* grown = (NvmSnapshotExtent*)realloc(out->extents,
+                                                                      extent_cap * sizeof(NvmSnapshotExtent));
+                if (!grown) goto err_format;
+                out->extents = grown;
+            }
+            NvmSnapshotExtent* ext = &out->extents[out->extent_count++];
+            ext->heap = (uint8_t)heap;
+            ext->offset = get_fixed(&c, 8);
+            ext->size = get_varint(&c);
+        } else if (tag == SNAPSHOT_TAG_END) {
+            uint64_t slabs = get_varint(&c);
+            uint64_t extents = get_varint(&c);
+            if (c.bad || slabs != out->slab_count || extents != out->extent_count) goto err_format;
+            free(buf);
+            qsort(out->slabs, out->slab_count, sizeof(NvmSnapshotSlab), compare_slabs);
+            qsort(out->extents, out->extent_count, sizeof(NvmSnapshotExtent), compare_extents);
+            return 0;
+        } else {
+            goto err_format;
+        }
+        if (c.bad) break;
+    }
+
+err_format:
+    // 截断的快照 (写入方中途失败) 缺少结束记录，同样视为无效
+    LOG_ERR("Malformed or truncated snapshot at byte %zu.", (size_t)(c.p - buf));
+err_free:
+    free(buf);
+    nvm_snapshot_release(out);
+    return -1;
+}
+
+void nvm_snapshot_release(NvmSnapshot* snap) {
+    if (!snap) return;
+    free(snap->slabs);
+    free(snap->extents);
+    snap->slabs = NULL;
+    snap->extents = NULL;
+    snap->slab_count = 0;
+    snap->extent_count = 0;
+}
+
+bool nvm_snapshot_slab_stranded(const NvmSnapshotSlab* slab) {
+    return slab->used > 0 && (uint64_t)slab->used * 100 < (uint64_t)slab->total * NVM_SNAPSHOT_STRANDED_PCT;
+}
+
+void nvm_snapshot_diff(const NvmSnapshot* before, const NvmSnapshot* after, NvmSnapshotDiff* out) {
+    memset(out, 0, sizeof(*out));
+    if (before) summarize(before, 0, out);
+    if (after) summarize(after, 1, out);
+
+    uint64_t n0 = before ? before->slab_count : 0;
+    uint64_t n1 = after ? after->slab_count : 0;
+    uint64_t i = 0, j = 0;
+
+    // 两边均按偏移升序，归并配对
+    while (i < n0 || j < n1) {
+        const NvmSnapshotSlab* a = (i < n0) ? &before->slabs[i] : NULL;
+        const NvmSnapshotSlab* b = (j < n1) ? &after->slabs[j] : NULL;
+
+        if (a && (!b || a->offset < b->offset)) {
+            out->slabs_removed++;
+            i++;
+        } else if (b && (!a || b->offset < a->offset)) {
+            out->slabs_added++;
+            j++;
+        } else {
+            if (a->size_class != b->size_class) {
+                out->slabs_reclassed++;
+            } else {
+                out->slabs_kept++;
+                if (nvm_snapshot_slab_stranded(b) && !nvm_snapshot_slab_stranded(a)) {
+                    if (out->newly_stranded < NVM_SNAPSHOT_SAMPLE) {
+                        out->stranded_sample[out->newly_stranded] = b->offset;
+                    }
+                    out->newly_stranded++;
+                }
+            }
+            i++;
+            j++;
+        }
+    }
+}
+
+// ============================================================================
+//                          内部函数实现
+// ============================================================================
+
+static void writer_flush(NvmSnapshotWriter* w) {
+    uint32_t done = 0;
+    while (!w->failed && done < w->len) {
+        ssize_t n = write(w->fd, w->buf + done, w->len - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            LOG_ERR("Snapshot write failed (errno %d).", errno);
+            w->failed = true;
+            break;
+        }
+        done += (uint32_t)n;
+    }
+    w->len = 0;
+}
+
+static void writer_reserve(NvmSnapshotWriter* w, uint32_t bytes) {
+    if (w->len + bytes > SNAPSHOT_BUFFER_SIZE) writer_flush(w);
+}
+
+static void put_u8(NvmSnapshotWriter* w, uint8_t v) {
+    w->buf[w->len++] = v;
+}
+
+static void put_u16(NvmSnapshotWriter* w, uint16_t v) {
+    put_u8(w, (uint8_t)v);
+    put_u8(w, (uint8_t)(v >> 8));
+}
+
+static void put_u32(NvmSnapshotWriter* w, uint32_t v) {
+    put_u16(w, (uint16_t)v);
+    put_u16(w, (uint16_t)(v >> 16));
+}
+
+static void put_u64(NvmSnapshotWriter* w, uint64_t v) {
+    put_u32(w, (uint32_t)v);
+    put_u32(w, (uint32_t)(v >> 32));
+}
+
+static void put_varint(NvmSnapshotWriter* w, uint64_t v) {
+    while (v >= 0x80) {
+        put_u8(w, (uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    put_u8(w, (uint8_t)v);
+}
+
+// 从 pos 开始、状态为 live 的游程的结束位置；整字节相同时一次跳过 8 块
+static uint32_t run_end(const unsigned char* bitmap, uint32_t pos, uint32_t total, bool live) {
+    const unsigned char same = live ? 0xFF : 0x00;
+    while (pos < total) {
+        if ((pos % 8) == 0 && pos + 8 <= total && bitmap[pos / 8] == same) {
+            pos += 8;
+            continue;
+        }
+        if ((bool)SNAP_BIT(bitmap, pos) != live) break;
+        pos++;
+    }
+    return pos;
+}
+
+static int read_all(int fd, unsigned char** out_buf, size_t* out_len) {
+    size_t cap = SNAPSHOT_READ_CHUNK, len = 0;
+    unsigned char* buf = (unsigned char*)malloc(cap);
+    if (!buf) return -1;
+
+    for (;;) {
+        if (len == cap) {
+            unsigned char* grown = (unsigned char*)realloc(buf, cap * 2);
+            if (!grown) goto err_free;
+            buf = grown;
+            cap *= 2;
+        }
+        ssize_t n = read(fd, buf + len, cap - len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            LOG_ERR("Snapshot read failed (errno %d).", errno);
+            goto err_free;
+        }
+        if (n == 0) break;
+        len += (size_t)n;
+    }
+    *out_buf = buf;
+    *out_len = len;
+    return 0;
+
+err_free:
+    free(buf);
+    return -1;
+}
+
+static uint8_t get_u8(SnapCursor* c) {
+    if (c->p >= c->end) {
+        c->bad = true;
+        return 0;
+    }
+    return *c->p++;
+}
+
+static uint64_t get_fixed(SnapCursor* c, uint32_t bytes) {
+    uint64_t v = 0;
+    for (uint32_t i = 0; i < bytes; ++i) {
+        v |= (uint64_t)get_u8(c) << (8 * i);
+    }
+    return v;
+}
+
+static uint64_t get_varint(SnapCursor* c) {
+    uint64_t v = 0;
+    for (uint32_t shift = 0; shift < 7 * SNAPSHOT_VARINT_MAX; shift += 7) {
+        uint8_t byte = get_u8(c);
+        v |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return v;
+    }
+    c->bad = true;
+    return 0;
+}
+
+// 解码 Slab 记录并核对游程：长度之和等于总块数，占用游程之和等于 used
+static int parse_slab(SnapCursor* c, NvmSnapshotSlab* slab) {
+    slab->offset = get_fixed(c, 8);
+    slab->size_class = get_u8(c);
+    slab->flags = get_u8(c);
+    uint64_t total = get_varint(c);
+    uint64_t used = get_varint(c);
+    slab->live_runs = 0;
+    if (c->bad || slab->size_class >= SC_COUNT || total > UINT32_MAX || used > total) return -1;
+    slab->total = (uint32_t)total;
+    slab->used = (uint32_t)used;
+    if (slab->flags & NVM_SNAPSHOT_SLAB_VOLATILE) return 0;
+
+    uint64_t covered = 0, live_blocks = 0;
+    for (bool live = false; covered < total && !c->bad; live = !live) {
+        uint64_t run = get_varint(c);
+        if (run == 0 && (live || covered > 0)) return -1;   // 只有开头的空闲游程可以为 0
+        covered += run;
+        if (live && run > 0) {
+            live_blocks += run;
+            slab->live_runs++;
+        }
+    }
+    return (c->bad || covered != total || live_blocks != used) ? -1 : 0;
+}
+
+static int compare_slabs(const void* a, const void* b) {
+    uint64_t x = ((const NvmSnapshotSlab*)a)->offset;
+    uint64_t y = ((const NvmSnapshotSlab*)b)->offset;
+    return (x > y) - (x < y);
+}
+
+static int compare_extents(const void* a, const void* b) {
+    uint64_t x = ((const NvmSnapshotExtent*)a)->offset;
+    uint64_t y = ((const NvmSnapshotExtent*)b)->offset;
+    return (x > y) - (x < y);
+}
+
+// 单份快照的汇总。分片条带边界上相邻的空闲段合并为一个区间计算
+static void summarize(const NvmSnapshot* snap, int side, NvmSnapshotDiff* out) {
+    for (uint64_t i = 0; i < snap->slab_count; ++i) {
+        const NvmSnapshotSlab* slab = &snap->slabs[i];
+        out->class_slabs[side][slab->size_class]++;
+        out->class_blocks[side][slab->size_class] += slab->used;
+        if (nvm_snapshot_slab_stranded(slab)) out->stranded[side]++;
+    }
+
+    uint64_t run = 0;
+    for (uint64_t i = 0; i < snap->extent_count; ++i) {
+        const NvmSnapshotExtent* ext = &snap->extents[i];
+        out->free_bytes[side] += ext->size;
+        bool joins = (i > 0) && snap->extents[i - 1].offset + snap->extents[i - 1].size == ext->offset;
+        if (joins) {
+            run += ext->size;
+        } else {
+            out->free_extents[side]++;
+            run = ext->size;
+        }
+        if (run > out->largest_extent[side]) out->largest_extent[side] = run;
+    }
+}
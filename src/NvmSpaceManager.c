@@ -5,6 +5,21 @@
 
 #include "NvmDefs.h"
 #include "NvmSpaceManager.h"
+#include "NvmMetaArena.h"
+
+// ============================================================================
+//                          常量定义
+// ============================================================================
+
+// 分片数上限。地址空间按条带轮流分给各分片，每个分片独立加锁
+#define NVM_SPACE_MAX_SHARDS   8
+
+// 条带大小 (Slab 数)。不足 NVM_SPACE_STRIPE_SLABS * 2 个 Slab 的空间只用一个分片
+#define NVM_SPACE_STRIPE_SLABS 16
+#define NVM_SPACE_STRIPE_SIZE  ((uint64_t)NVM_SPACE_STRIPE_SLABS * NVM_SLAB_SIZE)
+
+// space_manager_for_each_extent 每次持锁复制的段数
+#define NVM_SPACE_VISIT_BATCH  64
 
 // ============================================================================
 //                          核心数据结构
@@ -18,11 +33,20 @@ typedef struct FreeSegmentNode {
     struct FreeSegmentNode* next;
 } FreeSegmentNode;
 
-// 空间管理器
-typedef struct FreeSpaceManager {
+// 分片：只管理属于自己的条带，空闲段不跨越条带边界 (单分片时除外)
+typedef struct FreeSpaceShard {
     FreeSegmentNode* head;
     FreeSegmentNode* tail;
+    uint64_t         free_bytes;   // 锁内更新，锁外仅作窃取前的预检
     nvm_mutex_t      lock;
+} __attribute__((aligned(CACHE_LINE_SIZE))) FreeSpaceShard;
+
+// 空间管理器。偏移按 (offset - base_offset) / 条带大小 轮转映射到分片，
+// 释放的空间总是回到其所属分片，与同分片内的相邻段合并
+typedef struct FreeSpaceManager {
+    FreeSpaceShard shards[NVM_SPACE_MAX_SHARDS];
+    uint64_t       base_offset;
+    uint32_t       shard_count;
 } FreeSpaceManager;
 
 // ============================================================================
@@ -30,9 +54,15 @@ typedef struct FreeSpaceManager {
 // ============================================================================
 
 static FreeSegmentNode* create_segment_node(uint64_t offset, uint64_t size);
-static void remove_node_from_list(FreeSpaceManager* manager, FreeSegmentNode* node);
-static void insert_node_into_list(FreeSpaceManager* manager, FreeSegmentNode* new_node, 
+static void             destroy_segment_node(FreeSegmentNode* node);
+static void remove_node_from_list(FreeSpaceShard* shard, FreeSegmentNode* node);
+static void insert_node_into_list(FreeSpaceShard* shard, FreeSegmentNode* new_node, 
                                   FreeSegmentNode* prev_node, FreeSegmentNode* next_node);
+static int  insert_free_range(FreeSpaceShard* shard, uint64_t offset, uint64_t size);
+static FreeSpaceShard* shard_of(FreeSpaceManager* manager, uint64_t offset);
+static uint64_t        stripe_piece(const FreeSpaceManager* manager, uint64_t offset, uint64_t end);
+static int             insert_range_striped(FreeSpaceManager* manager, uint64_t offset, uint64_t size);
+static uint64_t        take_first_fit(FreeSpaceShard* shard);
 
 // ============================================================================
 //                          公共 API 实现
@@ -45,35 +75,41 @@ FreeSpaceManager* space_manager_create(uint64_t total_nvm_size, uint64_t nvm_sta
         return NULL;
     }
 
-    FreeSpaceManager* manager = (FreeSpaceManager*)malloc(sizeof(FreeSpaceManager));
+    FreeSpaceManager* manager = (FreeSpaceManager*)aligned_alloc(CACHE_LINE_SIZE, sizeof(FreeSpaceManager));
     if (!manager) {
         LOG_ERR("Failed to allocate manager struct.");
         return NULL;
     }
 
-    manager->head = NULL;
-    manager->tail = NULL;
-
-    if (NVM_MUTEX_INIT(&manager->lock) != 0) {
-        LOG_ERR("Failed to init mutex.");
-        goto err_free_manager;
+    uint64_t stripes = total_nvm_size / NVM_SPACE_STRIPE_SIZE;
+    manager->base_offset = nvm_start_offset;
+    manager->shard_count = (stripes < 2) ? 1 : (uint32_t)(stripes < NVM_SPACE_MAX_SHARDS ? stripes : NVM_SPACE_MAX_SHARDS);
+
+    uint32_t i;
+    for (i = 0; i < manager->shard_count; ++i) {
+        FreeSpaceShard* shard = &manager->shards[i];
+        shard->head = NULL;
+        shard->tail = NULL;
+        shard->free_bytes = 0;
+        if (NVM_MUTEX_INIT(&shard->lock) != 0) {
+            LOG_ERR("Failed to init mutex.");
+            goto err_destroy_shards;
+        }
     }
 
-    // 创建初始的大块空闲节点
-    FreeSegmentNode* initial_node = create_segment_node(nvm_start_offset, total_nvm_size);
-    if (!initial_node) {
+    // 创建初始的空闲段 (按条带分给各分片)
+    if (insert_range_striped(manager, nvm_start_offset, total_nvm_size) != 0) {
         LOG_ERR("Failed to create initial segment.");
-        goto err_destroy_mutex;
+        space_manager_destroy(manager);
+        return NULL;
     }
 
-    manager->head = initial_node;
-    manager->tail = initial_node;
-
     return manager;
 
-err_destroy_mutex:
-    NVM_MUTEX_DESTROY(&manager->lock);
-err_free_manager:
+err_destroy_shards:
+    while (i-- > 0) {
+        NVM_MUTEX_DESTROY(&manager->shards[i].lock);
+    }
     free(manager);
     return NULL;
 }
@@ -81,92 +117,64 @@ err_free_manager:
 void space_manager_destroy(FreeSpaceManager* manager) {
     if (!manager) return;
 
-    FreeSegmentNode* current = manager->head;
-    while (current) {
-        FreeSegmentNode* next = current->next;
-        free(current);
-        current = next;
+    for (uint32_t i = 0; i < manager->shard_count; ++i) {
+        FreeSegmentNode* current = manager->shards[i].head;
+        while (current) {
+            FreeSegmentNode* next = current->next;
+            destroy_segment_node(current);
+            current = next;
+        }
+        NVM_MUTEX_DESTROY(&manager->shards[i].lock);
     }
-    
-    NVM_MUTEX_DESTROY(&manager->lock);
     free(manager);
 }
 
 uint64_t space_manager_alloc_slab(FreeSpaceManager* manager) {
     if (!manager) return (uint64_t)-1;
 
-    NVM_MUTEX_ACQUIRE(&manager->lock);
+    // 先查本 CPU 的归属分片，耗尽时依次从其他分片窃取
+    uint32_t home = (uint32_t)NVM_GET_CURRENT_CPU_ID() % manager->shard_count;
+    for (uint32_t i = 0; i < manager->shard_count; ++i) {
+        FreeSpaceShard* shard = &manager->shards[(home + i) % manager->shard_count];
+        if (i > 0 && __atomic_load_n(&shard->free_bytes, __ATOMIC_RELAXED) < NVM_SLAB_SIZE) continue;
 
-    // [First-Fit] 查找首个满足大小的节点
-    FreeSegmentNode* curr = manager->head;
-    while (curr) {
-        if (curr->size >= NVM_SLAB_SIZE) {
-            uint64_t offset = curr->nvm_offset;
+        NVM_MUTEX_ACQUIRE(&shard->lock);
+        uint64_t offset = take_first_fit(shard);
+        NVM_MUTEX_RELEASE(&shard->lock);
 
-            if (curr->size == NVM_SLAB_SIZE) {
-                // 大小刚好，移除节点
-                remove_node_from_list(manager, curr);
-                free(curr);
-            } else {
-                // 空间富余，切割节点
-                curr->nvm_offset += NVM_SLAB_SIZE;
-                curr->size       -= NVM_SLAB_SIZE;
-            }
-
-            NVM_MUTEX_RELEASE(&manager->lock);
-            return offset;
-        }
-        curr = curr->next;
+        if (offset != (uint64_t)-1) return offset;
     }
-
-    NVM_MUTEX_RELEASE(&manager->lock);
     return (uint64_t)-1;
 }
 
 void space_manager_free_slab(FreeSpaceManager* manager, uint64_t offset_to_free) {
     if (!manager) return;
 
-    NVM_MUTEX_ACQUIRE(&manager->lock);
-
-    // 查找插入位置 (prev < offset < next)
-    FreeSegmentNode* prev = NULL;
-    FreeSegmentNode* next = manager->head;
-    while (next && next->nvm_offset < offset_to_free) {
-        prev = next;
-        next = next->next;
-    }
-
-    // 校验重叠 (Debug 模式)
-    assert(!next || (offset_to_free + NVM_SLAB_SIZE <= next->nvm_offset));
-    assert(!prev || (prev->nvm_offset + prev->size <= offset_to_free));
-
-    bool merge_prev = (prev && (prev->nvm_offset + prev->size == offset_to_free));
-    bool merge_next = (next && (offset_to_free + NVM_SLAB_SIZE == next->nvm_offset));
+    FreeSpaceShard* shard = shard_of(manager, offset_to_free);
+    NVM_MUTEX_ACQUIRE(&shard->lock);
+    insert_free_range(shard, offset_to_free, NVM_SLAB_SIZE);
+    NVM_MUTEX_RELEASE(&shard->lock);
+}
 
-    if (merge_prev && merge_next) {
-        // 双向合并：Prev + Self + Next
-        prev->size += NVM_SLAB_SIZE + next->size;
-        remove_node_from_list(manager, next);
-        free(next);
-    } else if (merge_prev) {
-        // 向前合并
-        prev->size += NVM_SLAB_SIZE;
-    } else if (merge_next) {
-        // 向后合并 (节点前移)
-        next->nvm_offset = offset_to_free;
-        next->size      += NVM_SLAB_SIZE;
-    } else {
-        // 无法合并，插入新节点
-        FreeSegmentNode* node = create_segment_node(offset_to_free, NVM_SLAB_SIZE);
-        if (!node) {
-            LOG_ERR("Failed to create free segment node (Memory Leak!).");
-            // 无法插入回链表，只能丢弃该块（这属于严重系统错误）
-        } else {
-            insert_node_into_list(manager, node, prev, next);
+int space_manager_add_range(FreeSpaceManager* manager, uint64_t offset, uint64_t size) {
+    if (!manager || size < NVM_SLAB_SIZE || offset + size < offset) return -1;
+
+    // 新区间不得与现有空闲段重叠 (与已分配空间的重叠由调用方保证)
+    for (uint32_t i = 0; i < manager->shard_count; ++i) {
+        FreeSpaceShard* shard = &manager->shards[i];
+        NVM_MUTEX_ACQUIRE(&shard->lock);
+        for (FreeSegmentNode* curr = shard->head; curr; curr = curr->next) {
+            if (offset < curr->nvm_offset + curr->size && curr->nvm_offset < offset + size) {
+                NVM_MUTEX_RELEASE(&shard->lock);
+                LOG_ERR("Range [0x%llx, +0x%llx) overlaps free space.",
+                        (unsigned long long)offset, (unsigned long long)size);
+                return -1;
+            }
         }
+        NVM_MUTEX_RELEASE(&shard->lock);
     }
 
-    NVM_MUTEX_RELEASE(&manager->lock);
+    return insert_range_striped(manager, offset, size);
 }
 
 int space_manager_alloc_at_offset(FreeSpaceManager* manager, uint64_t offset) {
@@ -175,8 +183,11 @@ int space_manager_alloc_at_offset(FreeSpaceManager* manager, uint64_t offset) {
     const uint64_t req_size = NVM_SLAB_SIZE;
     uint64_t req_end = offset + req_size;
 
+    FreeSpaceShard* shard = shard_of(manager, offset);
+    NVM_MUTEX_ACQUIRE(&shard->lock);
+
     // 遍历查找包含目标区域的节点
-    FreeSegmentNode* curr = manager->head;
+    FreeSegmentNode* curr = shard->head;
     while (curr) {
         uint64_t curr_end = curr->nvm_offset + curr->size;
 
@@ -186,8 +197,8 @@ int space_manager_alloc_at_offset(FreeSpaceManager* manager, uint64_t offset) {
 
             if (match_head && match_tail) {
                 // 情况 1: 完全重合 -> 移除节点
-                remove_node_from_list(manager, curr);
-                free(curr);
+                remove_node_from_list(shard, curr);
+                destroy_segment_node(curr);
             } else if (match_head) {
                 // 情况 2: 头部重合 -> 头部缩进
                 curr->nvm_offset += req_size;
@@ -200,57 +211,211 @@ int space_manager_alloc_at_offset(FreeSpaceManager* manager, uint64_t offset) {
                 FreeSegmentNode* new_tail = create_segment_node(req_end, curr_end - req_end);
                 if (!new_tail) {
                     LOG_ERR("Failed to create split node during restore.");
+                    NVM_MUTEX_RELEASE(&shard->lock);
                     return -1;
                 }
                 // 修改前段大小，插入后段节点
                 curr->size = offset - curr->nvm_offset;
-                insert_node_into_list(manager, new_tail, curr, curr->next);
+                insert_node_into_list(shard, new_tail, curr, curr->next);
             }
+            __atomic_store_n(&shard->free_bytes, shard->free_bytes - req_size, __ATOMIC_RELAXED);
+            NVM_MUTEX_RELEASE(&shard->lock);
             return 0; // 成功
         }
         curr = curr->next;
     }
 
+    NVM_MUTEX_RELEASE(&shard->lock);
     LOG_ERR("Requested offset %llu is not free.", (unsigned long long)offset);
     return -1;
 }
 
+uint64_t space_manager_free_bytes(FreeSpaceManager* manager) {
+    if (!manager) return 0;
+
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < manager->shard_count; ++i) {
+        total += __atomic_load_n(&manager->shards[i].free_bytes, __ATOMIC_RELAXED);
+    }
+    return total;
+}
+
+uint64_t space_manager_for_each_extent(FreeSpaceManager* manager, space_extent_fn fn, void* ctx) {
+    if (!manager || !fn) return 0;
+
+    uint64_t visited = 0;
+    for (uint32_t i = 0; i < manager->shard_count; ++i) {
+        FreeSpaceShard* shard = &manager->shards[i];
+        uint64_t resume = 0;     // 下一批从不低于该偏移的段开始 (链表按地址有序)
+        bool     first = true;
+
+        for (;;) {
+            uint64_t offsets[NVM_SPACE_VISIT_BATCH];
+            uint64_t sizes[NVM_SPACE_VISIT_BATCH];
+            uint32_t count = 0;
+
+            NVM_MUTEX_ACQUIRE(&shard->lock);
+            FreeSegmentNode* curr = shard->head;
+            while (curr && !first && curr->nvm_offset < resume) curr = curr->next;
+            for (; curr && count < NVM_SPACE_VISIT_BATCH; curr = curr->next, ++count) {
+                offsets[count] = curr->nvm_offset;
+                sizes[count] = curr->size;
+            }
+            NVM_MUTEX_RELEASE(&shard->lock);
+
+            for (uint32_t k = 0; k < count; ++k) {
+                fn(offsets[k], sizes[k], ctx);
+            }
+            visited += count;
+            if (count < NVM_SPACE_VISIT_BATCH) break;
+
+            resume = offsets[count - 1] + sizes[count - 1];
+            if (resume <= offsets[count - 1]) break;   // 最后一段止于地址空间末尾
+            first = false;
+        }
+    }
+    return visited;
+}
+
 // ============================================================================
 //                          内部函数实现
 // ============================================================================
 
 static FreeSegmentNode* create_segment_node(uint64_t offset, uint64_t size) {
-    FreeSegmentNode* node = (FreeSegmentNode*)malloc(sizeof(FreeSegmentNode));
+    FreeSegmentNode* node = (FreeSegmentNode*)nvm_meta_alloc(sizeof(FreeSegmentNode), -1);
     if (node) {
         node->nvm_offset = offset;
         node->size       = size;
         node->prev       = NULL;
         node->next       = NULL;
     } else {
-        LOG_ERR("Malloc failed for segment node.");
+        LOG_ERR("Metadata allocation failed for segment node.");
     }
     return node;
 }
 
-static void remove_node_from_list(FreeSpaceManager* manager, FreeSegmentNode* node) {
+static void destroy_segment_node(FreeSegmentNode* node) {
+    nvm_meta_free(node, sizeof(FreeSegmentNode), -1);
+}
+
+static void remove_node_from_list(FreeSpaceShard* shard, FreeSegmentNode* node) {
     if (node->prev) node->prev->next = node->next;
-    else            manager->head    = node->next;
+    else            shard->head      = node->next;
 
     if (node->next) node->next->prev = node->prev;
-    else            manager->tail    = node->prev;
+    else            shard->tail      = node->prev;
 
     node->prev = NULL;
     node->next = NULL;
 }
 
-static void insert_node_into_list(FreeSpaceManager* manager, FreeSegmentNode* new_node, 
+static void insert_node_into_list(FreeSpaceShard* shard, FreeSegmentNode* new_node, 
                                   FreeSegmentNode* prev, FreeSegmentNode* next) {
     new_node->prev = prev;
     new_node->next = next;
 
-    if (prev) prev->next     = new_node;
-    else      manager->head  = new_node;
+    if (prev) prev->next   = new_node;
+    else      shard->head  = new_node;
+
+    if (next) next->prev   = new_node;
+    else      shard->tail  = new_node;
+}
+
+// 按地址顺序插入一段空闲空间并与相邻段合并 (调用方持有分片锁)
+static int insert_free_range(FreeSpaceShard* shard, uint64_t offset, uint64_t size) {
+    // 查找插入位置 (prev < offset < next)
+    FreeSegmentNode* prev = NULL;
+    FreeSegmentNode* next = shard->head;
+    while (next && next->nvm_offset < offset) {
+        prev = next;
+        next = next->next;
+    }
+
+    // 校验重叠 (Debug 模式)
+    assert(!next || (offset + size <= next->nvm_offset));
+    assert(!prev || (prev->nvm_offset + prev->size <= offset));
+
+    bool merge_prev = (prev && (prev->nvm_offset + prev->size == offset));
+    bool merge_next = (next && (offset + size == next->nvm_offset));
 
-    if (next) next->prev     = new_node;
-    else      manager->tail  = new_node;
-}
\ No newline at end of file
+    if (merge_prev && merge_next) {
+        // 双向合并：Prev + Self + Next
+        prev->size += size + next->size;
+        remove_node_from_list(shard, next);
+        destroy_segment_node(next);
+    } else if (merge_prev) {
+        // 向前合并
+        prev->size += size;
+    } else if (merge_next) {
+        // 向后合并 (节点前移)
+        next->nvm_offset = offset;
+        next->size      += size;
+    } else {
+        // 无法合并，插入新节点
+        FreeSegmentNode* node = create_segment_node(offset, size);
+        if (!node) {
+            LOG_ERR("Failed to create free segment node (Memory Leak!).");
+            // 无法插入回链表，只能丢弃该段（这属于严重系统错误）
+            return -1;
+        }
+        insert_node_into_list(shard, node, prev, next);
+    }
+    __atomic_store_n(&shard->free_bytes, shard->free_bytes + size, __ATOMIC_RELAXED);
+    return 0;
+}
+
+static FreeSpaceShard* shard_of(FreeSpaceManager* manager, uint64_t offset) {
+    if (manager->shard_count == 1) return &manager->shards[0];
+
+    // 扩容区域可能位于 base_offset 之下：无符号回绕后映射依然确定
+    uint64_t stripe = (offset - manager->base_offset) / NVM_SPACE_STRIPE_SIZE;
+    return &manager->shards[stripe % manager->shard_count];
+}
+
+// 从 offset 开始、不跨越条带边界的最长片段长度
+static uint64_t stripe_piece(const FreeSpaceManager* manager, uint64_t offset, uint64_t end) {
+    if (manager->shard_count == 1) return end - offset;
+
+    uint64_t into = (offset - manager->base_offset) % NVM_SPACE_STRIPE_SIZE;
+    uint64_t room = NVM_SPACE_STRIPE_SIZE - into;
+    return (end - offset < room) ? end - offset : room;
+}
+
+// 把区间按条带切开，分别插入所属分片
+static int insert_range_striped(FreeSpaceManager* manager, uint64_t offset, uint64_t size) {
+    uint64_t end = offset + size;
+
+    while (offset < end) {
+        uint64_t piece = stripe_piece(manager, offset, end);
+        FreeSpaceShard* shard = shard_of(manager, offset);
+
+        NVM_MUTEX_ACQUIRE(&shard->lock);
+        int ret = insert_free_range(shard, offset, piece);
+        NVM_MUTEX_RELEASE(&shard->lock);
+        if (ret != 0) return -1;
+
+        offset += piece;
+    }
+    return 0;
+}
+
+// [First-Fit] 从分片中切下一个 Slab (调用方持有分片锁)
+static uint64_t take_first_fit(FreeSpaceShard* shard) {
+    for (FreeSegmentNode* curr = shard->head; curr; curr = curr->next) {
+        if (curr->size < NVM_SLAB_SIZE) continue;
+
+        uint64_t offset = curr->nvm_offset;
+        if (curr->size == NVM_SLAB_SIZE) {
+            // 大小刚好，移除节点
+            remove_node_from_list(shard, curr);
+            destroy_segment_node(curr);
+        } else {
+            // 空间富余，切割节点
+            curr->nvm_offset += NVM_SLAB_SIZE;
+            curr->size       -= NVM_SLAB_SIZE;
+        }
+        __atomic_store_n(&shard->free_bytes, shard->free_bytes - NVM_SLAB_SIZE, __ATOMIC_RELAXED);
+        return offset;
+    }
+    return (uint64_t)-1;
+}
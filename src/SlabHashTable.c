@@ -1,4 +1,6 @@
 #include "SlabHashTable.h"
+#include "NvmEpoch.h"
+#include "NvmMetaArena.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -19,7 +21,7 @@ typedef struct SlabHashTable {
     SlabHashNode** buckets;      // 桶数组
     uint32_t       capacity;     // 桶容量
     uint32_t       count;        // 元素总数
-    nvm_rwlock_t   lock;         // 读写锁
+    nvm_rwlock_t   lock;         // 写者互斥 (查找不加锁，由纪元回收保护)
 } SlabHashTable;
 
 #define CHECK_BIT(bitmap, idx) ((bitmap)[(idx) / 8] & (1 << ((idx) % 8)))
@@ -31,6 +33,7 @@ typedef struct SlabHashTable {
 
 static uint32_t      hash_function(const SlabHashTable* table, uint64_t key);
 static SlabHashNode* create_hash_node(uint64_t nvm_offset, NvmSlab* slab_ptr);
+static void          destroy_hash_node(void* node);
 
 // ============================================================================
 //                          公共 API 实现
@@ -77,7 +80,7 @@ void slab_hashtable_destroy(SlabHashTable* table) {
         SlabHashNode* curr = table->buckets[i];
         while (curr) {
             SlabHashNode* next = curr->next;
-            free(curr);
+            destroy_hash_node(curr);
             curr = next;
         }
     }
@@ -113,8 +116,9 @@ int slab_hashtable_insert(SlabHashTable* table, uint64_t nvm_offset, NvmSlab* sl
         return -1;
     }
 
+    // 节点内容先于桶头指针发布，无锁读者不会看到未初始化的节点
     new_node->next = table->buckets[idx];
-    table->buckets[idx] = new_node;
+    __atomic_store_n(&table->buckets[idx], new_node, __ATOMIC_RELEASE);
     table->count++;
 
     NVM_RWLOCK_UNLOCK(&table->lock);
@@ -124,22 +128,23 @@ int slab_hashtable_insert(SlabHashTable* table, uint64_t nvm_offset, NvmSlab* sl
 NvmSlab* slab_hashtable_lookup(SlabHashTable* table, uint64_t nvm_offset) {
     if (!table) return NULL;
 
-    NVM_RWLOCK_READ_LOCK(&table->lock);
+    // 无锁遍历：被摘下的节点经纪元回收延迟释放，临界区内始终可安全解引用
+    uint32_t token = nvm_epoch_enter();
 
     uint32_t idx = hash_function(table, nvm_offset);
-    SlabHashNode* curr = table->buckets[idx];
+    SlabHashNode* curr = __atomic_load_n(&table->buckets[idx], __ATOMIC_ACQUIRE);
+    NvmSlab* result = NULL;
 
     while (curr) {
         if (curr->nvm_offset == nvm_offset) {
-            NvmSlab* result = curr->slab_ptr;
-            NVM_RWLOCK_UNLOCK(&table->lock);
-            return result;
+            result = curr->slab_ptr;
+            break;
         }
-        curr = curr->next;
+        curr = __atomic_load_n(&curr->next, __ATOMIC_ACQUIRE);
     }
 
-    NVM_RWLOCK_UNLOCK(&table->lock);
-    return NULL;
+    nvm_epoch_exit(token);
+    return result;
 }
 
 NvmSlab* slab_hashtable_remove(SlabHashTable* table, uint64_t nvm_offset) {
@@ -153,15 +158,15 @@ NvmSlab* slab_hashtable_remove(SlabHashTable* table, uint64_t nvm_offset) {
 
     while (curr) {
         if (curr->nvm_offset == nvm_offset) {
-            // 解链
-            if (prev) prev->next = curr->next;
-            else      table->buckets[idx] = curr->next;
+            // 解链：并发读者可能仍停在该节点上，节点交给纪元回收延迟释放
+            if (prev) __atomic_store_n(&prev->next, curr->next, __ATOMIC_RELEASE);
+            else      __atomic_store_n(&table->buckets[idx], curr->next, __ATOMIC_RELEASE);
 
             NvmSlab* slab = curr->slab_ptr;
-            free(curr);
             table->count--;
 
             NVM_RWLOCK_UNLOCK(&table->lock);
+            nvm_epoch_retire(curr, destroy_hash_node);
             return slab;
         }
         prev = curr;
@@ -173,6 +178,26 @@ NvmSlab* slab_hashtable_remove(SlabHashTable* table, uint64_t nvm_offset) {
     return NULL;
 }
 
+uint32_t slab_hashtable_for_each(SlabHashTable* table, slab_visit_fn fn, void* ctx) {
+    if (!table || !fn) return 0;
+
+    uint32_t visited = 0;
+    for (uint32_t i = 0; i < table->capacity; ++i) {
+        if (!__atomic_load_n(&table->buckets[i], __ATOMIC_RELAXED)) continue;
+
+        // 每个桶单独进入临界区，回调较慢时也不会长时间阻碍纪元推进
+        uint32_t token = nvm_epoch_enter();
+        SlabHashNode* curr = __atomic_load_n(&table->buckets[i], __ATOMIC_ACQUIRE);
+        while (curr) {
+            fn(curr->nvm_offset, curr->slab_ptr, ctx);
+            visited++;
+            curr = __atomic_load_n(&curr->next, __ATOMIC_ACQUIRE);
+        }
+        nvm_epoch_exit(token);
+    }
+    return visited;
+}
+
 
 // ============================================================================
 //                          调试工具 API 实现
@@ -202,11 +227,12 @@ void slab_hashtable_print_layout(SlabHashTable* table, void* base_addr, bool ver
             // 为了读取准确的 cache 状态，我们需要持有 Slab 的锁
             // 注意：这可能会短暂阻塞分配器，但对于调试打印是可以接受的
             NVM_SPINLOCK_ACQUIRE(&slab->lock);
+            NVM_SPINLOCK_ACQUIRE(&slab->remote_lock);
 
             uint32_t b_size = slab->block_size;
-            // allocated_block_count 是逻辑计数 (用户持有的)
-            // bitmap 是物理计数 (用户持有 + 缓存预取)
-            uint32_t logical_usage = slab->allocated_block_count; 
+            // allocated_block_count 减去远程暂存数是逻辑计数 (用户持有的)
+            // bitmap 是物理计数 (用户持有 + 缓存预取 + 远程暂存)
+            uint32_t logical_usage = slab->allocated_block_count - slab->remote_count;
             uint32_t total_cnt = slab->total_block_count;
             uint32_t cached_count = slab->cache_count;
             
@@ -223,7 +249,8 @@ void slab_hashtable_print_layout(SlabHashTable* table, void* base_addr, bool ver
                    total_cnt,
                    cached_count);
 
-            if (verbose && logical_usage > 0) {
+            // 易失模式没有位图，只打印汇总
+            if (verbose && logical_usage > 0 && !(slab->flags & NVM_SLAB_FLAG_VOLATILE)) {
                 printf("    Allocated Blocks (Index -> Address):\n");
                 
                 uint32_t printed_lines = 0;
@@ -236,13 +263,17 @@ void slab_hashtable_print_layout(SlabHashTable* table, void* base_addr, bool ver
                         // 2. 检查是否在 Ring Buffer 缓存中 (预取块/空闲块)
                         bool is_cached = false;
                         for (uint32_t c = 0; c < slab->cache_count; c++) {
-                            // Ring Buffer 索引计算： (head + i) % SIZE
-                            uint32_t ring_idx = (slab->cache_head + c) % SLAB_CACHE_SIZE;
+                            // Ring Buffer 索引计算： (head + i) & mask
+                            uint32_t ring_idx = (slab->cache_head + c) & slab->cache_mask;
                             if (slab->free_block_buffer[ring_idx] == k) {
                                 is_cached = true;
                                 break;
                             }
                         }
+                        // 远程暂存区中的块同样已被释放
+                        for (uint32_t c = 0; !is_cached && c < slab->remote_count; c++) {
+                            if (slab->remote_buffer[c] == k) is_cached = true;
+                        }
 
                         // 如果在缓存里，说明它虽然位图是1，但不是用户的数据，跳过
                         if (is_cached) {
@@ -274,6 +305,7 @@ void slab_hashtable_print_layout(SlabHashTable* table, void* base_addr, bool ver
                 total_objects_allocated += logical_usage;
             }
 
+            NVM_SPINLOCK_RELEASE(&slab->remote_lock);
             NVM_SPINLOCK_RELEASE(&slab->lock); // 释放 Slab 锁
             
             curr = curr->next;
@@ -298,13 +330,18 @@ static uint32_t hash_function(const SlabHashTable* table, uint64_t key) {
 }
 
 static SlabHashNode* create_hash_node(uint64_t nvm_offset, NvmSlab* slab_ptr) {
-    SlabHashNode* node = (SlabHashNode*)malloc(sizeof(SlabHashNode));
+    SlabHashNode* node = (SlabHashNode*)nvm_meta_alloc(sizeof(SlabHashNode), -1);
     if (node) {
         node->nvm_offset = nvm_offset;
         node->slab_ptr   = slab_ptr;
         node->next       = NULL;
     } else {
-        LOG_ERR("Malloc failed for node.");
+        LOG_ERR("Metadata allocation failed for node.");
     }
     return node;
+}
+
+// 也用作纪元回收的释放回调
+static void destroy_hash_node(void* node) {
+    nvm_meta_free(node, sizeof(SlabHashNode), -1);
 }
\ No newline at end of file
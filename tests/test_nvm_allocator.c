@@ -12,15 +12,23 @@
 #include "NvmSpaceManager.c"
 #include "SlabHashTable.c"
 #include "NvmAllocator.c"
+#include "NvmDeferredFree.c"
+#include "NvmRemoteBatch.c"
 
 #include <stdlib.h>
 #include <string.h>
 #include <sched.h> // 用于 CPU 绑定
+#include <unistd.h>
+#include <sys/stat.h>
 
 #define MAX_BLOCK_SIZE 4096
 #define TOTAL_NVM_SIZE (10 * NVM_SLAB_SIZE)
 #define NUM_SLABS 10
 
+// 预备线程测试：稳定负载的批次数与每批分配数
+#define PROV_BATCHES    24
+#define PROV_BATCH_SIZE 64
+
 static void* mock_nvm_base = NULL;
 extern struct NvmAllocator* global_nvm_allocator;
 
@@ -42,10 +50,10 @@ void tearDown(void) {
 // ... (test_allocator_lifecycle 保持不变) ...
 void test_allocator_lifecycle(void) {
     TEST_ASSERT_NOT_NULL(global_nvm_allocator);
-    TEST_ASSERT_EQUAL_PTR(mock_nvm_base, global_nvm_allocator->central_heap.nvm_base_addr);
-    TEST_ASSERT_NOT_NULL(global_nvm_allocator->central_heap.space_manager);
-    TEST_ASSERT_NOT_NULL(global_nvm_allocator->central_heap.slab_lookup_table);
-    TEST_ASSERT_EQUAL_UINT64(TOTAL_NVM_SIZE, global_nvm_allocator->central_heap.space_manager->head->size);
+    TEST_ASSERT_EQUAL_PTR(mock_nvm_base, global_nvm_allocator->central_heaps[0].nvm_base_addr);
+    TEST_ASSERT_NOT_NULL(global_nvm_allocator->central_heaps[0].space_manager);
+    TEST_ASSERT_NOT_NULL(global_nvm_allocator->central_heaps[0].slab_lookup_table);
+    TEST_ASSERT_EQUAL_UINT64(TOTAL_NVM_SIZE, global_nvm_allocator->central_heaps[0].space_manager->shards[0].head->size);
     for (int i = 0; i < SC_COUNT; ++i) {
         TEST_ASSERT_NULL(global_nvm_allocator->cpu_heaps[0].slab_lists[i]);
     }
@@ -63,8 +71,8 @@ void test_basic_malloc_and_free(void) {
     void* ptr = nvm_malloc(30);
     TEST_ASSERT_NOT_NULL(ptr);
     TEST_ASSERT_NOT_NULL(global_nvm_allocator->cpu_heaps[0].slab_lists[SC_32B]); // 这里的[0]现在安全了
-    TEST_ASSERT_EQUAL_UINT32(1, global_nvm_allocator->central_heap.slab_lookup_table->count);
-    TEST_ASSERT_EQUAL_UINT64((NUM_SLABS - 1) * NVM_SLAB_SIZE, global_nvm_allocator->central_heap.space_manager->head->size);
+    TEST_ASSERT_EQUAL_UINT32(1, global_nvm_allocator->central_heaps[0].slab_lookup_table->count);
+    TEST_ASSERT_EQUAL_UINT64((NUM_SLABS - 1) * NVM_SLAB_SIZE, global_nvm_allocator->central_heaps[0].space_manager->shards[0].head->size);
 
     nvm_free(ptr);
     TEST_ASSERT_NOT_NULL(global_nvm_allocator->cpu_heaps[0].slab_lists[SC_32B]);
@@ -85,7 +93,7 @@ void test_slab_creation_and_reuse(void) {
     void* ptr3 = nvm_malloc(8);
     TEST_ASSERT_NOT_NULL(ptr3);
     TEST_ASSERT_NOT_NULL(global_nvm_allocator->cpu_heaps[0].slab_lists[SC_8B]);
-    TEST_ASSERT_EQUAL_UINT32(2, global_nvm_allocator->central_heap.slab_lookup_table->count);
+    TEST_ASSERT_EQUAL_UINT32(2, global_nvm_allocator->central_heaps[0].slab_lookup_table->count);
 }
 
 // ... (test_empty_slab_recycling 保持不变) ...
@@ -119,7 +127,7 @@ void test_empty_slab_recycling(void) {
     TEST_ASSERT_NOT_NULL(second_slab); 
     TEST_ASSERT_TRUE(nvm_slab_is_empty(second_slab)); 
     
-    TEST_ASSERT_EQUAL_UINT32(2, global_nvm_allocator->central_heap.slab_lookup_table->count);
+    TEST_ASSERT_EQUAL_UINT32(2, global_nvm_allocator->central_heaps[0].slab_lookup_table->count);
     
     nvm_free(ptrs[blocks_per_slab]);
     free(ptrs);
@@ -140,7 +148,7 @@ void test_nvm_space_exhaustion(void) {
     for (int i = 0; i < NVM_SLAB_SIZE / 8; ++i) nvm_malloc(8);
     for (int i = 0; i < NVM_SLAB_SIZE / 16; ++i) nvm_malloc(16);
 
-    TEST_ASSERT_NULL(global_nvm_allocator->central_heap.space_manager->head);
+    TEST_ASSERT_NULL(global_nvm_allocator->central_heaps[0].space_manager->shards[0].head);
     TEST_ASSERT_NULL(nvm_malloc(32));
 }
 
@@ -167,6 +175,1084 @@ void test_mixed_load_and_fragmentation(void) {
 
 
 
+/**
+ * @brief calloc 返回清零内存 (含复用的脏块)，溢出与零参数返回 NULL。
+ */
+void test_calloc_zeroes_reused_blocks(void) {
+    unsigned char* p = nvm_malloc(128);
+    TEST_ASSERT_NOT_NULL(p);
+    memset(p, 0xFF, 128);
+    nvm_free(p);
+
+    unsigned char* q = nvm_calloc(4, 32);
+    TEST_ASSERT_NOT_NULL(q);
+    for (int i = 0; i < 128; ++i) {
+        TEST_ASSERT_EQUAL_HEX8(0, q[i]);
+    }
+    nvm_free(q);
+
+    TEST_ASSERT_NULL(nvm_calloc(0, 16));
+    TEST_ASSERT_NULL(nvm_calloc(SIZE_MAX / 2, 4));
+}
+
+/**
+ * @brief realloc：容量足够时原地返回，扩容时拷贝内容并释放原块。
+ */
+void test_realloc_grow_and_shrink(void) {
+    unsigned char* p = nvm_realloc(NULL, 40);
+    TEST_ASSERT_NOT_NULL(p);
+    for (int i = 0; i < 40; ++i) p[i] = (unsigned char)i;
+
+    // 40B 位于 64B 块中，扩到 64B 仍原地
+    TEST_ASSERT_EQUAL_PTR(p, nvm_realloc(p, 64));
+    TEST_ASSERT_EQUAL_PTR(p, nvm_realloc(p, 8));
+
+    unsigned char* q = nvm_realloc(p, 1000);
+    TEST_ASSERT_NOT_NULL(q);
+    TEST_ASSERT_TRUE(q != p);
+    for (int i = 0; i < 40; ++i) {
+        TEST_ASSERT_EQUAL_UINT8((unsigned char)i, q[i]);
+    }
+
+    // 原块已归还
+    uint64_t old_off = (uint64_t)((char*)p - (char*)mock_nvm_base);
+    NvmSlab* old_slab = slab_hashtable_lookup(global_nvm_allocator->central_heaps[0].slab_lookup_table,
+                                              NVM_ALIGN_DOWN(old_off, NVM_SLAB_SIZE));
+    TEST_ASSERT_NOT_NULL(old_slab);
+    TEST_ASSERT_TRUE(nvm_slab_is_empty(old_slab));
+
+    TEST_ASSERT_NULL(nvm_realloc(q, 0));
+}
+
+/**
+ * @brief 预清零池：后台线程清零的 Slab 被慢路径取用，calloc 无需内联清零。
+ */
+void test_zero_pool_supplies_prezeroed_slabs(void) {
+    memset(mock_nvm_base, 0xFF, TOTAL_NVM_SIZE);
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_set_zero_pool_depth(2));
+
+    NvmSlabPool* pool = global_nvm_allocator->central_heaps[0].zero_pool;
+    TEST_ASSERT_NOT_NULL(pool);
+    for (int i = 0; i < 500 && slab_pool_available(pool) < 2; ++i) {
+        usleep(10 * 1000);
+    }
+    TEST_ASSERT_EQUAL_UINT32(2, slab_pool_available(pool));
+
+    unsigned char* p = nvm_calloc(1, 256);
+    TEST_ASSERT_NOT_NULL(p);
+    uint64_t off = (uint64_t)((char*)p - (char*)mock_nvm_base);
+    NvmSlab* slab = slab_hashtable_lookup(global_nvm_allocator->central_heaps[0].slab_lookup_table,
+                                          NVM_ALIGN_DOWN(off, NVM_SLAB_SIZE));
+    TEST_ASSERT_NOT_NULL(slab);
+    TEST_ASSERT_TRUE(slab->flags & NVM_SLAB_FLAG_PREZEROED);
+    for (int i = 0; i < 256; ++i) {
+        TEST_ASSERT_EQUAL_HEX8(0, p[i]);
+    }
+
+    // 停止补充后，销毁时池中剩余 Slab 归还空间管理器
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_set_zero_pool_depth(0));
+    nvm_free(p);
+}
+
+/**
+ * @brief 预缺页：Slab 填充率越过阈值后后台准备下一个 Slab，慢路径直接取用。
+ */
+void test_prefault_next_slab_on_threshold(void) {
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_set_prefault(101));
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_set_prefault(50));
+
+    NvmSlabPool* pool = global_nvm_allocator->central_heaps[0].prefault_pool;
+    TEST_ASSERT_NOT_NULL(pool);
+
+    const int blocks_per_slab = NVM_SLAB_SIZE / MAX_BLOCK_SIZE;
+    void** ptrs = malloc(sizeof(void*) * (blocks_per_slab + 1));
+    TEST_ASSERT_NOT_NULL(ptrs);
+
+    // 阈值之前不请求
+    for (int i = 0; i < blocks_per_slab / 2 - 1; ++i) {
+        ptrs[i] = nvm_malloc(MAX_BLOCK_SIZE);
+        TEST_ASSERT_NOT_NULL(ptrs[i]);
+    }
+    usleep(20 * 1000);
+    TEST_ASSERT_EQUAL_UINT32(0, slab_pool_available(pool));
+
+    // 越过 50% 后后台准备一个 Slab
+    for (int i = blocks_per_slab / 2 - 1; i < blocks_per_slab; ++i) {
+        ptrs[i] = nvm_malloc(MAX_BLOCK_SIZE);
+        TEST_ASSERT_NOT_NULL(ptrs[i]);
+    }
+    for (int i = 0; i < 500 && slab_pool_available(pool) < 1; ++i) {
+        usleep(10 * 1000);
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, slab_pool_available(pool));
+
+    // 当前 Slab 写满，下一个 Slab 来自预缺页池
+    ptrs[blocks_per_slab] = nvm_malloc(MAX_BLOCK_SIZE);
+    TEST_ASSERT_NOT_NULL(ptrs[blocks_per_slab]);
+    TEST_ASSERT_EQUAL_UINT32(0, slab_pool_available(pool));
+    TEST_ASSERT_EQUAL_UINT32(2, global_nvm_allocator->central_heaps[0].slab_lookup_table->count);
+
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_set_prefault(0));
+    for (int i = 0; i <= blocks_per_slab; ++i) {
+        nvm_free(ptrs[i]);
+    }
+    free(ptrs);
+}
+
+/**
+ * @brief 基于文件映射的 NVM 池 (MAP_POPULATE)，分配器可直接在其上工作。
+ */
+void test_pool_map_file_backed(void) {
+    nvm_allocator_destroy();
+
+    char path[] = "/tmp/nvm_pool_test_XXXXXX";
+    int fd = mkstemp(path);
+    TEST_ASSERT_TRUE(fd >= 0);
+    close(fd);
+
+    const uint64_t size = 2 * NVM_SLAB_SIZE;
+    void* base = nvm_pool_map(path, size, NVM_MAP_POPULATE);
+    TEST_ASSERT_NOT_NULL(base);
+    TEST_ASSERT_NULL(nvm_pool_map(NULL, size, 0));
+
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create(base, size));
+    char* p = nvm_malloc(64);
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_TRUE(p >= (char*)base && p < (char*)base + size);
+    nvm_memcpy_persist(p, "persistent", 11);
+    TEST_ASSERT_EQUAL_STRING("persistent", p);
+    nvm_allocator_destroy();
+
+    nvm_pool_unmap(base, size);
+    unlink(path);
+
+    // 恢复 setUp 状态，交给 tearDown 销毁
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create(mock_nvm_base, TOTAL_NVM_SIZE));
+}
+
+/**
+ * @brief 在线扩容：不连续的新区域加入空间管理器，指针查找跨区域工作。
+ */
+void test_extend_adds_discontiguous_region(void) {
+    nvm_allocator_destroy();
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create(mock_nvm_base, NVM_SLAB_SIZE));
+
+    const int blocks_per_slab = NVM_SLAB_SIZE / MAX_BLOCK_SIZE;
+    for (int i = 0; i < blocks_per_slab; ++i) {
+        TEST_ASSERT_NOT_NULL(nvm_malloc(MAX_BLOCK_SIZE));
+    }
+    TEST_ASSERT_NULL(nvm_malloc(MAX_BLOCK_SIZE));
+
+    // 新区域来自独立的堆内存，与基址不连续且不保证 Slab 对齐
+    const uint64_t extra_size = 3 * NVM_SLAB_SIZE;
+    char* extra = malloc(extra_size);
+    TEST_ASSERT_NOT_NULL(extra);
+
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_extend(NULL, extra_size));
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_extend(extra, NVM_SLAB_SIZE / 2));
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_extend(extra, extra_size));
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_extend(extra, extra_size));
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_extend(mock_nvm_base, NVM_SLAB_SIZE));
+    TEST_ASSERT_EQUAL_UINT32(2, global_nvm_allocator->region_count);
+
+    // 新区域至少容纳 2 个对齐的 Slab
+    char* p = nvm_malloc(MAX_BLOCK_SIZE);
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_TRUE(p >= extra && p + MAX_BLOCK_SIZE <= extra + extra_size);
+    for (int i = 1; i < 2 * blocks_per_slab; ++i) {
+        char* q = nvm_malloc(MAX_BLOCK_SIZE);
+        TEST_ASSERT_NOT_NULL(q);
+        TEST_ASSERT_TRUE(q >= extra && q + MAX_BLOCK_SIZE <= extra + extra_size);
+    }
+
+    // 释放路径能定位到新区域中的 Slab
+    uint64_t offset;
+    NvmSlab* slab = lookup_slab(global_nvm_allocator, p, &offset);
+    TEST_ASSERT_NOT_NULL(slab);
+    TEST_ASSERT_EQUAL_UINT64(0, slab->nvm_base_offset % NVM_SLAB_SIZE);
+    uint32_t before = slab->allocated_block_count;
+    nvm_free(p);
+    TEST_ASSERT_EQUAL_UINT32(before - 1, slab->allocated_block_count);
+    TEST_ASSERT_EQUAL_PTR(p, nvm_malloc(MAX_BLOCK_SIZE));
+
+    nvm_allocator_destroy();
+    free(extra);
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create(mock_nvm_base, TOTAL_NVM_SIZE));
+}
+
+/**
+ * @brief 扩展池文件并映射新增部分，随后在线交给分配器。
+ */
+void test_pool_grow_and_extend(void) {
+    nvm_allocator_destroy();
+
+    char path[] = "/tmp/nvm_pool_test_XXXXXX";
+    int fd = mkstemp(path);
+    TEST_ASSERT_TRUE(fd >= 0);
+    close(fd);
+
+    const uint64_t old_size = NVM_SLAB_SIZE;
+    const uint64_t new_size = 4 * NVM_SLAB_SIZE;
+    void* base = nvm_pool_map(path, old_size, 0);
+    TEST_ASSERT_NOT_NULL(base);
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create(base, old_size));
+
+    const int blocks_per_slab = NVM_SLAB_SIZE / MAX_BLOCK_SIZE;
+    for (int i = 0; i < blocks_per_slab; ++i) {
+        TEST_ASSERT_NOT_NULL(nvm_malloc(MAX_BLOCK_SIZE));
+    }
+    TEST_ASSERT_NULL(nvm_malloc(MAX_BLOCK_SIZE));
+
+    TEST_ASSERT_NULL(nvm_pool_grow(path, base, old_size, old_size, 0));
+    char* seg = nvm_pool_grow(path, base, old_size, new_size, 0);
+    TEST_ASSERT_NOT_NULL(seg);
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_extend(seg, new_size - old_size));
+
+    // 新增部分映射到文件的 [old_size, new_size)
+    for (int i = 0; i < 2 * blocks_per_slab; ++i) {
+        char* p = nvm_malloc(MAX_BLOCK_SIZE);
+        TEST_ASSERT_NOT_NULL(p);
+        TEST_ASSERT_TRUE(p >= seg && p < seg + (new_size - old_size));
+    }
+    nvm_allocator_destroy();
+
+    struct stat st;
+    TEST_ASSERT_EQUAL_INT(0, stat(path, &st));
+    TEST_ASSERT_EQUAL_UINT64(new_size, (uint64_t)st.st_size);
+
+    nvm_pool_unmap(seg, new_size - old_size);
+    nvm_pool_unmap(base, old_size);
+    unlink(path);
+
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create(mock_nvm_base, TOTAL_NVM_SIZE));
+}
+
+/**
+ * @brief 跨 CPU 窃取：空闲 CPU 捐出的未满 Slab 在空间耗尽时被其他 CPU 复用。
+ */
+void test_depot_steal_avoids_false_oom(void) {
+    nvm_allocator_destroy();
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create(mock_nvm_base, 2 * NVM_SLAB_SIZE));
+
+    const int blocks_per_slab = NVM_SLAB_SIZE / MAX_BLOCK_SIZE;
+    void* ptrs[2 * (NVM_SLAB_SIZE / MAX_BLOCK_SIZE)];
+    for (int i = 0; i < 2 * blocks_per_slab; ++i) {
+        ptrs[i] = nvm_malloc(MAX_BLOCK_SIZE);
+        TEST_ASSERT_NOT_NULL(ptrs[i]);
+    }
+    TEST_ASSERT_NULL(nvm_malloc(MAX_BLOCK_SIZE));
+
+    // 模拟 Slab 属于另一个 CPU：把本地链表整体移交给 CPU 1
+    NvmCpuHeap* cpu0 = &global_nvm_allocator->cpu_heaps[0];
+    NvmCpuHeap* cpu1 = &global_nvm_allocator->cpu_heaps[1];
+    cpu1->slab_lists[SC_4K] = cpu0->slab_lists[SC_4K];
+    cpu0->slab_lists[SC_4K] = NULL;
+    for (NvmSlab* s = cpu1->slab_lists[SC_4K]; s; s = s->next_in_chain) s->owner_cpu = s->heap_cpu = 1;
+
+    // 两个 Slab 各释放一块；CPU 1 未捐出前，CPU 0 无法使用这些空闲块
+    nvm_free(ptrs[0]);
+    nvm_free(ptrs[blocks_per_slab]);
+    TEST_ASSERT_EQUAL_INT(2, nvm_free_remote_flush());
+    TEST_ASSERT_NULL(nvm_malloc(MAX_BLOCK_SIZE));
+
+    // CPU 1 空闲时捐出全部未满 Slab
+    donate_partial_slabs(global_nvm_allocator, cpu1, 0);
+    TEST_ASSERT_NULL(cpu1->slab_lists[SC_4K]);
+    TEST_ASSERT_EQUAL_UINT8(NVM_SLAB_NO_HEAP, global_nvm_allocator->depots[SC_4K].head->heap_cpu);
+    TEST_ASSERT_EQUAL_UINT32(2, global_nvm_allocator->depots[SC_4K].count);
+
+    // CPU 0 窃取而非报告内存不足，且不创建新 Slab、不改变日志归属
+    void* a = nvm_malloc(MAX_BLOCK_SIZE);
+    void* b = nvm_malloc(MAX_BLOCK_SIZE);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_TRUE((a == ptrs[0] && b == ptrs[blocks_per_slab]) ||
+                     (b == ptrs[0] && a == ptrs[blocks_per_slab]));
+    TEST_ASSERT_EQUAL_UINT32(0, global_nvm_allocator->depots[SC_4K].count);
+    TEST_ASSERT_EQUAL_UINT32(2, global_nvm_allocator->central_heaps[0].slab_lookup_table->count);
+    TEST_ASSERT_EQUAL_UINT8(1, cpu0->slab_lists[SC_4K]->owner_cpu);
+    TEST_ASSERT_EQUAL_UINT8(0, cpu0->slab_lists[SC_4K]->heap_cpu);
+    TEST_ASSERT_NULL(nvm_malloc(MAX_BLOCK_SIZE));
+
+    // 释放按当前挂载的堆路由：窃取后本 CPU 的释放走本地路径，不进远程暂存区
+    nvm_free(a);
+    TEST_ASSERT_EQUAL_INT(0, nvm_free_remote_flush());
+    TEST_ASSERT_EQUAL_UINT32(0, cpu0->slab_lists[SC_4K]->remote_count +
+                                cpu0->slab_lists[SC_4K]->next_in_chain->remote_count);
+
+    // 公共 API 捐出当前 CPU 的未满 Slab；全满的 Slab 留在本地
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_donate_partial());
+    TEST_ASSERT_EQUAL_UINT32(1, global_nvm_allocator->depots[SC_4K].count);
+    TEST_ASSERT_NOT_NULL(cpu0->slab_lists[SC_4K]);
+    TEST_ASSERT_TRUE(nvm_slab_is_full(cpu0->slab_lists[SC_4K]));
+
+    nvm_allocator_destroy();
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_donate_partial());
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create(mock_nvm_base, TOTAL_NVM_SIZE));
+}
+
+/**
+ * @brief 分配路径周期性地只保留 NVM_DEPOT_CPU_KEEP 个未满 Slab，其余捐给仓库。
+ */
+void test_depot_periodic_trim_keeps_local_slabs(void) {
+    const int blocks_per_slab = NVM_SLAB_SIZE / MAX_BLOCK_SIZE;
+    const int slabs = NVM_DEPOT_CPU_KEEP + 2;
+    void* ptrs[(NVM_DEPOT_CPU_KEEP + 2) * (NVM_SLAB_SIZE / MAX_BLOCK_SIZE)];
+    for (int i = 0; i < slabs * blocks_per_slab; ++i) {
+        ptrs[i] = nvm_malloc(MAX_BLOCK_SIZE);
+        TEST_ASSERT_NOT_NULL(ptrs[i]);
+    }
+    // 每个 Slab 释放一块，全部变为未满
+    for (int i = 0; i < slabs; ++i) nvm_free(ptrs[i * blocks_per_slab]);
+
+    // 其他类别的分配推动计数，触发一次修剪
+    NvmCpuHeap* cpu0 = &global_nvm_allocator->cpu_heaps[0];
+    cpu0->allocs_since_trim = NVM_DEPOT_TRIM_INTERVAL - 1;
+    TEST_ASSERT_NOT_NULL(nvm_malloc(8));
+    TEST_ASSERT_EQUAL_UINT32(0, cpu0->allocs_since_trim);
+    TEST_ASSERT_EQUAL_UINT32(slabs - NVM_DEPOT_CPU_KEEP, global_nvm_allocator->depots[SC_4K].count);
+
+    int local = 0;
+    for (NvmSlab* s = cpu0->slab_lists[SC_4K]; s; s = s->next_in_chain) local++;
+    TEST_ASSERT_EQUAL_INT(NVM_DEPOT_CPU_KEEP, local);
+}
+
+/**
+ * @brief 清空其他 CPU 的堆：空 Slab 归还空间，未满 Slab 进入仓库，全满 Slab 留待下次。
+ */
+void test_cpu_heap_drain_and_trim(void) {
+    const int blocks_per_slab = NVM_SLAB_SIZE / MAX_BLOCK_SIZE;
+    void* ptrs[3 * (NVM_SLAB_SIZE / MAX_BLOCK_SIZE)];
+    for (int i = 0; i < 3 * blocks_per_slab; ++i) {
+        ptrs[i] = nvm_malloc(MAX_BLOCK_SIZE);
+        TEST_ASSERT_NOT_NULL(ptrs[i]);
+    }
+
+    // 模拟这些 Slab 属于已下线的 CPU 3
+    NvmCpuHeap* cpu3 = &global_nvm_allocator->cpu_heaps[3];
+    cpu3->slab_lists[SC_4K] = global_nvm_allocator->cpu_heaps[0].slab_lists[SC_4K];
+    global_nvm_allocator->cpu_heaps[0].slab_lists[SC_4K] = NULL;
+
+    // 第 1 个 Slab 全部释放，第 2 个释放一块，第 3 个保持全满
+    for (int i = 0; i < blocks_per_slab; ++i) nvm_free(ptrs[i]);
+    nvm_free(ptrs[blocks_per_slab]);
+
+    TEST_ASSERT_EQUAL_INT(-1, nvm_cpu_heap_drain(MAX_CPUS));
+    TEST_ASSERT_EQUAL_INT(1, nvm_cpu_heap_drain(3));
+    TEST_ASSERT_EQUAL_UINT32(2, global_nvm_allocator->central_heaps[0].slab_lookup_table->count);
+    TEST_ASSERT_EQUAL_UINT32(1, global_nvm_allocator->depots[SC_4K].count);
+    TEST_ASSERT_NOT_NULL(cpu3->slab_lists[SC_4K]);
+    TEST_ASSERT_NULL(cpu3->slab_lists[SC_4K]->next_in_chain);
+    TEST_ASSERT_TRUE(nvm_slab_is_full(cpu3->slab_lists[SC_4K]));
+
+    // 全满 Slab 出现空闲块后，再次清空将其移入仓库
+    nvm_free(ptrs[2 * blocks_per_slab]);
+    TEST_ASSERT_EQUAL_INT(0, nvm_cpu_heap_drain(3));
+    TEST_ASSERT_NULL(cpu3->slab_lists[SC_4K]);
+    TEST_ASSERT_EQUAL_UINT32(2, global_nvm_allocator->depots[SC_4K].count);
+
+    // 仓库中的 Slab 变空后由 trim 归还，空间完全合并
+    for (int i = blocks_per_slab + 1; i < 3 * blocks_per_slab; ++i) {
+        if (i != 2 * blocks_per_slab) nvm_free(ptrs[i]);
+    }
+    TEST_ASSERT_EQUAL_INT(2, nvm_allocator_trim());
+    TEST_ASSERT_EQUAL_UINT32(0, global_nvm_allocator->depots[SC_4K].count);
+    TEST_ASSERT_EQUAL_UINT32(0, global_nvm_allocator->central_heaps[0].slab_lookup_table->count);
+    TEST_ASSERT_EQUAL_UINT64(TOTAL_NVM_SIZE, global_nvm_allocator->central_heaps[0].space_manager->shards[0].head->size);
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_trim());
+}
+
+/**
+ * @brief 亲和性变化钩子只清空不再允许运行的 CPU 堆。
+ */
+void test_affinity_change_drains_disallowed_cpus(void) {
+    uint8_t allowed[MAX_CPUS];
+    TEST_ASSERT_EQUAL_INT(0, nvm_get_allowed_cpus(allowed));
+    int current = NVM_GET_CURRENT_CPU_ID();
+    TEST_ASSERT_TRUE(allowed[current]);
+
+    int offline = -1;
+    for (int cpu = 0; cpu < MAX_CPUS && offline < 0; ++cpu) {
+        if (!allowed[cpu]) offline = cpu;
+    }
+    if (offline < 0) TEST_IGNORE_MESSAGE("All CPU ids are allowed");
+
+    void* kept = nvm_malloc(64);
+    void* moved = nvm_malloc(MAX_BLOCK_SIZE);
+    TEST_ASSERT_NOT_NULL(kept);
+    TEST_ASSERT_NOT_NULL(moved);
+
+    NvmCpuHeap* local = &global_nvm_allocator->cpu_heaps[current];
+    NvmCpuHeap* gone = &global_nvm_allocator->cpu_heaps[offline];
+    gone->slab_lists[SC_4K] = local->slab_lists[SC_4K];
+    local->slab_lists[SC_4K] = NULL;
+
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_on_affinity_change());
+    TEST_ASSERT_NULL(gone->slab_lists[SC_4K]);
+    TEST_ASSERT_EQUAL_UINT32(1, global_nvm_allocator->depots[SC_4K].count);
+    TEST_ASSERT_NOT_NULL(local->slab_lists[SC_64B]);
+
+    nvm_free(moved);
+    nvm_free(kept);
+    TEST_ASSERT_EQUAL_INT(2, nvm_allocator_on_affinity_change());
+}
+
+typedef struct TrimWorkerArg {
+    volatile int* stop;
+    int           failures;
+} TrimWorkerArg;
+
+static void* trim_alloc_worker(void* arg) {
+    TrimWorkerArg* w = (TrimWorkerArg*)arg;
+    void* batch[64];
+    while (!*w->stop) {
+        for (int i = 0; i < 64; ++i) {
+            // 只用 4 个类别：同一 CPU 上的两个线程可能各自新建 Slab，需给 10 个 Slab 的池留出余量
+            batch[i] = nvm_malloc((size_t)(8u << (i % 4)));
+            if (!batch[i]) w->failures++;
+            else memset(batch[i], 0xAB, 8);
+        }
+        for (int i = 0; i < 64; ++i) nvm_free(batch[i]);
+    }
+    return NULL;
+}
+
+/**
+ * @brief drain/trim 与其他线程的分配、释放并发执行。
+ */
+void test_trim_concurrent_with_allocation(void) {
+    volatile int stop = 0;
+    TrimWorkerArg args[2] = { { &stop, 0 }, { &stop, 0 } };
+    pthread_t threads[2];
+    for (int i = 0; i < 2; ++i) {
+        TEST_ASSERT_EQUAL_INT(0, pthread_create(&threads[i], NULL, trim_alloc_worker, &args[i]));
+    }
+
+    for (int round = 0; round < 200; ++round) {
+        for (int cpu = 0; cpu < MAX_CPUS; ++cpu) {
+            TEST_ASSERT_TRUE(nvm_cpu_heap_drain(cpu) >= 0);
+        }
+        TEST_ASSERT_TRUE(nvm_allocator_trim() >= 0);
+        sched_yield();
+    }
+
+    stop = 1;
+    for (int i = 0; i < 2; ++i) {
+        pthread_join(threads[i], NULL);
+        TEST_ASSERT_EQUAL_INT(0, args[i].failures);
+    }
+
+    // 全部释放后 trim 归还一切
+    nvm_allocator_trim();
+    for (int cpu = 0; cpu < MAX_CPUS; ++cpu) nvm_cpu_heap_drain(cpu);
+    nvm_allocator_trim();
+    TEST_ASSERT_EQUAL_UINT32(0, global_nvm_allocator->central_heaps[0].slab_lookup_table->count);
+    TEST_ASSERT_EQUAL_UINT64(TOTAL_NVM_SIZE, global_nvm_allocator->central_heaps[0].space_manager->shards[0].head->size);
+}
+
+/**
+ * @brief 延迟释放：入队不改变 Slab 状态，flush 与后台线程成批处理。
+ */
+void test_free_deferred_flush_and_reclaimer(void) {
+    enum { N = 200 };
+    void* ptrs[N];
+    for (int i = 0; i < N; ++i) {
+        ptrs[i] = nvm_malloc((i % 2) ? 64 : 256);
+        TEST_ASSERT_NOT_NULL(ptrs[i]);
+    }
+    NvmSlab* slab64  = global_nvm_allocator->cpu_heaps[0].slab_lists[map_size_to_sc_id(64)];
+    NvmSlab* slab256 = global_nvm_allocator->cpu_heaps[0].slab_lists[map_size_to_sc_id(256)];
+    TEST_ASSERT_EQUAL_UINT32(N / 2, slab64->allocated_block_count);
+
+    // 逆序入队，处理时按地址排序
+    for (int i = N - 1; i >= 0; --i) {
+        TEST_ASSERT_EQUAL_INT(0, nvm_free_deferred(ptrs[i]));
+    }
+    TEST_ASSERT_EQUAL_UINT32(N / 2, slab64->allocated_block_count);
+    TEST_ASSERT_EQUAL_INT(N, nvm_free_deferred_flush());
+    TEST_ASSERT_EQUAL_UINT32(0, slab64->allocated_block_count);
+    TEST_ASSERT_EQUAL_UINT32(0, slab256->allocated_block_count);
+    TEST_ASSERT_EQUAL_INT(0, nvm_free_deferred_flush());
+
+    // 后台线程按间隔处理
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_set_deferred_reclaim(5));
+    for (int i = 0; i < N; ++i) ptrs[i] = nvm_malloc(64);
+    for (int i = 0; i < N; ++i) TEST_ASSERT_EQUAL_INT(0, nvm_free_deferred(ptrs[i]));
+    for (int wait = 0; wait < 200 && __atomic_load_n(&slab64->allocated_block_count, __ATOMIC_RELAXED) > 0; ++wait) {
+        usleep(5000);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, slab64->allocated_block_count);
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_set_deferred_reclaim(0));
+    TEST_ASSERT_FALSE(global_nvm_allocator->deferred->running);
+}
+
+static void* deferred_exit_worker(void* arg) {
+    void** ptrs = (void**)arg;
+    for (int i = 0; i < 8; ++i) nvm_free_deferred(ptrs[i]);
+    return NULL;
+}
+
+/**
+ * @brief 队列满时的背压策略，以及已退出线程的队列被接管。
+ */
+void test_free_deferred_backpressure_and_ring_reuse(void) {
+    enum { N = NVM_DEFERRED_RING_SIZE + 1 };
+    void** ptrs = (void**)malloc(N * sizeof(void*));
+    for (int i = 0; i < N; ++i) {
+        ptrs[i] = nvm_malloc(32);
+        TEST_ASSERT_NOT_NULL(ptrs[i]);
+    }
+    NvmSlab* slab = global_nvm_allocator->cpu_heaps[0].slab_lists[map_size_to_sc_id(32)];
+
+    // REJECT：满时拒绝，指针仍归调用方
+    nvm_free_deferred_set_policy(NVM_DEFER_FULL_REJECT);
+    for (int i = 0; i < NVM_DEFERRED_RING_SIZE; ++i) {
+        TEST_ASSERT_EQUAL_INT(0, nvm_free_deferred(ptrs[i]));
+    }
+    TEST_ASSERT_EQUAL_INT(-1, nvm_free_deferred(ptrs[N - 1]));
+    TEST_ASSERT_EQUAL_UINT32(N, slab->allocated_block_count);
+
+    // FLUSH：满时同步处理整个队列后入队
+    nvm_free_deferred_set_policy(NVM_DEFER_FULL_FLUSH);
+    TEST_ASSERT_EQUAL_INT(0, nvm_free_deferred(ptrs[N - 1]));
+    TEST_ASSERT_EQUAL_UINT32(1, slab->allocated_block_count);
+
+    // WAIT：未启动后台线程时退化为 FLUSH
+    nvm_free_deferred_set_policy(NVM_DEFER_FULL_WAIT);
+    TEST_ASSERT_EQUAL_INT(1, nvm_free_deferred_flush());
+    TEST_ASSERT_EQUAL_UINT32(0, slab->allocated_block_count);
+    nvm_free_deferred_set_policy(NVM_DEFER_FULL_FLUSH);
+
+    // 线程退出后其积压保留，新线程接管同一环形队列
+    for (int i = 0; i < 8; ++i) ptrs[i] = nvm_malloc(32);
+    pthread_t t;
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&t, NULL, deferred_exit_worker, ptrs));
+    pthread_join(t, NULL);
+    TEST_ASSERT_EQUAL_UINT32(8, slab->allocated_block_count);
+
+    NvmDeferredFree* queue = global_nvm_allocator->deferred;
+    uint32_t ring_count = 0;
+    for (NvmDeferredRing* r = queue->rings; r; r = r->next) ring_count++;
+    TEST_ASSERT_EQUAL_UINT32(2, ring_count);
+
+    for (int i = 0; i < 8; ++i) ptrs[i] = nvm_malloc(32);
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&t, NULL, deferred_exit_worker, ptrs));
+    pthread_join(t, NULL);
+    ring_count = 0;
+    for (NvmDeferredRing* r = queue->rings; r; r = r->next) ring_count++;
+    TEST_ASSERT_EQUAL_UINT32(2, ring_count);
+
+    TEST_ASSERT_EQUAL_UINT32(16, deferred_free_flush_all(queue));
+    TEST_ASSERT_EQUAL_UINT32(0, slab->allocated_block_count);
+    free(ptrs);
+}
+
+static void* remote_exit_worker(void* arg) {
+    void** ptrs = (void**)arg;
+    for (int i = 0; i < 5; ++i) nvm_free(ptrs[i]);
+    return NULL;
+}
+
+/**
+ * @brief 远程释放批处理：组满整组写入暂存区，显式刷新、线程退出与 trim 交出剩余块；组大小为 0 时直接远程释放。
+ */
+void test_remote_free_batching(void) {
+    enum { N = 100 };
+    void* ptrs[N];
+    for (int i = 0; i < N; ++i) {
+        ptrs[i] = nvm_malloc(64);
+        TEST_ASSERT_NOT_NULL(ptrs[i]);
+    }
+    NvmSlab* slab = global_nvm_allocator->cpu_heaps[0].slab_lists[map_size_to_sc_id(64)];
+    NvmRemoteBatcher* batcher = global_nvm_allocator->remote;
+    TEST_ASSERT_EQUAL_UINT32(NVM_REMOTE_BATCH_DEFAULT, remote_batch_get_group_size(batcher));
+
+    // 模拟其他 CPU 释放：前 31 块只进线程缓存，第 32 块使整组一次写入暂存区
+    slab->heap_cpu = 1;
+    for (int i = 0; i < NVM_REMOTE_BATCH_DEFAULT - 1; ++i) nvm_free(ptrs[i]);
+    TEST_ASSERT_EQUAL_UINT32(0, slab->remote_count);
+    nvm_free(ptrs[NVM_REMOTE_BATCH_DEFAULT - 1]);
+    TEST_ASSERT_EQUAL_UINT32(NVM_REMOTE_BATCH_DEFAULT, slab->remote_count);
+    TEST_ASSERT_EQUAL_UINT32(N, slab->allocated_block_count);
+
+    // 暂存区已满时刷新：吸收暂存区后直接释放其余块
+    for (int i = NVM_REMOTE_BATCH_DEFAULT; i < 40; ++i) nvm_free(ptrs[i]);
+    TEST_ASSERT_EQUAL_INT(40 - NVM_REMOTE_BATCH_DEFAULT, nvm_free_remote_flush());
+    TEST_ASSERT_EQUAL_INT(0, nvm_free_remote_flush());
+    TEST_ASSERT_EQUAL_UINT32(0, slab->remote_count);
+    TEST_ASSERT_EQUAL_UINT32(N - 40, slab->allocated_block_count);
+
+    uint64_t frees = 0, flushes = 0;
+    size_t len = sizeof(uint64_t);
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("stats.remote_batch.frees", &frees, &len, NULL, 0));
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("stats.remote_batch.flushes", &flushes, &len, NULL, 0));
+    TEST_ASSERT_EQUAL_UINT64(40, frees);
+    TEST_ASSERT_EQUAL_UINT64(2, flushes);
+
+    // 线程退出时刷新自己的缓存；新线程接管已退出线程的缓存
+    pthread_t t;
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&t, NULL, remote_exit_worker, &ptrs[40]));
+    pthread_join(t, NULL);
+    TEST_ASSERT_EQUAL_UINT32(5, slab->remote_count);
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&t, NULL, remote_exit_worker, &ptrs[45]));
+    pthread_join(t, NULL);
+    TEST_ASSERT_EQUAL_UINT32(10, slab->remote_count);
+    uint32_t cache_count = 0;
+    for (NvmRemoteCache* c = batcher->caches; c; c = c->next) cache_count++;
+    TEST_ASSERT_EQUAL_UINT32(2, cache_count);
+
+    // 组大小为 0：不经缓存，直接写入暂存区
+    uint32_t zero = 0;
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("opt.remote_batch", NULL, NULL, &zero, sizeof(zero)));
+    nvm_free(ptrs[50]);
+    TEST_ASSERT_EQUAL_UINT32(11, slab->remote_count);
+    uint32_t size = NVM_REMOTE_BATCH_MAX + 1;
+    TEST_ASSERT_EQUAL_INT(-1, nvm_ctl("opt.remote_batch", NULL, NULL, &size, sizeof(size)));
+    size = 8;
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("opt.remote_batch", NULL, NULL, &size, sizeof(size)));
+
+    // trim 先刷新所有线程缓存，否则暂存的块会让 Slab 看似未空
+    for (int i = 51; i < N; ++i) nvm_free(ptrs[i]);
+    TEST_ASSERT_TRUE(t_remote.cache->pending > 0);
+    TEST_ASSERT_EQUAL_INT(1, nvm_allocator_trim());
+    TEST_ASSERT_EQUAL_UINT32(0, t_remote.cache->pending);
+    TEST_ASSERT_EQUAL_UINT32(0, global_nvm_allocator->central_heaps[0].slab_lookup_table->count);
+}
+
+typedef struct ReplenishLog {
+    int    calls;
+    int    cpu;
+    size_t size;
+} ReplenishLog;
+
+static void record_replenish(int cpu, size_t size, void* arg) {
+    ReplenishLog* log = (ReplenishLog*)arg;
+    log->calls++;
+    log->cpu = cpu;
+    log->size = size;
+}
+
+/**
+ * @brief nvm_try_malloc 只使用本地已有 Slab，其余情况返回原因且不进入慢路径。
+ */
+void test_try_malloc_bounded_fast_path(void) {
+    NvmTryStatus status;
+    ReplenishLog log = { 0, -1, 0 };
+    nvm_try_malloc_set_replenish(record_replenish, &log);
+
+    TEST_ASSERT_NULL(nvm_try_malloc(0, &status));
+    TEST_ASSERT_EQUAL_INT(NVM_TRY_BAD_SIZE, status);
+    TEST_ASSERT_NULL(nvm_try_malloc(MAX_BLOCK_SIZE + 1, &status));
+    TEST_ASSERT_EQUAL_INT(NVM_TRY_BAD_SIZE, status);
+
+    // 本地无 Slab：不申请空间、不写哈希表，只请求补充
+    TEST_ASSERT_NULL(nvm_try_malloc(64, &status));
+    TEST_ASSERT_EQUAL_INT(NVM_TRY_NO_LOCAL_SLAB, status);
+    TEST_ASSERT_EQUAL_INT(1, log.calls);
+    TEST_ASSERT_EQUAL_INT(0, log.cpu);
+    TEST_ASSERT_EQUAL_size_t(64, log.size);
+    TEST_ASSERT_EQUAL_UINT32(0, global_nvm_allocator->central_heaps[0].slab_lookup_table->count);
+    TEST_ASSERT_EQUAL_UINT64(TOTAL_NVM_SIZE, space_manager_free_bytes(global_nvm_allocator->central_heaps[0].space_manager));
+
+    // 补充后从本地 Slab 分配，直到 Slab 用尽
+    TEST_ASSERT_EQUAL_INT(0, nvm_cpu_heap_replenish(0, 64));
+    TEST_ASSERT_EQUAL_INT(0, nvm_cpu_heap_replenish(0, 64));   // 已有未满 Slab，不再申请
+    TEST_ASSERT_EQUAL_UINT32(1, global_nvm_allocator->central_heaps[0].slab_lookup_table->count);
+
+    NvmSlab* slab = global_nvm_allocator->cpu_heaps[0].slab_lists[SC_64B];
+    uint32_t served = 0;
+    void* first = NULL;
+    void* p;
+    while ((p = nvm_try_malloc(64, &status)) != NULL) {
+        TEST_ASSERT_EQUAL_INT(NVM_TRY_OK, status);
+        if (!first) first = p;
+        served++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(slab->total_block_count, served);
+    TEST_ASSERT_EQUAL_INT(NVM_TRY_NO_LOCAL_SLAB, status);
+    TEST_ASSERT_EQUAL_INT(2, log.calls);
+
+    // CPU 堆锁或 Slab 锁被占用时立即返回，不请求补充
+    nvm_free(first);
+    NVM_SPINLOCK_ACQUIRE(&global_nvm_allocator->cpu_heaps[0].lock);
+    TEST_ASSERT_NULL(nvm_try_malloc(64, &status));
+    TEST_ASSERT_EQUAL_INT(NVM_TRY_CONTENDED, status);
+    NVM_SPINLOCK_RELEASE(&global_nvm_allocator->cpu_heaps[0].lock);
+
+    NVM_SPINLOCK_ACQUIRE(&slab->lock);
+    TEST_ASSERT_NULL(nvm_try_malloc(64, &status));
+    TEST_ASSERT_EQUAL_INT(NVM_TRY_CONTENDED, status);
+    NVM_SPINLOCK_RELEASE(&slab->lock);
+    TEST_ASSERT_EQUAL_INT(2, log.calls);
+
+    TEST_ASSERT_EQUAL_PTR(first, nvm_try_malloc(64, NULL));
+    nvm_try_malloc_set_replenish(NULL, NULL);
+}
+
+/**
+ * @brief 运行时配置：解析、后缀与错误整串拒绝；编译期固定的 Slab 大小与锁后端只能核对。
+ */
+void test_runtime_config_parse_and_validate(void) {
+    NvmAllocatorConfig cfg;
+    nvm_allocator_config_default(&cfg);
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_config_validate(&cfg));
+
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_config_parse("cache_depth:16,cache_batch:4,,depot_trim_interval:2k", &cfg));
+    TEST_ASSERT_EQUAL_UINT32(16, cfg.cache_depth);
+    TEST_ASSERT_EQUAL_UINT32(4, cfg.cache_batch);
+    TEST_ASSERT_EQUAL_UINT32(2048, cfg.depot_trim_interval);
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_config_parse("slab_size:2m", &cfg));
+    TEST_ASSERT_EQUAL_UINT64(NVM_SLAB_SIZE, cfg.slab_size);
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_config_validate(&cfg));
+
+    // 任一项非法时整串不生效
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_config_parse("heap_count:4,bogus:1", &cfg));
+    TEST_ASSERT_EQUAL_UINT32(MAX_CPUS, cfg.heap_count);
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_config_parse("heap_count", &cfg));
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_config_parse("heap_count:4x", &cfg));
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_config_parse("depot_keep:8g", &cfg));
+
+    NvmAllocatorConfig bad = cfg;
+    bad.cache_batch = bad.cache_depth;
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_config_validate(&bad));
+    bad = cfg;
+    bad.heap_count = MAX_CPUS + 1;
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_config_validate(&bad));
+    bad = cfg;
+    bad.slab_size = 4 * 1024 * 1024;
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_config_validate(&bad));
+    bad = cfg;
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_config_parse("spinlock:" NVM_SPINLOCK_BACKEND_NAME, &bad));
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_config_validate(&bad));
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_config_parse("rwlock:nonexistent", &bad));
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_config_validate(&bad));
+
+    // 无效配置创建失败，不留下半初始化的分配器
+    nvm_allocator_destroy();
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_create_config(mock_nvm_base, TOTAL_NVM_SIZE, 0, &bad));
+    TEST_ASSERT_NULL(global_nvm_allocator);
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create(mock_nvm_base, TOTAL_NVM_SIZE));
+}
+
+/**
+ * @brief 环境变量覆盖调用方配置；缓存参数进入新建 Slab，CPU 编号按堆数取模。
+ */
+void test_runtime_config_env_and_heap_folding(void) {
+    nvm_allocator_destroy();
+
+    NvmAllocatorConfig cfg;
+    nvm_allocator_config_default(&cfg);
+    cfg.heap_count = 8;
+    cfg.depot_keep = 5;
+    TEST_ASSERT_EQUAL_INT(0, setenv(NVM_MALLOC_CONF_ENV, "heap_count:4,cache_depth:16,cache_batch:4", 1));
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create_config(mock_nvm_base, TOTAL_NVM_SIZE, 0, &cfg));
+    TEST_ASSERT_EQUAL_UINT32(4, global_nvm_allocator->heap_count);
+    TEST_ASSERT_EQUAL_UINT32(5, global_nvm_allocator->depot_keep);
+
+    void* p = nvm_malloc(64);
+    TEST_ASSERT_NOT_NULL(p);
+    NvmSlab* slab = global_nvm_allocator->cpu_heaps[0].slab_lists[SC_64B];
+    TEST_ASSERT_EQUAL_UINT16(16, slab->cache_depth);
+    TEST_ASSERT_EQUAL_UINT16(4, slab->cache_batch);
+    TEST_ASSERT_TRUE(slab->cache_count < 4);
+
+    // CPU 5 与 CPU 1 共用堆 1
+    TEST_ASSERT_EQUAL_INT(1, heap_index_of_cpu(global_nvm_allocator, 5));
+    TEST_ASSERT_EQUAL_INT(0, nvm_cpu_heap_replenish(5, MAX_BLOCK_SIZE));
+    NvmSlab* folded = global_nvm_allocator->cpu_heaps[1].slab_lists[SC_4K];
+    TEST_ASSERT_NOT_NULL(folded);
+    TEST_ASSERT_NULL(global_nvm_allocator->cpu_heaps[5].slab_lists[SC_4K]);
+    TEST_ASSERT_EQUAL_INT(1, nvm_cpu_heap_drain(9));
+    TEST_ASSERT_NULL(global_nvm_allocator->cpu_heaps[1].slab_lists[SC_4K]);
+    nvm_free(p);
+
+    // 环境变量非法时创建失败
+    nvm_allocator_destroy();
+    TEST_ASSERT_EQUAL_INT(0, setenv(NVM_MALLOC_CONF_ENV, "cache_depth:8k", 1));
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_create(mock_nvm_base, TOTAL_NVM_SIZE));
+    TEST_ASSERT_EQUAL_INT(0, unsetenv(NVM_MALLOC_CONF_ENV));
+
+    // 恢复默认：后续 Slab 使用完整深度
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create(mock_nvm_base, TOTAL_NVM_SIZE));
+    TEST_ASSERT_EQUAL_UINT32(MAX_CPUS, global_nvm_allocator->heap_count);
+    TEST_ASSERT_NOT_NULL(nvm_malloc(64));
+    TEST_ASSERT_EQUAL_UINT16(SLAB_CACHE_SIZE, global_nvm_allocator->cpu_heaps[0].slab_lists[SC_64B]->cache_depth);
+}
+
+/**
+ * @brief nvm_ctl：读取统计、读写可调参数、触发动作；名称、下标、长度与只读检查。
+ */
+void test_ctl_namespace(void) {
+    uint64_t u64;
+    uint32_t u32;
+    size_t len64 = sizeof(u64), len32 = sizeof(u32);
+
+    void* p[3];
+    for (int i = 0; i < 3; ++i) TEST_ASSERT_NOT_NULL(p[i] = nvm_malloc(64));
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("stats.class.3.active", &u64, &len64, NULL, 0));
+    TEST_ASSERT_EQUAL_UINT64(3, u64);
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("stats.class.3.capacity", &u64, &len64, NULL, 0));
+    TEST_ASSERT_EQUAL_UINT64(NVM_SLAB_SIZE / 64, u64);
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("stats.class.3.allocs", &u64, &len64, NULL, 0));
+    TEST_ASSERT_EQUAL_UINT64(3, u64);
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("stats.slabs", &u64, &len64, NULL, 0));
+    TEST_ASSERT_EQUAL_UINT64(1, u64);
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("stats.heap.0.free_bytes", &u64, &len64, NULL, 0));
+    TEST_ASSERT_EQUAL_UINT64(TOTAL_NVM_SIZE - NVM_SLAB_SIZE, u64);
+
+    // 只查询大小
+    size_t probe = 0;
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("opt.spinlock", NULL, &probe, NULL, 0));
+    TEST_ASSERT_EQUAL_size_t(sizeof(const char*), probe);
+    const char* name = NULL;
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("opt.spinlock", &name, &probe, NULL, 0));
+    TEST_ASSERT_EQUAL_STRING(NVM_SPINLOCK_BACKEND_NAME, name);
+
+    // 读旧值并写入新值
+    uint32_t keep = 7;
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("opt.depot_keep", &u32, &len32, &keep, sizeof(keep)));
+    TEST_ASSERT_EQUAL_UINT32(NVM_DEPOT_CPU_KEEP, u32);
+    TEST_ASSERT_EQUAL_UINT32(7, global_nvm_allocator->depot_keep);
+    uint32_t depth = 8;
+    TEST_ASSERT_EQUAL_INT(-1, nvm_ctl("opt.cache_depth", NULL, NULL, &depth, sizeof(depth)));   // 不大于 batch
+    uint32_t batch = 4;
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("opt.cache_batch", NULL, NULL, &batch, sizeof(batch)));
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("opt.cache_depth", NULL, NULL, &depth, sizeof(depth)));
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("opt.cache_depth", &u32, &len32, NULL, 0));
+    TEST_ASSERT_EQUAL_UINT32(8, u32);
+    uint32_t interval = 25;
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("opt.provision.interval_ms", NULL, NULL, &interval, sizeof(interval)));
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("opt.provision.interval_ms", &u32, &len32, NULL, 0));
+    TEST_ASSERT_EQUAL_UINT32(25, u32);
+
+    // 动作：CPU 堆只归还空 Slab
+    for (int i = 0; i < 3; ++i) nvm_free(p[i]);
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("heap.cpu.0.slabs", &u64, &len64, NULL, 0));
+    TEST_ASSERT_EQUAL_UINT64(1, u64);
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("heap.cpu.0.trim", &u64, &len64, NULL, 0));
+    TEST_ASSERT_EQUAL_UINT64(1, u64);
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("stats.class.3.slabs", &u64, &len64, NULL, 0));
+    TEST_ASSERT_EQUAL_UINT64(0, u64);
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("heap.trim", NULL, NULL, NULL, 0));
+    TEST_ASSERT_EQUAL_INT(-1, nvm_ctl("heap.checkpoint", NULL, NULL, NULL, 0));   // 未启用日志
+
+    // 错误：未知名称、下标越界、长度不符、只读
+    TEST_ASSERT_EQUAL_INT(-1, nvm_ctl("stats.class", &u64, &len64, NULL, 0));
+    TEST_ASSERT_EQUAL_INT(-1, nvm_ctl("stats.class.x.active", &u64, &len64, NULL, 0));
+    TEST_ASSERT_EQUAL_INT(-1, nvm_ctl("stats.class.10.active", &u64, &len64, NULL, 0));
+    TEST_ASSERT_EQUAL_INT(-1, nvm_ctl("heap.cpu.64.drain", NULL, NULL, NULL, 0));
+    TEST_ASSERT_EQUAL_INT(-1, nvm_ctl("opt.depot_keep", &u64, &len64, NULL, 0));
+    TEST_ASSERT_EQUAL_INT(-1, nvm_ctl("opt.heap_count", NULL, NULL, &keep, sizeof(keep)));
+    TEST_ASSERT_EQUAL_INT(-1, nvm_ctl("stats.slabs", NULL, NULL, &u64, sizeof(u64)));
+
+    nvm_slab_set_cache_params(SLAB_CACHE_SIZE, SLAB_CACHE_BATCH_SIZE);
+}
+
+/**
+ * @brief 易失模式：块内嵌空闲链表，跨 CPU 释放与 trim 正常工作，不支持恢复与日志。
+ */
+void test_volatile_mode_intrusive_heap(void) {
+    nvm_allocator_destroy();
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_create_ex(mock_nvm_base, TOTAL_NVM_SIZE,
+                                                      NVM_CREATE_VOLATILE | NVM_CREATE_LOG));
+    TEST_ASSERT_NULL(global_nvm_allocator);
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create_ex(mock_nvm_base, TOTAL_NVM_SIZE, NVM_CREATE_VOLATILE));
+    TEST_ASSERT_TRUE(global_nvm_allocator->volatile_mode);
+
+    unsigned char* p = nvm_malloc(64);
+    unsigned char* q = nvm_malloc(64);
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_EQUAL_PTR(p + 64, q);
+    NvmSlab* slab = global_nvm_allocator->cpu_heaps[0].slab_lists[SC_64B];
+    TEST_ASSERT_TRUE(slab->flags & NVM_SLAB_FLAG_VOLATILE);
+    TEST_ASSERT_EQUAL_PTR((char*)mock_nvm_base + slab->nvm_base_offset, slab->block_base);
+
+    // 释放后块首存放链表指针；calloc 复用该块时必须清零
+    memset(p, 0xFF, 64);
+    nvm_free(q);
+    nvm_free(p);
+    TEST_ASSERT_EQUAL_PTR(q, *(void**)p);
+    unsigned char* z = nvm_calloc(1, 64);
+    TEST_ASSERT_EQUAL_PTR(p, z);
+    for (int i = 0; i < 64; ++i) {
+        TEST_ASSERT_EQUAL_HEX8(0, z[i]);
+    }
+
+    // realloc 普通拷贝
+    for (int i = 0; i < 64; ++i) z[i] = (unsigned char)i;
+    unsigned char* r = nvm_realloc(z, 200);
+    TEST_ASSERT_NOT_NULL(r);
+    for (int i = 0; i < 64; ++i) {
+        TEST_ASSERT_EQUAL_UINT8((unsigned char)i, r[i]);
+    }
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_restore_allocation(r, 200));
+
+    // 其他 CPU 的释放走远程链表
+    slab->heap_cpu = 1;
+    void* s1 = nvm_malloc(64);
+    nvm_free(s1);
+    TEST_ASSERT_EQUAL_INT(1, nvm_free_remote_flush());
+    TEST_ASSERT_EQUAL_UINT32(1, slab->remote_count);
+    TEST_ASSERT_EQUAL_PTR(s1, slab->remote_head);
+    TEST_ASSERT_TRUE(nvm_slab_is_empty(slab));
+    slab->heap_cpu = 0;
+
+    // 全部归还后 trim 把空 Slab 交还空间管理器
+    nvm_free(r);
+    TEST_ASSERT_EQUAL_INT(2, nvm_allocator_trim());
+    TEST_ASSERT_EQUAL_UINT32(0, global_nvm_allocator->central_heaps[0].slab_lookup_table->count);
+}
+
+/**
+ * @brief 原子位图引擎：按池选择，远程释放直接清位而不经线程缓存，trim 与恢复正常工作，不可与易失模式组合。
+ */
+void test_atomic_slab_engine_pool(void) {
+    nvm_allocator_destroy();
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_create_ex(mock_nvm_base, TOTAL_NVM_SIZE,
+                                                      NVM_CREATE_ATOMIC | NVM_CREATE_VOLATILE));
+    TEST_ASSERT_NULL(global_nvm_allocator);
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create_ex(mock_nvm_base, TOTAL_NVM_SIZE, NVM_CREATE_ATOMIC));
+    TEST_ASSERT_TRUE(global_nvm_allocator->atomic_mode);
+
+    const char* engine = NULL;
+    size_t len = sizeof(engine);
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("opt.slab_engine", &engine, &len, NULL, 0));
+    TEST_ASSERT_EQUAL_STRING("atomic", engine);
+
+    char* p = nvm_malloc(64);
+    char* q = nvm_malloc(64);
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_EQUAL_PTR(p + 64, q);
+    NvmSlab* slab = global_nvm_allocator->cpu_heaps[0].slab_lists[SC_64B];
+    TEST_ASSERT_TRUE(slab->flags & NVM_SLAB_FLAG_ATOMIC);
+    TEST_ASSERT_EQUAL_UINT32(2, nvm_slab_used_blocks(slab));
+
+    // 其他 CPU 的释放不进线程缓存与暂存区，立即生效
+    slab->heap_cpu = 1;
+    nvm_free(q);
+    TEST_ASSERT_EQUAL_UINT32(0, slab->remote_count);
+    TEST_ASSERT_EQUAL_UINT32(1, nvm_slab_used_blocks(slab));
+    TEST_ASSERT_EQUAL_INT(0, nvm_free_remote_flush());
+    slab->heap_cpu = 0;
+
+    // 恢复路径同样创建原子引擎的 Slab
+    void* restored = (char*)mock_nvm_base + 8 * NVM_SLAB_SIZE + 128;
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_restore_allocation(restored, 128));
+    NvmSlab* restored_slab = NULL;
+    for (NvmSlab* s = global_nvm_allocator->cpu_heaps[0].slab_lists[SC_128B]; s; s = s->next_in_chain) {
+        if (s->nvm_base_offset == 8 * NVM_SLAB_SIZE) restored_slab = s;
+    }
+    TEST_ASSERT_NOT_NULL(restored_slab);
+    TEST_ASSERT_TRUE(restored_slab->flags & NVM_SLAB_FLAG_ATOMIC);
+    TEST_ASSERT_EQUAL_UINT32(1, nvm_slab_used_blocks(restored_slab));
+
+    // 全部归还后 trim 把空 Slab 交还空间管理器
+    nvm_free(p);
+    nvm_free(restored);
+    TEST_ASSERT_EQUAL_INT(2, nvm_allocator_trim());
+    TEST_ASSERT_EQUAL_UINT32(0, global_nvm_allocator->central_heaps[0].slab_lookup_table->count);
+}
+
+/**
+ * @brief 预备线程按消耗速率提前挂入 Slab，稳定负载下分配路径不再同步创建 Slab。
+ */
+void test_provisioning_keeps_slabs_ahead(void) {
+    static void* ptrs[1 + PROV_BATCHES * PROV_BATCH_SIZE];
+    int n = 0;
+
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_set_provisioning(NVM_PROVISION_MAX_AHEAD + 1, 1));
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_set_provisioning(1, 1));
+    TEST_ASSERT_TRUE(global_nvm_allocator->provisioner.running);
+
+    // 预热：第一次分配尚无速率，只能走慢路径；之后预备线程补足一个 Slab 的余量
+    ptrs[n++] = nvm_malloc(MAX_BLOCK_SIZE);
+    TEST_ASSERT_NOT_NULL(ptrs[0]);
+    TEST_ASSERT_EQUAL_UINT64(1, global_nvm_allocator->slow_path_hits);
+    for (int i = 0; i < 200 && __atomic_load_n(&global_nvm_allocator->provisioner.provisioned, __ATOMIC_RELAXED) == 0; ++i) {
+        usleep(1000);
+    }
+    TEST_ASSERT_TRUE(global_nvm_allocator->provisioner.provisioned > 0);
+
+    // 稳定负载：消耗约三个 Slab，全部由预备的 Slab 满足
+    for (int b = 0; b < PROV_BATCHES; ++b) {
+        for (int i = 0; i < PROV_BATCH_SIZE; ++i) {
+            ptrs[n] = nvm_malloc(MAX_BLOCK_SIZE);
+            TEST_ASSERT_NOT_NULL(ptrs[n]);
+            n++;
+        }
+        usleep(5000);
+    }
+    TEST_ASSERT_EQUAL_UINT64(1, global_nvm_allocator->slow_path_hits);
+    TEST_ASSERT_TRUE(global_nvm_allocator->provisioner.provisioned >= 3);
+
+    // 超出首个 Slab 的块都来自预备的 Slab，且这些 Slab 挂在本 CPU 的堆上
+    int heap = heap_index_of_cpu(global_nvm_allocator, NVM_GET_CURRENT_CPU_ID());
+    uint64_t offset;
+    NvmSlab* first = lookup_slab(global_nvm_allocator, ptrs[0], &offset);
+    int from_provisioned = 0;
+    for (int i = 1; i < n; ++i) {
+        NvmSlab* slab = lookup_slab(global_nvm_allocator, ptrs[i], &offset);
+        TEST_ASSERT_EQUAL_UINT8(heap, slab->heap_cpu);
+        from_provisioned += slab != first;
+    }
+    TEST_ASSERT_TRUE(from_provisioned >= n - 1 - (int)first->total_block_count);
+
+    // 停止后不再预备
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_set_provisioning(0, 0));
+    TEST_ASSERT_FALSE(global_nvm_allocator->provisioner.running);
+    TEST_ASSERT_EQUAL_UINT32(0, global_nvm_allocator->provisioner.slabs_ahead);
+
+    // 本 CPU 释放预备的 Slab 中的块走本地路径，不经远程批处理
+    for (int i = 0; i < n; ++i) nvm_free(ptrs[i]);
+    uint64_t remote_frees = 0;
+    size_t len = sizeof(remote_frees);
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("stats.remote_batch.frees", &remote_frees, &len, NULL, 0));
+    TEST_ASSERT_EQUAL_UINT64(0, remote_frees);
+    TEST_ASSERT_EQUAL_INT(0, nvm_free_remote_flush());
+}
+
+/**
+ * @brief 预备的 Slab 挂入时记录挂载堆：同一 CPU 上的分配与释放走本地路径，远程计数保持为零。
+ */
+void test_provisioned_slabs_free_locally(void) {
+    static void* ptrs[NVM_SLAB_SIZE / MAX_BLOCK_SIZE + 8];
+    int heap = heap_index_of_cpu(global_nvm_allocator, NVM_GET_CURRENT_CPU_ID());
+    NvmCpuHeap* cpu_heap = &global_nvm_allocator->cpu_heaps[heap];
+    int n = 0;
+
+    // 产生消耗速率后直接跑一个采样周期 (不启动后台线程)，预备的 Slab 挂到链表尾部
+    ptrs[n++] = nvm_malloc(MAX_BLOCK_SIZE);
+    TEST_ASSERT_NOT_NULL(ptrs[0]);
+    provision_tick(global_nvm_allocator, 1);
+    TEST_ASSERT_TRUE(global_nvm_allocator->provisioner.provisioned > 0);
+    NvmSlab* provisioned = cpu_heap->slab_lists[SC_4K]->next_in_chain;
+    TEST_ASSERT_NOT_NULL(provisioned);
+    for (NvmSlab* s = cpu_heap->slab_lists[SC_4K]; s; s = s->next_in_chain) {
+        TEST_ASSERT_EQUAL_UINT8(heap, s->heap_cpu);
+    }
+
+    // 用满首个 Slab 后分配落在预备的 Slab 上
+    while (n < (int)(sizeof(ptrs) / sizeof(ptrs[0]))) {
+        ptrs[n] = nvm_malloc(MAX_BLOCK_SIZE);
+        TEST_ASSERT_NOT_NULL(ptrs[n]);
+        n++;
+    }
+    uint64_t offset;
+    TEST_ASSERT_EQUAL_PTR(provisioned, lookup_slab(global_nvm_allocator, ptrs[n - 1], &offset));
+
+    // 全部释放：不进线程缓存与暂存区
+    for (int i = 0; i < n; ++i) nvm_free(ptrs[i]);
+    uint64_t frees = 0;
+    size_t len = sizeof(frees);
+    TEST_ASSERT_EQUAL_INT(0, nvm_ctl("stats.remote_batch.frees", &frees, &len, NULL, 0));
+    TEST_ASSERT_EQUAL_UINT64(0, frees);
+    TEST_ASSERT_EQUAL_INT(0, nvm_free_remote_flush());
+    for (NvmSlab* s = cpu_heap->slab_lists[SC_4K]; s; s = s->next_in_chain) {
+        TEST_ASSERT_EQUAL_UINT32(0, s->remote_count);
+        TEST_ASSERT_TRUE(nvm_slab_is_empty(s));
+    }
+}
+
 void test_debug_print_api(void) {
     // Case 1: 正常初始化状态下的打印
     printf("\n>>> [TEST START] Visual Check for nvm_allocator_debug_print <<<\n");
@@ -359,6 +1445,29 @@ int main(void) {
     RUN_TEST(test_parameter_and_error_handling);
     RUN_TEST(test_nvm_space_exhaustion);
     RUN_TEST(test_mixed_load_and_fragmentation);
+    RUN_TEST(test_calloc_zeroes_reused_blocks);
+    RUN_TEST(test_realloc_grow_and_shrink);
+    RUN_TEST(test_zero_pool_supplies_prezeroed_slabs);
+    RUN_TEST(test_prefault_next_slab_on_threshold);
+    RUN_TEST(test_pool_map_file_backed);
+    RUN_TEST(test_extend_adds_discontiguous_region);
+    RUN_TEST(test_pool_grow_and_extend);
+    RUN_TEST(test_depot_steal_avoids_false_oom);
+    RUN_TEST(test_depot_periodic_trim_keeps_local_slabs);
+    RUN_TEST(test_cpu_heap_drain_and_trim);
+    RUN_TEST(test_affinity_change_drains_disallowed_cpus);
+    RUN_TEST(test_trim_concurrent_with_allocation);
+    RUN_TEST(test_free_deferred_flush_and_reclaimer);
+    RUN_TEST(test_free_deferred_backpressure_and_ring_reuse);
+    RUN_TEST(test_remote_free_batching);
+    RUN_TEST(test_try_malloc_bounded_fast_path);
+    RUN_TEST(test_provisioning_keeps_slabs_ahead);
+    RUN_TEST(test_provisioned_slabs_free_locally);
+    RUN_TEST(test_volatile_mode_intrusive_heap);
+    RUN_TEST(test_atomic_slab_engine_pool);
+    RUN_TEST(test_runtime_config_parse_and_validate);
+    RUN_TEST(test_runtime_config_env_and_heap_folding);
+    RUN_TEST(test_ctl_namespace);
 
     RUN_TEST(test_debug_print_api);
 
@@ -86,9 +86,9 @@ void reinit_allocator_with_size(size_t new_size) {
 
 void test_allocator_lifecycle(void) {
     TEST_ASSERT_NOT_NULL(global_nvm_allocator);
-    TEST_ASSERT_EQUAL_PTR(mock_nvm_base, global_nvm_allocator->central_heap.nvm_base_addr);
-    TEST_ASSERT_NOT_NULL(global_nvm_allocator->central_heap.space_manager);
-    TEST_ASSERT_NOT_NULL(global_nvm_allocator->central_heap.slab_lookup_table);
+    TEST_ASSERT_EQUAL_PTR(mock_nvm_base, global_nvm_allocator->central_heaps[0].nvm_base_addr);
+    TEST_ASSERT_NOT_NULL(global_nvm_allocator->central_heaps[0].space_manager);
+    TEST_ASSERT_NOT_NULL(global_nvm_allocator->central_heaps[0].slab_lookup_table);
     
     for (int i = 0; i < SC_COUNT; ++i) {
         TEST_ASSERT_NULL(global_nvm_allocator->cpu_heaps[0].slab_lists[i]);
@@ -127,7 +127,7 @@ void test_basic_malloc_and_free(void) {
     // 验证是否已创建对应的 Slab
     TEST_ASSERT_NOT_NULL(global_nvm_allocator->cpu_heaps[0].slab_lists[SC_32B]); 
     // 验证 Hash 表中是否记录了该 Slab
-    TEST_ASSERT_EQUAL_UINT32(1, global_nvm_allocator->central_heap.slab_lookup_table->count);
+    TEST_ASSERT_EQUAL_UINT32(1, global_nvm_allocator->central_heaps[0].slab_lookup_table->count);
 
     nvm_free(ptr);
     
@@ -151,7 +151,7 @@ void test_slab_creation_and_reuse(void) {
     TEST_ASSERT_NOT_NULL(global_nvm_allocator->cpu_heaps[0].slab_lists[SC_8B]);
     
     // 现在应该有 2 个 Slab 在 Hash 表中
-    TEST_ASSERT_EQUAL_UINT32(2, global_nvm_allocator->central_heap.slab_lookup_table->count);
+    TEST_ASSERT_EQUAL_UINT32(2, global_nvm_allocator->central_heaps[0].slab_lookup_table->count);
     
     nvm_free(ptr1);
     nvm_free(ptr2);
@@ -12,6 +12,7 @@
 #include "NvmSpaceManager.c"
 #include "SlabHashTable.c"
 #include "NvmAllocator.c"
+#include "NvmLog.c"
 
 #include <stdlib.h>
 #include <string.h>
@@ -101,7 +102,7 @@ void test_restore_object_at_head_of_space(void) {
     TEST_ASSERT_EQUAL_INT(0, nvm_allocator_restore_allocation(mock_nvm_base, 16));
     
     // [Updated for Parallel Heap]: 访问 central_heap
-    FreeSegmentNode* head = global_nvm_allocator->central_heap.space_manager->head;
+    FreeSegmentNode* head = global_nvm_allocator->central_heaps[0].space_manager->shards[0].head;
     TEST_ASSERT_EQUAL_UINT64(NVM_SLAB_SIZE, head->nvm_offset);
 }
 
@@ -115,7 +116,7 @@ void test_restore_object_at_tail_of_space(void) {
     TEST_ASSERT_EQUAL_INT(0, nvm_allocator_restore_allocation(obj_ptr, 16));
 
     // [Updated for Parallel Heap]: 访问 central_heap
-    FreeSegmentNode* head = global_nvm_allocator->central_heap.space_manager->head;
+    FreeSegmentNode* head = global_nvm_allocator->central_heaps[0].space_manager->shards[0].head;
     TEST_ASSERT_EQUAL_UINT64(slab_base_offset, head->size);
     TEST_ASSERT_NULL(head->next);
 }
@@ -170,7 +171,7 @@ static void restore_single_slab_for_stress_test(const StressTestSlabInfo* info)
 
 static void verify_restored_slab(const StressTestSlabInfo* info) {
     // [Updated for Parallel Heap]: 访问 central_heap
-    NvmSlab* slab = slab_hashtable_lookup(global_nvm_allocator->central_heap.slab_lookup_table, info->slab_base_offset);
+    NvmSlab* slab = slab_hashtable_lookup(global_nvm_allocator->central_heaps[0].slab_lookup_table, info->slab_base_offset);
     TEST_ASSERT_NOT_NULL(slab);
     TEST_ASSERT_EQUAL_UINT64(info->slab_base_offset, slab->nvm_base_offset);
     TEST_ASSERT_EQUAL_UINT8(info->sc_id, slab->size_type_id);
@@ -201,7 +202,7 @@ void test_restore_multiple_slabs_and_stress(void) {
     }
 
     // [Updated for Parallel Heap]: 访问 central_heap
-    TEST_ASSERT_EQUAL_UINT32(num_scenarios, global_nvm_allocator->central_heap.slab_lookup_table->count);
+    TEST_ASSERT_EQUAL_UINT32(num_scenarios, global_nvm_allocator->central_heaps[0].slab_lookup_table->count);
     // [Updated for Parallel Heap]: 访问 cpu_heaps[0]
     TEST_ASSERT_NOT_NULL(global_nvm_allocator->cpu_heaps[0].slab_lists[SC_16B]);
 
@@ -210,7 +211,7 @@ void test_restore_multiple_slabs_and_stress(void) {
     }
 
     // [Updated for Parallel Heap]: 访问 central_heap
-    FreeSegmentNode* current = global_nvm_allocator->central_heap.space_manager->head;
+    FreeSegmentNode* current = global_nvm_allocator->central_heaps[0].space_manager->shards[0].head;
 
     TEST_ASSERT_NOT_NULL(current);
     TEST_ASSERT_EQUAL_UINT64(0 * NVM_SLAB_SIZE, current->nvm_offset);
@@ -220,6 +221,181 @@ void test_restore_multiple_slabs_and_stress(void) {
     // ...
 }
 
+// ============================================================================
+//         测试日志式元数据持久化 (nvm_allocator_create_ex)
+// ============================================================================
+
+// 模拟崩溃：丢弃日志 DRAM 状态 (不做最后一次检查点) 后销毁分配器
+static void crash_allocator(void) {
+    log_region_release(global_nvm_allocator->log, false);
+    global_nvm_allocator->log = NULL;
+    nvm_allocator_destroy();
+}
+
+static bool block_is_allocated(void* ptr) {
+    uint64_t off = (uint64_t)((char*)ptr - (char*)mock_nvm_base);
+    NvmSlab* slab = slab_hashtable_lookup(global_nvm_allocator->central_heaps[0].slab_lookup_table,
+                                          NVM_ALIGN_DOWN(off, NVM_SLAB_SIZE));
+    if (!slab) return false;
+    return IS_BIT_SET(slab->bitmap, (off - slab->nvm_base_offset) / slab->block_size);
+}
+
+/**
+ * @brief 崩溃后从日志恢复：仍存活的块被标记占用，已释放的块保持空闲。
+ */
+void test_log_engine_crash_recovery(void) {
+    nvm_allocator_destroy();
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_create_ex(mock_nvm_base, TOTAL_NVM_SIZE,
+                                                      NVM_CREATE_LOG | NVM_CREATE_RECOVER));
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_create_ex(mock_nvm_base, TOTAL_NVM_SIZE, NVM_CREATE_RECOVER));
+    TEST_ASSERT_NULL(global_nvm_allocator);
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create_ex(mock_nvm_base, TOTAL_NVM_SIZE, NVM_CREATE_LOG));
+
+    // 数据区位于元数据区之后
+    uint64_t meta_size = nvm_log_region_size(TOTAL_NVM_SIZE);
+    TEST_ASSERT_EQUAL_UINT64(meta_size, global_nvm_allocator->central_heaps[0].range_offset);
+
+    enum { SMALL = 200, LARGE = 8 };
+    void* small[SMALL];
+    void* large[LARGE];
+    for (int i = 0; i < SMALL; ++i) {
+        small[i] = nvm_malloc(64);
+        TEST_ASSERT_NOT_NULL(small[i]);
+        TEST_ASSERT_TRUE((uint64_t)((char*)small[i] - (char*)mock_nvm_base) >= meta_size);
+    }
+    for (int i = 0; i < LARGE; ++i) {
+        large[i] = nvm_malloc(MAX_BLOCK_SIZE);
+        TEST_ASSERT_NOT_NULL(large[i]);
+    }
+    for (int i = 0; i < SMALL; i += 2) {
+        nvm_free(small[i]);
+    }
+    nvm_free(large[0]);
+
+    crash_allocator();
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create_ex(mock_nvm_base, TOTAL_NVM_SIZE,
+                                                     NVM_CREATE_LOG | NVM_CREATE_RECOVER));
+
+    for (int i = 0; i < SMALL; ++i) {
+        TEST_ASSERT_EQUAL(i % 2 == 1, block_is_allocated(small[i]));
+    }
+    TEST_ASSERT_FALSE(block_is_allocated(large[0]));
+    for (int i = 1; i < LARGE; ++i) {
+        TEST_ASSERT_TRUE(block_is_allocated(large[i]));
+    }
+
+    // 恢复后的分配不会与存活块重叠
+    for (int i = 0; i < SMALL; ++i) {
+        void* p = nvm_malloc(64);
+        TEST_ASSERT_NOT_NULL(p);
+        for (int j = 1; j < SMALL; j += 2) {
+            TEST_ASSERT_TRUE(p != small[j]);
+        }
+    }
+
+    // 正常关闭后再次恢复，状态保持一致
+    nvm_free(small[1]);
+    nvm_allocator_destroy();
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create_ex(mock_nvm_base, TOTAL_NVM_SIZE,
+                                                     NVM_CREATE_LOG | NVM_CREATE_RECOVER));
+    TEST_ASSERT_FALSE(block_is_allocated(small[1]));
+    TEST_ASSERT_TRUE(block_is_allocated(small[3]));
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_checkpoint());
+}
+
+/**
+ * @brief trim 归还空 Slab 前折叠日志；空间以其他尺寸类别重用后恢复结果正确。
+ */
+void test_log_engine_trim_then_reuse(void) {
+    nvm_allocator_destroy();
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create_ex(mock_nvm_base, TOTAL_NVM_SIZE, NVM_CREATE_LOG));
+
+    void* small = nvm_malloc(64);
+    TEST_ASSERT_NOT_NULL(small);
+    nvm_free(small);
+    TEST_ASSERT_TRUE(nvm_log_pending(global_nvm_allocator->log, 0) > 0);
+
+    TEST_ASSERT_EQUAL_INT(1, nvm_allocator_trim());
+    TEST_ASSERT_EQUAL_UINT32(0, nvm_log_pending(global_nvm_allocator->log, 0));
+    TEST_ASSERT_NULL(global_nvm_allocator->cpu_heaps[0].slab_lists[SC_64B]);
+
+    // 同一 Slab 空间以 4K 类别重新使用
+    void* large = nvm_malloc(MAX_BLOCK_SIZE);
+    TEST_ASSERT_EQUAL_PTR(small, large);
+
+    crash_allocator();
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create_ex(mock_nvm_base, TOTAL_NVM_SIZE,
+                                                     NVM_CREATE_LOG | NVM_CREATE_RECOVER));
+    TEST_ASSERT_TRUE(block_is_allocated(large));
+    uint64_t off = (uint64_t)((char*)large - (char*)mock_nvm_base);
+    NvmSlab* slab = slab_hashtable_lookup(global_nvm_allocator->central_heaps[0].slab_lookup_table, off);
+    TEST_ASSERT_NOT_NULL(slab);
+    TEST_ASSERT_EQUAL_UINT32(SC_4K, slab->size_type_id);
+    TEST_ASSERT_EQUAL_UINT32(1, slab->allocated_block_count);
+}
+
+/**
+ * @brief 原子位图引擎与日志组合：恢复重建的 Slab 仍使用原子引擎，存活块与计数一致。
+ */
+void test_log_engine_recovery_atomic_slabs(void) {
+    nvm_allocator_destroy();
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create_ex(mock_nvm_base, TOTAL_NVM_SIZE,
+                                                     NVM_CREATE_LOG | NVM_CREATE_ATOMIC));
+
+    enum { N = 100 };
+    void* ptrs[N];
+    for (int i = 0; i < N; ++i) {
+        ptrs[i] = nvm_malloc(64);
+        TEST_ASSERT_NOT_NULL(ptrs[i]);
+    }
+    for (int i = 0; i < N; i += 2) {
+        nvm_free(ptrs[i]);
+    }
+
+    crash_allocator();
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create_ex(mock_nvm_base, TOTAL_NVM_SIZE,
+                                                     NVM_CREATE_LOG | NVM_CREATE_RECOVER | NVM_CREATE_ATOMIC));
+    for (int i = 0; i < N; ++i) {
+        TEST_ASSERT_EQUAL(i % 2 == 1, block_is_allocated(ptrs[i]));
+    }
+    uint64_t off = (uint64_t)((char*)ptrs[1] - (char*)mock_nvm_base);
+    NvmSlab* slab = slab_hashtable_lookup(global_nvm_allocator->central_heaps[0].slab_lookup_table,
+                                          NVM_ALIGN_DOWN(off, (uint64_t)NVM_SLAB_SIZE));
+    TEST_ASSERT_NOT_NULL(slab);
+    TEST_ASSERT_TRUE(slab->flags & NVM_SLAB_FLAG_ATOMIC);
+    TEST_ASSERT_EQUAL_UINT32(N / 2, nvm_slab_used_blocks(slab));
+
+    // 新分配填补已释放的空洞，不与存活块重叠
+    void* p = nvm_malloc(64);
+    TEST_ASSERT_EQUAL_PTR(ptrs[0], p);
+}
+
+/**
+ * @brief 日志锁被占用时 nvm_try_malloc 回滚已取出的块并报告 LOG_BUSY。
+ */
+void test_try_malloc_log_busy_rolls_back(void) {
+    nvm_allocator_destroy();
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create_ex(mock_nvm_base, TOTAL_NVM_SIZE, NVM_CREATE_LOG));
+    TEST_ASSERT_EQUAL_INT(0, nvm_cpu_heap_replenish(0, 64));
+
+    NvmTryStatus status;
+    void* ptr = nvm_try_malloc(64, &status);
+    TEST_ASSERT_NOT_NULL(ptr);
+    TEST_ASSERT_EQUAL_INT(NVM_TRY_OK, status);
+    TEST_ASSERT_EQUAL_UINT32(1, nvm_log_pending(global_nvm_allocator->log, 0));
+
+    NvmSlab* slab = global_nvm_allocator->cpu_heaps[0].slab_lists[SC_64B];
+    NVM_MUTEX_ACQUIRE(&global_nvm_allocator->log->logs[0].lock);
+    TEST_ASSERT_NULL(nvm_try_malloc(64, &status));
+    TEST_ASSERT_EQUAL_INT(NVM_TRY_LOG_BUSY, status);
+    NVM_MUTEX_RELEASE(&global_nvm_allocator->log->logs[0].lock);
+
+    TEST_ASSERT_EQUAL_UINT32(1, slab->allocated_block_count);
+    TEST_ASSERT_EQUAL_UINT32(1, nvm_log_pending(global_nvm_allocator->log, 0));
+    TEST_ASSERT_NOT_NULL(nvm_try_malloc(64, &status));
+    TEST_ASSERT_EQUAL_UINT32(2, nvm_log_pending(global_nvm_allocator->log, 0));
+}
+
 // ============================================================================
 //                          测试执行入口
 // ============================================================================
@@ -232,6 +408,10 @@ int main(void) {
     RUN_TEST(test_restore_object_at_tail_of_space);
     RUN_TEST(test_restore_error_handling);
     RUN_TEST(test_restore_multiple_slabs_and_stress); 
+    RUN_TEST(test_log_engine_crash_recovery);
+    RUN_TEST(test_log_engine_trim_then_reuse);
+    RUN_TEST(test_log_engine_recovery_atomic_slabs);
+    RUN_TEST(test_try_malloc_log_busy_rolls_back);
 
     return UNITY_END();
 }
\ No newline at end of file
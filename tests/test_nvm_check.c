@@ -0,0 +1,214 @@
+#include "unity.h"
+
+// 包含所有必要的头文件
+#include "NvmDefs.h"
+#include "NvmAllocator.h"
+#include "NvmLog.h"
+#include "NvmCheck.h"
+
+// 包含实现文件 (白盒测试)
+#include "NvmLog.c"
+#include "NvmCheck.c"
+
+#include <stdlib.h>
+#include <string.h>
+
+// 数据区 16 个 Slab，元数据区对齐到一个 Slab
+#define DATA_SLABS      16
+#define TOTAL_POOL_SIZE ((DATA_SLABS + 1) * (uint64_t)NVM_SLAB_SIZE)
+
+static void*        g_pool = NULL;
+static NvmLogLayout g_layout;
+
+void setUp(void) {
+    g_pool = aligned_alloc(NVM_SLAB_SIZE, TOTAL_POOL_SIZE);
+    TEST_ASSERT_NOT_NULL(g_pool);
+    memset(g_pool, 0, TOTAL_POOL_SIZE);
+}
+
+void tearDown(void) {
+    free(g_pool);
+    g_pool = NULL;
+}
+
+// ============================================================================
+//                          辅助函数
+// ============================================================================
+
+// 通过分配器格式化池并留下若干已分配块 (销毁时最后一次检查点折叠全部日志)
+static void format_pool_with_allocations(void) {
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create_ex(g_pool, TOTAL_POOL_SIZE, NVM_CREATE_LOG));
+    for (int i = 0; i < 100; ++i) TEST_ASSERT_NOT_NULL(nvm_malloc(64));
+    for (int i = 0; i < 3; ++i) TEST_ASSERT_NOT_NULL(nvm_malloc(4096));
+    nvm_allocator_destroy();
+    TEST_ASSERT_EQUAL_INT(0, nvm_log_inspect_layout(g_pool, TOTAL_POOL_SIZE, &g_layout));
+}
+
+static NvmSlabImage* image_of(uint32_t slab_idx) {
+    uint8_t* sc;
+    unsigned char* bitmap;
+    TEST_ASSERT_EQUAL_INT(0, nvm_log_inspect_image(g_pool, slab_idx, &sc, &bitmap));
+    return (NvmSlabImage*)sc;
+}
+
+// 数据区中第一个使用指定尺寸类别的 Slab
+static uint32_t find_slab_of_class(SizeClassID sc) {
+    for (uint32_t i = 0; i < g_layout.slab_count; ++i) {
+        if (image_of(i)->size_class == sc) return i;
+    }
+    TEST_FAIL_MESSAGE("No slab of requested class.");
+    return 0;
+}
+
+static uint32_t find_free_slab(void) {
+    for (uint32_t i = 0; i < g_layout.slab_count; ++i) {
+        if (image_of(i)->size_class == NVM_LOG_SC_NONE) return i;
+    }
+    TEST_FAIL_MESSAGE("No free slab.");
+    return 0;
+}
+
+static uint64_t block_offset(uint32_t slab_idx, SizeClassID sc, uint32_t block_idx) {
+    return g_layout.data_offset + (uint64_t)slab_idx * NVM_SLAB_SIZE + (uint64_t)block_idx * (8u << sc);
+}
+
+// ============================================================================
+//                          测试用例
+// ============================================================================
+
+/**
+ * @brief 一致的池：报告各类别用量与空闲区间，分段数不影响结果；头部无效时拒绝。
+ */
+void test_check_consistent_pool_reports_usage(void) {
+    format_pool_with_allocations();
+
+    NvmCheckOptions opts = { 1, false };
+    NvmCheckReport serial;
+    TEST_ASSERT_EQUAL_INT(0, nvm_check_pool(g_pool, TOTAL_POOL_SIZE, &opts, &serial));
+    TEST_ASSERT_EQUAL_UINT32(DATA_SLABS, serial.slab_count);
+    TEST_ASSERT_EQUAL_UINT64(2, serial.slabs_in_use);
+    TEST_ASSERT_EQUAL_UINT64(1, serial.class_slabs[SC_64B]);
+    TEST_ASSERT_EQUAL_UINT64(100, serial.class_blocks[SC_64B]);
+    TEST_ASSERT_EQUAL_UINT64(1, serial.class_slabs[SC_4K]);
+    TEST_ASSERT_EQUAL_UINT64(3, serial.class_blocks[SC_4K]);
+    TEST_ASSERT_EQUAL_UINT64(0, serial.pending_records);
+    TEST_ASSERT_EQUAL_UINT64(0, nvm_check_error_count(&serial));
+    TEST_ASSERT_TRUE(serial.free_extents >= 1);
+    TEST_ASSERT_TRUE(serial.largest_free_extent >= (DATA_SLABS - 2) / serial.free_extents);
+
+    // 把一个使用中的 Slab 挪到中间，制造跨段的空闲区间
+    uint32_t last = g_layout.slab_count - 1;
+    uint32_t mid = DATA_SLABS / 2 + 1;
+    uint32_t used = find_slab_of_class(SC_4K);
+    memcpy(image_of(mid), image_of(used), sizeof(NvmSlabImage));
+    image_of(used)->size_class = NVM_LOG_SC_NONE;
+    TEST_ASSERT_TRUE(mid != last);
+
+    TEST_ASSERT_EQUAL_INT(0, nvm_check_pool(g_pool, TOTAL_POOL_SIZE, &opts, &serial));
+    for (uint32_t workers = 2; workers <= 5; ++workers) {
+        NvmCheckOptions par = { workers, false };
+        NvmCheckReport parallel;
+        TEST_ASSERT_EQUAL_INT(0, nvm_check_pool(g_pool, TOTAL_POOL_SIZE, &par, &parallel));
+        TEST_ASSERT_EQUAL_UINT64(serial.slabs_in_use, parallel.slabs_in_use);
+        TEST_ASSERT_EQUAL_UINT64(serial.free_extents, parallel.free_extents);
+        TEST_ASSERT_EQUAL_UINT64(serial.largest_free_extent, parallel.largest_free_extent);
+        TEST_ASSERT_EQUAL_UINT64(serial.class_blocks[SC_64B], parallel.class_blocks[SC_64B]);
+    }
+
+    // 池文件比头部描述的短，或头部被破坏
+    NvmCheckReport report;
+    TEST_ASSERT_EQUAL_INT(-1, nvm_check_pool(g_pool, TOTAL_POOL_SIZE - NVM_SLAB_SIZE, NULL, &report));
+    ((NvmLogHeader*)g_pool)->magic ^= 1;
+    TEST_ASSERT_EQUAL_INT(-1, nvm_check_pool(g_pool, TOTAL_POOL_SIZE, NULL, &report));
+}
+
+/**
+ * @brief 镜像损坏：无效尺寸类别、越界位与孤立 Slab；修复后重新检查一致。
+ */
+void test_check_detects_and_repairs_images(void) {
+    format_pool_with_allocations();
+    NvmCheckOptions opts = { 2, false };
+    NvmCheckReport report;
+
+    uint32_t bad = find_free_slab();
+    image_of(bad)->size_class = 0x20;
+    uint32_t stray = find_slab_of_class(SC_4K);
+    image_of(stray)->bitmap[(NVM_SLAB_SIZE / 4096) / 8 + 5] = 0x10;
+    uint32_t orphan = find_free_slab();
+    image_of(orphan)->size_class = SC_256B;
+
+    TEST_ASSERT_EQUAL_INT(1, nvm_check_pool(g_pool, TOTAL_POOL_SIZE, &opts, &report));
+    TEST_ASSERT_EQUAL_UINT64(1, report.bad_class_slabs);
+    TEST_ASSERT_EQUAL_UINT64(1, report.stray_bit_slabs);
+    TEST_ASSERT_EQUAL_UINT64(1, report.orphaned_slabs);
+    TEST_ASSERT_EQUAL_UINT64(4, report.slabs_in_use);
+    TEST_ASSERT_EQUAL_UINT64(0, report.repaired_slabs);
+    TEST_ASSERT_EQUAL_UINT64(3, report.class_blocks[SC_4K]);
+
+    opts.repair = true;
+    TEST_ASSERT_EQUAL_INT(1, nvm_check_pool(g_pool, TOTAL_POOL_SIZE, &opts, &report));
+    TEST_ASSERT_EQUAL_UINT64(3, report.repaired_slabs);
+    TEST_ASSERT_EQUAL_UINT64(2, report.slabs_in_use);
+    TEST_ASSERT_EQUAL_UINT8(NVM_LOG_SC_NONE, image_of(bad)->size_class);
+    TEST_ASSERT_EQUAL_UINT8(NVM_LOG_SC_NONE, image_of(orphan)->size_class);
+
+    opts.repair = false;
+    TEST_ASSERT_EQUAL_INT(0, nvm_check_pool(g_pool, TOTAL_POOL_SIZE, &opts, &report));
+    TEST_ASSERT_EQUAL_UINT64(0, report.orphaned_slabs);
+
+    // 修复后的池可以正常恢复
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create_ex(g_pool, TOTAL_POOL_SIZE, NVM_CREATE_LOG | NVM_CREATE_RECOVER));
+    nvm_allocator_destroy();
+}
+
+/**
+ * @brief 未折叠日志：越界记录、重复分配/释放、两条日志共用一个 Slab 与不同尺寸类别重叠。
+ */
+void test_check_replays_pending_log(void) {
+    format_pool_with_allocations();
+    uint32_t slab64 = find_slab_of_class(SC_64B);
+    uint32_t slab4k = find_slab_of_class(SC_4K);
+    uint32_t fresh = find_free_slab();
+
+    // 不启动检查点线程，释放时也不折叠，记录留在日志中
+    NvmLogRegion* region = nvm_log_region_create(g_pool, g_layout.data_offset, g_layout.data_size, true, 0);
+    TEST_ASSERT_NOT_NULL(region);
+
+    // 正常：释放已分配块后再分配；在空闲 Slab 上新建
+    TEST_ASSERT_EQUAL_INT(0, nvm_log_append(region, 0, NVM_LOG_OP_FREE, block_offset(slab64, SC_64B, 0), SC_64B));
+    TEST_ASSERT_EQUAL_INT(0, nvm_log_append(region, 0, NVM_LOG_OP_ALLOC, block_offset(slab64, SC_64B, 0), SC_64B));
+    TEST_ASSERT_EQUAL_INT(0, nvm_log_append(region, 0, NVM_LOG_OP_ALLOC, block_offset(fresh, SC_32B, 7), SC_32B));
+    // 重复分配、释放空闲块
+    TEST_ASSERT_EQUAL_INT(0, nvm_log_append(region, 0, NVM_LOG_OP_ALLOC, block_offset(slab64, SC_64B, 1), SC_64B));
+    TEST_ASSERT_EQUAL_INT(0, nvm_log_append(region, 0, NVM_LOG_OP_FREE, block_offset(slab64, SC_64B, 500), SC_64B));
+    // 以另一尺寸类别使用仍有存活块的 Slab
+    TEST_ASSERT_EQUAL_INT(0, nvm_log_append(region, 0, NVM_LOG_OP_ALLOC, block_offset(slab4k, SC_8B, 0), SC_8B));
+    // 数据区之外的记录
+    TEST_ASSERT_EQUAL_INT(0, nvm_log_append(region, 0, NVM_LOG_OP_ALLOC,
+                                            g_layout.data_offset + g_layout.data_size, SC_8B));
+    // 同一 Slab 出现在另一条日志中
+    TEST_ASSERT_EQUAL_INT(0, nvm_log_append(region, 1, NVM_LOG_OP_ALLOC, block_offset(fresh, SC_32B, 8), SC_32B));
+    log_region_release(region, false);
+
+    NvmCheckReport report;
+    TEST_ASSERT_EQUAL_INT(1, nvm_check_pool(g_pool, TOTAL_POOL_SIZE, NULL, &report));
+    TEST_ASSERT_EQUAL_UINT64(8, report.pending_records);
+    TEST_ASSERT_EQUAL_UINT64(1, report.bad_records);
+    TEST_ASSERT_EQUAL_UINT64(1, report.double_allocs);
+    TEST_ASSERT_EQUAL_UINT64(1, report.double_frees);
+    TEST_ASSERT_EQUAL_UINT64(2, report.overlapping_slabs);
+    TEST_ASSERT_EQUAL_UINT64(0, report.orphaned_slabs);
+}
+
+// ============================================================================
+//                          测试执行入口
+// ============================================================================
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_check_consistent_pool_reports_usage);
+    RUN_TEST(test_check_detects_and_repairs_images);
+    RUN_TEST(test_check_replays_pending_log);
+
+    return UNITY_END();
+}
@@ -0,0 +1,177 @@
+#include "unity.h"
+
+// 包含所有必要的头文件
+#include "NvmDefs.h"
+#include "NvmEpoch.h"
+
+// 包含实现文件 (白盒测试)
+#include "NvmEpoch.c"
+
+#include <stdlib.h>
+#include <string.h>
+
+// 并发测试参数
+#define NUM_READERS        3
+#define WRITER_SWAPS       20000
+#define OBJ_MAGIC          0x5A5A5A5A5A5A5A5AULL
+#define OBJ_POISON         0xDEADDEADDEADDEADULL
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// ============================================================================
+//                          辅助函数
+// ============================================================================
+
+static uint64_t g_freed_count;
+
+static void counting_free(void* ptr) {
+    __atomic_fetch_add(&g_freed_count, 1, __ATOMIC_RELAXED);
+    free(ptr);
+}
+
+typedef struct TestObj {
+    uint64_t magic;
+} TestObj;
+
+// 释放前写毒值：若读者仍能看到毒值，说明对象在其临界区内被回收了
+static void poison_free(void* ptr) {
+    ((TestObj*)ptr)->magic = OBJ_POISON;
+    __atomic_fetch_add(&g_freed_count, 1, __ATOMIC_RELAXED);
+    free(ptr);
+}
+
+static TestObj* new_obj(void) {
+    TestObj* obj = (TestObj*)malloc(sizeof(TestObj));
+    TEST_ASSERT_NOT_NULL(obj);
+    obj->magic = OBJ_MAGIC;
+    return obj;
+}
+
+// ============================================================================
+//                          测试用例
+// ============================================================================
+
+/**
+ * @brief 活跃读者阻止回收，离开后对象才被释放
+ */
+void test_epoch_retire_deferred_while_reader_active(void) {
+    g_freed_count = 0;
+    nvm_epoch_barrier();
+    TEST_ASSERT_EQUAL_UINT64(0, nvm_epoch_pending());
+
+    uint32_t token = nvm_epoch_enter();
+    nvm_epoch_retire(malloc(16), counting_free);
+    TEST_ASSERT_EQUAL_UINT64(1, nvm_epoch_pending());
+
+    // 读者未离开，纪元最多推进一次，对象不可回收
+    uint64_t start = g_epoch;
+    for (int i = 0; i < 8; ++i) nvm_epoch_reclaim();
+    TEST_ASSERT_TRUE(g_epoch <= start + 1);
+    TEST_ASSERT_EQUAL_UINT64(0, g_freed_count);
+
+    // 嵌套临界区同样有效
+    uint32_t inner = nvm_epoch_enter();
+    nvm_epoch_exit(inner);
+    nvm_epoch_reclaim();
+    TEST_ASSERT_EQUAL_UINT64(0, g_freed_count);
+
+    nvm_epoch_exit(token);
+    nvm_epoch_reclaim();
+    nvm_epoch_reclaim();
+    TEST_ASSERT_EQUAL_UINT64(1, g_freed_count);
+    TEST_ASSERT_EQUAL_UINT64(0, nvm_epoch_pending());
+}
+
+/**
+ * @brief 退休数达到批量阈值时自动回收，barrier 清空全部延迟链表
+ */
+void test_epoch_batch_reclaim_and_barrier(void) {
+    g_freed_count = 0;
+    nvm_epoch_barrier();
+
+    for (int i = 0; i < NVM_EPOCH_RECLAIM_BATCH * 4; ++i) {
+        nvm_epoch_retire(malloc(16), counting_free);
+    }
+    // 无读者时批量触发的回收会逐步释放较早退休的对象
+    TEST_ASSERT_TRUE(g_freed_count > 0);
+    TEST_ASSERT_TRUE(nvm_epoch_pending() < NVM_EPOCH_RECLAIM_BATCH * 4);
+
+    nvm_epoch_barrier();
+    TEST_ASSERT_EQUAL_UINT64(NVM_EPOCH_RECLAIM_BATCH * 4, g_freed_count);
+    TEST_ASSERT_EQUAL_UINT64(0, nvm_epoch_pending());
+
+    // 白盒检查：延迟链表已清空
+    for (int cpu = 0; cpu < MAX_CPUS; ++cpu) {
+        TEST_ASSERT_NULL(g_limbo[cpu].head);
+        TEST_ASSERT_NULL(g_limbo[cpu].tail);
+        TEST_ASSERT_EQUAL_UINT32(0, g_limbo[cpu].count);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// 并发：读者反复解引用共享指针，写者不断替换并退休旧对象
+// ----------------------------------------------------------------------------
+
+typedef struct StressArg {
+    TestObj**    shared;
+    volatile int stop;
+    uint64_t     bad_reads;
+} StressArg;
+
+static void* reader_worker(void* arg) {
+    StressArg* a = (StressArg*)arg;
+    uint64_t bad = 0;
+    while (!a->stop) {
+        uint32_t token = nvm_epoch_enter();
+        TestObj* obj = __atomic_load_n(a->shared, __ATOMIC_ACQUIRE);
+        for (int i = 0; i < 4; ++i) {
+            if (__atomic_load_n(&obj->magic, __ATOMIC_RELAXED) != OBJ_MAGIC) bad++;
+        }
+        nvm_epoch_exit(token);
+    }
+    __atomic_fetch_add(&a->bad_reads, bad, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+void test_epoch_concurrent_readers_and_retire(void) {
+    g_freed_count = 0;
+    nvm_epoch_barrier();
+
+    TestObj* shared = new_obj();
+    StressArg arg = { &shared, 0, 0 };
+    pthread_t readers[NUM_READERS];
+    for (int i = 0; i < NUM_READERS; ++i) {
+        TEST_ASSERT_EQUAL_INT(0, pthread_create(&readers[i], NULL, reader_worker, &arg));
+    }
+
+    for (int i = 0; i < WRITER_SWAPS; ++i) {
+        TestObj* old = __atomic_exchange_n(&shared, new_obj(), __ATOMIC_ACQ_REL);
+        nvm_epoch_retire(old, poison_free);
+        if ((i & 1023) == 0) sched_yield();
+    }
+
+    arg.stop = 1;
+    for (int i = 0; i < NUM_READERS; ++i) {
+        pthread_join(readers[i], NULL);
+    }
+
+    nvm_epoch_barrier();
+    TEST_ASSERT_EQUAL_UINT64(0, arg.bad_reads);
+    TEST_ASSERT_EQUAL_UINT64(WRITER_SWAPS, g_freed_count);
+    TEST_ASSERT_EQUAL_UINT64(0, nvm_epoch_pending());
+    free(shared);
+}
+
+// ============================================================================
+//                          测试执行入口
+// ============================================================================
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_epoch_retire_deferred_while_reader_active);
+    RUN_TEST(test_epoch_batch_reclaim_and_barrier);
+    RUN_TEST(test_epoch_concurrent_readers_and_retire);
+
+    return UNITY_END();
+}
@@ -0,0 +1,363 @@
+#include "unity.h"
+
+// 包含所有必要的头文件
+#include "NvmDefs.h"
+#include "NvmConfig.h"
+
+// 包含实现文件 (白盒测试)
+#include "NvmLock.c"
+
+#include <stdlib.h>
+#include <string.h>
+
+// 并发计数测试参数
+#define NUM_THREADS        4
+#define ITERS_PER_THREAD   20000
+
+// ============================================================================
+//                          通用并发计数框架
+// ============================================================================
+
+typedef struct LockOps {
+    void* lock;
+    int (*acquire)(void* lock);
+    int (*release)(void* lock);
+} LockOps;
+
+typedef struct CounterArg {
+    const LockOps* ops;
+    uint64_t*      counter;
+} CounterArg;
+
+static void* counter_worker(void* arg) {
+    CounterArg* a = (CounterArg*)arg;
+    for (int i = 0; i < ITERS_PER_THREAD; ++i) {
+        a->ops->acquire(a->ops->lock);
+        // 非原子读改写：只有互斥正确时计数才不会丢失
+        uint64_t v = *(volatile uint64_t*)a->counter;
+        *(volatile uint64_t*)a->counter = v + 1;
+        a->ops->release(a->ops->lock);
+    }
+    return NULL;
+}
+
+static void run_counter(const LockOps* ops) {
+    uint64_t counter = 0;
+    pthread_t threads[NUM_THREADS];
+    CounterArg arg = { ops, &counter };
+
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        TEST_ASSERT_EQUAL_INT(0, pthread_create(&threads[i], NULL, counter_worker, &arg));
+    }
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    TEST_ASSERT_EQUAL_UINT64((uint64_t)NUM_THREADS * ITERS_PER_THREAD, counter);
+}
+
+static int ticket_acquire(void* l)   { return nvm_ticket_lock_acquire((nvm_ticket_lock_t*)l); }
+static int ticket_release(void* l)   { return nvm_ticket_lock_release((nvm_ticket_lock_t*)l); }
+static int mcs_acquire(void* l)      { return nvm_mcs_lock_acquire((nvm_mcs_lock_t*)l); }
+static int mcs_release(void* l)      { return nvm_mcs_lock_release((nvm_mcs_lock_t*)l); }
+static int clh_acquire(void* l)      { return nvm_clh_lock_acquire((nvm_clh_lock_t*)l); }
+static int clh_release(void* l)      { return nvm_clh_lock_release((nvm_clh_lock_t*)l); }
+static int adaptive_acquire(void* l) { return nvm_adaptive_mutex_acquire((nvm_adaptive_mutex_t*)l); }
+static int adaptive_release(void* l) { return nvm_adaptive_mutex_release((nvm_adaptive_mutex_t*)l); }
+
+// 以 try_acquire 自旋获取
+static int ticket_try_spin(void* l) {
+    while (nvm_ticket_lock_try_acquire((nvm_ticket_lock_t*)l) != 0) nvm_cpu_relax();
+    return 0;
+}
+static int mcs_try_spin(void* l) {
+    while (nvm_mcs_lock_try_acquire((nvm_mcs_lock_t*)l) != 0) nvm_cpu_relax();
+    return 0;
+}
+static int clh_try_spin(void* l) {
+    while (nvm_clh_lock_try_acquire((nvm_clh_lock_t*)l) != 0) nvm_cpu_relax();
+    return 0;
+}
+static int adaptive_try_spin(void* l) {
+    while (nvm_adaptive_mutex_try_acquire((nvm_adaptive_mutex_t*)l) != 0) nvm_cpu_relax();
+    return 0;
+}
+static int percpu_wr_acquire(void* l) { return nvm_percpu_rwlock_write_lock((nvm_percpu_rwlock_t*)l); }
+static int percpu_unlock(void* l)     { return nvm_percpu_rwlock_unlock((nvm_percpu_rwlock_t*)l); }
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// ============================================================================
+//                          测试用例
+// ============================================================================
+
+/**
+ * @brief 票据锁：按取号顺序交接，并发计数不丢失。
+ */
+void test_ticket_lock(void) {
+    nvm_ticket_lock_t lock;
+    TEST_ASSERT_EQUAL_INT(0, nvm_ticket_lock_init(&lock));
+
+    nvm_ticket_lock_acquire(&lock);
+    TEST_ASSERT_EQUAL_UINT32(1, lock.next);
+    nvm_ticket_lock_release(&lock);
+    TEST_ASSERT_EQUAL_UINT32(1, lock.owner);
+
+    LockOps ops = { &lock, ticket_acquire, ticket_release };
+    run_counter(&ops);
+    TEST_ASSERT_EQUAL_UINT32(lock.next, lock.owner);
+    nvm_ticket_lock_destroy(&lock);
+}
+
+/**
+ * @brief MCS 锁：嵌套持有多把锁 (含非 LIFO 释放) 后节点全部归还。
+ */
+void test_mcs_lock(void) {
+    nvm_mcs_lock_t locks[3];
+    for (int i = 0; i < 3; ++i) nvm_mcs_lock_init(&locks[i]);
+
+    nvm_mcs_lock_acquire(&locks[0]);
+    nvm_mcs_lock_acquire(&locks[1]);
+    nvm_mcs_lock_acquire(&locks[2]);
+    TEST_ASSERT_EQUAL_HEX32(0x7, t_mcs_used);
+    nvm_mcs_lock_release(&locks[0]);
+    nvm_mcs_lock_release(&locks[2]);
+    TEST_ASSERT_EQUAL_HEX32(0x2, t_mcs_used);
+    nvm_mcs_lock_release(&locks[1]);
+    TEST_ASSERT_EQUAL_HEX32(0, t_mcs_used);
+    TEST_ASSERT_NULL(locks[0].tail);
+
+    LockOps ops = { &locks[0], mcs_acquire, mcs_release };
+    run_counter(&ops);
+    TEST_ASSERT_NULL(locks[0].tail);
+}
+
+/**
+ * @brief CLH 锁：释放后回收前驱节点，并发计数不丢失。
+ */
+void test_clh_lock(void) {
+    nvm_clh_lock_t lock;
+    TEST_ASSERT_EQUAL_INT(0, nvm_clh_lock_init(&lock));
+    nvm_clh_node_t* dummy = lock.tail;
+
+    nvm_clh_lock_acquire(&lock);
+    TEST_ASSERT_TRUE(lock.tail != dummy);
+    nvm_clh_lock_release(&lock);
+    // 哑节点被当前线程回收
+    TEST_ASSERT_NOT_NULL(t_clh_cache);
+    TEST_ASSERT_EQUAL_PTR(dummy, t_clh_cache->nodes[t_clh_cache->count - 1]);
+
+    LockOps ops = { &lock, clh_acquire, clh_release };
+    run_counter(&ops);
+    TEST_ASSERT_EQUAL_UINT32(0, lock.tail->locked);
+    nvm_clh_lock_destroy(&lock);
+}
+
+// 模拟线程退出：先运行 CLH 缓存的析构函数 (运行时会先把 key 的值置空)，
+// 之后其他 key 的析构函数仍获取与释放 CLH 锁
+static void* clh_exit_order_worker(void* arg) {
+    nvm_clh_lock_t* lock = (nvm_clh_lock_t*)arg;
+    nvm_clh_lock_acquire(lock);
+    nvm_clh_lock_release(lock);
+    ClhNodeCache* cache = t_clh_cache;
+    if (!cache) return (void*)1;
+
+    pthread_setspecific(g_clh_key, NULL);
+    clh_cache_destroy(cache);
+    nvm_clh_lock_acquire(lock);
+    nvm_clh_lock_release(lock);
+    return (void*)(uintptr_t)(t_clh_cache != NULL);
+}
+
+/**
+ * @brief CLH 锁：节点缓存析构后再持锁不访问已释放的缓存，回收的节点直接释放。
+ */
+void test_clh_lock_after_cache_destroyed(void) {
+    nvm_clh_lock_t lock;
+    TEST_ASSERT_EQUAL_INT(0, nvm_clh_lock_init(&lock));
+
+    pthread_t tid;
+    void* ret = NULL;
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&tid, NULL, clh_exit_order_worker, &lock));
+    pthread_join(tid, &ret);
+    TEST_ASSERT_NULL(ret);
+
+    // 锁仍可正常使用
+    nvm_clh_lock_acquire(&lock);
+    nvm_clh_lock_release(&lock);
+    TEST_ASSERT_EQUAL_UINT32(0, lock.tail->locked);
+    nvm_clh_lock_destroy(&lock);
+}
+
+/**
+ * @brief 只有一个可运行 CPU 时排队锁的等待者每步都让出，不空转到阈值。
+ */
+void test_spin_backoff_single_cpu(void) {
+    uint8_t allowed[MAX_CPUS];
+    TEST_ASSERT_EQUAL_INT(0, nvm_get_allowed_cpus(allowed));
+    int count = 0;
+    for (int cpu = 0; cpu < MAX_CPUS; ++cpu) count += allowed[cpu] != 0;
+
+    TEST_ASSERT_EQUAL_INT(count == 1, nvm_lock_detect_single_cpu());
+    TEST_ASSERT_EQUAL_INT(count == 1, nvm_lock_single_cpu_state);
+    TEST_ASSERT_EQUAL(count == 1, nvm_lock_single_cpu());
+
+    // 单 CPU 时第一步就让出并清零计数
+    uint32_t spins = 0;
+    nvm_spin_backoff(&spins);
+    TEST_ASSERT_EQUAL_UINT32(count == 1 ? 0 : 1, spins);
+}
+
+/**
+ * @brief 自适应互斥锁：竞争后状态归零；条件变量超时与唤醒。
+ */
+void test_adaptive_mutex_and_cond(void) {
+    nvm_adaptive_mutex_t mutex;
+    nvm_futex_cond_t cond;
+    nvm_adaptive_mutex_init(&mutex);
+    nvm_futex_cond_init(&cond);
+
+    LockOps ops = { &mutex, adaptive_acquire, adaptive_release };
+    run_counter(&ops);
+    TEST_ASSERT_EQUAL_UINT32(0, mutex.state);
+
+    // 无人唤醒时超时返回非 0，且返回时仍持有锁
+    nvm_adaptive_mutex_acquire(&mutex);
+    TEST_ASSERT_NOT_EQUAL(0, nvm_futex_cond_timedwait(&cond, &mutex, 5));
+    TEST_ASSERT_NOT_EQUAL(0, mutex.state);
+    nvm_adaptive_mutex_release(&mutex);
+
+    // 序号已变化时立即返回
+    nvm_adaptive_mutex_acquire(&mutex);
+    nvm_futex_cond_signal(&cond);
+    TEST_ASSERT_EQUAL_UINT32(1, cond.seq);
+    nvm_adaptive_mutex_release(&mutex);
+}
+
+static nvm_percpu_rwlock_t g_rwlock;
+static uint64_t            g_rw_pair[2];
+static volatile int        g_rw_torn;
+
+static void* rw_reader(void* arg) {
+    (void)arg;
+    for (int i = 0; i < ITERS_PER_THREAD; ++i) {
+        nvm_percpu_rwlock_read_lock(&g_rwlock);
+        if (g_rw_pair[0] != g_rw_pair[1]) g_rw_torn = 1;
+        nvm_percpu_rwlock_unlock(&g_rwlock);
+    }
+    return NULL;
+}
+
+static void* rw_writer(void* arg) {
+    (void)arg;
+    for (int i = 0; i < ITERS_PER_THREAD / 10; ++i) {
+        nvm_percpu_rwlock_write_lock(&g_rwlock);
+        g_rw_pair[0]++;
+        g_rw_pair[1]++;
+        nvm_percpu_rwlock_unlock(&g_rwlock);
+    }
+    return NULL;
+}
+
+/**
+ * @brief 每 CPU 读写锁：读者看不到写到一半的状态，写者之间互斥，计数最终归零。
+ */
+void test_percpu_rwlock(void) {
+    nvm_percpu_rwlock_init(&g_rwlock);
+
+    // 读锁可重入多次，写锁需等待全部读者离开
+    nvm_percpu_rwlock_read_lock(&g_rwlock);
+    nvm_percpu_rwlock_read_lock(&g_rwlock);
+    TEST_ASSERT_EQUAL_INT32(2, g_rwlock.readers[nvm_get_current_cpu_id()].count);
+    nvm_percpu_rwlock_unlock(&g_rwlock);
+    nvm_percpu_rwlock_unlock(&g_rwlock);
+
+    nvm_percpu_rwlock_write_lock(&g_rwlock);
+    TEST_ASSERT_EQUAL_PTR(&nvm_lock_thread_tag, g_rwlock.write_owner);
+    nvm_percpu_rwlock_unlock(&g_rwlock);
+    TEST_ASSERT_EQUAL_UINT32(0, g_rwlock.writer);
+
+    pthread_t threads[NUM_THREADS];
+    g_rw_torn = 0;
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        pthread_create(&threads[i], NULL, (i % 2) ? rw_writer : rw_reader, NULL);
+    }
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    TEST_ASSERT_EQUAL_INT(0, g_rw_torn);
+    TEST_ASSERT_EQUAL_UINT64((NUM_THREADS / 2) * (ITERS_PER_THREAD / 10), g_rw_pair[0]);
+
+    int64_t sum = 0;
+    for (int i = 0; i < MAX_CPUS; ++i) sum += g_rwlock.readers[i].count;
+    TEST_ASSERT_EQUAL_INT64(0, sum);
+
+    // 写锁作为互斥锁使用
+    LockOps ops = { &g_rwlock, percpu_wr_acquire, percpu_unlock };
+    run_counter(&ops);
+}
+
+/**
+ * @brief try_acquire：空闲时成功，被持有时立即失败且不改变锁状态；多线程以其自旋获取仍互斥。
+ */
+void test_try_acquire_all_backends(void) {
+    nvm_ticket_lock_t ticket;
+    nvm_ticket_lock_init(&ticket);
+    TEST_ASSERT_EQUAL_INT(0, nvm_ticket_lock_try_acquire(&ticket));
+    TEST_ASSERT_NOT_EQUAL(0, nvm_ticket_lock_try_acquire(&ticket));
+    TEST_ASSERT_EQUAL_UINT32(1, ticket.next);
+    nvm_ticket_lock_release(&ticket);
+
+    nvm_mcs_lock_t mcs;
+    nvm_mcs_lock_init(&mcs);
+    TEST_ASSERT_EQUAL_INT(0, nvm_mcs_lock_try_acquire(&mcs));
+    TEST_ASSERT_NOT_EQUAL(0, nvm_mcs_lock_try_acquire(&mcs));
+    TEST_ASSERT_EQUAL_HEX32(0x1, t_mcs_used);
+    nvm_mcs_lock_release(&mcs);
+    TEST_ASSERT_EQUAL_HEX32(0, t_mcs_used);
+    TEST_ASSERT_NULL(mcs.tail);
+
+    nvm_clh_lock_t clh;
+    TEST_ASSERT_EQUAL_INT(0, nvm_clh_lock_init(&clh));
+    TEST_ASSERT_EQUAL_INT(0, nvm_clh_lock_try_acquire(&clh));
+    nvm_clh_node_t* held_tail = clh.tail;
+    TEST_ASSERT_NOT_EQUAL(0, nvm_clh_lock_try_acquire(&clh));
+    TEST_ASSERT_EQUAL_PTR(held_tail, clh.tail);
+    nvm_clh_lock_release(&clh);
+
+    nvm_adaptive_mutex_t adaptive;
+    nvm_adaptive_mutex_init(&adaptive);
+    TEST_ASSERT_EQUAL_INT(0, nvm_adaptive_mutex_try_acquire(&adaptive));
+    TEST_ASSERT_NOT_EQUAL(0, nvm_adaptive_mutex_try_acquire(&adaptive));
+    nvm_adaptive_mutex_release(&adaptive);
+    TEST_ASSERT_EQUAL_UINT32(0, adaptive.state);
+
+    LockOps ticket_ops   = { &ticket,   ticket_try_spin,   ticket_release };
+    LockOps mcs_ops      = { &mcs,      mcs_try_spin,      mcs_release };
+    LockOps clh_ops      = { &clh,      clh_try_spin,      clh_release };
+    LockOps adaptive_ops = { &adaptive, adaptive_try_spin, adaptive_release };
+    run_counter(&ticket_ops);
+    run_counter(&mcs_ops);
+    run_counter(&clh_ops);
+    run_counter(&adaptive_ops);
+
+    nvm_clh_lock_destroy(&clh);
+}
+
+// ============================================================================
+//                          测试执行入口
+// ============================================================================
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_ticket_lock);
+    RUN_TEST(test_mcs_lock);
+    RUN_TEST(test_clh_lock);
+    RUN_TEST(test_clh_lock_after_cache_destroyed);
+    RUN_TEST(test_spin_backoff_single_cpu);
+    RUN_TEST(test_adaptive_mutex_and_cond);
+    RUN_TEST(test_percpu_rwlock);
+    RUN_TEST(test_try_acquire_all_backends);
+
+    return UNITY_END();
+}
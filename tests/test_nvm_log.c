@@ -0,0 +1,198 @@
+#include "unity.h"
+
+// 包含所有必要的头文件
+#include "NvmDefs.h"
+#include "NvmSlab.h"
+#include "NvmLog.h"
+
+// 包含实现文件 (白盒测试，用于模拟崩溃)
+#include "NvmLog.c"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// 数据区: 4 个 Slab，紧跟在元数据区之后
+#define NUM_SLABS   4
+#define DATA_SIZE   ((uint64_t)NUM_SLABS * NVM_SLAB_SIZE)
+
+static void*         meta_base = NULL;
+static uint64_t      meta_size = 0;
+static NvmLogRegion* region = NULL;
+
+void setUp(void) {
+    meta_size = nvm_log_region_size(DATA_SIZE);
+    meta_base = aligned_alloc(CACHE_LINE_SIZE, meta_size);
+    TEST_ASSERT_NOT_NULL(meta_base);
+    memset(meta_base, 0xCD, meta_size);
+
+    region = nvm_log_region_create(meta_base, meta_size, DATA_SIZE, false, 0);
+    TEST_ASSERT_NOT_NULL(region);
+}
+
+void tearDown(void) {
+    nvm_log_region_destroy(region);
+    region = NULL;
+    free(meta_base);
+    meta_base = NULL;
+}
+
+// 数据区中第 slab 个 Slab 的第 idx 个块 (尺寸类别 sc) 的偏移
+static uint64_t block_offset(uint32_t slab, SizeClassID sc, uint32_t idx) {
+    return meta_size + (uint64_t)slab * NVM_SLAB_SIZE + (uint64_t)idx * (8u << sc);
+}
+
+static bool image_bit(uint32_t slab, uint32_t idx) {
+    uint8_t sc;
+    const unsigned char* bitmap;
+    TEST_ASSERT_EQUAL_INT(0, nvm_log_slab_image(region, slab, &sc, &bitmap));
+    return IS_BIT_SET(bitmap, idx);
+}
+
+// 模拟崩溃：不做检查点直接丢弃 DRAM 状态，然后从 NVM 恢复
+static void crash_and_recover(void) {
+    log_region_release(region, false);
+    region = nvm_log_region_create(meta_base, meta_size, DATA_SIZE, true, 0);
+    TEST_ASSERT_NOT_NULL(region);
+}
+
+// ============================================================================
+//                          测试用例
+// ============================================================================
+
+/**
+ * @brief 格式化后所有镜像未使用；元数据区大小按 Slab 对齐；参数校验。
+ */
+void test_log_format_and_params(void) {
+    TEST_ASSERT_EQUAL_UINT64(0, meta_size % NVM_SLAB_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(NUM_SLABS, nvm_log_slab_count(region));
+
+    for (uint32_t i = 0; i < NUM_SLABS; ++i) {
+        uint8_t sc;
+        const unsigned char* bitmap;
+        TEST_ASSERT_EQUAL_INT(0, nvm_log_slab_image(region, i, &sc, &bitmap));
+        TEST_ASSERT_EQUAL_UINT8(NVM_LOG_SC_NONE, sc);
+    }
+
+    uint8_t sc;
+    const unsigned char* bitmap;
+    TEST_ASSERT_EQUAL_INT(-1, nvm_log_slab_image(region, NUM_SLABS, &sc, &bitmap));
+    TEST_ASSERT_EQUAL_INT(-1, nvm_log_append(region, MAX_CPUS, NVM_LOG_OP_ALLOC, block_offset(0, SC_8B, 0), SC_8B));
+    TEST_ASSERT_EQUAL_INT(-1, nvm_log_append(region, 0, (NvmLogOp)0, block_offset(0, SC_8B, 0), SC_8B));
+    TEST_ASSERT_NULL(nvm_log_region_create(meta_base, 4096, DATA_SIZE, false, 0));
+}
+
+/**
+ * @brief 追加只写日志；检查点把记录折叠进镜像并截断日志。
+ */
+void test_log_append_and_checkpoint(void) {
+    for (uint32_t i = 0; i < 10; ++i) {
+        TEST_ASSERT_EQUAL_INT(0, nvm_log_append(region, 1, NVM_LOG_OP_ALLOC, block_offset(2, SC_64B, i), SC_64B));
+    }
+    TEST_ASSERT_EQUAL_INT(0, nvm_log_append(region, 1, NVM_LOG_OP_FREE, block_offset(2, SC_64B, 3), SC_64B));
+    TEST_ASSERT_EQUAL_UINT32(11, nvm_log_pending(region, 1));
+    TEST_ASSERT_EQUAL_UINT8(NVM_LOG_SC_NONE, region->images[2].size_class);
+
+    nvm_log_checkpoint(region);
+    TEST_ASSERT_EQUAL_UINT32(0, nvm_log_pending(region, 1));
+    TEST_ASSERT_EQUAL_UINT64(11, region->cpu_headers[1].head);
+    TEST_ASSERT_EQUAL_UINT8(SC_64B, region->images[2].size_class);
+
+    for (uint32_t i = 0; i < 10; ++i) {
+        TEST_ASSERT_EQUAL(i != 3, image_bit(2, i));
+    }
+    TEST_ASSERT_FALSE(image_bit(2, 10));
+}
+
+/**
+ * @brief 日志写满时在追加路径上同步折叠，不丢记录。
+ */
+void test_log_full_forces_inline_fold(void) {
+    const uint32_t total = NVM_LOG_CAPACITY + 10;
+    for (uint32_t i = 0; i < total; ++i) {
+        TEST_ASSERT_EQUAL_INT(0, nvm_log_append(region, 0, NVM_LOG_OP_ALLOC, block_offset(0, SC_8B, i), SC_8B));
+    }
+    TEST_ASSERT_EQUAL_UINT32(10, nvm_log_pending(region, 0));
+    TEST_ASSERT_TRUE(image_bit(0, NVM_LOG_CAPACITY - 1));
+    TEST_ASSERT_FALSE(image_bit(0, NVM_LOG_CAPACITY));
+
+    nvm_log_checkpoint(region);
+    TEST_ASSERT_TRUE(image_bit(0, total - 1));
+}
+
+/**
+ * @brief 崩溃恢复：重放截断点之后的日志尾部，忽略上一圈残留的记录。
+ */
+void test_log_recovery_replays_tail(void) {
+    // 1. 写满一圈多并检查点，使记录环中留下上一圈的记录
+    for (uint32_t i = 0; i < NVM_LOG_CAPACITY + 5; ++i) {
+        nvm_log_append(region, 3, NVM_LOG_OP_ALLOC, block_offset(1, SC_16B, i), SC_16B);
+    }
+    nvm_log_checkpoint(region);
+
+    // 2. 检查点之后的尾部：释放两块、分配一块
+    nvm_log_append(region, 3, NVM_LOG_OP_FREE,  block_offset(1, SC_16B, 0), SC_16B);
+    nvm_log_append(region, 3, NVM_LOG_OP_FREE,  block_offset(1, SC_16B, 7), SC_16B);
+    nvm_log_append(region, 3, NVM_LOG_OP_ALLOC, block_offset(3, SC_4K, 2), SC_4K);
+    TEST_ASSERT_TRUE(image_bit(1, 0));
+
+    // 3. 崩溃并恢复
+    crash_and_recover();
+    TEST_ASSERT_EQUAL_UINT32(0, nvm_log_pending(region, 3));
+    TEST_ASSERT_EQUAL_UINT64(NVM_LOG_CAPACITY + 8, region->cpu_headers[3].head);
+    TEST_ASSERT_FALSE(image_bit(1, 0));
+    TEST_ASSERT_FALSE(image_bit(1, 7));
+    TEST_ASSERT_TRUE(image_bit(1, 8));
+    TEST_ASSERT_TRUE(image_bit(1, NVM_LOG_CAPACITY + 4));
+    TEST_ASSERT_EQUAL_UINT8(SC_4K, region->images[3].size_class);
+    TEST_ASSERT_TRUE(image_bit(3, 2));
+
+    // 4. 恢复后继续追加，圈号连续
+    nvm_log_append(region, 3, NVM_LOG_OP_FREE, block_offset(1, SC_16B, 8), SC_16B);
+    crash_and_recover();
+    TEST_ASSERT_FALSE(image_bit(1, 8));
+}
+
+/**
+ * @brief 头部不匹配 (未格式化或数据区大小不同) 时拒绝恢复。
+ */
+void test_log_recovery_rejects_mismatch(void) {
+    TEST_ASSERT_NULL(nvm_log_region_create(meta_base, meta_size, DATA_SIZE - NVM_SLAB_SIZE, true, 0));
+
+    region->header->magic = 0;
+    log_region_release(region, false);
+    region = nvm_log_region_create(meta_base, meta_size, DATA_SIZE, true, 0);
+    TEST_ASSERT_NULL(region);
+}
+
+/**
+ * @brief 后台检查点线程会自动折叠日志。
+ */
+void test_log_background_checkpoint(void) {
+    nvm_log_region_destroy(region);
+    region = nvm_log_region_create(meta_base, meta_size, DATA_SIZE, false, 5);
+    TEST_ASSERT_NOT_NULL(region);
+
+    nvm_log_append(region, 2, NVM_LOG_OP_ALLOC, block_offset(0, SC_1K, 1), SC_1K);
+    for (int i = 0; i < 500 && nvm_log_pending(region, 2) > 0; ++i) {
+        usleep(10 * 1000);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, nvm_log_pending(region, 2));
+    TEST_ASSERT_TRUE(image_bit(0, 1));
+}
+
+// ============================================================================
+//                          测试执行入口
+// ============================================================================
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_log_format_and_params);
+    RUN_TEST(test_log_append_and_checkpoint);
+    RUN_TEST(test_log_full_forces_inline_fold);
+    RUN_TEST(test_log_recovery_replays_tail);
+    RUN_TEST(test_log_recovery_rejects_mismatch);
+    RUN_TEST(test_log_background_checkpoint);
+
+    return UNITY_END();
+}
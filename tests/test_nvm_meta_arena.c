@@ -0,0 +1,202 @@
+#include "unity.h"
+
+// 包含所有必要的头文件
+#include "NvmDefs.h"
+#include "NvmMetaArena.h"
+
+// 包含实现文件 (白盒测试)
+#include "NvmMetaArena.c"
+
+#include <stdlib.h>
+#include <string.h>
+
+// 并发测试参数
+#define NUM_WORKERS        4
+#define OPS_PER_WORKER     20000
+#define LIVE_PER_WORKER    64
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// ============================================================================
+//                          辅助函数
+// ============================================================================
+
+static NvmMetaArenaStats get_stats(int node) {
+    NvmMetaArenaStats stats;
+    TEST_ASSERT_EQUAL_INT(0, nvm_meta_arena_stats(node, &stats));
+    return stats;
+}
+
+static bool all_zero(const void* ptr, size_t size) {
+    const unsigned char* p = (const unsigned char*)ptr;
+    for (size_t i = 0; i < size; ++i) {
+        if (p[i] != 0) return false;
+    }
+    return true;
+}
+
+// ============================================================================
+//                          测试用例
+// ============================================================================
+
+/**
+ * @brief 尺寸类别边界、对齐，以及同类别空闲块的复用与清零
+ */
+void test_meta_classes_alignment_and_reuse(void) {
+    TEST_ASSERT_EQUAL_UINT32(0, size_to_class(1));
+    TEST_ASSERT_EQUAL_UINT32(0, size_to_class(64));
+    TEST_ASSERT_EQUAL_UINT32(1, size_to_class(65));
+    TEST_ASSERT_EQUAL_UINT32(15, size_to_class(1024));
+    TEST_ASSERT_EQUAL_UINT32(16, size_to_class(1025));
+    TEST_ASSERT_EQUAL_UINT32(NVM_META_CLASS_COUNT - 1, size_to_class(NVM_META_MAX_SIZE));
+    TEST_ASSERT_EQUAL_size_t(2048, class_size(16));
+    TEST_ASSERT_EQUAL_size_t(NVM_META_MAX_SIZE, class_size(NVM_META_CLASS_COUNT - 1));
+    for (uint32_t sc = 0; sc < NVM_META_CLASS_COUNT; ++sc) {
+        TEST_ASSERT_EQUAL_UINT32(sc, size_to_class(class_size(sc)));
+        TEST_ASSERT_EQUAL_UINT32(sc, class_floor(class_size(sc)));
+    }
+
+    NvmMetaArenaStats before = get_stats(-1);
+    void* a = nvm_meta_alloc(24, -1);
+    void* b = nvm_meta_alloc(24, -1);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_EQUAL_UINT(0, (uintptr_t)a % CACHE_LINE_SIZE);
+    TEST_ASSERT_EQUAL_UINT(0, (uintptr_t)b % CACHE_LINE_SIZE);
+    TEST_ASSERT_TRUE(all_zero(a, 64));
+    TEST_ASSERT_EQUAL_UINT64(before.bytes_in_use + 128, get_stats(-1).bytes_in_use);
+
+    // 归还后同类别 (LIFO) 立即复用，且重新清零
+    memset(a, 0xAB, 64);
+    nvm_meta_free(a, 24, -1);
+    TEST_ASSERT_EQUAL_UINT64(before.bytes_cached + 64, get_stats(-1).bytes_cached);
+    void* c = nvm_meta_alloc(40, -1);
+    TEST_ASSERT_EQUAL_PTR(a, c);
+    TEST_ASSERT_TRUE(all_zero(c, 64));
+
+    nvm_meta_free(b, 24, -1);
+    nvm_meta_free(c, 40, -1);
+    TEST_ASSERT_EQUAL_UINT64(before.bytes_in_use, get_stats(-1).bytes_in_use);
+
+    // 参数校验与超大请求回退
+    TEST_ASSERT_NULL(nvm_meta_alloc(0, -1));
+    TEST_ASSERT_NULL(nvm_meta_alloc(64, MAX_NUMA_NODES));
+    TEST_ASSERT_EQUAL_INT(-1, nvm_meta_arena_stats(-2, &before));
+
+    before = get_stats(-1);
+    void* big = nvm_meta_alloc(NVM_META_MAX_SIZE + 1, -1);
+    TEST_ASSERT_NOT_NULL(big);
+    TEST_ASSERT_TRUE(all_zero(big, NVM_META_MAX_SIZE + 1));
+    TEST_ASSERT_EQUAL_UINT64(before.bytes_in_use, get_stats(-1).bytes_in_use);
+    nvm_meta_free(big, NVM_META_MAX_SIZE + 1, -1);
+}
+
+/**
+ * @brief 块用尽时映射新块，旧块剩余空间切进空闲链表而不是丢弃
+ */
+void test_meta_chunk_rollover_retires_remainder(void) {
+    // 节点 arena 与 -1 互不影响；使用独立节点使块边界可预测
+    const int node = 1;
+    const size_t obj = 40 * 1024;                        // 类别恰为 40KB
+    const uint32_t per_chunk = NVM_META_CHUNK_SIZE / obj;
+    const size_t remainder = NVM_META_CHUNK_SIZE - per_chunk * obj;
+    void* ptrs[64];
+
+    NvmMetaArenaStats before = get_stats(node);
+    TEST_ASSERT_EQUAL_UINT64(0, before.chunk_count);
+
+    for (uint32_t i = 0; i <= per_chunk; ++i) {
+        ptrs[i] = nvm_meta_alloc(obj, node);
+        TEST_ASSERT_NOT_NULL(ptrs[i]);
+    }
+    NvmMetaArenaStats after = get_stats(node);
+    TEST_ASSERT_EQUAL_UINT64(2, after.chunk_count);
+    TEST_ASSERT_EQUAL_UINT64(remainder, after.bytes_cached);
+
+    // 第一块按大页对齐，剩余空间可被对应类别复用
+    char* first_chunk = (char*)ptrs[0];
+    TEST_ASSERT_EQUAL_UINT(0, (uintptr_t)first_chunk % NVM_HUGE_PAGE_SIZE);
+    void* tail = nvm_meta_alloc(remainder, node);
+    TEST_ASSERT_EQUAL_PTR(first_chunk + per_chunk * obj, tail);
+    TEST_ASSERT_EQUAL_UINT64(0, get_stats(node).bytes_cached);
+
+    nvm_meta_free(tail, remainder, node);
+    for (uint32_t i = 0; i <= per_chunk; ++i) {
+        nvm_meta_free(ptrs[i], obj, node);
+    }
+    TEST_ASSERT_EQUAL_UINT64(0, get_stats(node).bytes_in_use);
+}
+
+// ----------------------------------------------------------------------------
+// 并发：各线程交替分配、填充、校验并归还不同尺寸的块
+// ----------------------------------------------------------------------------
+
+typedef struct LiveBlock {
+    unsigned char* ptr;
+    size_t         size;
+} LiveBlock;
+
+static uint64_t g_corrupted;
+
+static void* arena_worker(void* arg) {
+    unsigned char tag = (unsigned char)(uintptr_t)arg;
+    LiveBlock live[LIVE_PER_WORKER] = { { 0 } };
+    uint32_t seed = tag * 2654435761u;
+    uint64_t bad = 0;
+
+    for (int op = 0; op < OPS_PER_WORKER; ++op) {
+        seed = seed * 1103515245u + 12345u;
+        LiveBlock* slot = &live[(seed >> 8) % LIVE_PER_WORKER];
+        if (slot->ptr) {
+            for (size_t i = 0; i < slot->size; i += 61) {
+                if (slot->ptr[i] != tag) bad++;
+            }
+            nvm_meta_free(slot->ptr, slot->size, -1);
+            slot->ptr = NULL;
+        } else {
+            slot->size = 16 + (seed >> 16) % 4096;
+            slot->ptr = (unsigned char*)nvm_meta_alloc(slot->size, -1);
+            if (!slot->ptr || !all_zero(slot->ptr, slot->size)) {
+                bad++;
+                continue;
+            }
+            memset(slot->ptr, tag, slot->size);
+        }
+    }
+
+    for (int i = 0; i < LIVE_PER_WORKER; ++i) {
+        if (live[i].ptr) nvm_meta_free(live[i].ptr, live[i].size, -1);
+    }
+    __atomic_fetch_add(&g_corrupted, bad, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+void test_meta_concurrent_alloc_free(void) {
+    NvmMetaArenaStats before = get_stats(-1);
+    pthread_t workers[NUM_WORKERS];
+    g_corrupted = 0;
+
+    for (int i = 0; i < NUM_WORKERS; ++i) {
+        TEST_ASSERT_EQUAL_INT(0, pthread_create(&workers[i], NULL, arena_worker, (void*)(uintptr_t)(i + 1)));
+    }
+    for (int i = 0; i < NUM_WORKERS; ++i) {
+        pthread_join(workers[i], NULL);
+    }
+
+    TEST_ASSERT_EQUAL_UINT64(0, g_corrupted);
+    TEST_ASSERT_EQUAL_UINT64(before.bytes_in_use, get_stats(-1).bytes_in_use);
+}
+
+// ============================================================================
+//                          测试执行入口
+// ============================================================================
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_meta_classes_alignment_and_reuse);
+    RUN_TEST(test_meta_chunk_rollover_retires_remainder);
+    RUN_TEST(test_meta_concurrent_alloc_free);
+
+    return UNITY_END();
+}
@@ -0,0 +1,167 @@
+#include "unity.h"
+
+// 包含所有必要的头文件
+#include "NvmDefs.h"
+#include "NvmSlab.h"
+#include "NvmSpaceManager.h"
+#include "SlabHashTable.h"
+#include "NvmAllocator.h"
+
+// 包含所有组件的实现文件 (白盒测试)
+#include "NvmSlab.c"
+#include "NvmSpaceManager.c"
+#include "SlabHashTable.c"
+#include "NvmAllocator.c"
+
+#include <stdlib.h>
+#include <string.h>
+
+// 伪拓扑：两个节点，每个节点 2 个 Slab 的 NVM 区间
+#define SLABS_PER_NODE  2
+#define NODE_SIZE       (SLABS_PER_NODE * NVM_SLAB_SIZE)
+#define TOTAL_NVM_SIZE  (2 * NODE_SIZE)
+
+static void* mock_nvm_base = NULL;
+extern struct NvmAllocator* global_nvm_allocator;
+
+// 把所有 CPU 都映射到节点 1，使当前线程无论运行在哪个 CPU 上都属于节点 1
+static void install_fake_topology_all_on_node1(void) {
+    int cpu_to_node[MAX_CPUS];
+    for (int i = 0; i < MAX_CPUS; ++i) cpu_to_node[i] = 1;
+    nvm_numa_set_fake_topology(2, cpu_to_node, MAX_CPUS);
+}
+
+void setUp(void) {
+    mock_nvm_base = malloc(TOTAL_NVM_SIZE);
+    TEST_ASSERT_NOT_NULL(mock_nvm_base);
+    install_fake_topology_all_on_node1();
+
+    NvmNumaRange ranges[2] = {
+        { 0,         NODE_SIZE, 0 },
+        { NODE_SIZE, NODE_SIZE, 1 },
+    };
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create_numa(mock_nvm_base, ranges, 2));
+}
+
+void tearDown(void) {
+    nvm_allocator_destroy();
+    nvm_numa_clear_fake_topology();
+    free(mock_nvm_base);
+    mock_nvm_base = NULL;
+}
+
+// ============================================================================
+//                          测试用例
+// ============================================================================
+
+/**
+ * @brief 伪拓扑应覆盖真实拓扑，清除后恢复真实拓扑。
+ */
+void test_fake_topology_overrides_real(void) {
+    TEST_ASSERT_EQUAL_INT(2, nvm_numa_node_count());
+    TEST_ASSERT_EQUAL_INT(1, nvm_numa_node_of_cpu(0));
+    TEST_ASSERT_EQUAL_INT(0, nvm_numa_node_of_cpu(-1));
+
+    nvm_numa_clear_fake_topology();
+    TEST_ASSERT_TRUE(nvm_numa_node_count() >= 1);
+    TEST_ASSERT_TRUE(nvm_numa_node_of_cpu(0) >= 0);
+    install_fake_topology_all_on_node1();
+}
+
+/**
+ * @brief 每个节点拥有独立的中心堆，CPU 堆绑定到本地节点。
+ */
+void test_numa_central_heaps_layout(void) {
+    TEST_ASSERT_EQUAL_INT(2, global_nvm_allocator->central_heap_count);
+
+    for (int i = 0; i < 2; ++i) {
+        NvmCentralHeap* central = &global_nvm_allocator->central_heaps[i];
+        TEST_ASSERT_EQUAL_INT(i, central->numa_node);
+        TEST_ASSERT_EQUAL_UINT64((uint64_t)i * NODE_SIZE, central->range_offset);
+        TEST_ASSERT_NOT_NULL(central->space_manager);
+        TEST_ASSERT_NOT_NULL(central->slab_lookup_table);
+        TEST_ASSERT_EQUAL_UINT64((uint64_t)i * NODE_SIZE, central->space_manager->shards[0].head->nvm_offset);
+        TEST_ASSERT_EQUAL_UINT64(NODE_SIZE, central->space_manager->shards[0].head->size);
+    }
+
+    for (int cpu = 0; cpu < MAX_CPUS; ++cpu) {
+        TEST_ASSERT_EQUAL_INT(1, global_nvm_allocator->cpu_heaps[cpu].home_heap);
+    }
+}
+
+/**
+ * @brief 优先从本地节点分配；本地耗尽后回退远端；元数据位于本地节点。
+ */
+void test_numa_local_first_then_remote_fallback(void) {
+    const size_t block = 4096;
+    const int blocks_per_slab = NVM_SLAB_SIZE / block;
+    const int local_blocks = SLABS_PER_NODE * blocks_per_slab;
+    void** ptrs = malloc(sizeof(void*) * (local_blocks + 1));
+    TEST_ASSERT_NOT_NULL(ptrs);
+
+    // 1. 本地节点 (节点 1) 的所有块
+    for (int i = 0; i < local_blocks; ++i) {
+        ptrs[i] = nvm_malloc(block);
+        TEST_ASSERT_NOT_NULL(ptrs[i]);
+        uint64_t off = (uint64_t)((char*)ptrs[i] - (char*)mock_nvm_base);
+        TEST_ASSERT_TRUE_MESSAGE(off >= NODE_SIZE, "Allocation should come from the local node range.");
+    }
+    TEST_ASSERT_NULL(global_nvm_allocator->central_heaps[1].space_manager->shards[0].head);
+    TEST_ASSERT_EQUAL_UINT64(NODE_SIZE, global_nvm_allocator->central_heaps[0].space_manager->shards[0].head->size);
+
+    // 2. 本地耗尽，回退到远端节点 (节点 0)
+    ptrs[local_blocks] = nvm_malloc(block);
+    TEST_ASSERT_NOT_NULL(ptrs[local_blocks]);
+    uint64_t remote_off = (uint64_t)((char*)ptrs[local_blocks] - (char*)mock_nvm_base);
+    TEST_ASSERT_TRUE(remote_off < NODE_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(1, global_nvm_allocator->central_heaps[0].slab_lookup_table->count);
+
+    // 3. 元数据始终分配在 CPU 所在的本地节点
+    NvmSlab* remote_slab = slab_hashtable_lookup(global_nvm_allocator->central_heaps[0].slab_lookup_table,
+                                                 NVM_ALIGN_DOWN(remote_off, NVM_SLAB_SIZE));
+    TEST_ASSERT_NOT_NULL(remote_slab);
+    TEST_ASSERT_EQUAL_INT8(1, remote_slab->numa_node);
+
+    // 4. 释放路由到正确的中心堆
+    for (int i = 0; i <= local_blocks; ++i) {
+        nvm_free(ptrs[i]);
+    }
+    TEST_ASSERT_TRUE(nvm_slab_is_empty(remote_slab));
+    for (NvmSlab* s = global_nvm_allocator->cpu_heaps[nvm_get_current_cpu_id()].slab_lists[SC_4K]; s; s = s->next_in_chain) {
+        TEST_ASSERT_TRUE(nvm_slab_is_empty(s));
+    }
+
+    free(ptrs);
+}
+
+/**
+ * @brief 无效区间 (未对齐、重叠) 应被拒绝。
+ */
+void test_numa_invalid_ranges(void) {
+    nvm_allocator_destroy();
+
+    NvmNumaRange unaligned[1] = { { 4096, NODE_SIZE, 0 } };
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_create_numa(mock_nvm_base, unaligned, 1));
+
+    NvmNumaRange overlap[2] = {
+        { 0,             NODE_SIZE, 0 },
+        { NVM_SLAB_SIZE, NODE_SIZE, 1 },
+    };
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_create_numa(mock_nvm_base, overlap, 2));
+    TEST_ASSERT_EQUAL_INT(-1, nvm_allocator_create_numa(mock_nvm_base, overlap, 0));
+    TEST_ASSERT_NULL(global_nvm_allocator);
+}
+
+// ============================================================================
+//                          测试执行入口
+// ============================================================================
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_fake_topology_overrides_real);
+    RUN_TEST(test_numa_central_heaps_layout);
+    RUN_TEST(test_numa_local_first_then_remote_fallback);
+    RUN_TEST(test_numa_invalid_ranges);
+
+    return UNITY_END();
+}
@@ -0,0 +1,194 @@
+#include "unity.h"
+#include "NvmDefs.h"
+#include "NvmPersist.h"
+
+// 直接包含实现文件，便于白盒检查仿真器内部状态
+#include "NvmPersist.c"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_BUFFER_SIZE (64 * 1024)
+
+static unsigned char* g_buffer = NULL;
+
+void setUp(void) {
+    g_buffer = aligned_alloc(NVM_MEDIA_LINE_SIZE, TEST_BUFFER_SIZE);
+    TEST_ASSERT_NOT_NULL(g_buffer);
+    memset(g_buffer, 0, TEST_BUFFER_SIZE);
+
+    nvm_persist_emu_enable(true);
+    nvm_persist_emu_reset();
+}
+
+void tearDown(void) {
+    nvm_persist_emu_enable(false);
+    free(g_buffer);
+    g_buffer = NULL;
+}
+
+// ============================================================================
+//                          测试用例
+// ============================================================================
+
+/**
+ * @brief 探测结果应与平台一致，且对任意地址执行 flush 不崩溃。
+ */
+void test_persist_flush_kind_detection(void) {
+    NvmFlushKind kind = nvm_persist_flush_kind();
+#if defined(__x86_64__)
+    // x86_64 架构必然支持 CLFLUSH
+    TEST_ASSERT_NOT_EQUAL(NVM_FLUSH_NONE, kind);
+#endif
+    TEST_ASSERT_TRUE(kind <= NVM_FLUSH_CLWB);
+
+    // 非对齐地址与跨行长度
+    nvm_persist(g_buffer + 3, 200);
+    nvm_persist(NULL, 64);
+    nvm_persist(g_buffer, 0);
+}
+
+/**
+ * @brief 顺序写满整条介质行：每行只产生一次介质写，无读-改-写。
+ */
+void test_persist_emu_sequential_lines_no_amplification(void) {
+    const size_t lines = 16;
+    for (size_t i = 0; i < lines * NVM_MEDIA_LINE_SIZE; i += CACHE_LINE_SIZE) {
+        nvm_persist(g_buffer + i, CACHE_LINE_SIZE);
+    }
+
+    NvmPersistStats stats;
+    nvm_persist_emu_get_stats(&stats);
+
+    TEST_ASSERT_EQUAL_UINT64(lines * (NVM_MEDIA_LINE_SIZE / CACHE_LINE_SIZE), stats.flushed_lines);
+    TEST_ASSERT_EQUAL_UINT64(lines, stats.media_writes);
+    TEST_ASSERT_EQUAL_UINT64(0, stats.media_rmw);
+    TEST_ASSERT_EQUAL_FLOAT(1.0, (float)nvm_persist_emu_write_amplification(&stats));
+}
+
+/**
+ * @brief 每条介质行只写一个缓存行：每次回写都被放大为一次整行 RMW。
+ */
+void test_persist_emu_scattered_lines_amplified(void) {
+    const size_t lines = 128; // 超过写合并缓冲容量，触发逐出
+    for (size_t i = 0; i < lines; ++i) {
+        nvm_persist(g_buffer + i * NVM_MEDIA_LINE_SIZE, 8);
+    }
+
+    NvmPersistStats stats;
+    nvm_persist_emu_get_stats(&stats);
+
+    TEST_ASSERT_EQUAL_UINT64(lines, stats.flushed_lines);
+    TEST_ASSERT_EQUAL_UINT64(lines, stats.media_writes);
+    TEST_ASSERT_EQUAL_UINT64(lines, stats.media_rmw);
+    TEST_ASSERT_EQUAL_FLOAT((float)NVM_MEDIA_LINE_SIZE / CACHE_LINE_SIZE,
+                            (float)nvm_persist_emu_write_amplification(&stats));
+}
+
+/**
+ * @brief 关闭仿真后 flush 不再计数；reset 清空全部统计。
+ */
+void test_persist_emu_disable_and_reset(void) {
+    nvm_persist(g_buffer, CACHE_LINE_SIZE);
+    nvm_persist_emu_enable(false);
+    nvm_persist(g_buffer + NVM_MEDIA_LINE_SIZE, CACHE_LINE_SIZE);
+
+    NvmPersistStats stats;
+    nvm_persist_emu_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT64(1, stats.flushed_lines);
+
+    nvm_persist_emu_reset();
+    nvm_persist_emu_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT64(0, stats.flushed_lines);
+    TEST_ASSERT_EQUAL_UINT64(0, stats.media_writes);
+    TEST_ASSERT_EQUAL_FLOAT(0.0, (float)nvm_persist_emu_write_amplification(&stats));
+}
+
+/**
+ * @brief 非临时填充/拷贝：非对齐首尾与对齐主体都应写入正确，且按缓存行计入仿真。
+ */
+void test_persist_nt_memset_and_memcpy(void) {
+    const size_t offset = 5;                        // 非对齐起点
+    const size_t len = 4 * NVM_MEDIA_LINE_SIZE + 7; // 非对齐结尾
+    memset(g_buffer, 0xAA, TEST_BUFFER_SIZE);
+
+    nvm_persist_memset_nt(g_buffer + offset, 0, len);
+    TEST_ASSERT_EQUAL_HEX8(0xAA, g_buffer[offset - 1]);
+    TEST_ASSERT_EQUAL_HEX8(0xAA, g_buffer[offset + len]);
+    for (size_t i = 0; i < len; ++i) {
+        TEST_ASSERT_EQUAL_HEX8(0, g_buffer[offset + i]);
+    }
+
+    NvmPersistStats stats;
+    nvm_persist_emu_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT64((offset + len + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE, stats.flushed_lines);
+
+    // 拷贝到另一半缓冲区 (源与目标相对缓存行的偏移不同)
+    unsigned char* src = g_buffer + TEST_BUFFER_SIZE / 2 + 3;
+    for (size_t i = 0; i < len; ++i) src[i] = (unsigned char)(i * 31);
+    nvm_persist_memcpy_nt(g_buffer + offset, src, len);
+    TEST_ASSERT_EQUAL_MEMORY(src, g_buffer + offset, len);
+    TEST_ASSERT_EQUAL_HEX8(0xAA, g_buffer[offset + len]);
+
+    // 零长度与小于一行的长度
+    nvm_persist_memset_nt(g_buffer, 0x11, 0);
+    TEST_ASSERT_EQUAL_HEX8(0xAA, g_buffer[0]);
+    nvm_persist_memset_nt(g_buffer + 1, 0x11, 3);
+    TEST_ASSERT_EQUAL_HEX8(0x11, g_buffer[3]);
+    TEST_ASSERT_EQUAL_HEX8(0xAA, g_buffer[4]);
+}
+
+/**
+ * @brief 应用层持久化写入：短写走普通写 + flush，长写走流式写入，结果一致。
+ */
+void test_persist_memcpy_memset_dispatch(void) {
+    unsigned char src[1024];
+    for (size_t i = 0; i < sizeof(src); ++i) src[i] = (unsigned char)(i ^ 0x5A);
+
+    NvmStoreKind kind = nvm_persist_store_kind();
+#if defined(__SSE2__)
+    TEST_ASSERT_NOT_EQUAL(NVM_STORE_CACHED, kind);
+#endif
+    TEST_ASSERT_TRUE(kind <= NVM_STORE_NT_AVX512);
+
+    // 短写：阈值以下，flush 数等于覆盖的缓存行数
+    TEST_ASSERT_EQUAL_PTR(g_buffer + 10, nvm_memcpy_persist(g_buffer + 10, src, 100));
+    TEST_ASSERT_EQUAL_MEMORY(src, g_buffer + 10, 100);
+
+    NvmPersistStats stats;
+    nvm_persist_emu_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT64(2, stats.flushed_lines);
+
+    // 长写：跨越多条介质行的各种非对齐长度
+    for (size_t len = NVM_PERSIST_NT_THRESHOLD; len <= sizeof(src); len += 97) {
+        memset(g_buffer, 0, 2048);
+        nvm_memcpy_persist(g_buffer + 3, src, len);
+        TEST_ASSERT_EQUAL_MEMORY(src, g_buffer + 3, len);
+        TEST_ASSERT_EQUAL_HEX8(0, g_buffer[3 + len]);
+
+        nvm_memset_persist(g_buffer + 3, 0xC3, len);
+        TEST_ASSERT_EQUAL_HEX8(0xC3, g_buffer[3]);
+        TEST_ASSERT_EQUAL_HEX8(0xC3, g_buffer[2 + len]);
+        TEST_ASSERT_EQUAL_HEX8(0, g_buffer[3 + len]);
+    }
+
+    // 空参数原样返回
+    TEST_ASSERT_NULL(nvm_memcpy_persist(NULL, src, 8));
+    TEST_ASSERT_EQUAL_PTR(g_buffer, nvm_memset_persist(g_buffer, 0, 0));
+}
+
+// ============================================================================
+//                          测试执行入口
+// ============================================================================
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_persist_flush_kind_detection);
+    RUN_TEST(test_persist_emu_sequential_lines_no_amplification);
+    RUN_TEST(test_persist_emu_scattered_lines_amplified);
+    RUN_TEST(test_persist_emu_disable_and_reset);
+    RUN_TEST(test_persist_nt_memset_and_memcpy);
+    RUN_TEST(test_persist_memcpy_memset_dispatch);
+
+    return UNITY_END();
+}
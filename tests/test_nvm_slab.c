@@ -2,6 +2,8 @@
 #include "NvmSlab.h"
 #include "NvmSlab.c"
 #include <stdlib.h>
+#include <stddef.h>
+#include <pthread.h>
 
 #define SIMULATED_NVM_SIZE (2 * 1024 * 1024) // 2MB
 static void* g_simulated_nvm_pool = NULL;    // 指向我们模拟的NVM空间的指针
@@ -115,11 +117,12 @@ void test_slab_alloc_free_cache_behavior(void) {
     uint32_t* allocated_indices = malloc(sizeof(uint32_t) * total_blocks);
     TEST_ASSERT_NOT_NULL(allocated_indices);
 
-    // --- 子测试 1: 首次分配触发 refill_cache ---
+    // --- 子测试 1: 新 Slab 直接推进切分游标，不填充缓存 ---
     ret = nvm_slab_alloc(slab, &allocated_indices[0]);
     TEST_ASSERT_EQUAL_INT(0, ret);
     TEST_ASSERT_EQUAL_UINT32(1, slab->allocated_block_count);
-    TEST_ASSERT_EQUAL_UINT32(batch_size - 1, slab->cache_count);
+    TEST_ASSERT_EQUAL_UINT32(0, slab->cache_count);
+    TEST_ASSERT_EQUAL_UINT32(1, slab->bump_cursor);
 
     // --- 子测试 2: 耗尽第一批缓存 (快速路径测试) ---
     for (int i = 1; i < batch_size; ++i) {
@@ -330,6 +333,407 @@ void test_slab_behavior_with_various_sizes(void) {
 
 
 
+/**
+ * @brief 测试介质行放置模式的 refill 顺序。
+ *
+ * 预先在前 10 条介质行中各占用一个块制造"空洞"：
+ * 默认模式会从块 1 开始逐个填补空洞，跨越多条半占用的介质行；
+ * 介质行模式应跳过半占用行，从第一条完全空闲的介质行开始整行交付。
+ */
+void test_slab_media_line_placement(void) {
+    const uint32_t per_line = NVM_MEDIA_LINE_SIZE / 64; // SC_64B: 每行 4 块
+    const uint32_t holed_lines = 10;
+    uint32_t block_idx;
+
+    // --- 子测试 1: 默认模式填补空洞 ---
+    NvmSlab* slab = nvm_slab_create(SC_64B, 0);
+    TEST_ASSERT_NOT_NULL(slab);
+    for (uint32_t l = 0; l < holed_lines; ++l) {
+        TEST_ASSERT_EQUAL_INT(0, nvm_slab_set_bitmap_at_idx(slab, l * per_line));
+    }
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &block_idx));
+    TEST_ASSERT_EQUAL_UINT32(1, block_idx);
+    nvm_slab_destroy(slab);
+
+    // --- 子测试 2: 介质行模式整行交付 ---
+    slab = nvm_slab_create(SC_64B, 0);
+    TEST_ASSERT_NOT_NULL(slab);
+    TEST_ASSERT_TRUE(nvm_slab_enable_media_line_placement(slab));
+    for (uint32_t l = 0; l < holed_lines; ++l) {
+        TEST_ASSERT_EQUAL_INT(0, nvm_slab_set_bitmap_at_idx(slab, l * per_line));
+    }
+
+    for (uint32_t i = 0; i < SLAB_CACHE_BATCH_SIZE; ++i) {
+        TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &block_idx));
+        TEST_ASSERT_EQUAL_UINT32(holed_lines * per_line + i, block_idx);
+    }
+
+    // --- 子测试 3: 整行耗尽后退化为填补空洞，直到 Slab 写满 ---
+    uint32_t alloc_count = holed_lines + SLAB_CACHE_BATCH_SIZE;
+    while (nvm_slab_alloc(slab, &block_idx) == 0) {
+        alloc_count++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(slab->total_block_count, alloc_count);
+    TEST_ASSERT_TRUE(nvm_slab_is_full(slab));
+    nvm_slab_destroy(slab);
+
+    // --- 子测试 4: 块大小不小于介质行的类别不适用 ---
+    slab = nvm_slab_create(SC_256B, 0);
+    TEST_ASSERT_NOT_NULL(slab);
+    TEST_ASSERT_FALSE(nvm_slab_enable_media_line_placement(slab));
+    TEST_ASSERT_EQUAL_UINT8(0, slab->flags);
+    nvm_slab_destroy(slab);
+}
+
+/**
+ * @brief 预清零 Slab 的脏块水位线：释放过的块及其之前的块不再视为干净块。
+ */
+void test_slab_prezeroed_watermark(void) {
+    uint32_t block_idx;
+    NvmSlab* slab = nvm_slab_create(SC_64B, 0);
+    TEST_ASSERT_NOT_NULL(slab);
+
+    // 未标记预清零时一律视为脏块
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &block_idx));
+    TEST_ASSERT_FALSE(nvm_slab_block_is_zeroed(slab, block_idx));
+    nvm_slab_destroy(slab);
+
+    slab = nvm_slab_create(SC_64B, 0);
+    TEST_ASSERT_NOT_NULL(slab);
+    nvm_slab_mark_prezeroed(slab);
+
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &block_idx));
+    TEST_ASSERT_EQUAL_UINT32(0, block_idx);
+    TEST_ASSERT_TRUE(nvm_slab_block_is_zeroed(slab, block_idx));
+
+    // 释放块 0 后，块 0 变脏，更高的块仍干净
+    nvm_slab_free(slab, 0);
+    TEST_ASSERT_FALSE(nvm_slab_block_is_zeroed(slab, 0));
+    TEST_ASSERT_TRUE(nvm_slab_block_is_zeroed(slab, 1));
+
+    // 恢复出的块承载旧数据
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_set_bitmap_at_idx(slab, 100));
+    TEST_ASSERT_FALSE(nvm_slab_block_is_zeroed(slab, 50));
+    TEST_ASSERT_TRUE(nvm_slab_block_is_zeroed(slab, 101));
+
+    nvm_slab_destroy(slab);
+}
+
+/**
+ * @brief 描述符按缓存行分组；远程释放只写暂存区，持有者在缓存耗尽时吸收，暂存区满时由释放者交还。
+ */
+void test_slab_remote_free_staging(void) {
+    // 三组字段各自从新的缓存行开始
+    TEST_ASSERT_EQUAL_UINT(0, offsetof(NvmSlab, lock) % CACHE_LINE_SIZE);
+    TEST_ASSERT_EQUAL_UINT(0, offsetof(NvmSlab, remote_lock) % CACHE_LINE_SIZE);
+    TEST_ASSERT_EQUAL_UINT(0, offsetof(NvmSlab, bitmap) % CACHE_LINE_SIZE);
+    TEST_ASSERT_TRUE(offsetof(NvmSlab, total_block_count) < offsetof(NvmSlab, lock));
+    TEST_ASSERT_TRUE(offsetof(NvmSlab, free_block_buffer) + sizeof(((NvmSlab*)0)->free_block_buffer)
+                     <= offsetof(NvmSlab, remote_lock));
+
+    NvmSlab* slab = nvm_slab_create(SC_4K, 0);
+    TEST_ASSERT_NOT_NULL(slab);
+    TEST_ASSERT_EQUAL_UINT(0, (uintptr_t)slab % CACHE_LINE_SIZE);
+
+    // 分配掉第一批缓存 (SLAB_CACHE_BATCH_SIZE 个)
+    uint32_t idxs[SLAB_CACHE_BATCH_SIZE];
+    for (uint32_t i = 0; i < SLAB_CACHE_BATCH_SIZE; ++i) {
+        TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &idxs[i]));
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, slab->cache_count);
+
+    // 远程释放不触碰本地缓存与已分配计数，但实际占用随之减少
+    for (uint32_t i = 0; i < 4; ++i) {
+        nvm_slab_free_remote(slab, idxs[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT32(4, slab->remote_count);
+    TEST_ASSERT_EQUAL_UINT32(0, slab->cache_count);
+    TEST_ASSERT_EQUAL_UINT32(SLAB_CACHE_BATCH_SIZE, slab->allocated_block_count);
+    TEST_ASSERT_EQUAL_UINT32(SLAB_CACHE_BATCH_SIZE - 4, nvm_slab_used_blocks(slab));
+
+    // 缓存耗尽时先吸收暂存区，重用远程释放的块而不是扫描位图
+    uint32_t block_idx;
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &block_idx));
+    TEST_ASSERT_EQUAL_UINT32(idxs[0], block_idx);
+    TEST_ASSERT_EQUAL_UINT32(0, slab->remote_count);
+    TEST_ASSERT_EQUAL_UINT32(3, slab->cache_count);
+    TEST_ASSERT_EQUAL_UINT32(SLAB_CACHE_BATCH_SIZE - 3, nvm_slab_used_blocks(slab));
+    for (uint32_t i = 1; i < 4; ++i) {
+        TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &idxs[i]));
+    }
+
+    // 暂存区满后的下一次远程释放把整批块交还持有者缓存
+    uint32_t extra;
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &extra));
+    for (uint32_t i = 0; i < SLAB_REMOTE_BUFFER_SIZE && i < SLAB_CACHE_BATCH_SIZE; ++i) {
+        nvm_slab_free_remote(slab, idxs[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT32(SLAB_REMOTE_BUFFER_SIZE, slab->remote_count);
+    TEST_ASSERT_EQUAL_UINT32(1, nvm_slab_used_blocks(slab));
+
+    nvm_slab_free_remote(slab, extra);
+    TEST_ASSERT_EQUAL_UINT32(0, slab->remote_count);
+    TEST_ASSERT_EQUAL_UINT32(0, slab->allocated_block_count);
+    TEST_ASSERT_TRUE(nvm_slab_is_empty(slab));
+
+    nvm_slab_free_remote(slab, slab->total_block_count);   // 越界索引被拒绝
+    TEST_ASSERT_EQUAL_UINT32(0, slab->remote_count);
+    TEST_ASSERT_FALSE(nvm_slab_is_full(slab));
+
+    nvm_slab_destroy(slab);
+}
+
+/**
+ * @brief 切分游标：新 Slab 顺序交付且不扫描位图，释放的块优先复用；切分完毕或恢复出游标之后的块时转入位图模式。
+ */
+void test_slab_bump_cursor_before_bitmap(void) {
+    NvmSlab* slab = nvm_slab_create(SC_4K, 0);
+    TEST_ASSERT_NOT_NULL(slab);
+    const uint32_t total = slab->total_block_count;
+
+    uint32_t idx;
+    for (uint32_t i = 0; i < 100; ++i) {
+        TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &idx));
+        TEST_ASSERT_EQUAL_UINT32(i, idx);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, slab->cache_count);
+    TEST_ASSERT_EQUAL_UINT32(100, slab->bump_cursor);
+
+    // 位图按 64 块整字预标记；对外复制的占用位图不含尚未交付的块
+    TEST_ASSERT_EQUAL_HEX8(0xFF, slab->bitmap[127 / 8]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, slab->bitmap[128 / 8]);
+    unsigned char live[(NVM_SLAB_SIZE / 4096) / 8];
+    TEST_ASSERT_EQUAL_INT(100, nvm_slab_copy_live_bitmap(slab, live));
+    TEST_ASSERT_EQUAL_HEX8(0x0F, live[96 / 8]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, live[104 / 8]);
+
+    // 释放的块进入缓存，先于继续切分被复用
+    nvm_slab_free(slab, 7);
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &idx));
+    TEST_ASSERT_EQUAL_UINT32(7, idx);
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &idx));
+    TEST_ASSERT_EQUAL_UINT32(100, idx);
+
+    // 切分完毕后由位图填充缓存，回写位图的空洞可再次分配
+    while (slab->bump_cursor < total) TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &idx));
+    TEST_ASSERT_TRUE(nvm_slab_is_full(slab));
+    for (uint32_t i = 0; i < SLAB_CACHE_SIZE + 1; ++i) nvm_slab_free(slab, 200 + i);
+    TEST_ASSERT_EQUAL_UINT32(SLAB_CACHE_BATCH_SIZE + 1, slab->cache_count);
+    uint32_t count = 0;
+    while (nvm_slab_alloc(slab, &idx) == 0) count++;
+    TEST_ASSERT_EQUAL_UINT32(SLAB_CACHE_SIZE + 1, count);
+    nvm_slab_destroy(slab);
+
+    // 恢复游标之后的块：结束切分并清除预标记，空闲块由位图找回
+    slab = nvm_slab_create(SC_4K, 0);
+    TEST_ASSERT_NOT_NULL(slab);
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &idx));
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_set_bitmap_at_idx(slab, 300));
+    TEST_ASSERT_EQUAL_UINT32(total, slab->bump_cursor);
+    TEST_ASSERT_EQUAL_HEX8(0x01, slab->bitmap[0]);
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &idx));
+    TEST_ASSERT_EQUAL_UINT32(1, idx);
+    nvm_slab_destroy(slab);
+}
+
+/**
+ * @brief 易失模式：空闲块内嵌链表指针，分配/释放为弹出/压入，远程链表整条接管，描述符不带位图。
+ */
+void test_slab_volatile_intrusive_free_list(void) {
+    char* base = (char*)g_simulated_nvm_pool;
+    TEST_ASSERT_NULL(nvm_slab_create_volatile(SC_8B, 0, NULL, -1));
+
+    NvmSlab* slab = nvm_slab_create_volatile(SC_8B, 0, base, -1);
+    TEST_ASSERT_NOT_NULL(slab);
+    TEST_ASSERT_TRUE(slab->flags & NVM_SLAB_FLAG_VOLATILE);
+    TEST_ASSERT_EQUAL_size_t(sizeof(NvmSlab), get_metadata_size(slab->total_block_count, true, 0));
+    TEST_ASSERT_FALSE(nvm_slab_enable_media_line_placement(slab));
+    TEST_ASSERT_EQUAL_INT(-1, nvm_slab_set_bitmap_at_idx(slab, 0));
+
+    // 从未交付过的块按顺序切分
+    uint32_t a, b, c;
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &a));
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &b));
+    TEST_ASSERT_EQUAL_UINT32(0, a);
+    TEST_ASSERT_EQUAL_UINT32(1, b);
+
+    // 释放把链表指针写进块本身，再次分配按 LIFO 弹出
+    nvm_slab_free(slab, a);
+    nvm_slab_free(slab, b);
+    TEST_ASSERT_EQUAL_PTR(base + 8, slab->free_head);
+    TEST_ASSERT_EQUAL_PTR(base, *(void**)(base + 8));
+    TEST_ASSERT_TRUE(nvm_slab_is_empty(slab));
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &c));
+    TEST_ASSERT_EQUAL_UINT32(1, c);
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &c));
+    TEST_ASSERT_EQUAL_UINT32(0, c);
+    TEST_ASSERT_NULL(slab->free_head);
+
+    // 远程释放不受暂存区容量限制，本地链表耗尽时整条接管
+    uint32_t remote_n = SLAB_REMOTE_BUFFER_SIZE * 2;
+    for (uint32_t i = 2; i < 2 + remote_n; ++i) {
+        TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &c));
+        TEST_ASSERT_EQUAL_UINT32(i, c);
+    }
+    for (uint32_t i = 2; i < 2 + remote_n; ++i) {
+        nvm_slab_free_remote(slab, i);
+    }
+    TEST_ASSERT_EQUAL_UINT32(remote_n, slab->remote_count);
+    TEST_ASSERT_EQUAL_UINT32(2, nvm_slab_used_blocks(slab));
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &c));
+    TEST_ASSERT_EQUAL_UINT32(1 + remote_n, c);
+    TEST_ASSERT_EQUAL_UINT32(0, slab->remote_count);
+    TEST_ASSERT_NULL(slab->remote_head);
+    TEST_ASSERT_EQUAL_UINT32(3, nvm_slab_used_blocks(slab));
+    TEST_ASSERT_EQUAL_UINT32(2 + remote_n, slab->dirty_watermark);
+
+    // 切分完全部块后 Slab 满；释放一个后恰好可再分配它
+    while (nvm_slab_alloc(slab, &c) == 0) {}
+    TEST_ASSERT_TRUE(nvm_slab_is_full(slab));
+    nvm_slab_free(slab, slab->total_block_count - 1);
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &c));
+    TEST_ASSERT_EQUAL_UINT32(slab->total_block_count - 1, c);
+    TEST_ASSERT_EQUAL_INT(-1, nvm_slab_try_alloc(slab, &c));
+
+    nvm_slab_destroy(slab);
+}
+
+/**
+ * @brief 原子位图引擎：不经缓存与暂存区，直接在位图上抢占与清除；重复释放被拒绝，多线程远程释放与分配并发时计数与位图一致。
+ */
+#define ATOMIC_HAMMER_THREADS 4
+#define ATOMIC_HAMMER_ROUNDS  20000
+
+typedef struct AtomicHammerArg {
+    NvmSlab* slab;
+    uint32_t allocs;
+} AtomicHammerArg;
+
+static void* atomic_hammer_worker(void* arg) {
+    AtomicHammerArg* a = (AtomicHammerArg*)arg;
+    uint32_t held[8];
+    for (uint32_t r = 0; r < ATOMIC_HAMMER_ROUNDS; ++r) {
+        uint32_t n = 0;
+        while (n < 8 && nvm_slab_try_alloc(a->slab, &held[n]) == 0) n++;
+        a->allocs += n;
+        for (uint32_t i = 0; i < n; ++i) nvm_slab_free_remote(a->slab, held[i]);
+    }
+    return NULL;
+}
+
+void test_slab_atomic_bitmap_engine(void) {
+    NvmSlab* slab = nvm_slab_create_atomic(SC_4K, 0, -1);
+    TEST_ASSERT_NOT_NULL(slab);
+    TEST_ASSERT_TRUE(slab->flags & NVM_SLAB_FLAG_ATOMIC);
+    const uint32_t total = slab->total_block_count;
+
+    // 从最低空闲位起顺序交付，位图即时反映占用
+    uint32_t idx;
+    for (uint32_t i = 0; i < 100; ++i) {
+        TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &idx));
+        TEST_ASSERT_EQUAL_UINT32(i, idx);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, slab->cache_count);
+    TEST_ASSERT_EQUAL_UINT32(100, nvm_slab_used_blocks(slab));
+    unsigned char live[(NVM_SLAB_SIZE / 4096) / 8];
+    TEST_ASSERT_EQUAL_INT(100, nvm_slab_copy_live_bitmap(slab, live));
+    TEST_ASSERT_EQUAL_HEX8(0x0F, live[96 / 8]);
+
+    // 本地与远程释放都直接清位，不经暂存区；重复释放不改变计数
+    nvm_slab_free(slab, 7);
+    nvm_slab_free_remote(slab, 9);
+    TEST_ASSERT_EQUAL_UINT32(0, slab->remote_count);
+    TEST_ASSERT_EQUAL_UINT32(98, nvm_slab_used_blocks(slab));
+    nvm_slab_free_remote(slab, 9);
+    TEST_ASSERT_EQUAL_UINT32(98, nvm_slab_used_blocks(slab));
+
+    // 扫描从提示字开始，释放不回拨提示；绕回后仍能找到前面的空洞
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_try_alloc(slab, &idx));
+    TEST_ASSERT_EQUAL_UINT32(100, idx);
+    uint32_t allocated = 101 - 2;
+    while (nvm_slab_alloc(slab, &idx) == 0) allocated++;
+    TEST_ASSERT_EQUAL_UINT32(total, allocated);
+    TEST_ASSERT_TRUE(nvm_slab_is_full(slab));
+
+    // 满后分配失败且不泄漏预留计数
+    TEST_ASSERT_EQUAL_INT(-1, nvm_slab_try_alloc(slab, &idx));
+    TEST_ASSERT_EQUAL_UINT32(total, slab->allocated_block_count);
+    uint32_t batch[3] = { 1, 300, total };   // 越界索引被跳过
+    nvm_slab_free_batch(slab, batch, 3);
+    TEST_ASSERT_EQUAL_UINT32(total - 2, nvm_slab_used_blocks(slab));
+    nvm_slab_destroy(slab);
+
+    // 恢复时直接置位，计数随之增加，重复恢复不重复计数
+    slab = nvm_slab_create_atomic(SC_4K, 0, -1);
+    TEST_ASSERT_NOT_NULL(slab);
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_set_bitmap_at_idx(slab, 0));
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_set_bitmap_at_idx(slab, 300));
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_set_bitmap_at_idx(slab, 300));
+    TEST_ASSERT_EQUAL_UINT32(2, nvm_slab_used_blocks(slab));
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &idx));
+    TEST_ASSERT_EQUAL_UINT32(1, idx);
+    nvm_slab_destroy(slab);
+
+    // 并发：各线程反复抢占后远程释放，结束时 Slab 为空且位图全清
+    slab = nvm_slab_create_atomic(SC_4K, 0, -1);
+    TEST_ASSERT_NOT_NULL(slab);
+    pthread_t tids[ATOMIC_HAMMER_THREADS];
+    AtomicHammerArg args[ATOMIC_HAMMER_THREADS];
+    for (int i = 0; i < ATOMIC_HAMMER_THREADS; ++i) {
+        args[i] = (AtomicHammerArg){ slab, 0 };
+        TEST_ASSERT_EQUAL_INT(0, pthread_create(&tids[i], NULL, atomic_hammer_worker, &args[i]));
+    }
+    for (int i = 0; i < ATOMIC_HAMMER_THREADS; ++i) {
+        pthread_join(tids[i], NULL);
+        TEST_ASSERT_TRUE(args[i].allocs > 0);
+    }
+    TEST_ASSERT_TRUE(nvm_slab_is_empty(slab));
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_copy_live_bitmap(slab, live));
+    nvm_slab_destroy(slab);
+}
+
+/**
+ * @brief 运行时加深环形缓存：缓冲区随描述符按深度分配 (向上取 2 的幂)，深度超过默认值时仍按 FIFO 工作。
+ */
+void test_slab_cache_depth_beyond_default(void) {
+    TEST_ASSERT_EQUAL_INT(-1, nvm_slab_set_cache_params(SLAB_CACHE_MAX_SIZE + 1, 8));
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_set_cache_params(200, 100));
+
+    NvmSlab* slab = nvm_slab_create(SC_4K, 0);
+    TEST_ASSERT_NOT_NULL(slab);
+    TEST_ASSERT_EQUAL_UINT16(200, slab->cache_depth);
+    TEST_ASSERT_EQUAL_UINT16(255, slab->cache_mask);
+    TEST_ASSERT_EQUAL_PTR((char*)slab + get_ring_offset(slab->total_block_count), slab->free_block_buffer);
+    TEST_ASSERT_TRUE((char*)slab->free_block_buffer >= (char*)slab->bitmap + slab->total_block_count / 8);
+
+    uint32_t idx;
+    for (uint32_t i = 0; i < 300; ++i) TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &idx));
+
+    // 200 个释放全部留在缓存；第 201 个回写一半后再入队
+    for (uint32_t i = 0; i < 200; ++i) nvm_slab_free(slab, i);
+    TEST_ASSERT_EQUAL_UINT32(200, slab->cache_count);
+    nvm_slab_free(slab, 200);
+    TEST_ASSERT_EQUAL_UINT32(101, slab->cache_count);
+
+    // 分配按入队顺序取出，跨过缓冲区末尾回绕
+    uint32_t first;
+    TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &first));
+    for (uint32_t i = 1; i < 101; ++i) {
+        TEST_ASSERT_EQUAL_INT(0, nvm_slab_alloc(slab, &idx));
+    }
+    TEST_ASSERT_EQUAL_UINT32(200, idx);
+    TEST_ASSERT_EQUAL_UINT32(0, slab->cache_count);
+    nvm_slab_destroy(slab);
+
+    // 原子位图引擎不带环形缓冲区
+    slab = nvm_slab_create_atomic(SC_4K, 0, -1);
+    TEST_ASSERT_NOT_NULL(slab);
+    TEST_ASSERT_NULL(slab->free_block_buffer);
+    nvm_slab_destroy(slab);
+
+    nvm_slab_set_cache_params(SLAB_CACHE_SIZE, SLAB_CACHE_BATCH_SIZE);
+}
+
 // ============================================================================
 // main 函数 - 测试执行入口
 // ============================================================================
@@ -340,6 +744,13 @@ int main(void) {
     RUN_TEST(test_nvm_slab_creation_and_destruction);
     RUN_TEST(test_slab_alloc_free_cache_behavior);
     RUN_TEST(test_slab_behavior_with_various_sizes);
+    RUN_TEST(test_slab_media_line_placement);
+    RUN_TEST(test_slab_prezeroed_watermark);
+    RUN_TEST(test_slab_remote_free_staging);
+    RUN_TEST(test_slab_bump_cursor_before_bitmap);
+    RUN_TEST(test_slab_volatile_intrusive_free_list);
+    RUN_TEST(test_slab_atomic_bitmap_engine);
+    RUN_TEST(test_slab_cache_depth_beyond_default);
 
     return UNITY_END();
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "SlabHashTable.c"
 
 #include <stdlib.h>
+#include <pthread.h>
 
 // A prime number is a good choice for capacity to improve hash distribution.
 #define TEST_HT_CAPACITY 17
@@ -180,6 +181,57 @@ void test_hashtable_remove(void) {
     slab_hashtable_destroy(table);
 }
 
+/**
+ * @brief 无锁查找与插入/移除并发：查找只会返回 NULL 或该键对应的值，
+ *        被移除的节点经纪元回收延迟释放。
+ */
+#define CONCURRENT_KEYS   64
+#define CONCURRENT_ROUNDS 2000
+
+typedef struct LookupArg {
+    SlabHashTable* table;
+    volatile int   stop;
+    uint64_t       mismatches;
+} LookupArg;
+
+static void* lookup_worker(void* arg) {
+    LookupArg* a = (LookupArg*)arg;
+    uint64_t mismatches = 0;
+    while (!a->stop) {
+        for (uint64_t k = 0; k < CONCURRENT_KEYS; ++k) {
+            NvmSlab* slab = slab_hashtable_lookup(a->table, k * NVM_SLAB_SIZE);
+            if (slab && slab != (NvmSlab*)((k + 1) << 12)) mismatches++;
+        }
+    }
+    a->mismatches = mismatches;
+    return NULL;
+}
+
+void test_hashtable_concurrent_lookup_and_remove(void) {
+    SlabHashTable* table = slab_hashtable_create(TEST_HT_CAPACITY);
+    LookupArg arg = { table, 0, 0 };
+    pthread_t reader;
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&reader, NULL, lookup_worker, &arg));
+
+    for (int round = 0; round < CONCURRENT_ROUNDS; ++round) {
+        for (uint64_t k = 0; k < CONCURRENT_KEYS; ++k) {
+            TEST_ASSERT_EQUAL_INT(0, slab_hashtable_insert(table, k * NVM_SLAB_SIZE, (NvmSlab*)((k + 1) << 12)));
+        }
+        for (uint64_t k = 0; k < CONCURRENT_KEYS; ++k) {
+            TEST_ASSERT_NOT_NULL(slab_hashtable_remove(table, k * NVM_SLAB_SIZE));
+        }
+    }
+
+    arg.stop = 1;
+    pthread_join(reader, NULL);
+    TEST_ASSERT_EQUAL_UINT64(0, arg.mismatches);
+    TEST_ASSERT_EQUAL_UINT32(0, table->count);
+
+    nvm_epoch_barrier();
+    TEST_ASSERT_EQUAL_UINT64(0, nvm_epoch_pending());
+    slab_hashtable_destroy(table);
+}
+
 
 // ============================================================================
 //                          测试执行入口
@@ -191,6 +243,7 @@ int main(void) {
     RUN_TEST(test_hashtable_insert_and_lookup);
     RUN_TEST(test_hashtable_collisions);
     RUN_TEST(test_hashtable_remove);
+    RUN_TEST(test_hashtable_concurrent_lookup_and_remove);
 
     return UNITY_END();
 }
\ No newline at end of file
@@ -0,0 +1,174 @@
+#include "unity.h"
+
+// 包含所有必要的头文件
+#include "NvmDefs.h"
+#include "NvmSpaceManager.h"
+#include "NvmSlabPool.h"
+
+// 包含所有组件的实现文件 (白盒测试)
+#include "NvmSpaceManager.c"
+#include "NvmSlabPool.c"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define NUM_SLABS      4
+#define TOTAL_NVM_SIZE (NUM_SLABS * NVM_SLAB_SIZE)
+
+static void* mock_nvm_base = NULL;
+static FreeSpaceManager* manager = NULL;
+
+void setUp(void) {
+    mock_nvm_base = malloc(TOTAL_NVM_SIZE);
+    TEST_ASSERT_NOT_NULL(mock_nvm_base);
+    memset(mock_nvm_base, 0xFF, TOTAL_NVM_SIZE);
+
+    manager = space_manager_create(TOTAL_NVM_SIZE, 0);
+    TEST_ASSERT_NOT_NULL(manager);
+}
+
+void tearDown(void) {
+    space_manager_destroy(manager);
+    manager = NULL;
+    free(mock_nvm_base);
+    mock_nvm_base = NULL;
+}
+
+// 轮询等待后台线程补充到指定数量 (最多约 5 秒)
+static uint32_t wait_available(NvmSlabPool* pool, uint32_t expected) {
+    uint32_t available = 0;
+    for (int i = 0; i < 500; ++i) {
+        available = slab_pool_available(pool);
+        if (available == expected) break;
+        usleep(10 * 1000);
+    }
+    return available;
+}
+
+static bool slab_is_zeroed(uint64_t offset) {
+    const unsigned char* p = (const unsigned char*)mock_nvm_base + offset;
+    for (size_t i = 0; i < NVM_SLAB_SIZE; ++i) {
+        if (p[i] != 0) return false;
+    }
+    return true;
+}
+
+// ============================================================================
+//                          测试用例
+// ============================================================================
+
+/**
+ * @brief 参数校验与深度截断。
+ */
+void test_slab_pool_invalid_params(void) {
+    uint64_t offset;
+    TEST_ASSERT_NULL(slab_pool_create(NULL, mock_nvm_base, 1, NVM_SLAB_POOL_ZERO));
+    TEST_ASSERT_NULL(slab_pool_create(manager, NULL, 1, NVM_SLAB_POOL_ZERO));
+    TEST_ASSERT_EQUAL_INT(-1, slab_pool_take(NULL, &offset));
+    TEST_ASSERT_EQUAL_UINT32(0, slab_pool_available(NULL));
+    slab_pool_destroy(NULL);
+
+    NvmSlabPool* pool = slab_pool_create(manager, mock_nvm_base, NVM_SLAB_POOL_MAX_DEPTH + 100, NVM_SLAB_POOL_ZERO);
+    TEST_ASSERT_NOT_NULL(pool);
+    TEST_ASSERT_EQUAL_UINT32(NVM_SLAB_POOL_MAX_DEPTH, pool->depth);
+    slab_pool_destroy(pool);
+}
+
+/**
+ * @brief 后台线程补充到目标深度，取出的 Slab 已整体清零，取走后自动补充。
+ */
+void test_slab_pool_fill_and_take(void) {
+    NvmSlabPool* pool = slab_pool_create(manager, mock_nvm_base, 2, NVM_SLAB_POOL_ZERO);
+    TEST_ASSERT_NOT_NULL(pool);
+    TEST_ASSERT_EQUAL_UINT32(2, wait_available(pool, 2));
+
+    uint64_t offset;
+    TEST_ASSERT_EQUAL_INT(0, slab_pool_take(pool, &offset));
+    TEST_ASSERT_EQUAL_UINT64(0, offset % NVM_SLAB_SIZE);
+    TEST_ASSERT_TRUE(slab_is_zeroed(offset));
+
+    // 取走一个后应补充回目标深度
+    TEST_ASSERT_EQUAL_UINT32(2, wait_available(pool, 2));
+
+    // 销毁后池中剩余的 2 个 Slab 归还，加上取走的 1 个，剩余 3 个
+    slab_pool_destroy(pool);
+    TEST_ASSERT_EQUAL_UINT64(TOTAL_NVM_SIZE - NVM_SLAB_SIZE, manager->shards[0].head->size
+        + (manager->shards[0].head->next ? manager->shards[0].head->next->size : 0));
+    space_manager_free_slab(manager, offset);
+    TEST_ASSERT_EQUAL_UINT64(TOTAL_NVM_SIZE, manager->shards[0].head->size);
+}
+
+/**
+ * @brief 空间耗尽时池为空、take 失败；深度调为 0 后不再补充。
+ */
+void test_slab_pool_exhaustion_and_depth(void) {
+    NvmSlabPool* pool = slab_pool_create(manager, mock_nvm_base, NVM_SLAB_POOL_MAX_DEPTH, NVM_SLAB_POOL_ZERO);
+    TEST_ASSERT_NOT_NULL(pool);
+    TEST_ASSERT_EQUAL_UINT32(NUM_SLABS, wait_available(pool, NUM_SLABS));
+
+    uint64_t offsets[NUM_SLABS];
+    for (int i = 0; i < NUM_SLABS; ++i) {
+        TEST_ASSERT_EQUAL_INT(0, slab_pool_take(pool, &offsets[i]));
+    }
+    TEST_ASSERT_EQUAL_INT(-1, slab_pool_take(pool, &offsets[0]));
+
+    // 停止补充后归还空间，池不应再增长
+    slab_pool_set_depth(pool, 0);
+    for (int i = 0; i < NUM_SLABS; ++i) {
+        space_manager_free_slab(manager, offsets[i]);
+    }
+    usleep(50 * 1000);
+    TEST_ASSERT_EQUAL_UINT32(0, slab_pool_available(pool));
+
+    slab_pool_destroy(pool);
+    TEST_ASSERT_EQUAL_UINT64(TOTAL_NVM_SIZE, manager->shards[0].head->size);
+}
+
+/**
+ * @brief 按需预缺页模式：只在请求后补充，请求数受深度限制，且不修改 Slab 内容。
+ */
+void test_slab_pool_on_demand_prefault(void) {
+    NvmSlabPool* pool = slab_pool_create(manager, mock_nvm_base, 2, NVM_SLAB_POOL_ON_DEMAND);
+    TEST_ASSERT_NOT_NULL(pool);
+
+    usleep(50 * 1000);
+    TEST_ASSERT_EQUAL_UINT32(0, slab_pool_available(pool));
+
+    for (int i = 0; i < 5; ++i) {
+        slab_pool_request(pool);
+    }
+    TEST_ASSERT_EQUAL_UINT32(2, wait_available(pool, 2));
+    usleep(50 * 1000);
+    TEST_ASSERT_EQUAL_UINT32(2, slab_pool_available(pool));
+    TEST_ASSERT_EQUAL_UINT32(0, pool->pending);
+
+    uint64_t offset;
+    TEST_ASSERT_EQUAL_INT(0, slab_pool_take(pool, &offset));
+    const unsigned char* p = (const unsigned char*)mock_nvm_base + offset;
+    TEST_ASSERT_EQUAL_HEX8(0xFF, p[0]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, p[NVM_SLAB_SIZE / 2]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, p[NVM_SLAB_SIZE - 1]);
+
+    // 取走后不自动补充
+    usleep(50 * 1000);
+    TEST_ASSERT_EQUAL_UINT32(1, slab_pool_available(pool));
+
+    slab_pool_destroy(pool);
+    space_manager_free_slab(manager, offset);
+    TEST_ASSERT_EQUAL_UINT64(TOTAL_NVM_SIZE, manager->shards[0].head->size);
+}
+
+// ============================================================================
+//                          测试执行入口
+// ============================================================================
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_slab_pool_invalid_params);
+    RUN_TEST(test_slab_pool_fill_and_take);
+    RUN_TEST(test_slab_pool_exhaustion_and_depth);
+    RUN_TEST(test_slab_pool_on_demand_prefault);
+
+    return UNITY_END();
+}
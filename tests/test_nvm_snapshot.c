@@ -0,0 +1,211 @@
+#include "unity.h"
+
+// 包含所有必要的头文件
+#include "NvmDefs.h"
+#include "NvmAllocator.h"
+#include "NvmSnapshot.h"
+
+// 包含实现文件 (白盒测试)
+#include "NvmSnapshot.c"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#define NUM_SLABS      32
+#define TOTAL_NVM_SIZE (NUM_SLABS * (uint64_t)NVM_SLAB_SIZE)
+
+static void* mock_nvm_base = NULL;
+
+void setUp(void) {
+    mock_nvm_base = aligned_alloc(NVM_SLAB_SIZE, TOTAL_NVM_SIZE);
+    TEST_ASSERT_NOT_NULL(mock_nvm_base);
+    memset(mock_nvm_base, 0, TOTAL_NVM_SIZE);
+}
+
+void tearDown(void) {
+    nvm_allocator_destroy();
+    free(mock_nvm_base);
+    mock_nvm_base = NULL;
+}
+
+// ============================================================================
+//                          辅助函数
+// ============================================================================
+
+// 把当前堆写入临时文件并读回
+static void take_snapshot(NvmSnapshot* snap) {
+    FILE* f = tmpfile();
+    TEST_ASSERT_NOT_NULL(f);
+    TEST_ASSERT_EQUAL_INT(0, nvm_heap_snapshot(fileno(f)));
+    TEST_ASSERT_EQUAL_INT(0, (int)lseek(fileno(f), 0, SEEK_SET));
+    TEST_ASSERT_EQUAL_INT(0, nvm_snapshot_load(fileno(f), snap));
+    fclose(f);
+}
+
+static const NvmSnapshotSlab* find_slab(const NvmSnapshot* snap, SizeClassID sc) {
+    for (uint64_t i = 0; i < snap->slab_count; ++i) {
+        if (snap->slabs[i].size_class == sc) return &snap->slabs[i];
+    }
+    TEST_FAIL_MESSAGE("No slab of requested class in snapshot.");
+    return NULL;
+}
+
+// ============================================================================
+//                          测试用例
+// ============================================================================
+
+/**
+ * @brief 往返：占用数与游程按用户持有的块计 (不含环形缓存中的块)，空闲段完整；截断的快照被拒绝。
+ */
+void test_snapshot_round_trip(void) {
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create(mock_nvm_base, TOTAL_NVM_SIZE));
+
+    static void* ptrs[1000];
+    for (int i = 0; i < 1000; ++i) TEST_ASSERT_NOT_NULL(ptrs[i] = nvm_malloc(64));
+    for (int i = 0; i < 1000; i += 2) nvm_free(ptrs[i]);
+    for (int i = 0; i < 10; ++i) TEST_ASSERT_NOT_NULL(nvm_malloc(4096));
+
+    NvmSnapshot snap;
+    take_snapshot(&snap);
+    TEST_ASSERT_EQUAL_UINT16(NVM_SNAPSHOT_VERSION, snap.version);
+    TEST_ASSERT_EQUAL_UINT32(NVM_SLAB_SIZE, snap.slab_size);
+    TEST_ASSERT_EQUAL_UINT32(1, snap.heap_count);
+    TEST_ASSERT_EQUAL_UINT64(TOTAL_NVM_SIZE, snap.heaps[0].range_size);
+    TEST_ASSERT_EQUAL_UINT64(2, snap.slab_count);
+
+    const NvmSnapshotSlab* small = find_slab(&snap, SC_64B);
+    TEST_ASSERT_EQUAL_UINT32(NVM_SLAB_SIZE / 64, small->total);
+    TEST_ASSERT_EQUAL_UINT32(500, small->used);
+    TEST_ASSERT_EQUAL_UINT32(500, small->live_runs);
+    const NvmSnapshotSlab* large = find_slab(&snap, SC_4K);
+    TEST_ASSERT_EQUAL_UINT32(10, large->used);
+    TEST_ASSERT_EQUAL_UINT32(1, large->live_runs);
+
+    NvmSnapshotDiff diff;
+    nvm_snapshot_diff(NULL, &snap, &diff);
+    TEST_ASSERT_EQUAL_UINT64(500, diff.class_blocks[1][SC_64B]);
+    TEST_ASSERT_EQUAL_UINT64(TOTAL_NVM_SIZE - 2 * NVM_SLAB_SIZE, diff.free_bytes[1]);
+    TEST_ASSERT_EQUAL_UINT64(diff.free_bytes[1], diff.largest_extent[1]);
+    TEST_ASSERT_EQUAL_UINT64(1, diff.free_extents[1]);
+    TEST_ASSERT_EQUAL_UINT64(2, diff.slabs_added);
+    nvm_snapshot_release(&snap);
+
+    // 截断：缺少结束记录
+    FILE* f = tmpfile();
+    TEST_ASSERT_EQUAL_INT(0, nvm_heap_snapshot(fileno(f)));
+    long size = lseek(fileno(f), 0, SEEK_END);
+    TEST_ASSERT_TRUE(size > NVM_SNAPSHOT_HEADER_SIZE && size < 4096);
+    TEST_ASSERT_EQUAL_INT(0, ftruncate(fileno(f), size - 1));
+    TEST_ASSERT_EQUAL_INT(0, (int)lseek(fileno(f), 0, SEEK_SET));
+    TEST_ASSERT_EQUAL_INT(-1, nvm_snapshot_load(fileno(f), &snap));
+    fclose(f);
+}
+
+/**
+ * @brief 差异：新增与移除的 Slab、各类别增长，以及占用率跌破阈值的新增搁浅 Slab。
+ */
+void test_snapshot_diff_reports_churn_and_stranding(void) {
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create(mock_nvm_base, TOTAL_NVM_SIZE));
+
+    static void* small[600];
+    static void* large[200];
+    for (int i = 0; i < 600; ++i) TEST_ASSERT_NOT_NULL(small[i] = nvm_malloc(64));
+    for (int i = 0; i < 200; ++i) TEST_ASSERT_NOT_NULL(large[i] = nvm_malloc(4096));
+
+    NvmSnapshot before;
+    take_snapshot(&before);
+    uint64_t large_offset = find_slab(&before, SC_4K)->offset;
+
+    // 4K Slab 只留 1 块 (1/512 < 10%)；64B Slab 全部释放并归还；新增一个 8B Slab
+    for (int i = 1; i < 200; ++i) nvm_free(large[i]);
+    for (int i = 0; i < 600; ++i) nvm_free(small[i]);
+    TEST_ASSERT_TRUE(nvm_allocator_trim() >= 1);
+    for (int i = 0; i < 300; ++i) TEST_ASSERT_NOT_NULL(nvm_malloc(8));
+
+    NvmSnapshot after;
+    take_snapshot(&after);
+
+    NvmSnapshotDiff diff;
+    nvm_snapshot_diff(&before, &after, &diff);
+    TEST_ASSERT_EQUAL_UINT64(1, diff.slabs_kept);
+    TEST_ASSERT_EQUAL_UINT64(1, diff.slabs_removed + diff.slabs_reclassed);
+    TEST_ASSERT_EQUAL_UINT64(1, diff.class_slabs[0][SC_64B]);
+    TEST_ASSERT_EQUAL_UINT64(0, diff.class_slabs[1][SC_64B]);
+    TEST_ASSERT_EQUAL_UINT64(300, diff.class_blocks[1][SC_8B]);
+    TEST_ASSERT_EQUAL_UINT64(200, diff.class_blocks[0][SC_4K]);
+    TEST_ASSERT_EQUAL_UINT64(1, diff.class_blocks[1][SC_4K]);
+    // 稀疏的 64B 与新建的 8B Slab 同样低于阈值，但只有保留下来的 4K Slab 算新增搁浅
+    TEST_ASSERT_EQUAL_UINT64(1, diff.stranded[0]);
+    TEST_ASSERT_EQUAL_UINT64(2, diff.stranded[1]);
+    TEST_ASSERT_EQUAL_UINT64(1, diff.newly_stranded);
+    TEST_ASSERT_EQUAL_UINT64(large_offset, diff.stranded_sample[0]);
+
+    nvm_snapshot_release(&before);
+    nvm_snapshot_release(&after);
+}
+
+/**
+ * @brief 易失模式的 Slab 没有位图，只记录占用数。
+ */
+void test_snapshot_volatile_slab(void) {
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create_ex(mock_nvm_base, TOTAL_NVM_SIZE, NVM_CREATE_VOLATILE));
+    void* p[3];
+    for (int i = 0; i < 3; ++i) TEST_ASSERT_NOT_NULL(p[i] = nvm_malloc(128));
+    nvm_free(p[1]);
+
+    NvmSnapshot snap;
+    take_snapshot(&snap);
+    TEST_ASSERT_EQUAL_UINT64(1, snap.slab_count);
+    TEST_ASSERT_EQUAL_UINT8(NVM_SNAPSHOT_SLAB_VOLATILE, snap.slabs[0].flags);
+    TEST_ASSERT_EQUAL_UINT32(2, snap.slabs[0].used);
+    TEST_ASSERT_EQUAL_UINT32(0, snap.slabs[0].live_runs);
+    nvm_snapshot_release(&snap);
+}
+
+// 快照期间持续分配/释放的线程
+static volatile int g_stop = 0;
+
+static void* churn_worker(void* arg) {
+    (void)arg;
+    void* ptrs[256];
+    while (!g_stop) {
+        for (int i = 0; i < 256; ++i) ptrs[i] = nvm_malloc(32 << (i % 6));
+        for (int i = 0; i < 256; ++i) nvm_free(ptrs[i]);
+    }
+    return NULL;
+}
+
+/**
+ * @brief 不暂停分配：并发分配与释放时每份快照仍然完整可解析。
+ */
+void test_snapshot_concurrent_with_allocation(void) {
+    TEST_ASSERT_EQUAL_INT(0, nvm_allocator_create(mock_nvm_base, TOTAL_NVM_SIZE));
+
+    g_stop = 0;
+    pthread_t worker;
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&worker, NULL, churn_worker, NULL));
+    for (int i = 0; i < 50; ++i) {
+        NvmSnapshot snap;
+        take_snapshot(&snap);
+        TEST_ASSERT_TRUE(snap.slab_count <= NUM_SLABS);
+        nvm_snapshot_release(&snap);
+    }
+    g_stop = 1;
+    pthread_join(worker, NULL);
+}
+
+// ============================================================================
+//                          测试执行入口
+// ============================================================================
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_snapshot_round_trip);
+    RUN_TEST(test_snapshot_diff_reports_churn_and_stranding);
+    RUN_TEST(test_snapshot_volatile_slab);
+    RUN_TEST(test_snapshot_concurrent_with_allocation);
+
+    return UNITY_END();
+}
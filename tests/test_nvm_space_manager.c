@@ -24,12 +24,12 @@ void tearDown(void) {}
 
 // 辅助函数，用于验证链表中只有一个节点，并且其属性正确
 static void verify_single_node_state(FreeSpaceManager* manager, uint64_t expected_offset, uint64_t expected_size) {
-    TEST_ASSERT_NOT_NULL_MESSAGE(manager->head, "Manager head should not be NULL.");
-    TEST_ASSERT_EQUAL_PTR_MESSAGE(manager->head, manager->tail, "Head and tail should be the same for a single node list.");
-    TEST_ASSERT_NULL_MESSAGE(manager->head->prev, "Single node's prev should be NULL.");
-    TEST_ASSERT_NULL_MESSAGE(manager->head->next, "Single node's next should be NULL.");
-    TEST_ASSERT_EQUAL_UINT64_MESSAGE(expected_offset, manager->head->nvm_offset, "Node offset mismatch.");
-    TEST_ASSERT_EQUAL_UINT64_MESSAGE(expected_size, manager->head->size, "Node size mismatch.");
+    TEST_ASSERT_NOT_NULL_MESSAGE(manager->shards[0].head, "Manager head should not be NULL.");
+    TEST_ASSERT_EQUAL_PTR_MESSAGE(manager->shards[0].head, manager->shards[0].tail, "Head and tail should be the same for a single node list.");
+    TEST_ASSERT_NULL_MESSAGE(manager->shards[0].head->prev, "Single node's prev should be NULL.");
+    TEST_ASSERT_NULL_MESSAGE(manager->shards[0].head->next, "Single node's next should be NULL.");
+    TEST_ASSERT_EQUAL_UINT64_MESSAGE(expected_offset, manager->shards[0].head->nvm_offset, "Node offset mismatch.");
+    TEST_ASSERT_EQUAL_UINT64_MESSAGE(expected_size, manager->shards[0].head->size, "Node size mismatch.");
 }
 
 
@@ -79,10 +79,10 @@ void test_alloc_and_free_with_merging(void) {
     space_manager_free_slab(manager, c1);
     
     // 链表应为: [c1] -> [c3-c9]
-    TEST_ASSERT_EQUAL_UINT64(c1, manager->head->nvm_offset);
-    TEST_ASSERT_EQUAL_UINT64(NVM_SLAB_SIZE, manager->head->size);
-    TEST_ASSERT_NOT_NULL(manager->head->next);
-    TEST_ASSERT_EQUAL_UINT64(offset_after_c2, manager->head->next->nvm_offset);
+    TEST_ASSERT_EQUAL_UINT64(c1, manager->shards[0].head->nvm_offset);
+    TEST_ASSERT_EQUAL_UINT64(NVM_SLAB_SIZE, manager->shards[0].head->size);
+    TEST_ASSERT_NOT_NULL(manager->shards[0].head->next);
+    TEST_ASSERT_EQUAL_UINT64(offset_after_c2, manager->shards[0].head->next->nvm_offset);
     space_manager_destroy(manager);
 
     // ========================================================================
@@ -96,8 +96,8 @@ void test_alloc_and_free_with_merging(void) {
     space_manager_free_slab(manager, c0); // 再释放 c0，应与 c1 向前合并
     
     // 链表应为: [c0-c1] -> [c2-c9]
-    TEST_ASSERT_EQUAL_UINT64(c0, manager->head->nvm_offset);
-    TEST_ASSERT_EQUAL_UINT64(10 * NVM_SLAB_SIZE, manager->head->size);
+    TEST_ASSERT_EQUAL_UINT64(c0, manager->shards[0].head->nvm_offset);
+    TEST_ASSERT_EQUAL_UINT64(10 * NVM_SLAB_SIZE, manager->shards[0].head->size);
     space_manager_destroy(manager);
 
     // ========================================================================
@@ -127,8 +127,8 @@ void test_alloc_and_free_with_merging(void) {
     space_manager_free_slab(manager, c1); // 释放 c1, 它应该和 [c2] 向后合并
     
     // 链表应为: [c1-c2] -> [c4-c9]
-    TEST_ASSERT_EQUAL_UINT64(c1, manager->head->nvm_offset);
-    TEST_ASSERT_EQUAL_UINT64(2 * NVM_SLAB_SIZE, manager->head->size);
+    TEST_ASSERT_EQUAL_UINT64(c1, manager->shards[0].head->nvm_offset);
+    TEST_ASSERT_EQUAL_UINT64(2 * NVM_SLAB_SIZE, manager->shards[0].head->size);
     space_manager_destroy(manager);
 
     // ========================================================================
@@ -148,9 +148,9 @@ void test_alloc_and_free_with_merging(void) {
     space_manager_free_slab(manager, c2); // 释放 c2, 连接 [c1] 和 [c3]
     
     // 链表应为: [c1-c3] -> [c5-c9]
-    TEST_ASSERT_EQUAL_UINT64(c1, manager->head->nvm_offset);
-    TEST_ASSERT_EQUAL_UINT64(3 * NVM_SLAB_SIZE, manager->head->size);
-    TEST_ASSERT_NOT_NULL(manager->head->next);
+    TEST_ASSERT_EQUAL_UINT64(c1, manager->shards[0].head->nvm_offset);
+    TEST_ASSERT_EQUAL_UINT64(3 * NVM_SLAB_SIZE, manager->shards[0].head->size);
+    TEST_ASSERT_NOT_NULL(manager->shards[0].head->next);
     space_manager_destroy(manager);
 }
 
@@ -174,7 +174,7 @@ void test_full_allocation_and_deallocation_cycle(void) {
     }
     
     // --- 2. 验证空间已耗尽 ---
-    TEST_ASSERT_NULL_MESSAGE(manager->head, "Manager should be empty after full allocation.");
+    TEST_ASSERT_NULL_MESSAGE(manager->shards[0].head, "Manager should be empty after full allocation.");
     uint64_t extra_alloc = space_manager_alloc_slab(manager);
     TEST_ASSERT_EQUAL_UINT64_MESSAGE((uint64_t)-1, extra_alloc, "Allocation should fail when space is exhausted.");
 
@@ -191,13 +191,145 @@ void test_full_allocation_and_deallocation_cycle(void) {
         uint64_t offset = space_manager_alloc_slab(manager);
         TEST_ASSERT_NOT_EQUAL((uint64_t)-1, offset);
     }
-    TEST_ASSERT_NULL_MESSAGE(manager->head, "Re-allocation should also exhaust the manager.");
+    TEST_ASSERT_NULL_MESSAGE(manager->shards[0].head, "Re-allocation should also exhaust the manager.");
 
     // 清理
     free(offsets);
     space_manager_destroy(manager);
 }
 
+/**
+ * @brief 测试 space_manager_add_range：不连续区间插入、相邻合并、重叠拒绝。
+ */
+void test_add_range_merges_and_rejects_overlap(void) {
+    FreeSpaceManager* manager = space_manager_create(2 * NVM_SLAB_SIZE, 0);
+    TEST_ASSERT_NOT_NULL(manager);
+
+    // 1. 参数校验与重叠
+    TEST_ASSERT_EQUAL_INT(-1, space_manager_add_range(NULL, 8 * NVM_SLAB_SIZE, NVM_SLAB_SIZE));
+    TEST_ASSERT_EQUAL_INT(-1, space_manager_add_range(manager, 8 * NVM_SLAB_SIZE, NVM_SLAB_SIZE - 1));
+    TEST_ASSERT_EQUAL_INT(-1, space_manager_add_range(manager, NVM_SLAB_SIZE, 2 * NVM_SLAB_SIZE));
+
+    // 2. 不连续区间：追加为独立节点
+    TEST_ASSERT_EQUAL_INT(0, space_manager_add_range(manager, 8 * NVM_SLAB_SIZE, 2 * NVM_SLAB_SIZE));
+    TEST_ASSERT_EQUAL_UINT64(8 * NVM_SLAB_SIZE, manager->shards[0].tail->nvm_offset);
+    TEST_ASSERT_EQUAL_UINT64(2 * NVM_SLAB_SIZE, manager->shards[0].tail->size);
+
+    // 3. 填补空洞：三段合并为一段
+    TEST_ASSERT_EQUAL_INT(0, space_manager_add_range(manager, 2 * NVM_SLAB_SIZE, 6 * NVM_SLAB_SIZE));
+    verify_single_node_state(manager, 0, 10 * NVM_SLAB_SIZE);
+
+    for (int i = 0; i < 10; ++i) {
+        TEST_ASSERT_EQUAL_UINT64((uint64_t)i * NVM_SLAB_SIZE, space_manager_alloc_slab(manager));
+    }
+    TEST_ASSERT_EQUAL_UINT64((uint64_t)-1, space_manager_alloc_slab(manager));
+
+    space_manager_destroy(manager);
+}
+
+
+/**
+ * @brief 大空间按条带分片：归属分片优先、耗尽后窃取、释放回到所属分片并合并。
+ */
+void test_sharded_alloc_steal_and_return(void) {
+    const uint64_t total = (uint64_t)NVM_SPACE_MAX_SHARDS * 2 * NVM_SPACE_STRIPE_SIZE;
+    const uint64_t total_slabs = total / NVM_SLAB_SIZE;
+    FreeSpaceManager* manager = space_manager_create(total, 0);
+    TEST_ASSERT_NOT_NULL(manager);
+    TEST_ASSERT_EQUAL_UINT32(NVM_SPACE_MAX_SHARDS, manager->shard_count);
+    TEST_ASSERT_EQUAL_UINT64(total, space_manager_free_bytes(manager));
+
+    // 每个分片持有 2 个不相邻的条带
+    for (uint32_t i = 0; i < manager->shard_count; ++i) {
+        FreeSpaceShard* shard = &manager->shards[i];
+        TEST_ASSERT_EQUAL_UINT64(i * NVM_SPACE_STRIPE_SIZE, shard->head->nvm_offset);
+        TEST_ASSERT_EQUAL_UINT64((i + NVM_SPACE_MAX_SHARDS) * NVM_SPACE_STRIPE_SIZE, shard->tail->nvm_offset);
+        TEST_ASSERT_EQUAL_UINT64(2 * NVM_SPACE_STRIPE_SIZE, shard->free_bytes);
+    }
+
+    // 归属分片 (CPU 0 -> 分片 0) 先被用尽，随后从其他分片窃取
+    uint32_t home = (uint32_t)NVM_GET_CURRENT_CPU_ID() % manager->shard_count;
+    uint64_t* offsets = malloc(total_slabs * sizeof(uint64_t));
+    TEST_ASSERT_NOT_NULL(offsets);
+    for (uint64_t i = 0; i < total_slabs; ++i) {
+        offsets[i] = space_manager_alloc_slab(manager);
+        TEST_ASSERT_NOT_EQUAL((uint64_t)-1, offsets[i]);
+        if (i < 2 * NVM_SPACE_STRIPE_SLABS) {
+            TEST_ASSERT_EQUAL_PTR(&manager->shards[home], shard_of(manager, offsets[i]));
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT64((uint64_t)-1, space_manager_alloc_slab(manager));
+    TEST_ASSERT_EQUAL_UINT64(0, space_manager_free_bytes(manager));
+
+    // 逆序释放：各分片重新合并回两个完整条带
+    for (uint64_t i = total_slabs; i-- > 0;) {
+        space_manager_free_slab(manager, offsets[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT64(total, space_manager_free_bytes(manager));
+    for (uint32_t i = 0; i < manager->shard_count; ++i) {
+        FreeSpaceShard* shard = &manager->shards[i];
+        TEST_ASSERT_NOT_NULL(shard->head->next);
+        TEST_ASSERT_EQUAL_PTR(shard->head->next, shard->tail);
+        TEST_ASSERT_EQUAL_UINT64(NVM_SPACE_STRIPE_SIZE, shard->head->size);
+        TEST_ASSERT_EQUAL_UINT64(NVM_SPACE_STRIPE_SIZE, shard->tail->size);
+    }
+
+    // 跨条带的扩容区间被切开分给各自分片；恢复占位定位到所属分片
+    TEST_ASSERT_EQUAL_INT(0, space_manager_add_range(manager, total + NVM_SLAB_SIZE, NVM_SPACE_STRIPE_SIZE));
+    TEST_ASSERT_EQUAL_UINT64(total + NVM_SPACE_STRIPE_SIZE, space_manager_free_bytes(manager));
+    TEST_ASSERT_EQUAL_UINT64(total + NVM_SLAB_SIZE, manager->shards[0].tail->nvm_offset);
+    TEST_ASSERT_EQUAL_UINT64(NVM_SPACE_STRIPE_SIZE - NVM_SLAB_SIZE, manager->shards[0].tail->size);
+    TEST_ASSERT_EQUAL_UINT64(total + NVM_SPACE_STRIPE_SIZE, manager->shards[1].tail->nvm_offset);
+    TEST_ASSERT_EQUAL_UINT64(NVM_SLAB_SIZE, manager->shards[1].tail->size);
+    TEST_ASSERT_EQUAL_INT(0, space_manager_alloc_at_offset(manager, 3 * NVM_SPACE_STRIPE_SIZE));
+    TEST_ASSERT_EQUAL_UINT64(2 * NVM_SPACE_STRIPE_SIZE - NVM_SLAB_SIZE, manager->shards[3].free_bytes);
+
+    free(offsets);
+    space_manager_destroy(manager);
+}
+
+typedef struct ShardWorkerArg {
+    FreeSpaceManager* manager;
+    int               rounds;
+} ShardWorkerArg;
+
+static void* shard_worker(void* arg) {
+    ShardWorkerArg* w = (ShardWorkerArg*)arg;
+    uint64_t held[8];
+    for (int r = 0; r < w->rounds; ++r) {
+        int n = 0;
+        while (n < 8 && (held[n] = space_manager_alloc_slab(w->manager)) != (uint64_t)-1) n++;
+        while (n > 0) space_manager_free_slab(w->manager, held[--n]);
+    }
+    return NULL;
+}
+
+/**
+ * @brief 多线程并发分配/释放后，空闲空间完整复原。
+ */
+void test_sharded_concurrent_alloc_free(void) {
+    const uint64_t total = (uint64_t)NVM_SPACE_MAX_SHARDS * NVM_SPACE_STRIPE_SIZE;
+    FreeSpaceManager* manager = space_manager_create(total, 0);
+    TEST_ASSERT_NOT_NULL(manager);
+
+    enum { THREADS = 4 };
+    pthread_t threads[THREADS];
+    ShardWorkerArg arg = { manager, 2000 };
+    for (int i = 0; i < THREADS; ++i) {
+        TEST_ASSERT_EQUAL_INT(0, pthread_create(&threads[i], NULL, shard_worker, &arg));
+    }
+    for (int i = 0; i < THREADS; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    TEST_ASSERT_EQUAL_UINT64(total, space_manager_free_bytes(manager));
+    for (uint32_t i = 0; i < manager->shard_count; ++i) {
+        TEST_ASSERT_EQUAL_PTR(manager->shards[i].head, manager->shards[i].tail);
+        TEST_ASSERT_EQUAL_UINT64(NVM_SPACE_STRIPE_SIZE, manager->shards[i].head->size);
+    }
+    space_manager_destroy(manager);
+}
+
 
 // ============================================================================
 //                          测试执行入口
@@ -208,6 +340,9 @@ int main(void) {
     RUN_TEST(test_space_manager_creation_and_destruction);
     RUN_TEST(test_alloc_and_free_with_merging);
     RUN_TEST(test_full_allocation_and_deallocation_cycle);
+    RUN_TEST(test_add_range_merges_and_rejects_overlap);
+    RUN_TEST(test_sharded_alloc_steal_and_return);
+    RUN_TEST(test_sharded_concurrent_alloc_free);
 
     return UNITY_END();
 }
\ No newline at end of file
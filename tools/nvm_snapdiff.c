@@ -0,0 +1,115 @@
+/*
+ * nvm_snapdiff.c
+ *
+ * 堆快照比较工具
+ * 目的：比较 nvm_heap_snapshot 在不同时刻写出的两份快照，跟踪碎片随时间的漂移。
+ *
+ * 输出：
+ *   - 各尺寸类别的 Slab 数与存活块数的增长
+ *   - Slab 周转：保留、新增、移除、改类
+ *   - 搁浅 Slab (非空但占用率低于 NVM_SNAPSHOT_STRANDED_PCT%)：两边总数与新增搁浅的偏移样本
+ *   - 空闲空间：字节数、连续区间数、最大区间
+ *
+ * 只给一份快照时打印其汇总。
+ *
+ * 用法: ./nvm_snapdiff <old_snapshot> [new_snapshot]
+ * 退出码: 0 成功, 2 参数错误或快照无效
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "NvmDefs.h"
+#include "NvmSnapshot.h"
+
+// ============================================================================
+//                          输出
+// ============================================================================
+
+static int load_file(const char* path, NvmSnapshot* snap) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+    int ret = nvm_snapshot_load(fd, snap);
+    close(fd);
+    if (ret != 0) fprintf(stderr, "%s: invalid snapshot.\n", path);
+    return ret;
+}
+
+static long long delta(uint64_t before, uint64_t after) {
+    return (long long)after - (long long)before;
+}
+
+static void print_diff(const NvmSnapshot* before, const NvmSnapshot* after, const NvmSnapshotDiff* d) {
+    printf("==================================================================\n");
+    if (before) {
+        printf("  Heap snapshot diff (%.1f s apart)\n",
+               (double)((long long)after->timestamp_ns - (long long)before->timestamp_ns) / 1e9);
+    } else {
+        printf("  Heap snapshot summary\n");
+    }
+    printf("==================================================================\n");
+    printf("%-8s | %19s | %25s\n", "Class", "Slabs (old -> new)", "Live blocks (old -> new)");
+    printf("------------------------------------------------------------------\n");
+    for (int sc = 0; sc < SC_COUNT; ++sc) {
+        if (!d->class_slabs[0][sc] && !d->class_slabs[1][sc]) continue;
+        printf("%6uB  | %5llu -> %5llu %+5lld | %8llu -> %8llu %+7lld\n", 8u << sc,
+               (unsigned long long)d->class_slabs[0][sc], (unsigned long long)d->class_slabs[1][sc],
+               delta(d->class_slabs[0][sc], d->class_slabs[1][sc]),
+               (unsigned long long)d->class_blocks[0][sc], (unsigned long long)d->class_blocks[1][sc],
+               delta(d->class_blocks[0][sc], d->class_blocks[1][sc]));
+    }
+    printf("------------------------------------------------------------------\n");
+    if (before) {
+        printf("Slab churn           : %llu kept, %llu added, %llu removed, %llu reclassed\n",
+               (unsigned long long)d->slabs_kept, (unsigned long long)d->slabs_added,
+               (unsigned long long)d->slabs_removed, (unsigned long long)d->slabs_reclassed);
+    }
+    printf("Stranded slabs (<%d%%): %llu -> %llu\n", NVM_SNAPSHOT_STRANDED_PCT,
+           (unsigned long long)d->stranded[0], (unsigned long long)d->stranded[1]);
+    if (d->newly_stranded) {
+        printf("Newly stranded       : %llu\n", (unsigned long long)d->newly_stranded);
+        uint64_t shown = d->newly_stranded < NVM_SNAPSHOT_SAMPLE ? d->newly_stranded : NVM_SNAPSHOT_SAMPLE;
+        for (uint64_t i = 0; i < shown; ++i) {
+            printf("    0x%llx\n", (unsigned long long)d->stranded_sample[i]);
+        }
+    }
+    printf("Free bytes           : %llu -> %llu\n",
+           (unsigned long long)d->free_bytes[0], (unsigned long long)d->free_bytes[1]);
+    printf("Free extents         : %llu -> %llu (largest %llu -> %llu bytes)\n",
+           (unsigned long long)d->free_extents[0], (unsigned long long)d->free_extents[1],
+           (unsigned long long)d->largest_extent[0], (unsigned long long)d->largest_extent[1]);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "Usage: %s <old_snapshot> [new_snapshot]\n", argv[0]);
+        return 2;
+    }
+
+    NvmSnapshot first, second;
+    if (load_file(argv[1], &first) != 0) return 2;
+
+    NvmSnapshotDiff diff;
+    if (argc == 2) {
+        nvm_snapshot_diff(NULL, &first, &diff);
+        print_diff(NULL, &first, &diff);
+        nvm_snapshot_release(&first);
+        return 0;
+    }
+
+    if (load_file(argv[2], &second) != 0) {
+        nvm_snapshot_release(&first);
+        return 2;
+    }
+    nvm_snapshot_diff(&first, &second, &diff);
+    print_diff(&first, &second, &diff);
+    nvm_snapshot_release(&first);
+    nvm_snapshot_release(&second);
+    return 0;
+}